@@ -21,8 +21,10 @@ import android.util.Log;
 
 import org.futo.inputmethod.keyboard.internal.TouchPositionCorrection;
 import org.futo.inputmethod.latin.common.Constants;
+import org.futo.inputmethod.latin.utils.ExecutorUtils;
 import org.futo.inputmethod.latin.utils.JniUtils;
 
+import java.io.File;
 import java.util.ArrayList;
 import java.util.Arrays;
 import java.util.Collections;
@@ -41,6 +43,13 @@ public class ProximityInfo {
     @Nonnull
     private static final List<Key> EMPTY_KEY_LIST = Collections.emptyList();
     private static final float DEFAULT_TOUCH_POSITION_CORRECTION_RADIUS = 0.15f;
+    // Must be changed whenever what the native proximity info is computed from changes, so that
+    // layouts cached by an older version are not used.
+    private static final long LAYOUT_HASH_VERSION = 1;
+
+    // Native cache of proximity infos by layout hash, persisted across processes. 0 until
+    // setLayoutCacheFile() is called.
+    private static volatile long sNativeLayoutCache;
 
     private final int mGridWidth;
     private final int mGridHeight;
@@ -56,6 +65,9 @@ public class ProximityInfo {
     private final List<Key> mSortedKeys;
     @Nonnull
     private final List<Key>[] mGridNeighbors;
+    // The native proximity info doesn't need mGridNeighbors when it is restored from the layout
+    // cache, so they are only computed when nearest keys are first asked for.
+    private boolean mHasGridNeighbors;
 
     @SuppressWarnings("unchecked")
     ProximityInfo(final int gridWidth, final int gridHeight, final int minWidth, final int height,
@@ -77,8 +89,28 @@ public class ProximityInfo {
             // No proximity required. Keyboard might be more keys keyboard.
             return;
         }
-        computeNearestNeighbors();
-        mNativeProximityInfo = createNativeProximityInfo(touchPositionCorrection);
+        final long layoutCache = sNativeLayoutCache;
+        final long layoutHash = computeLayoutHash(touchPositionCorrection);
+        if (layoutCache != 0) {
+            mNativeProximityInfo =
+                    createProximityInfoFromLayoutCacheNative(layoutCache, layoutHash);
+            if (mNativeProximityInfo != 0) {
+                return;
+            }
+        }
+        ensureGridNeighbors();
+        mNativeProximityInfo = createNativeProximityInfo(touchPositionCorrection, layoutCache,
+                layoutHash);
+        if (layoutCache != 0) {
+            // The new layout is only kept in memory so far, writing it out would hold up the
+            // keyboard being shown.
+            ExecutorUtils.getBackgroundExecutor(ExecutorUtils.KEYBOARD).execute(new Runnable() {
+                @Override
+                public void run() {
+                    writeLayoutCacheNative(layoutCache);
+                }
+            });
+        }
     }
 
     private long mNativeProximityInfo;
@@ -91,10 +123,73 @@ public class ProximityInfo {
             int gridWidth, int gridHeight, int mostCommonKeyWidth, int mostCommonKeyHeight,
             int[] proximityCharsArray, int keyCount, int[] keyXCoordinates, int[] keyYCoordinates,
             int[] keyWidths, int[] keyHeights, int[] keyCharCodes, float[] sweetSpotCenterXs,
-            float[] sweetSpotCenterYs, float[] sweetSpotRadii);
+            float[] sweetSpotCenterYs, float[] sweetSpotRadii, long layoutCache, long layoutHash);
 
     private static native void releaseProximityInfoNative(long nativeProximityInfo);
 
+    private static native long openLayoutCacheNative(String filePath);
+
+    private static native long createProximityInfoFromLayoutCacheNative(long layoutCache,
+            long layoutHash);
+
+    private static native void writeLayoutCacheNative(long layoutCache);
+
+    /**
+     * Sets the file in which proximity infos are cached, so that keyboards with a layout that was
+     * seen before skip computing them. The first call wins; the cache lives as long as the process.
+     */
+    public static synchronized void setLayoutCacheFile(@Nonnull final File file) {
+        if (sNativeLayoutCache == 0) {
+            sNativeLayoutCache = openLayoutCacheNative(file.getAbsolutePath());
+        }
+    }
+
+    // Hashes everything the native proximity info is computed from.
+    private long computeLayoutHash(@Nonnull final TouchPositionCorrection touchPositionCorrection) {
+        long hash = LAYOUT_HASH_VERSION;
+        hash = hashInt(hash, mGridWidth);
+        hash = hashInt(hash, mGridHeight);
+        hash = hashInt(hash, mKeyboardMinWidth);
+        hash = hashInt(hash, mKeyboardHeight);
+        hash = hashInt(hash, mMostCommonKeyWidth);
+        hash = hashInt(hash, mMostCommonKeyHeight);
+        hash = hashInt(hash, mSortedKeys.size());
+        for (final Key key : mSortedKeys) {
+            hash = hashInt(hash, key.getCode());
+            hash = hashInt(hash, key.getX());
+            hash = hashInt(hash, key.getY());
+            hash = hashInt(hash, key.getWidth());
+            hash = hashInt(hash, key.getHeight());
+            final Rect hitBox = key.getHitBox();
+            hash = hashInt(hash, hitBox.left);
+            hash = hashInt(hash, hitBox.top);
+            hash = hashInt(hash, hitBox.right);
+            hash = hashInt(hash, hitBox.bottom);
+            hash = hashInt(hash, key.isSpacer() ? 1 : 0);
+        }
+        if (touchPositionCorrection.isValid()) {
+            final int rows = touchPositionCorrection.getRows();
+            hash = hashInt(hash, rows);
+            for (int row = 0; row < rows; ++row) {
+                hash = hashInt(hash, Float.floatToIntBits(touchPositionCorrection.getX(row)));
+                hash = hashInt(hash, Float.floatToIntBits(touchPositionCorrection.getY(row)));
+                hash = hashInt(hash, Float.floatToIntBits(touchPositionCorrection.getRadius(row)));
+            }
+        } else {
+            hash = hashInt(hash, -1);
+        }
+        return hash;
+    }
+
+    // FNV-1a over the four bytes of the value.
+    private static long hashInt(long hash, final int value) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            hash ^= (value >>> shift) & 0xFF;
+            hash *= 0x100000001B3L;
+        }
+        return hash;
+    }
+
     static boolean needsProximityInfo(final Key key) {
         // Don't include special keys into ProximityInfo.
         return key.getCode() >= Constants.CODE_SPACE;
@@ -111,7 +206,8 @@ public class ProximityInfo {
     }
 
     private long createNativeProximityInfo(
-            @Nonnull final TouchPositionCorrection touchPositionCorrection) {
+            @Nonnull final TouchPositionCorrection touchPositionCorrection, final long layoutCache,
+            final long layoutHash) {
         final List<Key>[] gridNeighborKeys = mGridNeighbors;
         final int[] proximityCharsArray = new int[mGridSize * MAX_PROXIMITY_CHARS_SIZE];
         Arrays.fill(proximityCharsArray, Constants.NOT_A_CODE);
@@ -222,7 +318,7 @@ public class ProximityInfo {
         return setProximityInfoNative(mKeyboardMinWidth, mKeyboardHeight, mGridWidth, mGridHeight,
                 mMostCommonKeyWidth, mMostCommonKeyHeight, proximityCharsArray, keyCount,
                 keyXCoordinates, keyYCoordinates, keyWidths, keyHeights, keyCharCodes,
-                sweetSpotCenterXs, sweetSpotCenterYs, sweetSpotRadii);
+                sweetSpotCenterXs, sweetSpotCenterYs, sweetSpotRadii, layoutCache, layoutHash);
     }
 
     public long getNativeProximityInfo() {
@@ -241,6 +337,14 @@ public class ProximityInfo {
         }
     }
 
+    private synchronized void ensureGridNeighbors() {
+        if (mHasGridNeighbors) {
+            return;
+        }
+        computeNearestNeighbors();
+        mHasGridNeighbors = true;
+    }
+
     private void computeNearestNeighbors() {
         final int defaultWidth = mMostCommonKeyWidth;
         final int keyCount = mSortedKeys.size();
@@ -397,6 +501,7 @@ y |---+---+---+---+-v-+-|-+---+---+---+---+---|          | thresholdBase and get
         if (x >= 0 && x < mKeyboardMinWidth && y >= 0 && y < mKeyboardHeight) {
             int index = (y / mCellHeight) * mGridWidth + (x / mCellWidth);
             if (index < mGridSize) {
+                ensureGridNeighbors();
                 return mGridNeighbors[index];
             }
         }
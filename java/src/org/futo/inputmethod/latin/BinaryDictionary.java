@@ -38,6 +38,7 @@ import org.futo.inputmethod.latin.utils.JniUtils;
 import org.futo.inputmethod.latin.utils.WordInputEventForPersonalization;
 
 import java.io.File;
+import java.nio.ByteBuffer;
 import java.util.ArrayList;
 import java.util.Arrays;
 import java.util.HashMap;
@@ -59,6 +60,8 @@ public final class BinaryDictionary extends Dictionary {
 
     public static final int DICTIONARY_MAX_WORD_LENGTH = 48;
     public static final int MAX_PREV_WORD_COUNT_FOR_N_GRAM = 3;
+    // Must be equal to MAX_DICTIONARY_COUNT_IN_SESSION in native/jni/src/defines.h
+    public static final int MAX_DICTIONARY_COUNT_IN_GROUP = 4;
 
     @UsedForTesting
     public static final String UNIGRAM_COUNT_QUERY = "UNIGRAM_COUNT";
@@ -98,6 +101,8 @@ public final class BinaryDictionary extends Dictionary {
 
     private final SparseArray<DicTraverseSession> mDicTraverseSessions = new SparseArray<>();
 
+    private static long sNativeWorkerPool = 0;
+
     // TODO: There should be a way to remove used DicTraverseSession objects from
     // {@code mDicTraverseSessions}.
     private DicTraverseSession getTraverseSession(final int traverseSessionId) {
@@ -198,6 +203,23 @@ public final class BinaryDictionary extends Dictionary {
             int[] outputScores, int[] outputIndices, int[] outputTypes,
             int[] outputAutoCommitFirstWordConfidence,
             float[] inOutWeightOfLangModelVsSpatialModel);
+    private static native void getSuggestionsForGroupNative(long[] dicts, long proximityInfo,
+            long traverseSession, int[] xCoordinates, int[] yCoordinates, int[] times,
+            int[] pointerIds, int[] inputCodePoints, int inputSize, int[] suggestOptions,
+            int[][] prevWordCodePointArrays, boolean[] isBeginningOfSentenceArray,
+            int prevWordCount, int[] outputSuggestionCount, int[] outputCodePoints,
+            int[] outputScores, int[] outputIndices, int[] outputTypes,
+            int[] outputAutoCommitFirstWordConfidence,
+            float[] inOutWeightOfLangModelVsSpatialModel, int[] outputDictionaryIndices);
+    private static native long createWorkerPoolNative(int threadCount);
+    private static native void getSuggestionsInParallelNative(long workerPool, long[] dicts,
+            long[] traverseSessions, long proximityInfo, int[] xCoordinates, int[] yCoordinates,
+            int[] times, int[] pointerIds, int[] inputCodePoints, int inputSize,
+            int[][] suggestOptions, float[] weightsForLocale, int[][] prevWordCodePointArrays,
+            boolean[] isBeginningOfSentenceArray, int prevWordCount,
+            int[] outputSuggestionCount, int[] outputCodePoints, int[] outputScores,
+            int[] outputIndices, int[] outputTypes, int[] outputAutoCommitFirstWordConfidence,
+            float[] inOutWeightOfLangModelVsSpatialModel, int[] outputDictionaryIndices);
     private static native boolean addUnigramEntryNative(long dict, int[] word, int probability,
             int[] shortcutTarget, int shortcutProbability, boolean isBeginningOfSentence,
             boolean isNotAWord, boolean isPossiblyOffensive, int timestamp);
@@ -211,8 +233,9 @@ public final class BinaryDictionary extends Dictionary {
             int[][] prevWordCodePointArrays, boolean[] isBeginningOfSentenceArray,
             int[] word, boolean isValidWord, int count, int timestamp);
     private static native int updateEntriesForInputEventsNative(long dict,
-            WordInputEventForPersonalization[] inputEvents, int startIndex);
+            ByteBuffer packedInputEvents, int inputEventCount, int startIndex);
     private static native String getPropertyNative(long dict, String query);
+    private static native boolean supportsSnapshotReadsNative(long dict);
     private static native boolean isCorruptedNative(long dict);
     private static native boolean migrateNative(long dict, String dictFilePath,
             long newFormatVersion);
@@ -225,6 +248,15 @@ public final class BinaryDictionary extends Dictionary {
     }
 
     // TODO: Check isCorrupted() for main dictionaries.
+    /**
+     * Returns whether lookups can run while the dictionary is being updated. Such dictionaries
+     * keep two copies of their contents and read from the one that isn't being updated.
+     * Operations replacing the native dictionary, like GC, still need exclusive access.
+     */
+    public boolean supportsSnapshotReads() {
+        return isValidDictionary() && supportsSnapshotReadsNative(mNativeDict);
+    }
+
     public boolean isCorrupted() {
         if (!isValidDictionary()) {
             return false;
@@ -274,6 +306,152 @@ public final class BinaryDictionary extends Dictionary {
             return null;
         }
         final DicTraverseSession session = getTraverseSession(sessionId);
+        final int inputSize = setUpSessionAndReturnInputSize(session, composedData, ngramContext,
+                mUseFullEditDistance, settingsValuesForSuggestion, weightForLocale,
+                inOutWeightOfLangModelVsSpatialModel);
+        if (inputSize < 0) {
+            return null;
+        }
+        final InputPointers inputPointers = composedData.mInputPointers;
+        // TOOD: Pass multiple previous words information for n-gram.
+        getSuggestionsNative(mNativeDict, proximityInfoHandle,
+                getTraverseSession(sessionId).getSession(), inputPointers.getXCoordinates(),
+                inputPointers.getYCoordinates(), inputPointers.getTimes(),
+                inputPointers.getPointerIds(), session.mInputCodePoints, inputSize,
+                session.mNativeSuggestOptions.getOptions(), session.mPrevWordCodePointArrays,
+                session.mIsBeginningOfSentenceArray, ngramContext.getPrevWordCount(),
+                session.mOutputSuggestionCount, session.mOutputCodePoints, session.mOutputScores,
+                session.mSpaceIndices, session.mOutputTypes,
+                session.mOutputAutoCommitFirstWordConfidence,
+                session.mInputOutputWeightOfLangModelVsSpatialModel);
+        return readSuggestionsFromSession(session, new BinaryDictionary[] { this },
+                new float[] { weightForLocale }, inOutWeightOfLangModelVsSpatialModel);
+    }
+
+    /**
+     * Searches several dictionaries with a single traversal of the input. Spatial computations
+     * and the search caches are shared, so this is cheaper than calling
+     * {@link #getSuggestions} on each dictionary. Each suggestion's source dictionary is the
+     * dictionary it was found in. The traverse session of the first dictionary is used, so the
+     * largest dictionary should come first. A word found in several dictionaries is returned
+     * once, from the dictionary that scores it best.
+     *
+     * Predictions (empty input) run no search and query each dictionary in turn.
+     */
+    public static ArrayList<SuggestedWordInfo> getSuggestionsForGroup(
+            final BinaryDictionary[] dictionaries, final ComposedData composedData,
+            final NgramContext ngramContext, final long proximityInfoHandle,
+            final SettingsValuesForSuggestion settingsValuesForSuggestion,
+            final int sessionId, final float weightForLocale,
+            final float[] inOutWeightOfLangModelVsSpatialModel) {
+        if (dictionaries.length == 0 || dictionaries.length > MAX_DICTIONARY_COUNT_IN_GROUP) {
+            return null;
+        }
+        final long[] nativeDicts = new long[dictionaries.length];
+        for (int i = 0; i < dictionaries.length; ++i) {
+            if (!dictionaries[i].isValidDictionary()) {
+                return null;
+            }
+            nativeDicts[i] = dictionaries[i].mNativeDict;
+        }
+        final DicTraverseSession session = dictionaries[0].getTraverseSession(sessionId);
+        final int inputSize = setUpSessionAndReturnInputSize(session, composedData, ngramContext,
+                dictionaries[0].mUseFullEditDistance, settingsValuesForSuggestion,
+                weightForLocale, inOutWeightOfLangModelVsSpatialModel);
+        if (inputSize < 0) {
+            return null;
+        }
+        final InputPointers inputPointers = composedData.mInputPointers;
+        getSuggestionsForGroupNative(nativeDicts, proximityInfoHandle, session.getSession(),
+                inputPointers.getXCoordinates(), inputPointers.getYCoordinates(),
+                inputPointers.getTimes(), inputPointers.getPointerIds(),
+                session.mInputCodePoints, inputSize, session.mNativeSuggestOptions.getOptions(),
+                session.mPrevWordCodePointArrays, session.mIsBeginningOfSentenceArray,
+                ngramContext.getPrevWordCount(), session.mOutputSuggestionCount,
+                session.mOutputCodePoints, session.mOutputScores, session.mSpaceIndices,
+                session.mOutputTypes, session.mOutputAutoCommitFirstWordConfidence,
+                session.mInputOutputWeightOfLangModelVsSpatialModel,
+                session.mOutputDictionaryIndices);
+        final float[] weightsForLocale = new float[dictionaries.length];
+        Arrays.fill(weightsForLocale, weightForLocale);
+        return readSuggestionsFromSession(session, dictionaries, weightsForLocale,
+                inOutWeightOfLangModelVsSpatialModel);
+    }
+
+    /**
+     * Runs {@link #getSuggestions} on each dictionary concurrently on a shared native worker pool
+     * and returns the merged suggestions. Each dictionary keeps using its own traverse session,
+     * so its search state is the same as with {@link #getSuggestions}. Scores are scaled by the
+     * weight for locale given for their source dictionary, and a word found in several
+     * dictionaries is returned once, with its best scaled score.
+     */
+    public static ArrayList<SuggestedWordInfo> getSuggestionsInParallel(
+            final BinaryDictionary[] dictionaries, final float[] weightsForLocale,
+            final ComposedData composedData, final NgramContext ngramContext,
+            final long proximityInfoHandle,
+            final SettingsValuesForSuggestion settingsValuesForSuggestion,
+            final int sessionId, final float[] inOutWeightOfLangModelVsSpatialModel) {
+        if (dictionaries.length == 0 || dictionaries.length > MAX_DICTIONARY_COUNT_IN_GROUP
+                || weightsForLocale.length != dictionaries.length) {
+            return null;
+        }
+        final long[] nativeDicts = new long[dictionaries.length];
+        final long[] nativeSessions = new long[dictionaries.length];
+        final int[][] suggestOptions = new int[dictionaries.length][];
+        DicTraverseSession firstSession = null;
+        int inputSize = -1;
+        for (int i = 0; i < dictionaries.length; ++i) {
+            final BinaryDictionary dictionary = dictionaries[i];
+            if (!dictionary.isValidDictionary()) {
+                return null;
+            }
+            final DicTraverseSession session = dictionary.getTraverseSession(sessionId);
+            inputSize = setUpSessionAndReturnInputSize(session, composedData, ngramContext,
+                    dictionary.mUseFullEditDistance, settingsValuesForSuggestion,
+                    weightsForLocale[i], inOutWeightOfLangModelVsSpatialModel);
+            if (inputSize < 0) {
+                return null;
+            }
+            nativeDicts[i] = dictionary.mNativeDict;
+            nativeSessions[i] = session.getSession();
+            suggestOptions[i] = session.mNativeSuggestOptions.getOptions();
+            if (firstSession == null) {
+                firstSession = session;
+            }
+        }
+        final InputPointers inputPointers = composedData.mInputPointers;
+        getSuggestionsInParallelNative(getNativeWorkerPool(), nativeDicts, nativeSessions,
+                proximityInfoHandle, inputPointers.getXCoordinates(),
+                inputPointers.getYCoordinates(), inputPointers.getTimes(),
+                inputPointers.getPointerIds(), firstSession.mInputCodePoints, inputSize,
+                suggestOptions, weightsForLocale, firstSession.mPrevWordCodePointArrays,
+                firstSession.mIsBeginningOfSentenceArray, ngramContext.getPrevWordCount(),
+                firstSession.mOutputSuggestionCount, firstSession.mOutputCodePoints,
+                firstSession.mOutputScores, firstSession.mSpaceIndices,
+                firstSession.mOutputTypes, firstSession.mOutputAutoCommitFirstWordConfidence,
+                firstSession.mInputOutputWeightOfLangModelVsSpatialModel,
+                firstSession.mOutputDictionaryIndices);
+        // The native side weights the results of each dictionary before merging them, so that the
+        // results of a locale with a low weight don't push out better ones of another locale.
+        return readSuggestionsFromSession(firstSession, dictionaries,
+                null /* weightsForLocale */, inOutWeightOfLangModelVsSpatialModel);
+    }
+
+    // The pool lives as long as the process, like the native library, so it is never released.
+    private static synchronized long getNativeWorkerPool() {
+        if (sNativeWorkerPool == 0) {
+            sNativeWorkerPool = createWorkerPoolNative(Math.min(MAX_DICTIONARY_COUNT_IN_GROUP,
+                    Runtime.getRuntime().availableProcessors()));
+        }
+        return sNativeWorkerPool;
+    }
+
+    // Returns the input size, or -1 when the input can't be passed to the native side.
+    private static int setUpSessionAndReturnInputSize(final DicTraverseSession session,
+            final ComposedData composedData, final NgramContext ngramContext,
+            final boolean useFullEditDistance,
+            final SettingsValuesForSuggestion settingsValuesForSuggestion,
+            final float weightForLocale, final float[] inOutWeightOfLangModelVsSpatialModel) {
         Arrays.fill(session.mInputCodePoints, Constants.NOT_A_CODE);
         ngramContext.outputToArray(session.mPrevWordCodePointArrays,
                 session.mIsBeginningOfSentenceArray);
@@ -285,12 +463,12 @@ public final class BinaryDictionary extends Dictionary {
                     composedData.copyCodePointsExceptTrailingSingleQuotesAndReturnCodePointCount(
                         session.mInputCodePoints);
             if (inputSize < 0) {
-                return null;
+                return -1;
             }
         } else {
             inputSize = inputPointers.getPointerSize();
         }
-        session.mNativeSuggestOptions.setUseFullEditDistance(mUseFullEditDistance);
+        session.mNativeSuggestOptions.setUseFullEditDistance(useFullEditDistance);
         session.mNativeSuggestOptions.setIsGesture(isGesture);
         session.mNativeSuggestOptions.setBlockOffensiveWords(
                 settingsValuesForSuggestion.mBlockPotentiallyOffensive);
@@ -302,17 +480,14 @@ public final class BinaryDictionary extends Dictionary {
             session.mInputOutputWeightOfLangModelVsSpatialModel[0] =
                     Dictionary.NOT_A_WEIGHT_OF_LANG_MODEL_VS_SPATIAL_MODEL;
         }
-        // TOOD: Pass multiple previous words information for n-gram.
-        getSuggestionsNative(mNativeDict, proximityInfoHandle,
-                getTraverseSession(sessionId).getSession(), inputPointers.getXCoordinates(),
-                inputPointers.getYCoordinates(), inputPointers.getTimes(),
-                inputPointers.getPointerIds(), session.mInputCodePoints, inputSize,
-                session.mNativeSuggestOptions.getOptions(), session.mPrevWordCodePointArrays,
-                session.mIsBeginningOfSentenceArray, ngramContext.getPrevWordCount(),
-                session.mOutputSuggestionCount, session.mOutputCodePoints, session.mOutputScores,
-                session.mSpaceIndices, session.mOutputTypes,
-                session.mOutputAutoCommitFirstWordConfidence,
-                session.mInputOutputWeightOfLangModelVsSpatialModel);
+        return inputSize;
+    }
+
+    // The output dictionary indices of the session are only read when there are several
+    // dictionaries. weightsForLocale is null when the scores are already weighted.
+    private static ArrayList<SuggestedWordInfo> readSuggestionsFromSession(
+            final DicTraverseSession session, final BinaryDictionary[] dictionaries,
+            final float[] weightsForLocale, final float[] inOutWeightOfLangModelVsSpatialModel) {
         if (inOutWeightOfLangModelVsSpatialModel != null) {
             inOutWeightOfLangModelVsSpatialModel[0] =
                     session.mInputOutputWeightOfLangModelVsSpatialModel[0];
@@ -327,12 +502,17 @@ public final class BinaryDictionary extends Dictionary {
                 ++len;
             }
             if (len > 0) {
+                final int dictionaryIndex =
+                        dictionaries.length > 1 ? session.mOutputDictionaryIndices[j] : 0;
+                final int score = weightsForLocale != null
+                        ? (int)(session.mOutputScores[j] * weightsForLocale[dictionaryIndex])
+                        : session.mOutputScores[j];
                 suggestions.add(new SuggestedWordInfo(
                         new String(session.mOutputCodePoints, start, len),
                         "" /* prevWordsContext */,
-                        (int)(session.mOutputScores[j] * weightForLocale),
+                        score,
                         session.mOutputTypes[j],
-                        this /* sourceDict */,
+                        dictionaries[dictionaryIndex] /* sourceDict */,
                         session.mSpaceIndices[j] /* indexOfTouchPointOfSecondWord */,
                         session.mOutputAutoCommitFirstWordConfidence[0]));
             }
@@ -441,6 +621,27 @@ public final class BinaryDictionary extends Dictionary {
                 getWordProperty(word, isBeginningOfSentence[0]), nextToken);
     }
 
+    @Override
+    public ArrayList<String> getWords() {
+        final ArrayList<String> words = new ArrayList<>();
+        if (!isValidDictionary()) {
+            return words;
+        }
+        final int[] codePoints = new int[DICTIONARY_MAX_WORD_LENGTH];
+        final boolean[] isBeginningOfSentence = new boolean[1];
+        int token = 0;
+        do {
+            // The code points are not null-terminated.
+            Arrays.fill(codePoints, 0);
+            token = getNextWordNative(mNativeDict, token, codePoints, isBeginningOfSentence);
+            final String word = StringUtils.getStringFromNullTerminatedCodePointArray(codePoints);
+            if (!isBeginningOfSentence[0] && !word.isEmpty()) {
+                words.add(word);
+            }
+        } while (token != 0);
+        return words;
+    }
+
     // Add a unigram entry to binary dictionary with unigram attributes in native code.
     public boolean addUnigramEntry(final String word, final int probability,
             final String shortcutTarget, final int shortcutProbability,
@@ -515,17 +716,26 @@ public final class BinaryDictionary extends Dictionary {
         if (!isValidDictionary()) {
             return;
         }
-        int processedEventCount = 0;
-        while (processedEventCount < inputEvents.length) {
+        if (inputEvents.length == 0) {
+            return;
+        }
+        // Native code merges the events of the same word in the same context and applies them
+        // all at once. It only stops early when the dictionary needs GC, and returns the index of
+        // the first merged entry that hasn't been applied.
+        final ByteBuffer packedInputEvents =
+                WordInputEventForPersonalization.toPackedBuffer(inputEvents);
+        int processedEntryCount = 0;
+        while (true) {
             if (needsToRunGC(true /* mindsBlockByGC */)) {
                 flushWithGC();
             }
-            processedEventCount = updateEntriesForInputEventsNative(mNativeDict, inputEvents,
-                    processedEventCount);
+            final int nextEntryIndex = updateEntriesForInputEventsNative(mNativeDict,
+                    packedInputEvents, inputEvents.length, processedEntryCount);
             mHasUpdated = true;
-            if (processedEventCount <= 0) {
+            if (nextEntryIndex <= processedEntryCount || !needsToRunGC(true /* mindsBlockByGC */)) {
                 return;
             }
+            processedEntryCount = nextEntryIndex;
         }
     }
 
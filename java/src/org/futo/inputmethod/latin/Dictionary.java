@@ -134,6 +134,13 @@ public abstract class Dictionary {
         return NOT_A_PROBABILITY;
     }
 
+    /**
+     * Get the words of the dictionary, in no particular order.
+     */
+    public ArrayList<String> getWords() {
+        return new ArrayList<>();
+    }
+
     /**
      * Compares the contents of the character array with the typed word and returns true if they
      * are the same.
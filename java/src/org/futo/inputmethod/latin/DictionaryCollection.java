@@ -109,6 +109,15 @@ public final class DictionaryCollection extends Dictionary {
         return maxFreq;
     }
 
+    @Override
+    public ArrayList<String> getWords() {
+        final ArrayList<String> words = new ArrayList<>();
+        for (final Dictionary dict : mDictionaries) {
+            words.addAll(dict.getWords());
+        }
+        return words;
+    }
+
     @Override
     public boolean isInitialized() {
         return !mDictionaries.isEmpty();
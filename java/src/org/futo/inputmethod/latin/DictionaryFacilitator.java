@@ -142,6 +142,11 @@ public interface DictionaryFacilitator {
 
     boolean hasAtLeastOneUninitializedMainDictionary();
 
+    // Null while the main dictionaries are loading. Reloading the main dictionary, after an update
+    // or a change of locale, creates a new instance.
+    @Nullable
+    Dictionary getInitializedMainDictionary();
+
     void waitForLoadingMainDictionaries(final long timeout, final TimeUnit unit)
             throws InterruptedException;
 
@@ -482,6 +482,15 @@ public class DictionaryFacilitatorImpl implements DictionaryFacilitator {
         return false;
     }
 
+    @Nullable
+    public Dictionary getInitializedMainDictionary() {
+        final Dictionary mainDict = mDictionaryGroup.getDict(Dictionary.TYPE_MAIN);
+        if (mainDict == null || !mainDict.isInitialized()) {
+            return null;
+        }
+        return mainDict;
+    }
+
     public void waitForLoadingMainDictionaries(final long timeout, final TimeUnit unit)
             throws InterruptedException {
         mLatchForWaitingLoadingMainDictionaries.await(timeout, unit);
@@ -170,16 +170,20 @@ abstract public class ExpandableBinaryDictionary extends Dictionary {
         ExecutorUtils.getBackgroundExecutor(ExecutorUtils.KEYBOARD).execute(new Runnable() {
             @Override
             public void run() {
-                lock.lock();
-                try {
-                    task.run();
-                } finally {
-                    lock.unlock();
-                }
+                runTaskWithLock(lock, task);
             }
         });
     }
 
+    private static void runTaskWithLock(final Lock lock, final Runnable task) {
+        lock.lock();
+        try {
+            task.run();
+        } finally {
+            lock.unlock();
+        }
+    }
+
     @Nullable
     BinaryDictionary getBinaryDictionary() {
         return mBinaryDictionary;
@@ -276,19 +280,53 @@ abstract public class ExpandableBinaryDictionary extends Dictionary {
         }
     }
 
-    private void updateDictionaryWithWriteLock(@Nonnull final Runnable updateTask) {
+    /**
+     * Runs a task updating the contents of the dictionary after running GC if required.
+     *
+     * When the native dictionary supports snapshot reads, lookups can run while it is updated, so
+     * the update only takes the read lock. GC replaces the native dictionary and always takes the
+     * write lock.
+     */
+    private void asyncUpdateDictionary(@Nonnull final Runnable updateTask) {
         reloadDictionaryIfRequired();
-        final Runnable task = new Runnable() {
+        ExecutorUtils.getBackgroundExecutor(ExecutorUtils.KEYBOARD).execute(new Runnable() {
             @Override
             public void run() {
-                if (getBinaryDictionary() == null) {
+                // The native dictionary is only replaced by tasks on this executor, so it can be
+                // read here without the lock.
+                final BinaryDictionary binaryDictionary = getBinaryDictionary();
+                if (binaryDictionary == null) {
+                    return;
+                }
+                if (!binaryDictionary.supportsSnapshotReads()) {
+                    runTaskWithLock(mLock.writeLock(), new Runnable() {
+                        @Override
+                        public void run() {
+                            runGCIfRequiredLocked(true /* mindsBlockByGC */);
+                            updateTask.run();
+                        }
+                    });
                     return;
                 }
-                runGCIfRequiredLocked(true /* mindsBlockByGC */);
-                updateTask.run();
+                if (binaryDictionary.needsToRunGC(true /* mindsBlockByGC */)) {
+                    runTaskWithLock(mLock.writeLock(), new Runnable() {
+                        @Override
+                        public void run() {
+                            runGCIfRequiredLocked(true /* mindsBlockByGC */);
+                        }
+                    });
+                }
+                runTaskWithLock(mLock.readLock(), new Runnable() {
+                    @Override
+                    public void run() {
+                        if (getBinaryDictionary() == null) {
+                            return;
+                        }
+                        updateTask.run();
+                    }
+                });
             }
-        };
-        asyncExecuteTaskWithWriteLock(task);
+        });
     }
 
     /**
@@ -297,7 +335,7 @@ abstract public class ExpandableBinaryDictionary extends Dictionary {
     public void addUnigramEntry(final String word, final int frequency,
             final String shortcutTarget, final int shortcutProbability,
             final boolean isNotAWord, final boolean isPossiblyOffensive, final int timestamp) {
-        updateDictionaryWithWriteLock(new Runnable() {
+        asyncUpdateDictionary(new Runnable() {
             @Override
             public void run() {
                 addUnigramLocked(word, frequency, shortcutTarget, shortcutProbability, isNotAWord, isPossiblyOffensive, timestamp);
@@ -319,16 +357,10 @@ abstract public class ExpandableBinaryDictionary extends Dictionary {
      * Dynamically remove the unigram entry from the dictionary.
      */
     public void removeUnigramEntryDynamically(final String word) {
-        reloadDictionaryIfRequired();
-        asyncExecuteTaskWithWriteLock(new Runnable() {
+        asyncUpdateDictionary(new Runnable() {
             @Override
             public void run() {
-                final BinaryDictionary binaryDictionary = getBinaryDictionary();
-                if (binaryDictionary == null) {
-                    return;
-                }
-                runGCIfRequiredLocked(true /* mindsBlockByGC */);
-                if (!binaryDictionary.removeUnigramEntry(word)) {
+                if (!getBinaryDictionary().removeUnigramEntry(word)) {
                     if (DEBUG) {
                         Log.i(TAG, "Cannot remove unigram entry: " + word);
                     }
@@ -342,14 +374,9 @@ abstract public class ExpandableBinaryDictionary extends Dictionary {
      */
     public void addNgramEntry(@Nonnull final NgramContext ngramContext, final String word,
             final int frequency, final int timestamp) {
-        reloadDictionaryIfRequired();
-        asyncExecuteTaskWithWriteLock(new Runnable() {
+        asyncUpdateDictionary(new Runnable() {
             @Override
             public void run() {
-                if (getBinaryDictionary() == null) {
-                    return;
-                }
-                runGCIfRequiredLocked(true /* mindsBlockByGC */);
                 addNgramEntryLocked(ngramContext, word, frequency, timestamp);
             }
         });
@@ -370,14 +397,10 @@ abstract public class ExpandableBinaryDictionary extends Dictionary {
      */
     public void updateEntriesForWord(@Nonnull final NgramContext ngramContext,
             final String word, final boolean isValidWord, final int count, final int timestamp) {
-        updateDictionaryWithWriteLock(new Runnable() {
+        asyncUpdateDictionary(new Runnable() {
             @Override
             public void run() {
-                final BinaryDictionary binaryDictionary = getBinaryDictionary();
-                if (binaryDictionary == null) {
-                    return;
-                }
-                if (!binaryDictionary.updateEntriesForWordWithNgramContext(ngramContext, word,
+                if (!getBinaryDictionary().updateEntriesForWordWithNgramContext(ngramContext, word,
                         isValidWord, count, timestamp)) {
                     if (DEBUG) {
                         Log.e(TAG, "Cannot update counter. word: " + word
@@ -691,7 +714,9 @@ abstract public class ExpandableBinaryDictionary extends Dictionary {
         reloadDictionaryIfRequired();
         final String tag = TAG;
         final String dictName = mDictName;
-        asyncExecuteTaskWithLock(mLock.readLock(), new Runnable() {
+        // Content updates only take the read lock, and the iteration token is only valid while
+        // the dictionary doesn't change.
+        asyncExecuteTaskWithWriteLock(new Runnable() {
             @Override
             public void run() {
                 Log.d(tag, "Dump dictionary: " + dictName + " for " + mLocale);
@@ -730,7 +755,8 @@ abstract public class ExpandableBinaryDictionary extends Dictionary {
         reloadDictionaryIfRequired();
         final AsyncResultHolder<WordProperty[]> result =
                 new AsyncResultHolder<>("WordPropertiesForSync");
-        asyncExecuteTaskWithLock(mLock.readLock(), new Runnable() {
+        // Updates must not run between two steps of the iteration, see dumpAllWordsForDebug().
+        asyncExecuteTaskWithWriteLock(new Runnable() {
             @Override
             public void run() {
                 final ArrayList<WordProperty> wordPropertyList = new ArrayList<>();
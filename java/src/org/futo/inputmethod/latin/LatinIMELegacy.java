@@ -70,6 +70,7 @@ import org.futo.inputmethod.keyboard.KeyboardActionListener;
 import org.futo.inputmethod.keyboard.KeyboardId;
 import org.futo.inputmethod.keyboard.KeyboardSwitcher;
 import org.futo.inputmethod.keyboard.MainKeyboardView;
+import org.futo.inputmethod.keyboard.ProximityInfo;
 import org.futo.inputmethod.latin.Suggest.OnGetSuggestedWordsCallback;
 import org.futo.inputmethod.latin.SuggestedWords.SuggestedWordInfo;
 import org.futo.inputmethod.latin.common.Constants;
@@ -99,6 +100,7 @@ import org.futo.inputmethod.latin.utils.SubtypeLocaleUtils;
 import org.futo.inputmethod.latin.utils.ViewLayoutUtils;
 import org.futo.inputmethod.latin.xlm.LanguageModelFacilitator;
 
+import java.io.File;
 import java.io.FileDescriptor;
 import java.io.PrintWriter;
 import java.util.ArrayList;
@@ -140,6 +142,8 @@ public class LatinIMELegacy implements KeyboardActionListener,
      */
     private static final String SCHEME_PACKAGE = "package";
 
+    private static final String PROXIMITY_INFO_CACHE_FILE_NAME = "proximity_info_cache";
+
     public static boolean mPendingDictionaryUpdate = false;
     public final Settings mSettings;
     private Locale mLocale;
@@ -583,6 +587,8 @@ public class LatinIMELegacy implements KeyboardActionListener,
         mRichImm = RichInputMethodManager.getInstance();
         AudioAndHapticFeedbackManager.init(mInputMethodService);
         AccessibilityUtils.init(mInputMethodService);
+        ProximityInfo.setLayoutCacheFile(
+                new File(mInputMethodService.getCacheDir(), PROXIMITY_INFO_CACHE_FILE_NAME));
         mStatsUtilsManager.onCreate(mInputMethodService, mDictionaryFacilitator);
         final WindowManager wm = mInputMethodService.getSystemService(WindowManager.class);
         mDisplayContext = getDisplayContext();
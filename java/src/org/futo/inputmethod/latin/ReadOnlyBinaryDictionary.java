@@ -115,6 +115,18 @@ public final class ReadOnlyBinaryDictionary extends Dictionary {
         return NOT_A_PROBABILITY;
     }
 
+    @Override
+    public ArrayList<String> getWords() {
+        if (mLock.readLock().tryLock()) {
+            try {
+                return mBinaryDictionary.getWords();
+            } finally {
+                mLock.readLock().unlock();
+            }
+        }
+        return new ArrayList<>();
+    }
+
     @Override
     public void close() {
         mLock.writeLock().lock();
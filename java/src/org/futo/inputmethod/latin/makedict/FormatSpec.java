@@ -180,6 +180,8 @@ public final class FormatSpec {
     public static final int VERSION402 = 402;
     public static final int VERSION403 = 403;
     public static final int VERSION4 = VERSION403;
+    // Read-only format with fixed size PtNode records, written by dicttoolkit makedict -o flat.
+    public static final int VERSION_FLAT = 501;
     public static final int MINIMUM_SUPPORTED_STATIC_VERSION = VERSION202;
     public static final int MAXIMUM_SUPPORTED_STATIC_VERSION = VERSION_DELIGHT3;
     static final int MINIMUM_SUPPORTED_DYNAMIC_VERSION = VERSION4;
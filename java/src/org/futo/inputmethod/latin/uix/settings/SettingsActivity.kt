@@ -29,11 +29,13 @@ import androidx.navigation.NavHostController
 import androidx.navigation.compose.ComposeNavigator
 import androidx.navigation.compose.DialogNavigator
 import kotlinx.coroutines.DelicateCoroutinesApi
+import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.GlobalScope
 import kotlinx.coroutines.Job
 import kotlinx.coroutines.delay
 import kotlinx.coroutines.launch
 import kotlinx.coroutines.runBlocking
+import kotlinx.coroutines.withContext
 import org.futo.inputmethod.latin.uix.BasicThemeProvider
 import org.futo.inputmethod.latin.uix.DynamicThemeProvider
 import org.futo.inputmethod.latin.uix.DynamicThemeProviderOwner
@@ -284,11 +286,24 @@ class SettingsActivity : ComponentActivity(), DynamicThemeProviderOwner {
             }
         } else if(requestCode == EXPORT_GGUF_MODEL_REQUEST && resultCode == Activity.RESULT_OK && fileBeingSaved != null) {
             data?.data?.also { uri ->
-                ModelPaths.exportModel(this, uri, fileBeingSaved!!)
-                navController.navigateToInfo(
-                    "Model Exported",
-                    "Model saved to file"
-                )
+                val file = fileBeingSaved!!
+                // Merging a finetuned adapter into the model takes a while
+                lifecycleScope.launch {
+                    val exported = withContext(Dispatchers.IO) {
+                        ModelPaths.exportModel(this@SettingsActivity, uri, file)
+                    }
+                    if(exported) {
+                        navController.navigateToInfo(
+                            "Model Exported",
+                            "Model saved to file"
+                        )
+                    } else {
+                        navController.navigateToInfo(
+                            "Export Failed",
+                            "The finetuning of this model could not be merged into the exported file"
+                        )
+                    }
+                }
             }
         }
     }
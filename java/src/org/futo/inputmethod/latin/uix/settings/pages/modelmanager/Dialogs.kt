@@ -35,9 +35,12 @@ fun ModelDeleteConfirmScreen(path: File = File("/example"), navController: NavHo
             navController.navigateUp()
         },
         confirmButton = {
+            val context = LocalContext.current
             TextButton(
                 onClick = {
                     path.delete()
+                    ModelPaths.getAdapterFile(context, path.nameWithoutExtension).delete()
+                    ModelPaths.getAdapterHistoryFile(context, path.nameWithoutExtension).delete()
                     runBlocking {
                         ModelPaths.signalReloadModels()
                     }
@@ -72,7 +75,7 @@ fun PrivateModelExportConfirmation(path: File = File("/example"), navController:
             Text(text = "PRIVACY WARNING - \"${path.nameWithoutExtension}\"")
         },
         text = {
-            Text(text = "This model has been tainted with your personal data through finetuning. If you share the exported file, others may be able to reconstruct things you've typed.\n\nExporting is intended for transferring between devices or backup. We do not recommend sharing the exported file with other people.")
+            Text(text = "This model has been tainted with your personal data through finetuning, and the finetuning is merged into the exported file. If you share the exported file, others may be able to reconstruct things you've typed.\n\nExporting is intended for transferring between devices or backup. We do not recommend sharing the exported file with other people.")
         },
         onDismissRequest = {
             navController.navigateUp()
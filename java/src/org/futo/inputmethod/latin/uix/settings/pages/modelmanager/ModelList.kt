@@ -72,7 +72,8 @@ fun ModelListScreen(navController: NavHostController = rememberNavController())
             ScreenTitle(Locale(item.key).displayLanguage)
 
             item.value.forEach { model ->
-                val name = if (model.finetune_count > 0) {
+                val finetuneCount = remember(model.path) { ModelPaths.getFinetuneCount(context, model) }
+                val name = if (finetuneCount > 0) {
                     model.name.trim() + " (local finetune)"
                 } else {
                     model.name.trim()
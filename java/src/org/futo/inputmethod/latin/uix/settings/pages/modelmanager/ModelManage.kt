@@ -76,16 +76,18 @@ fun DamagedModelScreen(model: ModelInfoLoader, navController: NavHostController
 @Preview(showBackground = true)
 @Composable
 fun ManageModelScreen(model: ModelInfo = PreviewModels[0], navController: NavHostController = rememberNavController()) {
+    val context = LocalContext.current
+
+    val finetuneCount = remember { ModelPaths.getFinetuneCount(context, model) }
+
     val name = remember {
-        if (model.finetune_count > 0) {
+        if (finetuneCount > 0) {
             model.name.trim() + " (local finetune)"
         } else {
             model.name.trim()
         }
     }
 
-    val context = LocalContext.current
-
     val file = remember { File(model.path) }
 
     val fileSize = remember {
@@ -101,7 +103,7 @@ fun ManageModelScreen(model: ModelInfo = PreviewModels[0], navController: NavHos
     ScrollableList {
         ScreenTitle(name, showBack = true, navController)
 
-        if(model.finetune_count > 0) {
+        if(finetuneCount > 0) {
             Tip("This is a version of the model fine-tuned on your private typing data. Avoid sharing the exported file with other people!")
         }
 
@@ -119,7 +121,7 @@ fun ManageModelScreen(model: ModelInfo = PreviewModels[0], navController: NavHos
             listOf("Languages", model.languages.joinToString(" ")),
             listOf("Features", model.features.joinToString(" ")),
             listOf("Tokenizer", model.tokenizer_type),
-            listOf("Number of finetuning runs", model.finetune_count.toString()),
+            listOf("Number of finetuning runs", finetuneCount.toString()),
         )
 
         data.forEach { row ->
@@ -182,7 +184,7 @@ fun ManageModelScreen(model: ModelInfo = PreviewModels[0], navController: NavHos
             title = "Export to file",
             style = NavigationItemStyle.Misc,
             navigate = {
-                if(model.finetune_count > 0) {
+                if(finetuneCount > 0) {
                     navController.navigate("modelExport/${model.path.urlEncode()}")
                 } else {
                     triggerModelExport(context, file)
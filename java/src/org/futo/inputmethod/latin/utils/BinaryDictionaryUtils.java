@@ -45,6 +45,7 @@ public final class BinaryDictionaryUtils {
             String locale, String[] attributeKeyStringArray, String[] attributeValueStringArray);
     private static native float calcNormalizedScoreNative(int[] before, int[] after, int score);
     private static native int setCurrentTimeForTestNative(int currentTime);
+    private static native String getStatsNative(boolean reset);
 
     public static DictionaryHeader getHeader(final File dictFile)
             throws IOException, UnsupportedFormatException {
@@ -125,4 +126,17 @@ public final class BinaryDictionaryUtils {
     public static int setCurrentTimeForTest(final int currentTime) {
         return setCurrentTimeForTestNative(currentTime);
     }
+
+    /**
+     * Get the counters and latency percentiles of the native language model and dictionary
+     * pipelines, one line per stage, e.g.
+     * "sample_step events=42 items=180 total_us=51234 max_us=3010 p50_us=1024 p90_us=2048 p99_us=4096".
+     * Percentiles are the upper bounds of power of two buckets.
+     *
+     * @param reset whether to clear the counters after reading them
+     * @return the stats of all stages since the library was loaded or last reset
+     */
+    public static String getStats(final boolean reset) {
+        return getStatsNative(reset);
+    }
 }
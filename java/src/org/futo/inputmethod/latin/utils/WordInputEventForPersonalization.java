@@ -24,12 +24,14 @@ import org.futo.inputmethod.latin.common.StringUtils;
 import org.futo.inputmethod.latin.define.DecoderSpecificConstants;
 import org.futo.inputmethod.latin.settings.SpacingAndPunctuations;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
 import java.util.ArrayList;
 import java.util.List;
 import java.util.Locale;
 
-// Note: this class is used as a parameter type of a native method. You should be careful when you
-// rename this class or field name. See BinaryDictionary#addMultipleDictionaryEntriesNative().
+// Note: input events are given to native code with {@link #toPackedBuffer}. You should update
+// InputEventBatch on the native side when you change the packed format.
 public final class WordInputEventForPersonalization {
     private static final String TAG = WordInputEventForPersonalization.class.getSimpleName();
     private static final boolean DEBUG_TOKEN = false;
@@ -52,6 +54,46 @@ public final class WordInputEventForPersonalization {
         mTimestamp = timestamp;
     }
 
+    /**
+     * Packs input events into a direct buffer of ints in native byte order, which native code reads
+     * without going through JNI for every field. Each event is packed as:
+     * timestamp, isValidWord, prevWordCount, for each previous word: isBeginningOfSentence,
+     * codePointCount, codePoints, and then codePointCount, codePoints of the target word.
+     */
+    public static ByteBuffer toPackedBuffer(final WordInputEventForPersonalization[] inputEvents) {
+        int intCount = 0;
+        for (final WordInputEventForPersonalization inputEvent : inputEvents) {
+            intCount += 4 + inputEvent.mTargetWord.length;
+            for (int i = 0; i < inputEvent.mPrevWordsCount; ++i) {
+                final int[] prevWord = inputEvent.mPrevWordArray[i];
+                intCount += 2 + (prevWord == null ? 0 : prevWord.length);
+            }
+        }
+        final ByteBuffer buffer = ByteBuffer.allocateDirect(intCount * Integer.BYTES)
+                .order(ByteOrder.nativeOrder());
+        for (final WordInputEventForPersonalization inputEvent : inputEvents) {
+            buffer.putInt(inputEvent.mTimestamp);
+            // Words that have been input are counted as valid words.
+            buffer.putInt(1);
+            buffer.putInt(inputEvent.mPrevWordsCount);
+            for (int i = 0; i < inputEvent.mPrevWordsCount; ++i) {
+                final int[] prevWord = inputEvent.mPrevWordArray[i];
+                buffer.putInt(inputEvent.mIsPrevWordBeginningOfSentenceArray[i] ? 1 : 0);
+                putCodePoints(buffer, prevWord == null ? new int[0] : prevWord);
+            }
+            putCodePoints(buffer, inputEvent.mTargetWord);
+        }
+        buffer.rewind();
+        return buffer;
+    }
+
+    private static void putCodePoints(final ByteBuffer buffer, final int[] codePoints) {
+        buffer.putInt(codePoints.length);
+        for (final int codePoint : codePoints) {
+            buffer.putInt(codePoint);
+        }
+    }
+
     // Process a list of words and return a list of {@link WordInputEventForPersonalization}
     // objects.
     public static ArrayList<WordInputEventForPersonalization> createInputEventFrom(
@@ -14,16 +14,17 @@ class InadequateDataException() : Exception("Inadequate Training Data")
 class AdapterTrainer(
     baseModelPath: String,
     checkpointCachePath: String,
-    outputModelPath: String,
+    outputAdapterPath: String,
     weight: Float,
     examples: List<String>,
     val lossFlow: MutableSharedFlow<Float>?,
     val progressFlow: MutableSharedFlow<Float>?
 ) {
-    private external fun openNative(baseModelPath: String, loraCachePath: String, outputModelPath: String, weight: Float): Long
+    private external fun openNative(baseModelPath: String, loraCachePath: String, outputAdapterPath: String, weight: Float): Long
     private external fun closeNative(handle: Long)
     private external fun addExample(handle: Long, example: String)
     private external fun train(handle: Long) // Long-running function
+    private external fun trainSliceNative(handle: Long, maxTimeMs: Long): Int
 
     private var handle: Long = 0L
     private fun isHandleValid() = handle != 0L
@@ -39,7 +40,7 @@ class AdapterTrainer(
     }
 
     init {
-        handle = openNative(baseModelPath, checkpointCachePath, outputModelPath, weight)
+        handle = openNative(baseModelPath, checkpointCachePath, outputAdapterPath, weight)
         if(!isHandleValid()) {
             throw IllegalArgumentException("Failed to initialize AdapterTrainer with given parameters")
         }
@@ -67,9 +68,19 @@ class AdapterTrainer(
         if(!isHandleValid()) throw IllegalStateException("Attempting to train with null handle")
         train(handle)
     }
+
+    // Trains for at most maxTimeMs, continuing from the checkpoint left by an earlier slice.
+    // Returns true once training has finished and the output model has been written
+    suspend fun trainSlice(maxTimeMs: Long): Boolean = withContext(TrainingContext) {
+        if(!isHandleValid()) throw IllegalStateException("Attempting to train with null handle")
+        val result = trainSliceNative(handle, maxTimeMs)
+        if(result < 0) throw IllegalStateException("Training failed with code $result")
+
+        result == 0
+    }
 }
 
-class AdapterTrainerBuilder(val baseModelPath: String, val checkpointPath: String, val outputModelPath: String) {
+class AdapterTrainerBuilder(val baseModelPath: String, val checkpointPath: String, val outputAdapterPath: String) {
     private val examples = mutableListOf<String>()
     fun addExamples(newExamples: List<String>) {
         examples.addAll(newExamples)
@@ -91,6 +102,6 @@ class AdapterTrainerBuilder(val baseModelPath: String, val checkpointPath: Strin
     }
 
     fun loadAndPrepare(): AdapterTrainer {
-        return AdapterTrainer(baseModelPath, checkpointPath, outputModelPath, weight, examples, lossFlow = lossFlow, progressFlow = progressFlow)
+        return AdapterTrainer(baseModelPath, checkpointPath, outputAdapterPath, weight, examples, lossFlow = lossFlow, progressFlow = progressFlow)
     }
 }
\ No newline at end of file
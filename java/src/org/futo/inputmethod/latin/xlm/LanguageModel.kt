@@ -1,12 +1,19 @@
 package org.futo.inputmethod.latin.xlm
 
 import android.content.Context
+import android.os.SystemClock
 import android.util.Log
 import androidx.lifecycle.LifecycleCoroutineScope
+import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.Deferred
 import kotlinx.coroutines.DelicateCoroutinesApi
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.ExperimentalCoroutinesApi
+import kotlinx.coroutines.async
 import kotlinx.coroutines.newSingleThreadContext
 import kotlinx.coroutines.withContext
 import org.futo.inputmethod.keyboard.KeyDetector
+import org.futo.inputmethod.latin.Dictionary
 import org.futo.inputmethod.latin.NgramContext
 import org.futo.inputmethod.latin.SuggestedWords
 import org.futo.inputmethod.latin.SuggestedWords.SuggestedWordInfo
@@ -33,7 +40,7 @@ class LanguageModel(
 ) {
     private suspend fun loadModel() = withContext(LanguageModelScope) {
         val modelPath = modelInfoLoader.path.absolutePath
-        mNativeState = openNative(modelPath)
+        mNativeState = openNative(modelPath, getAdapterPath())
 
         // TODO: Not sure how to handle finetuned model being corrupt. Maybe have finetunedA.gguf and finetunedB.gguf and swap between them
         if (mNativeState == 0L) {
@@ -41,6 +48,19 @@ class LanguageModel(
         }
     }
 
+    private fun getAdapterPath(): String {
+        val adapterFile = ModelPaths.getAdapterFile(applicationContext, modelInfoLoader.name)
+        return if(adapterFile.isFile) { adapterFile.absolutePath } else { "" }
+    }
+
+    // Picks up a newly trained adapter without reloading the base model
+    suspend fun reloadAdapter() = withContext(LanguageModelScope) {
+        if (mNativeState == 0L) return@withContext
+
+        if(!setAdapterNative(mNativeState, getAdapterPath())) {
+            Log.e("LanguageModel", "Failed to reload adapter for ${modelInfoLoader.name}")
+        }
+    }
 
     private fun getComposeInfo(composedData: ComposedData, keyDetector: KeyDetector): ComposeInfo {
         var partialWord = composedData.mTypedWord
@@ -165,24 +185,78 @@ class LanguageModel(
         return context
     }
 
-    private fun addPersonalDictionary(ctx: String, personalDictionary: List<String>) : String {
-        var context = ctx
-
-        if (personalDictionary.isNotEmpty()) {
-            val glossary = StringBuilder()
-            for (s in personalDictionary) {
-                glossary.append(s.trim { it <= ' ' }).append(", ")
+    private var syncedBannedWords: Set<String> = emptySet()
+    private var syncedPersonalDictionary: List<String> = emptyList()
+
+    // The native side keeps both word sets between calls, so only changes are sent
+    private fun syncWordSets(personalDictionary: List<String>, bannedWords: Array<String>?) {
+        if (bannedWords != null) {
+            val banned = bannedWords.toSet()
+            if (banned != syncedBannedWords) {
+                updateWordSetNative(
+                    mNativeState,
+                    WORD_SET_BANNED,
+                    false,
+                    (banned - syncedBannedWords).toTypedArray(),
+                    (syncedBannedWords - banned).toTypedArray()
+                )
+                syncedBannedWords = banned
             }
-            if (glossary.length > 2) {
-                context = """
-                    (Glossary: ${glossary.substring(0, glossary.length - 2)})
-                    
-                    $context
-                    """.trimIndent()
+        }
+
+        // The glossary keeps the order of the personal dictionary, so it is replaced as a whole
+        if (personalDictionary != syncedPersonalDictionary) {
+            updateWordSetNative(
+                mNativeState,
+                WORD_SET_GLOSSARY,
+                true,
+                personalDictionary.toTypedArray(),
+                emptyArray()
+            )
+            syncedPersonalDictionary = personalDictionary
+        }
+    }
+
+    // The main dictionary the native lexicon is built from, or being built from
+    private var lexiconDictionary: Dictionary? = null
+    private var lexiconBuild: Deferred<Long>? = null
+    // Uptime after which a dictionary that gave no words is read again
+    private var lexiconRetryTime = Long.MAX_VALUE
+
+    // Reading and tokenizing every word of the main dictionary takes a while, so the lexicon is built
+    // on another thread and decoding stays unconstrained until it is ready. A reloaded main
+    // dictionary is a new instance, which starts a new build
+    @OptIn(ExperimentalCoroutinesApi::class)
+    private fun syncLexicon(mainDictionary: Dictionary?) {
+        lexiconBuild?.let { build ->
+            if (!build.isCompleted) return
+
+            val lexicon = build.getCompleted()
+            setLexiconNative(mNativeState, lexicon)
+            lexiconBuild = null
+
+            // The dictionary had no words to give, for example while it was being closed or
+            // written. Reading it again on every keystroke would redo the whole build each time
+            lexiconRetryTime = if (lexicon == 0L) {
+                SystemClock.uptimeMillis() + LEXICON_RETRY_DELAY_MS
+            } else {
+                Long.MAX_VALUE
             }
         }
 
-        return context
+        if (mainDictionary === lexiconDictionary && SystemClock.uptimeMillis() < lexiconRetryTime) return
+        lexiconDictionary = mainDictionary
+        lexiconRetryTime = Long.MAX_VALUE
+
+        if (mainDictionary == null) {
+            setLexiconNative(mNativeState, 0L)
+            return
+        }
+
+        val state = mNativeState
+        lexiconBuild = CoroutineScope(Dispatchers.Default).async {
+            buildLexiconNative(state, mainDictionary.words.toTypedArray())
+        }
     }
 
     suspend fun rescoreSuggestions(
@@ -203,7 +277,7 @@ class LanguageModel(
 
         composeInfo = safeguardComposeInfo(composeInfo)
         context = safeguardContext(context)
-        context = addPersonalDictionary(context, personalDictionary)
+        syncWordSets(personalDictionary, null)
 
         val wordStrings = suggestedWords.mSuggestedWordInfoList.map { it.mWord }.toTypedArray()
         val wordScoresInput = suggestedWords.mSuggestedWordInfoList.map { it.mScore }.toTypedArray().toIntArray()
@@ -246,7 +320,8 @@ class LanguageModel(
         autocorrectThreshold: Float,
         inOutWeightOfLangModelVsSpatialModel: FloatArray?,
         personalDictionary: List<String>,
-        bannedWords: Array<String>
+        bannedWords: Array<String>,
+        lexiconDictionary: Dictionary?
     ): ArrayList<SuggestedWordInfo>? = withContext(LanguageModelScope) {
         if (mNativeState == 0L) {
             loadModel()
@@ -265,8 +340,8 @@ class LanguageModel(
 
         composeInfo = safeguardComposeInfo(composeInfo)
         context = safeguardContext(context)
-        context = addPersonalDictionary(context, personalDictionary)
-
+        syncWordSets(personalDictionary, bannedWords)
+        syncLexicon(lexiconDictionary)
 
         val maxResults = 128
         val outProbabilities = FloatArray(maxResults)
@@ -280,7 +355,6 @@ class LanguageModel(
             composeInfo.xCoords,
             composeInfo.yCoords,
             autocorrectThreshold,
-            bannedWords,
             outStrings,
             outProbabilities
         )
@@ -359,13 +433,30 @@ class LanguageModel(
 
     suspend fun closeInternalLocked() = withContext(LanguageModelScope) {
         if (mNativeState != 0L) {
+            // The build reads the tokenizer of the model, so it has to finish first. Handing the
+            // lexicon over lets closeNative free it. Other calls run on this thread while waiting
+            // and may install the build or start another one
+            while (true) {
+                val build = lexiconBuild ?: break
+                val lexicon = build.await()
+                if (lexiconBuild === build) {
+                    setLexiconNative(mNativeState, lexicon)
+                    lexiconBuild = null
+                }
+            }
+            lexiconDictionary = null
+            lexiconRetryTime = Long.MAX_VALUE
+
             closeNative(mNativeState)
             mNativeState = 0
+            syncedBannedWords = emptySet()
+            syncedPersonalDictionary = emptyList()
         }
     }
 
     var mNativeState: Long = 0
-    private external fun openNative(sourceDir: String): Long
+    private external fun openNative(sourceDir: String, adapterPath: String): Long
+    private external fun setAdapterNative(state: Long, adapterPath: String): Boolean
     private external fun closeNative(state: Long)
     private external fun getSuggestionsNative( // inputs
         state: Long,
@@ -375,8 +466,7 @@ class LanguageModel(
         inputMode: Int,
         inComposeX: IntArray,
         inComposeY: IntArray,
-        thresholdSetting: Float,
-        bannedWords: Array<String>,  // outputs
+        thresholdSetting: Float,  // outputs
         outStrings: Array<String?>,
         outProbs: FloatArray
     )
@@ -390,4 +480,30 @@ class LanguageModel(
 
         outSuggestedScores: IntArray
     )
+
+    private external fun updateWordSetNative(
+        state: Long,
+        set: Int,
+        clear: Boolean,
+        addedWords: Array<String>,
+        removedWords: Array<String>
+    ): Long
+
+    private external fun buildLexiconNative(
+        state: Long,
+        words: Array<String>
+    ): Long
+
+    private external fun setLexiconNative(
+        state: Long,
+        lexicon: Long
+    )
+
+    companion object {
+        // Must match the WORD_SET_ constants in the native LanguageModel
+        private const val WORD_SET_BANNED = 0
+        private const val WORD_SET_GLOSSARY = 1
+
+        private const val LEXICON_RETRY_DELAY_MS = 30_000L
+    }
 }
@@ -2,6 +2,7 @@ package org.futo.inputmethod.latin.xlm;
 
 import android.content.Context
 import android.util.Log
+import androidx.datastore.preferences.core.booleanPreferencesKey
 import androidx.datastore.preferences.core.floatPreferencesKey
 import androidx.lifecycle.LifecycleCoroutineScope
 import kotlinx.coroutines.CoroutineScope
@@ -50,6 +51,12 @@ val BinaryDictTransformerWeightSetting = SettingsKey(
     3.4f
 )
 
+// Limits the words the transformer suggests to the words of the main and personal dictionaries
+val LexiconConstrainedDecodingSetting = SettingsKey(
+    booleanPreferencesKey("lm_lexicon_constrained_decoding"),
+    false
+)
+
 private fun SuggestedWordInfo.add(other: SuggestedWordInfo): SuggestedWordInfo {
     assert(mWord == other.mWord)
 
@@ -217,6 +224,9 @@ public class LanguageModelFacilitator(
         val proximityInfoHandle = keyboard.proximityInfo.nativeProximityInfo
 
         val autocorrectThreshold = context.getSetting(AutocorrectThresholdSetting)
+        val lexiconDictionary = if (context.getSetting(LexiconConstrainedDecodingSetting)) {
+            dictionaryFacilitator.initializedMainDictionary
+        } else null
 
         return languageModel?.getSuggestions(
             values.composedData,
@@ -228,7 +238,8 @@ public class LanguageModelFacilitator(
             autocorrectThreshold,
             floatArrayOf(),
             userDictionary.getWords().map { it.word },
-            suggestionBlacklist.currentBlacklist.toTypedArray<String>()
+            suggestionBlacklist.currentBlacklist.toTypedArray<String>(),
+            lexiconDictionary
         )
     }
 
@@ -448,6 +459,8 @@ public class LanguageModelFacilitator(
                     }else if(it == LanguageModelFacilitatorRequest.ClearTrainingLog) {
                         historyLog.clear()
                         saveHistoryLog()
+                    }else if(it == LanguageModelFacilitatorRequest.ReloadAdapter) {
+                        languageModel?.reloadAdapter()
                     }
                 }
             }
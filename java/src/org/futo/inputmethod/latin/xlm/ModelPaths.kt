@@ -50,22 +50,49 @@ class ModelInfoLoader(
         return loadNative(path.absolutePath)
     }
 
+    fun exportWithAdapter(adapter: File, output: File): Boolean {
+        return exportWithAdapterNative(path.absolutePath, adapter.absolutePath, output.absolutePath)
+    }
+
     external fun loadNative(path: String): ModelInfo?
+    external fun exportWithAdapterNative(path: String, adapterPath: String, outPath: String): Boolean
 }
 
 object ModelPaths {
     val modelOptionsUpdated = MutableSharedFlow<Unit>(replay = 0)
 
-    fun exportModel(context: Context, uri: Uri, file: File) {
-        context.contentResolver.openOutputStream(uri)!!.use { outputStream ->
-            file.inputStream().use { inputStream ->
-                var read = 0
-                val bytes = ByteArray(1024)
-                while (inputStream.read(bytes).also { read = it } != -1) {
-                    outputStream.write(bytes, 0, read)
+    // The adapter trained on the user's typing is merged into the exported file, as it lives apart
+    // from the model. Returns false if merging it failed
+    fun exportModel(context: Context, uri: Uri, file: File): Boolean {
+        val adapterFile = getAdapterFile(context, file.nameWithoutExtension)
+        val mergedFile = File(context.cacheDir, file.name + ".export")
+
+        val exportedFile = if(adapterFile.isFile) {
+            val loader = ModelInfoLoader(file, file.nameWithoutExtension)
+            if(!loader.exportWithAdapter(adapterFile, mergedFile)) {
+                mergedFile.delete()
+                return false
+            }
+            mergedFile
+        } else {
+            file
+        }
+
+        try {
+            context.contentResolver.openOutputStream(uri)!!.use { outputStream ->
+                exportedFile.inputStream().use { inputStream ->
+                    var read = 0
+                    val bytes = ByteArray(1024)
+                    while (inputStream.read(bytes).also { read = it } != -1) {
+                        outputStream.write(bytes, 0, read)
+                    }
                 }
             }
+        } finally {
+            mergedFile.delete()
         }
+
+        return true
     }
 
 
@@ -211,6 +238,38 @@ object ModelPaths {
         return modelDirectory
     }
 
+    fun getAdapterDirectory(context: Context): File {
+        val adapterDirectory = File(context.filesDir, "transformer-adapters")
+
+        if(!adapterDirectory.isDirectory){
+            adapterDirectory.mkdir()
+        }
+
+        return adapterDirectory
+    }
+
+    // LoRA adapter trained on the user's typing, evaluated on top of the named model at runtime
+    fun getAdapterFile(context: Context, modelName: String): File {
+        return File(getAdapterDirectory(context), "$modelName.lora")
+    }
+
+    // One line per finetuning run of the adapter, appended by the trainer (LORA_ADAPTER_HISTORY_SUFFIX)
+    fun getAdapterHistoryFile(context: Context, modelName: String): File {
+        return File(getAdapterDirectory(context), "$modelName.lora.history")
+    }
+
+    // Runs merged into the model file, by older versions or by an export, and runs of its adapter
+    fun getFinetuneCount(context: Context, model: ModelInfo): Int {
+        val historyFile = getAdapterHistoryFile(context, File(model.path).nameWithoutExtension)
+        val adapterRuns = if(historyFile.isFile) {
+            historyFile.readLines().count { it.isNotBlank() }
+        } else {
+            0
+        }
+
+        return model.finetune_count + adapterRuns
+    }
+
     fun ensureDefaultModelExists(context: Context) {
         val directory = getModelDirectory(context)
 
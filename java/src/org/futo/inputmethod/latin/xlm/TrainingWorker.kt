@@ -49,7 +49,8 @@ data class TrainingStateWithModel(
 
 enum class LanguageModelFacilitatorRequest {
     ResetModel,
-    ClearTrainingLog
+    ClearTrainingLog,
+    ReloadAdapter
 }
 
 object TrainingWorkerStatus {
@@ -192,13 +193,15 @@ class TrainingWorker(val context: Context, val parameters: WorkerParameters) : C
             return TrainingStateWithModel(TrainingState.ErrorInadequateData, modelFile.nameWithoutExtension)
         }
 
-        val outputModel = File(applicationContext.cacheDir, modelFile.name + ".tmp")
-        val cacheLoraPath = File(applicationContext.cacheDir, "adapter.bin")
+        // The trained adapter is applied on top of the model at runtime instead of rewriting the model
+        val outputAdapter = ModelPaths.getAdapterFile(applicationContext, modelFile.nameWithoutExtension)
+        // Per-model, so that a checkpoint left by an interrupted run is only resumed for the same model
+        val cacheLoraPath = File(applicationContext.cacheDir, "adapter-${modelFile.nameWithoutExtension}.bin")
 
         val builder = AdapterTrainerBuilder(
             modelFile.absolutePath,
             cacheLoraPath.absolutePath,
-            outputModel.absolutePath
+            outputAdapter.absolutePath
         )
 
         builder.setLossFlow(TrainingWorkerStatus.loss)
@@ -216,31 +219,34 @@ class TrainingWorker(val context: Context, val parameters: WorkerParameters) : C
 
         val powerManager = applicationContext.getSystemService(Context.POWER_SERVICE) as PowerManager
         val wakeLock = powerManager.newWakeLock(PowerManager.PARTIAL_WAKE_LOCK, "FUTOLatinIME::modelTrainer")
-        withContext(Dispatchers.Default) {
+        val finished = withContext(Dispatchers.Default) {
             println("Staring to train")
             wakeLock.acquire(120*60*1000L /*1 hour*/)
             try {
-                trainer.train()
+                // Train in slices so that losing the charging constraint stops us within one slice,
+                // the checkpoint lets the next run continue from there
+                var done = false
+                while(!done && !isStopped) {
+                    done = trainer.trainSlice(TRAINING_SLICE_MS)
+                }
+                done
             } finally {
                 wakeLock.release()
             }
-            println("Finished training")
         }
 
+        if(!finished) {
+            println("Training was stopped, will resume from checkpoint")
+            return TrainingStateWithModel(TrainingState.None, modelFile.nameWithoutExtension)
+        }
+        println("Finished training")
+
         // In case there's no one to receive ClearTrainingLog, save an empty log
         saveHistoryLogBackup(applicationContext, listOf())
 
         TrainingWorkerStatus.lmRequest.emit(LanguageModelFacilitatorRequest.ClearTrainingLog)
 
-        val fallback = File(
-            modelFile.absolutePath + ".bak"
-        )
-
-        // TODO: A better solution for backup/reverting, etc
-        //modelFile.copyTo(fallback, overwrite = true)
-        outputModel.copyTo(modelFile, overwrite = true)
-
-        ModelPaths.signalReloadModels()
+        TrainingWorkerStatus.lmRequest.emit(LanguageModelFacilitatorRequest.ReloadAdapter)
 
         return TrainingStateWithModel(TrainingState.Finished, modelFile.nameWithoutExtension)
     }
@@ -289,6 +295,7 @@ class TrainingWorker(val context: Context, val parameters: WorkerParameters) : C
 }
 
 private val WORKER_TAG: String = "TRAINING_WORKER"
+private const val TRAINING_SLICE_MS: Long = 30_000L
 public fun scheduleTrainingWorkerBackground(context: Context) {
     if(!context.isDirectBootUnlocked) return
     val workManager = WorkManager.getInstance(context)
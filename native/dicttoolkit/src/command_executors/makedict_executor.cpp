@@ -18,6 +18,11 @@
 
 #include <cstdio>
 
+#include "dictionary/structure/dictionary_structure_with_buffer_policy_factory.h"
+#include "dictionary/structure/flat/flat_dict_writer.h"
+#include "dictionary/structure/v2/ver2_reverse_index_writer.h"
+#include "dictionary/utils/file_utils.h"
+
 namespace latinime {
 namespace dicttoolkit {
 
@@ -30,7 +35,45 @@ const char *const MakedictExecutor::COMMAND_NAME = "makedict";
         printUsage();
         return 1;
     }
-    fprintf(stderr, "Command '%s' has not been implemented yet.\n", COMMAND_NAME);
+    const std::string &format = argumentsAndOptions.getOptionValue("o");
+    const std::string &srcDictPath = argumentsAndOptions.getSingleArgument("src_dict");
+    const std::string &destDictPath = argumentsAndOptions.getSingleArgument("dest_dict");
+    const std::string &reverseIndexMode = argumentsAndOptions.getOptionValue("r");
+    if (reverseIndexMode != "on" && reverseIndexMode != "off") {
+        fprintf(stderr, "Unknown reverse index mode '%s'.\n", reverseIndexMode.c_str());
+        printUsage();
+        return 1;
+    }
+    if (reverseIndexMode == "on" && format != "2") {
+        fprintf(stderr, "The reverse index is only supported by version 2 outputs.\n");
+        return 1;
+    }
+    if (reverseIndexMode == "on") {
+        // Only binary version 2 sources are supported; the trie is copied as is.
+        if (!Ver2ReverseIndexWriter::writeDictFileWithReverseIndex(srcDictPath.c_str(),
+                destDictPath.c_str())) {
+            fprintf(stderr, "Cannot write dictionary with reverse index '%s'.\n",
+                    destDictPath.c_str());
+            return 1;
+        }
+        return 0;
+    }
+    if (format != "flat") {
+        fprintf(stderr, "Output format '%s' has not been implemented yet.\n", format.c_str());
+        return 0;
+    }
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr srcPolicy =
+            DictionaryStructureWithBufferPolicyFactory::newPolicyForExistingDictFile(
+                    srcDictPath.c_str(), 0 /* bufOffset */,
+                    FileUtils::getFileSize(srcDictPath.c_str()), false /* isUpdatable */);
+    if (!srcPolicy) {
+        fprintf(stderr, "Cannot open source dictionary '%s'.\n", srcDictPath.c_str());
+        return 1;
+    }
+    if (!FlatDictWriter::writeFlatDictFile(srcPolicy.get(), destDictPath.c_str())) {
+        fprintf(stderr, "Cannot write flat dictionary '%s'.\n", destDictPath.c_str());
+        return 1;
+    }
     return 0;
 }
 
@@ -39,15 +82,17 @@ const char *const MakedictExecutor::COMMAND_NAME = "makedict";
     getArgumentsParser().printUsage(COMMAND_NAME,
             "Converts a source dictionary file to one or several outputs.\n"
             "Source can be a binary dictionary file or a combined format file.\n"
-            "Binary version 2 (Jelly Bean), 4, and combined format outputs are supported.");
+            "Binary version 2 (Jelly Bean), 4, flat, and combined format outputs are supported.");
 }
 
 /* static */const ArgumentsParser MakedictExecutor::getArgumentsParser() {
     std::unordered_map<std::string, OptionSpec> optionSpecs;
     optionSpecs["o"] = OptionSpec::keyValueOption("format", "2",
-            "output format version: 2/4/combined");
+            "output format version: 2/4/flat/combined");
     optionSpecs["t"] = OptionSpec::keyValueOption("mode", "off",
             "code point table switch: on/off/auto");
+    optionSpecs["r"] = OptionSpec::keyValueOption("mode", "off",
+            "word id to code points reverse index for version 2 outputs: on/off");
 
     const std::vector<ArgumentSpec> argumentSpecs = {
         ArgumentSpec::singleArgument("src_dict", "source dictionary file"),
@@ -43,7 +43,9 @@ LATIN_IME_CORE_SRC_FILES := \
     ggml/train.cpp \
     ggml/common.cpp \
     ggml/LanguageModel.cpp \
+    ggml/LanguageModelState.cpp \
     ggml/ModelMeta.cpp \
+    ggml/TokenLexicon.cpp \
     third_party/protobuf-lite/arena.cc \
     third_party/protobuf-lite/arenastring.cc \
     third_party/protobuf-lite/bytestream.cc \
@@ -87,8 +89,12 @@ LATIN_IME_CORE_SRC_FILES := \
     $(addprefix dictionary/header/, \
         header_policy.cpp \
         header_read_write_utils.cpp) \
+    dictionary/property/input_event_batch.cpp \
     dictionary/property/ngram_context.cpp \
     dictionary/structure/dictionary_structure_with_buffer_policy_factory.cpp \
+    $(addprefix dictionary/structure/flat/, \
+        flat_dict_writer.cpp \
+        flat_patricia_trie_policy.cpp) \
     $(addprefix dictionary/structure/pt_common/, \
         bigram/bigram_list_read_write_utils.cpp \
         dynamic_pt_gc_event_listeners.cpp \
@@ -101,7 +107,9 @@ LATIN_IME_CORE_SRC_FILES := \
     $(addprefix dictionary/structure/v2/, \
         patricia_trie_policy.cpp \
         ver2_patricia_trie_node_reader.cpp \
-        ver2_pt_node_array_reader.cpp) \
+        ver2_pt_node_array_reader.cpp \
+        ver2_reverse_index.cpp \
+        ver2_reverse_index_writer.cpp) \
     $(addprefix dictionary/structure/v4/, \
         ver4_dict_buffers.cpp \
         ver4_dict_constants.cpp \
@@ -143,11 +151,13 @@ LATIN_IME_CORE_SRC_FILES := \
     $(addprefix suggest/core/layout/, \
         additional_proximity_chars.cpp \
         proximity_info.cpp \
+        proximity_info_cache.cpp \
         proximity_info_params.cpp \
         proximity_info_state.cpp \
         proximity_info_state_utils.cpp) \
     suggest/core/policy/weighting.cpp \
     suggest/core/session/dic_traverse_session.cpp \
+    suggest/core/session/gesture_match_cache.cpp \
     $(addprefix suggest/core/result/, \
         suggestion_results.cpp \
         suggestions_output_utils.cpp) \
@@ -167,8 +177,11 @@ LATIN_IME_CORE_SRC_FILES := \
         autocorrection_threshold_utils.cpp \
         char_utils.cpp \
         jni_data_utils.cpp \
+        left_right_sync.cpp \
         log_utils.cpp \
-        time_keeper.cpp)
+        stats_registry.cpp \
+        time_keeper.cpp \
+        worker_pool.cpp)
 
 LATIN_IME_CORE_SRC_FILES_BACKWARD_V402 := \
     $(addprefix dictionary/structure/backward/v402/, \
@@ -194,6 +207,11 @@ LATIN_IME_CORE_SRC_FILES += $(LATIN_IME_CORE_SRC_FILES_BACKWARD_V402)
 LATIN_IME_CORE_TEST_FILES := \
     defines_test.cpp \
     dictionary/header/header_read_write_utils_test.cpp \
+    dictionary/property/input_event_batch_test.cpp \
+    dictionary/structure/flat/flat_patricia_trie_policy_test.cpp \
+    dictionary/structure/v2/ver2_reverse_index_test.cpp \
+    dictionary/structure/v2/ver2_reverse_index_writer_test.cpp \
+    dictionary/structure/v4/content/dynamic_language_model_probability_utils_test.cpp \
     dictionary/structure/v4/content/language_model_dict_content_test.cpp \
     dictionary/structure/v4/content/language_model_dict_content_global_counters_test.cpp \
     dictionary/structure/v4/content/probability_entry_test.cpp \
@@ -205,11 +223,21 @@ LATIN_IME_CORE_TEST_FILES := \
     dictionary/utils/probability_utils_test.cpp \
     dictionary/utils/sparse_table_test.cpp \
     dictionary/utils/trie_map_test.cpp \
+    ggml/token_lexicon_test.cpp \
     suggest/core/dicnode/dic_node_pool_test.cpp \
+    suggest/core/dicnode/dic_node_test.cpp \
+    suggest/core/dictionary/dictionary_test.cpp \
     suggest/core/layout/geometry_utils_test.cpp \
     suggest/core/layout/normal_distribution_2d_test.cpp \
+    suggest/core/layout/proximity_info_cache_test.cpp \
+    suggest/core/result/suggestion_results_test.cpp \
+    suggest/core/session/gesture_match_cache_test.cpp \
+    suggest/policyimpl/gesture/swipe_weighting_test.cpp \
     suggest/policyimpl/utils/damerau_levenshtein_edit_distance_policy_test.cpp \
     utils/autocorrection_threshold_utils_test.cpp \
     utils/char_utils_test.cpp \
     utils/int_array_view_test.cpp \
-    utils/time_keeper_test.cpp
+    utils/left_right_sync_test.cpp \
+    utils/stats_registry_test.cpp \
+    utils/time_keeper_test.cpp \
+    utils/worker_pool_test.cpp
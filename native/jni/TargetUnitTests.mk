@@ -36,7 +36,7 @@ include $(CLEAR_VARS)
 LATIN_IME_TEST_SRC_DIR := tests
 LOCAL_CFLAGS += -Wno-unused-parameter -Wno-unused-function
 LOCAL_CLANG := true
-LOCAL_C_INCLUDES += $(LOCAL_PATH)/$(LATIN_IME_SRC_DIR)
+LOCAL_C_INCLUDES += $(LOCAL_PATH)/$(LATIN_IME_SRC_DIR) $(LOCAL_PATH)/$(LATIN_IME_TEST_SRC_DIR)
 LOCAL_MODULE := liblatinime_target_unittests
 LOCAL_MODULE_TAGS := tests
 LOCAL_SRC_FILES :=  \
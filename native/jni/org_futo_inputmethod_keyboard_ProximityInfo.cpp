@@ -22,6 +22,7 @@
 #include "jni.h"
 #include "jni_common.h"
 #include "suggest/core/layout/proximity_info.h"
+#include "suggest/core/layout/proximity_info_cache.h"
 
 namespace latinime {
 
@@ -30,14 +31,44 @@ static jlong latinime_Keyboard_setProximityInfo(JNIEnv *env, jclass clazz,
         jint mostCommonkeyWidth, jint mostCommonkeyHeight, jintArray proximityChars, jint keyCount,
         jintArray keyXCoordinates, jintArray keyYCoordinates, jintArray keyWidths,
         jintArray keyHeights, jintArray keyCharCodes, jfloatArray sweetSpotCenterXs,
-        jfloatArray sweetSpotCenterYs, jfloatArray sweetSpotRadii) {
+        jfloatArray sweetSpotCenterYs, jfloatArray sweetSpotRadii, jlong layoutCache,
+        jlong layoutHash) {
     ProximityInfo *proximityInfo = new ProximityInfo(env, displayWidth, displayHeight,
             gridWidth, gridHeight, mostCommonkeyWidth, mostCommonkeyHeight, proximityChars,
             keyCount, keyXCoordinates, keyYCoordinates, keyWidths, keyHeights, keyCharCodes,
             sweetSpotCenterXs, sweetSpotCenterYs, sweetSpotRadii);
+    ProximityInfoCache *const cache = reinterpret_cast<ProximityInfoCache *>(layoutCache);
+    if (cache) {
+        cache->put(static_cast<uint64_t>(layoutHash), proximityInfo);
+    }
     return reinterpret_cast<jlong>(proximityInfo);
 }
 
+static jlong latinime_Keyboard_openLayoutCache(JNIEnv *env, jclass clazz, jstring filePath) {
+    const jsize filePathUtf8Length = env->GetStringUTFLength(filePath);
+    char filePathChars[filePathUtf8Length + 1];
+    env->GetStringUTFRegion(filePath, 0, env->GetStringLength(filePath), filePathChars);
+    filePathChars[filePathUtf8Length] = '\0';
+    return reinterpret_cast<jlong>(new ProximityInfoCache(filePathChars));
+}
+
+// Returns 0 if the layout is not in the cache.
+static jlong latinime_Keyboard_createProximityInfoFromLayoutCache(JNIEnv *env, jclass clazz,
+        jlong layoutCache, jlong layoutHash) {
+    ProximityInfoCache *const cache = reinterpret_cast<ProximityInfoCache *>(layoutCache);
+    if (!cache) {
+        return 0;
+    }
+    return reinterpret_cast<jlong>(cache->createProximityInfo(static_cast<uint64_t>(layoutHash)));
+}
+
+static void latinime_Keyboard_writeLayoutCache(JNIEnv *env, jclass clazz, jlong layoutCache) {
+    ProximityInfoCache *const cache = reinterpret_cast<ProximityInfoCache *>(layoutCache);
+    if (cache) {
+        cache->writePendingEntries();
+    }
+}
+
 static void latinime_Keyboard_release(JNIEnv *env, jclass clazz, jlong proximityInfo) {
     ProximityInfo *pi = reinterpret_cast<ProximityInfo *>(proximityInfo);
     delete pi;
@@ -46,9 +77,24 @@ static void latinime_Keyboard_release(JNIEnv *env, jclass clazz, jlong proximity
 static const JNINativeMethod sMethods[] = {
     {
         const_cast<char *>("setProximityInfoNative"),
-        const_cast<char *>("(IIIIII[II[I[I[I[I[I[F[F[F)J"),
+        const_cast<char *>("(IIIIII[II[I[I[I[I[I[F[F[FJJ)J"),
         reinterpret_cast<void *>(latinime_Keyboard_setProximityInfo)
     },
+    {
+        const_cast<char *>("openLayoutCacheNative"),
+        const_cast<char *>("(Ljava/lang/String;)J"),
+        reinterpret_cast<void *>(latinime_Keyboard_openLayoutCache)
+    },
+    {
+        const_cast<char *>("createProximityInfoFromLayoutCacheNative"),
+        const_cast<char *>("(JJ)J"),
+        reinterpret_cast<void *>(latinime_Keyboard_createProximityInfoFromLayoutCache)
+    },
+    {
+        const_cast<char *>("writeLayoutCacheNative"),
+        const_cast<char *>("(J)V"),
+        reinterpret_cast<void *>(latinime_Keyboard_writeLayoutCache)
+    },
     {
         const_cast<char *>("releaseProximityInfoNative"),
         const_cast<char *>("(J)V"),
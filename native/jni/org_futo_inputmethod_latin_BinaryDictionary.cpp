@@ -19,9 +19,11 @@
 #include "org_futo_inputmethod_latin_BinaryDictionary.h"
 
 #include <cstring> // for memset()
+#include <memory>
 #include <vector>
 
 #include "defines.h"
+#include "dictionary/property/input_event_batch.h"
 #include "dictionary/property/unigram_property.h"
 #include "dictionary/property/ngram_context.h"
 #include "dictionary/property/word_property.h"
@@ -37,6 +39,7 @@
 #include "utils/log_utils.h"
 #include "utils/profiler.h"
 #include "utils/time_keeper.h"
+#include "utils/worker_pool.h"
 
 namespace latinime {
 
@@ -61,9 +64,19 @@ static jlong latinime_BinaryDictionary_open(JNIEnv *env, jclass clazz, jstring s
     if (!dictionaryStructureWithBufferPolicy) {
         return 0;
     }
+    // Updatable dictionaries get a second copy so that lookups don't wait for updates.
+    DictionaryStructureWithBufferPolicy::StructurePolicyPtr replicaPolicy;
+    if (isUpdatable == JNI_TRUE) {
+        replicaPolicy = DictionaryStructureWithBufferPolicyFactory::newPolicyForExistingDictFile(
+                sourceDirChars, static_cast<int>(dictOffset), static_cast<int>(dictSize),
+                true /* isUpdatable */);
+        if (!replicaPolicy) {
+            AKLOGE("Cannot open a replica of %s. Snapshot reads are disabled.", sourceDirChars);
+        }
+    }
 
-    Dictionary *const dictionary =
-            new Dictionary(env, std::move(dictionaryStructureWithBufferPolicy));
+    Dictionary *const dictionary = new Dictionary(env,
+            std::move(dictionaryStructureWithBufferPolicy), std::move(replicaPolicy));
     PROF_TIMER_END(66);
     return reinterpret_cast<jlong>(dictionary);
 }
@@ -91,8 +104,15 @@ static jlong latinime_BinaryDictionary_createOnMemory(JNIEnv *env, jclass clazz,
     if (!dictionaryStructureWithBufferPolicy) {
         return 0;
     }
-    Dictionary *const dictionary =
-            new Dictionary(env, std::move(dictionaryStructureWithBufferPolicy));
+    // On-memory dictionaries are always updatable, so they get a second copy as well.
+    DictionaryStructureWithBufferPolicy::StructurePolicyPtr replicaPolicy =
+            DictionaryStructureWithBufferPolicyFactory::newPolicyForOnMemoryDict(
+                    formatVersion, localeCodePoints, &attributeMap);
+    if (!replicaPolicy) {
+        AKLOGE("Cannot create a replica of an on-memory dictionary. Snapshot reads are disabled.");
+    }
+    Dictionary *const dictionary = new Dictionary(env,
+            std::move(dictionaryStructureWithBufferPolicy), std::move(replicaPolicy));
     return reinterpret_cast<jlong>(dictionary);
 }
 
@@ -136,6 +156,7 @@ static void latinime_BinaryDictionary_getHeaderInfo(JNIEnv *env, jclass clazz, j
         jobject outAttributeValues) {
     Dictionary *dictionary = reinterpret_cast<Dictionary *>(dict);
     if (!dictionary) return;
+    const LeftRightSync::ReadScope readScope(dictionary->getLeftRightSync());
     const DictionaryHeaderStructurePolicy *const headerPolicy =
             dictionary->getDictionaryStructurePolicy()->getHeaderStructurePolicy();
     JniDataUtils::putIntToArray(env, outHeaderSize, 0 /* index */, headerPolicy->getSize());
@@ -170,12 +191,44 @@ static void latinime_BinaryDictionary_getHeaderInfo(JNIEnv *env, jclass clazz, j
 static int latinime_BinaryDictionary_getFormatVersion(JNIEnv *env, jclass clazz, jlong dict) {
     Dictionary *dictionary = reinterpret_cast<Dictionary *>(dict);
     if (!dictionary) return 0;
+    const LeftRightSync::ReadScope readScope(dictionary->getLeftRightSync());
     const DictionaryHeaderStructurePolicy *const headerPolicy =
             dictionary->getDictionaryStructurePolicy()->getHeaderStructurePolicy();
     return headerPolicy->getFormatVersionNumber();
 }
 
-static void latinime_BinaryDictionary_getSuggestions(JNIEnv *env, jclass clazz, jlong dict,
+static bool checkSuggestionOutputArrays(JNIEnv *env, jintArray outCodePointsArray,
+        jintArray outScoresArray, jintArray outAutoCommitFirstWordConfidenceArray) {
+    /* By the way, let's check the output array length here to make sure */
+    const jsize outputCodePointsLength = env->GetArrayLength(outCodePointsArray);
+    if (outputCodePointsLength != (MAX_WORD_LENGTH * MAX_RESULTS)) {
+        AKLOGE("Invalid outputCodePointsLength: %d", outputCodePointsLength);
+        ASSERT(false);
+        return false;
+    }
+    const jsize scoresLength = env->GetArrayLength(outScoresArray);
+    if (scoresLength != MAX_RESULTS) {
+        AKLOGE("Invalid scoresLength: %d", scoresLength);
+        ASSERT(false);
+        return false;
+    }
+    const jsize outputAutoCommitFirstWordConfidenceLength =
+            env->GetArrayLength(outAutoCommitFirstWordConfidenceArray);
+    ASSERT(outputAutoCommitFirstWordConfidenceLength == 1);
+    if (outputAutoCommitFirstWordConfidenceLength != 1) {
+        // We only use the first result, as obviously we will only ever autocommit the first one
+        AKLOGE("Invalid outputAutoCommitFirstWordConfidenceLength: %d",
+                outputAutoCommitFirstWordConfidenceLength);
+        ASSERT(false);
+        return false;
+    }
+    return true;
+}
+
+// Shared by the single dictionary and the dictionary group entry points. outSuggestionCount must
+// already be cleared.
+static void getSuggestionsFromDictionaries(JNIEnv *env,
+        const Dictionary *const *dictionaries, const int dictionaryCount,
         jlong proximityInfo, jlong dicTraverseSession, jintArray xCoordinatesArray,
         jintArray yCoordinatesArray, jintArray timesArray, jintArray pointerIdsArray,
         jintArray inputCodePointsArray, jint inputSize, jintArray suggestOptions,
@@ -183,13 +236,8 @@ static void latinime_BinaryDictionary_getSuggestions(JNIEnv *env, jclass clazz,
         jint prevWordCount, jintArray outSuggestionCount, jintArray outCodePointsArray,
         jintArray outScoresArray, jintArray outSpaceIndicesArray, jintArray outTypesArray,
         jintArray outAutoCommitFirstWordConfidenceArray,
-        jfloatArray inOutWeightOfLangModelVsSpatialModel) {
-    Dictionary *dictionary = reinterpret_cast<Dictionary *>(dict);
-    // Assign 0 to outSuggestionCount here in case of returning earlier in this method.
-    JniDataUtils::putIntToArray(env, outSuggestionCount, 0 /* index */, 0);
-    if (!dictionary) {
-        return;
-    }
+        jfloatArray inOutWeightOfLangModelVsSpatialModel,
+        jintArray outDictionaryIndicesArray) {
     ProximityInfo *pInfo = reinterpret_cast<ProximityInfo *>(proximityInfo);
     DicTraverseSession *traverseSession =
             reinterpret_cast<DicTraverseSession *>(dicTraverseSession);
@@ -215,49 +263,218 @@ static void latinime_BinaryDictionary_getSuggestions(JNIEnv *env, jclass clazz,
     SuggestOptions givenSuggestOptions(options, numberOfOptions);
 
     // Output values
-    /* By the way, let's check the output array length here to make sure */
-    const jsize outputCodePointsLength = env->GetArrayLength(outCodePointsArray);
-    if (outputCodePointsLength != (MAX_WORD_LENGTH * MAX_RESULTS)) {
-        AKLOGE("Invalid outputCodePointsLength: %d", outputCodePointsLength);
+    if (!checkSuggestionOutputArrays(env, outCodePointsArray, outScoresArray,
+            outAutoCommitFirstWordConfidenceArray)) {
+        return;
+    }
+    float weightOfLangModelVsSpatialModel;
+    env->GetFloatArrayRegion(inOutWeightOfLangModelVsSpatialModel, 0, 1 /* len */,
+            &weightOfLangModelVsSpatialModel);
+    SuggestionResults suggestionResults(MAX_RESULTS);
+    const NgramContext ngramContext = JniDataUtils::constructNgramContext(env,
+            prevWordCodePointArrays, isBeginningOfSentenceArray, prevWordCount);
+    if (givenSuggestOptions.isGesture() || inputSize > 0) {
+        // TODO: Use SuggestionResults to return suggestions.
+        if (dictionaryCount == 1) {
+            dictionaries[0]->getSuggestions(pInfo, traverseSession, xCoordinates, yCoordinates,
+                    times, pointerIds, inputCodePoints, inputSize, &ngramContext,
+                    &givenSuggestOptions, weightOfLangModelVsSpatialModel, &suggestionResults);
+        } else {
+            Dictionary::getSuggestionsForGroup(dictionaries, dictionaryCount, pInfo,
+                    traverseSession, xCoordinates, yCoordinates, times, pointerIds,
+                    inputCodePoints, inputSize, &ngramContext, &givenSuggestOptions,
+                    weightOfLangModelVsSpatialModel, &suggestionResults);
+        }
+    } else if (dictionaryCount == 1) {
+        dictionaries[0]->getPredictions(&ngramContext, &suggestionResults);
+    } else {
+        Dictionary::getPredictionsForGroup(dictionaries, dictionaryCount, &ngramContext,
+                &suggestionResults);
+    }
+    if (DEBUG_DICT) {
+        suggestionResults.dumpSuggestions();
+    }
+    suggestionResults.outputSuggestions(env, outSuggestionCount, outCodePointsArray,
+            outScoresArray, outSpaceIndicesArray, outTypesArray,
+            outAutoCommitFirstWordConfidenceArray, inOutWeightOfLangModelVsSpatialModel,
+            outDictionaryIndicesArray);
+}
+
+static void latinime_BinaryDictionary_getSuggestions(JNIEnv *env, jclass clazz, jlong dict,
+        jlong proximityInfo, jlong dicTraverseSession, jintArray xCoordinatesArray,
+        jintArray yCoordinatesArray, jintArray timesArray, jintArray pointerIdsArray,
+        jintArray inputCodePointsArray, jint inputSize, jintArray suggestOptions,
+        jobjectArray prevWordCodePointArrays, jbooleanArray isBeginningOfSentenceArray,
+        jint prevWordCount, jintArray outSuggestionCount, jintArray outCodePointsArray,
+        jintArray outScoresArray, jintArray outSpaceIndicesArray, jintArray outTypesArray,
+        jintArray outAutoCommitFirstWordConfidenceArray,
+        jfloatArray inOutWeightOfLangModelVsSpatialModel) {
+    const Dictionary *const dictionary = reinterpret_cast<Dictionary *>(dict);
+    // Assign 0 to outSuggestionCount here in case of returning earlier in this method.
+    JniDataUtils::putIntToArray(env, outSuggestionCount, 0 /* index */, 0);
+    if (!dictionary) {
+        return;
+    }
+    getSuggestionsFromDictionaries(env, &dictionary, 1 /* dictionaryCount */, proximityInfo,
+            dicTraverseSession, xCoordinatesArray, yCoordinatesArray, timesArray,
+            pointerIdsArray, inputCodePointsArray, inputSize, suggestOptions,
+            prevWordCodePointArrays, isBeginningOfSentenceArray, prevWordCount,
+            outSuggestionCount, outCodePointsArray, outScoresArray, outSpaceIndicesArray,
+            outTypesArray, outAutoCommitFirstWordConfidenceArray,
+            inOutWeightOfLangModelVsSpatialModel,
+            nullptr /* outDictionaryIndicesArray */);
+}
+
+// Suggests words from several dictionaries with a single search over the input. The index into
+// dicts of the dictionary each suggestion comes from is written to outDictionaryIndicesArray.
+static void latinime_BinaryDictionary_getSuggestionsForGroup(JNIEnv *env, jclass clazz,
+        jlongArray dicts, jlong proximityInfo, jlong dicTraverseSession,
+        jintArray xCoordinatesArray, jintArray yCoordinatesArray, jintArray timesArray,
+        jintArray pointerIdsArray, jintArray inputCodePointsArray, jint inputSize,
+        jintArray suggestOptions, jobjectArray prevWordCodePointArrays,
+        jbooleanArray isBeginningOfSentenceArray, jint prevWordCount,
+        jintArray outSuggestionCount, jintArray outCodePointsArray, jintArray outScoresArray,
+        jintArray outSpaceIndicesArray, jintArray outTypesArray,
+        jintArray outAutoCommitFirstWordConfidenceArray,
+        jfloatArray inOutWeightOfLangModelVsSpatialModel, jintArray outDictionaryIndicesArray) {
+    // Assign 0 to outSuggestionCount here in case of returning earlier in this method.
+    JniDataUtils::putIntToArray(env, outSuggestionCount, 0 /* index */, 0);
+    const jsize dictionaryCount = env->GetArrayLength(dicts);
+    if (dictionaryCount <= 0 || dictionaryCount > MAX_DICTIONARY_COUNT_IN_SESSION) {
+        AKLOGE("Invalid dictionary count: %d", dictionaryCount);
+        return;
+    }
+    if (env->GetArrayLength(outDictionaryIndicesArray) != MAX_RESULTS) {
+        AKLOGE("Invalid outDictionaryIndicesArray length: %d",
+                env->GetArrayLength(outDictionaryIndicesArray));
         ASSERT(false);
         return;
     }
-    const jsize scoresLength = env->GetArrayLength(outScoresArray);
-    if (scoresLength != MAX_RESULTS) {
-        AKLOGE("Invalid scoresLength: %d", scoresLength);
+    jlong dictHandles[MAX_DICTIONARY_COUNT_IN_SESSION];
+    env->GetLongArrayRegion(dicts, 0, dictionaryCount, dictHandles);
+    const Dictionary *dictionaries[MAX_DICTIONARY_COUNT_IN_SESSION];
+    for (int i = 0; i < dictionaryCount; ++i) {
+        dictionaries[i] = reinterpret_cast<Dictionary *>(dictHandles[i]);
+        if (!dictionaries[i]) {
+            return;
+        }
+    }
+    getSuggestionsFromDictionaries(env, dictionaries, dictionaryCount, proximityInfo,
+            dicTraverseSession, xCoordinatesArray, yCoordinatesArray, timesArray,
+            pointerIdsArray, inputCodePointsArray, inputSize, suggestOptions,
+            prevWordCodePointArrays, isBeginningOfSentenceArray, prevWordCount,
+            outSuggestionCount, outCodePointsArray, outScoresArray, outSpaceIndicesArray,
+            outTypesArray, outAutoCommitFirstWordConfidenceArray,
+            inOutWeightOfLangModelVsSpatialModel,
+            outDictionaryIndicesArray);
+}
+
+static jlong latinime_BinaryDictionary_createWorkerPool(JNIEnv *env, jclass clazz,
+        jint threadCount) {
+    if (threadCount <= 0) {
+        AKLOGE("Invalid thread count: %d", threadCount);
+        return 0;
+    }
+    return reinterpret_cast<jlong>(new WorkerPool(threadCount));
+}
+
+// Searches each dictionary with its own traverse session on the threads of the worker pool. The
+// index into dicts of the dictionary each suggestion comes from is written to
+// outDictionaryIndicesArray. Output scores are already scaled by the weight for locale of that
+// dictionary.
+static void latinime_BinaryDictionary_getSuggestionsInParallel(JNIEnv *env, jclass clazz,
+        jlong workerPool, jlongArray dicts, jlongArray dicTraverseSessions, jlong proximityInfo,
+        jintArray xCoordinatesArray, jintArray yCoordinatesArray, jintArray timesArray,
+        jintArray pointerIdsArray, jintArray inputCodePointsArray, jint inputSize,
+        jobjectArray suggestOptionsArrays, jfloatArray weightsForLocaleArray,
+        jobjectArray prevWordCodePointArrays, jbooleanArray isBeginningOfSentenceArray,
+        jint prevWordCount, jintArray outSuggestionCount, jintArray outCodePointsArray,
+        jintArray outScoresArray, jintArray outSpaceIndicesArray, jintArray outTypesArray,
+        jintArray outAutoCommitFirstWordConfidenceArray,
+        jfloatArray inOutWeightOfLangModelVsSpatialModel, jintArray outDictionaryIndicesArray) {
+    // Assign 0 to outSuggestionCount here in case of returning earlier in this method.
+    JniDataUtils::putIntToArray(env, outSuggestionCount, 0 /* index */, 0);
+    WorkerPool *const pool = reinterpret_cast<WorkerPool *>(workerPool);
+    if (!pool) {
+        return;
+    }
+    const jsize dictionaryCount = env->GetArrayLength(dicts);
+    if (dictionaryCount <= 0 || dictionaryCount > MAX_DICTIONARY_COUNT_IN_SESSION
+            || env->GetArrayLength(dicTraverseSessions) != dictionaryCount
+            || env->GetArrayLength(suggestOptionsArrays) != dictionaryCount
+            || env->GetArrayLength(weightsForLocaleArray) != dictionaryCount) {
+        AKLOGE("Invalid dictionary count: %d", dictionaryCount);
         ASSERT(false);
         return;
     }
-    const jsize outputAutoCommitFirstWordConfidenceLength =
-            env->GetArrayLength(outAutoCommitFirstWordConfidenceArray);
-    ASSERT(outputAutoCommitFirstWordConfidenceLength == 1);
-    if (outputAutoCommitFirstWordConfidenceLength != 1) {
-        // We only use the first result, as obviously we will only ever autocommit the first one
-        AKLOGE("Invalid outputAutoCommitFirstWordConfidenceLength: %d",
-                outputAutoCommitFirstWordConfidenceLength);
+    if (!checkSuggestionOutputArrays(env, outCodePointsArray, outScoresArray,
+            outAutoCommitFirstWordConfidenceArray)) {
+        return;
+    }
+    if (env->GetArrayLength(outDictionaryIndicesArray) != MAX_RESULTS) {
+        AKLOGE("Invalid outDictionaryIndicesArray length: %d",
+                env->GetArrayLength(outDictionaryIndicesArray));
         ASSERT(false);
         return;
     }
+    jlong dictHandles[MAX_DICTIONARY_COUNT_IN_SESSION];
+    jlong sessionHandles[MAX_DICTIONARY_COUNT_IN_SESSION];
+    env->GetLongArrayRegion(dicts, 0, dictionaryCount, dictHandles);
+    env->GetLongArrayRegion(dicTraverseSessions, 0, dictionaryCount, sessionHandles);
+    const Dictionary *dictionaries[MAX_DICTIONARY_COUNT_IN_SESSION];
+    DicTraverseSession *traverseSessions[MAX_DICTIONARY_COUNT_IN_SESSION];
+    // SuggestOptions only points to the option values, which must outlive it.
+    std::vector<std::vector<int>> options(dictionaryCount);
+    std::vector<std::unique_ptr<SuggestOptions>> givenSuggestOptions;
+    const SuggestOptions *suggestOptions[MAX_DICTIONARY_COUNT_IN_SESSION];
+    float weightsForLocale[MAX_DICTIONARY_COUNT_IN_SESSION];
+    env->GetFloatArrayRegion(weightsForLocaleArray, 0, dictionaryCount, weightsForLocale);
+    for (int i = 0; i < dictionaryCount; ++i) {
+        dictionaries[i] = reinterpret_cast<Dictionary *>(dictHandles[i]);
+        traverseSessions[i] = reinterpret_cast<DicTraverseSession *>(sessionHandles[i]);
+        if (!dictionaries[i] || !traverseSessions[i]) {
+            return;
+        }
+        jintArray optionsArray =
+                static_cast<jintArray>(env->GetObjectArrayElement(suggestOptionsArrays, i));
+        options[i].resize(env->GetArrayLength(optionsArray));
+        env->GetIntArrayRegion(optionsArray, 0, options[i].size(), options[i].data());
+        env->DeleteLocalRef(optionsArray);
+        givenSuggestOptions.emplace_back(
+                new SuggestOptions(options[i].data(), static_cast<int>(options[i].size())));
+        suggestOptions[i] = givenSuggestOptions.back().get();
+    }
+    ProximityInfo *pInfo = reinterpret_cast<ProximityInfo *>(proximityInfo);
+    // Input values
+    int xCoordinates[inputSize];
+    int yCoordinates[inputSize];
+    int times[inputSize];
+    int pointerIds[inputSize];
+    const jsize inputCodePointsLength = env->GetArrayLength(inputCodePointsArray);
+    int inputCodePoints[inputCodePointsLength];
+    env->GetIntArrayRegion(xCoordinatesArray, 0, inputSize, xCoordinates);
+    env->GetIntArrayRegion(yCoordinatesArray, 0, inputSize, yCoordinates);
+    env->GetIntArrayRegion(timesArray, 0, inputSize, times);
+    env->GetIntArrayRegion(pointerIdsArray, 0, inputSize, pointerIds);
+    env->GetIntArrayRegion(inputCodePointsArray, 0, inputCodePointsLength, inputCodePoints);
+
     float weightOfLangModelVsSpatialModel;
     env->GetFloatArrayRegion(inOutWeightOfLangModelVsSpatialModel, 0, 1 /* len */,
             &weightOfLangModelVsSpatialModel);
     SuggestionResults suggestionResults(MAX_RESULTS);
     const NgramContext ngramContext = JniDataUtils::constructNgramContext(env,
             prevWordCodePointArrays, isBeginningOfSentenceArray, prevWordCount);
-    if (givenSuggestOptions.isGesture() || inputSize > 0) {
-        // TODO: Use SuggestionResults to return suggestions.
-        dictionary->getSuggestions(pInfo, traverseSession, xCoordinates, yCoordinates,
-                times, pointerIds, inputCodePoints, inputSize, &ngramContext,
-                &givenSuggestOptions, weightOfLangModelVsSpatialModel, &suggestionResults);
-    } else {
-        dictionary->getPredictions(&ngramContext, &suggestionResults);
-    }
+    Dictionary::getSuggestionsInParallel(pool, dictionaries, traverseSessions, suggestOptions,
+            weightsForLocale, dictionaryCount, pInfo, xCoordinates, yCoordinates, times, pointerIds,
+            inputCodePoints, inputSize, &ngramContext, weightOfLangModelVsSpatialModel,
+            &suggestionResults);
     if (DEBUG_DICT) {
         suggestionResults.dumpSuggestions();
     }
     suggestionResults.outputSuggestions(env, outSuggestionCount, outCodePointsArray,
             outScoresArray, outSpaceIndicesArray, outTypesArray,
-            outAutoCommitFirstWordConfidenceArray, inOutWeightOfLangModelVsSpatialModel);
+            outAutoCommitFirstWordConfidenceArray, inOutWeightOfLangModelVsSpatialModel,
+            outDictionaryIndicesArray);
 }
 
 static jint latinime_BinaryDictionary_getProbability(JNIEnv *env, jclass clazz, jlong dict,
@@ -452,60 +669,29 @@ static bool latinime_BinaryDictionary_updateEntriesForWordWithNgramContext(JNIEn
             historicalInfo);
 }
 
-// Returns how many input events are processed.
+// Returns the index of the first entry of the merged input events that has not been processed.
 static int latinime_BinaryDictionary_updateEntriesForInputEvents(JNIEnv *env, jclass clazz,
-        jlong dict, jobjectArray inputEvents, jint startIndex) {
+        jlong dict, jobject packedInputEvents, jint inputEventCount, jint startIndex) {
     Dictionary *dictionary = reinterpret_cast<Dictionary *>(dict);
     if (!dictionary) {
         return 0;
     }
-    jsize inputEventCount = env->GetArrayLength(inputEvents);
-    if (inputEventCount == 0 || startIndex >= inputEventCount) {
+    const int *const buffer = static_cast<const int *>(
+            env->GetDirectBufferAddress(packedInputEvents));
+    const jlong bufferCapacity = env->GetDirectBufferCapacity(packedInputEvents);
+    if (!buffer || bufferCapacity < 0) {
+        AKLOGE("Input events have to be given in a direct buffer.");
         return 0;
     }
-    jobject inputEvent = env->GetObjectArrayElement(inputEvents, 0);
-    jclass wordInputEventClass = env->GetObjectClass(inputEvent);
-    env->DeleteLocalRef(inputEvent);
-
-    jfieldID targetWordFieldId = env->GetFieldID(wordInputEventClass, "mTargetWord", "[I");
-    jfieldID prevWordCountFieldId = env->GetFieldID(wordInputEventClass, "mPrevWordsCount", "I");
-    jfieldID prevWordArrayFieldId = env->GetFieldID(wordInputEventClass, "mPrevWordArray", "[[I");
-    jfieldID isPrevWordBoSArrayFieldId =
-            env->GetFieldID(wordInputEventClass, "mIsPrevWordBeginningOfSentenceArray", "[Z");
-    jfieldID isValidFieldId = env->GetFieldID(wordInputEventClass, "mIsValid", "Z");
-    jfieldID timestampFieldId = env->GetFieldID(wordInputEventClass, "mTimestamp", "I");
-    env->DeleteLocalRef(wordInputEventClass);
-
-    for (int i = startIndex; i < inputEventCount; ++i) {
-        jobject inputEvent = env->GetObjectArrayElement(inputEvents, i);
-        jintArray targetWord = static_cast<jintArray>(
-                env->GetObjectField(inputEvent, targetWordFieldId));
-        jsize wordLength = env->GetArrayLength(targetWord);
-        int wordCodePoints[wordLength];
-        env->GetIntArrayRegion(targetWord, 0, wordLength, wordCodePoints);
-        env->DeleteLocalRef(targetWord);
-
-        jint prevWordCount = env->GetIntField(inputEvent, prevWordCountFieldId);
-        jobjectArray prevWordArray =
-                static_cast<jobjectArray>(env->GetObjectField(inputEvent, prevWordArrayFieldId));
-        jbooleanArray isPrevWordBeginningOfSentenceArray = static_cast<jbooleanArray>(
-                env->GetObjectField(inputEvent, isPrevWordBoSArrayFieldId));
-        jboolean isValid = env->GetBooleanField(inputEvent, isValidFieldId);
-        jint timestamp = env->GetIntField(inputEvent, timestampFieldId);
-        const NgramContext ngramContext = JniDataUtils::constructNgramContext(env,
-                prevWordArray, isPrevWordBeginningOfSentenceArray, prevWordCount);
-        // Use 1 for count to indicate the word has inputted.
-        dictionary->updateEntriesForWordWithNgramContext(&ngramContext,
-                CodePointArrayView(wordCodePoints, wordLength), isValid,
-                HistoricalInfo(timestamp, 0 /* level */, 1 /* count */));
-        if (dictionary->needsToRunGC(true /* mindsBlockByGC */)) {
-            return i + 1;
-        }
-        env->DeleteLocalRef(prevWordArray);
-        env->DeleteLocalRef(isPrevWordBeginningOfSentenceArray);
-        env->DeleteLocalRef(inputEvent);
+    InputEventBatch inputEventBatch;
+    if (!inputEventBatch.readFrom(IntArrayView(buffer, bufferCapacity / sizeof(int)),
+            inputEventCount)) {
+        return 0;
+    }
+    if (startIndex >= inputEventBatch.getEntryCount()) {
+        return inputEventBatch.getEntryCount();
     }
-    return inputEventCount;
+    return dictionary->updateEntriesForInputEvents(&inputEventBatch, startIndex);
 }
 
 static jstring latinime_BinaryDictionary_getProperty(JNIEnv *env, jclass clazz, jlong dict,
@@ -525,11 +711,21 @@ static jstring latinime_BinaryDictionary_getProperty(JNIEnv *env, jclass clazz,
     return env->NewStringUTF(resultChars);
 }
 
+static bool latinime_BinaryDictionary_supportsSnapshotReadsNative(JNIEnv *env, jclass clazz,
+        jlong dict) {
+    Dictionary *dictionary = reinterpret_cast<Dictionary *>(dict);
+    if (!dictionary) {
+        return false;
+    }
+    return dictionary->supportsSnapshotReads();
+}
+
 static bool latinime_BinaryDictionary_isCorruptedNative(JNIEnv *env, jclass clazz, jlong dict) {
     Dictionary *dictionary = reinterpret_cast<Dictionary *>(dict);
     if (!dictionary) {
         return false;
     }
+    const LeftRightSync::ReadScope readScope(dictionary->getLeftRightSync());
     return dictionary->getDictionaryStructurePolicy()->isCorrupted();
 }
 
@@ -553,11 +749,18 @@ static bool latinime_BinaryDictionary_migrateNative(JNIEnv *env, jclass clazz, j
     env->GetStringUTFRegion(dictFilePath, 0, env->GetStringLength(dictFilePath), dictFilePathChars);
     dictFilePathChars[filePathUtf8Length] = '\0';
 
-    const DictionaryHeaderStructurePolicy *const headerPolicy =
-            dictionary->getDictionaryStructurePolicy()->getHeaderStructurePolicy();
-    DictionaryStructureWithBufferPolicy::StructurePolicyPtr dictionaryStructureWithBufferPolicy =
-            DictionaryStructureWithBufferPolicyFactory::newPolicyForOnMemoryDict(
-                    newFormatVersion, *headerPolicy->getLocale(), headerPolicy->getAttributeMap());
+    DictionaryStructureWithBufferPolicy::StructurePolicyPtr dictionaryStructureWithBufferPolicy;
+    {
+        // Only the header is read here. The scope can't stay open while iterating, an update
+        // waiting for its readers would hold the lock getNextWordAndNextToken() takes.
+        const LeftRightSync::ReadScope readScope(dictionary->getLeftRightSync());
+        const DictionaryHeaderStructurePolicy *const headerPolicy =
+                dictionary->getDictionaryStructurePolicy()->getHeaderStructurePolicy();
+        dictionaryStructureWithBufferPolicy =
+                DictionaryStructureWithBufferPolicyFactory::newPolicyForOnMemoryDict(
+                        newFormatVersion, *headerPolicy->getLocale(),
+                        headerPolicy->getAttributeMap());
+    }
     if (!dictionaryStructureWithBufferPolicy) {
         LogUtils::logToJava(env, "Cannot migrate header.");
         return false;
@@ -662,6 +865,21 @@ static const JNINativeMethod sMethods[] = {
         const_cast<char *>("(JJJ[I[I[I[I[II[I[[I[ZI[I[I[I[I[I[I[F)V"),
         reinterpret_cast<void *>(latinime_BinaryDictionary_getSuggestions)
     },
+    {
+        const_cast<char *>("getSuggestionsForGroupNative"),
+        const_cast<char *>("([JJJ[I[I[I[I[II[I[[I[ZI[I[I[I[I[I[I[F[I)V"),
+        reinterpret_cast<void *>(latinime_BinaryDictionary_getSuggestionsForGroup)
+    },
+    {
+        const_cast<char *>("createWorkerPoolNative"),
+        const_cast<char *>("(I)J"),
+        reinterpret_cast<void *>(latinime_BinaryDictionary_createWorkerPool)
+    },
+    {
+        const_cast<char *>("getSuggestionsInParallelNative"),
+        const_cast<char *>("(J[J[JJ[I[I[I[I[II[[I[F[[I[ZI[I[I[I[I[I[I[F[I)V"),
+        reinterpret_cast<void *>(latinime_BinaryDictionary_getSuggestionsInParallel)
+    },
     {
         const_cast<char *>("getProbabilityNative"),
         const_cast<char *>("(J[I)I"),
@@ -716,8 +934,7 @@ static const JNINativeMethod sMethods[] = {
     },
     {
         const_cast<char *>("updateEntriesForInputEventsNative"),
-        const_cast<char *>(
-                "(J[Lorg/futo/inputmethod/latin/utils/WordInputEventForPersonalization;I)I"),
+        const_cast<char *>("(JLjava/nio/ByteBuffer;II)I"),
         reinterpret_cast<void *>(latinime_BinaryDictionary_updateEntriesForInputEvents)
     },
     {
@@ -725,6 +942,11 @@ static const JNINativeMethod sMethods[] = {
         const_cast<char *>("(JLjava/lang/String;)Ljava/lang/String;"),
         reinterpret_cast<void *>(latinime_BinaryDictionary_getProperty)
     },
+    {
+        const_cast<char *>("supportsSnapshotReadsNative"),
+        const_cast<char *>("(J)Z"),
+        reinterpret_cast<void *>(latinime_BinaryDictionary_supportsSnapshotReadsNative)
+    },
     {
         const_cast<char *>("isCorruptedNative"),
         const_cast<char *>("(J)Z"),
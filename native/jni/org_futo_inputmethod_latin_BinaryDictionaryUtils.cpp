@@ -25,6 +25,7 @@
 #include "utils/autocorrection_threshold_utils.h"
 #include "utils/char_utils.h"
 #include "utils/jni_data_utils.h"
+#include "utils/stats_registry.h"
 #include "utils/time_keeper.h"
 
 namespace latinime {
@@ -79,6 +80,15 @@ static int latinime_BinaryDictionaryUtils_setCurrentTimeForTest(JNIEnv *env, jcl
     return TimeKeeper::peekCurrentTime();
 }
 
+static jstring latinime_BinaryDictionaryUtils_getStats(JNIEnv *env, jclass clazz,
+        jboolean reset) {
+    const std::string stats = StatsRegistry::dump();
+    if (reset) {
+        StatsRegistry::reset();
+    }
+    return env->NewStringUTF(stats.c_str());
+}
+
 static const JNINativeMethod sMethods[] = {
     {
         const_cast<char *>("createEmptyDictFileNative"),
@@ -95,6 +105,11 @@ static const JNINativeMethod sMethods[] = {
         const_cast<char *>("setCurrentTimeForTestNative"),
         const_cast<char *>("(I)I"),
         reinterpret_cast<void *>(latinime_BinaryDictionaryUtils_setCurrentTimeForTest)
+    },
+    {
+        const_cast<char *>("getStatsNative"),
+        const_cast<char *>("(Z)Ljava/lang/String;"),
+        reinterpret_cast<void *>(latinime_BinaryDictionaryUtils_getStats)
     }
 };
 
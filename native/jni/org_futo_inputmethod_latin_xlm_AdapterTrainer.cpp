@@ -7,6 +7,8 @@
 #include <sstream>
 #include <chrono>
 #include <iomanip>
+#include <thread>
+#include <cstdio>
 #include "org_futo_inputmethod_latin_xlm_AdapterTrainer.h"
 #include "defines.h"
 #include "jni_common.h"
@@ -19,14 +21,24 @@ namespace latinime {
     struct AdapterTrainerState {
         std::string baseModelPath;
         std::string loraCachePath;
-        std::string outputModelPath;
+        std::string outputAdapterPath;
+        std::string checkpointPath;
         float outputScale;
 
+        // Wall time spent in training slices so far, logged once training finishes
+        std::chrono::system_clock::time_point trainingStart;
+        std::chrono::duration<double> trainingTime = std::chrono::duration<double>::zero();
+        bool trainingStarted = false;
+
         ModelMetadata metadata;
 
         sentencepiece::SentencePieceProcessor spm;
         struct train_params params;
 
+        // Examples are only queued on the JNI thread and tokenized in parallel right before training
+        std::vector<std::string> pendingExamples;
+        struct train_token_arena trainingData;
+
         static void OnLossCallback(void *userdata, float loss) {
             auto *state = reinterpret_cast<AdapterTrainerState *>(userdata);
             state->OnLoss(loss);
@@ -59,17 +71,27 @@ namespace latinime {
 
             params = get_default_train_params();
             params.common.fn_train_data = "";
-            params.common.fn_checkpoint_in = "";
-            params.common.fn_checkpoint_out = "";
+            // Optimizer and LoRA state are checkpointed so training can continue in later slices
+            checkpointPath = loraCachePath + ".checkpoint";
+            params.common.fn_checkpoint_in = checkpointPath.c_str();
+            params.common.fn_checkpoint_out = checkpointPath.c_str();
             params.fn_model_base = baseModelPath.c_str();
             params.fn_lora_out = loraCachePath.c_str();
 
+            // Training continues from the previously exported adapter, whose B matrices carry outputScale
+            params.fn_lora_in = outputAdapterPath.c_str();
+            params.lora_in_scale = outputScale > 0.0f ? 1.0f / outputScale : 1.0f;
+
             params.common.fill_with_next_samples = true;
             params.common.n_threads = 6;
             params.common.n_gradient_accumulation = 2;
             params.common.n_batch = 2;
             params.common.n_ctx = 64;
-            params.common.sample_random_offsets = true;
+
+            // Samples are packed into whole n_ctx windows, so random offsets would only split messages
+            params.pack_samples = true;
+            params.common.sample_random_offsets = false;
+            params.training_data = &trainingData;
 
             params.common.warmup = 10;
             params.common.n_epochs = 1;
@@ -93,23 +115,74 @@ namespace latinime {
         }
 
         void AddTrainingExample(const std::string &example) {
-            std::vector<llama_token> result = spm.EncodeAsIds(example);
-            params.training_data.push_back(result);
+            pendingExamples.push_back(example);
         }
 
-        int Train() const {
-            return finetune_train(params);
+        void TokenizePendingExamples() {
+            if(pendingExamples.empty()) return;
+
+            const size_t numExamples = pendingExamples.size();
+            const size_t numWorkers = std::max((size_t)1, std::min((size_t)params.common.n_threads, numExamples / 64));
+
+            // Each worker tokenizes a contiguous slice into its own arena, merged in order afterwards
+            std::vector<struct train_token_arena> shards(numWorkers);
+            auto worker = [&](size_t w) {
+                const size_t begin = numExamples * w / numWorkers;
+                const size_t end = numExamples * (w + 1) / numWorkers;
+                std::vector<int> ids;
+                for(size_t i = begin; i < end; i++) {
+                    ids.clear();
+                    if(!spm.Encode(pendingExamples[i], &ids).ok() || ids.empty()) continue;
+                    shards[w].add_sample(ids.data(), ids.size());
+                }
+            };
+
+            std::vector<std::thread> threads;
+            for(size_t w = 1; w < numWorkers; w++) {
+                threads.emplace_back(worker, w);
+            }
+            worker(0);
+            for(auto &thread : threads) {
+                thread.join();
+            }
+
+            for(const auto &shard : shards) {
+                trainingData.append(shard);
+            }
+
+            pendingExamples.clear();
+            pendingExamples.shrink_to_fit();
         }
 
-        void UpdateHistoryAndCount(std::chrono::system_clock::time_point start, std::chrono::system_clock::time_point end) {
-            std::chrono::duration<double> elapsed_seconds = end - start;
+        // Returns a finetune_result, or a negative value on error
+        int Train(int64_t maxTimeMs) {
+            TokenizePendingExamples();
+            if(trainingData.samples_size.empty()) return -1;
+
+            params.max_time_ms = maxTimeMs;
 
-            int num_examples = params.training_data.size();
-            int num_tokens = 0;
-            for(const auto & example: params.training_data) {
-                num_tokens += example.size();
+            auto start = std::chrono::system_clock::now();
+            if(!trainingStarted) {
+                trainingStart = start;
+                trainingStarted = true;
             }
 
+            int result = finetune_train(params);
+
+            trainingTime += std::chrono::system_clock::now() - start;
+            return result;
+        }
+
+        void DiscardCheckpoint() const {
+            std::remove(checkpointPath.c_str());
+        }
+
+        // One line of the adapter history
+        std::string GetTrainingSummary(std::chrono::system_clock::time_point start, std::chrono::duration<double> elapsed_seconds) const {
+
+            int num_examples = trainingData.samples_size.size();
+            int num_tokens = trainingData.tokens.size();
+
             time_t rawtime;
             struct tm * timeinfo;
             char date_time[32];
@@ -126,22 +199,18 @@ namespace latinime {
             std::stringstream ss;
 
             // Format the string using the stringstream object
-            ss << "\n" << date_time << ": Fine-tuned on " << num_examples << " examples (" << num_tokens << " tokens), took "
+            ss << date_time << ": Fine-tuned on " << num_examples << " examples (" << num_tokens << " tokens), took "
                << std::fixed << std::setprecision(2) << elapsed_seconds.count() / 60.0 << " minutes";
 
-            // Convert the stringstream object to a std::string
-            std::string result = ss.str();
-
-            metadata.finetuning_count += 1;
-            metadata.history.append(result);
+            return ss.str();
         }
     };
 
-    static jlong xlm_AdapterTrainer_open(JNIEnv *env, jclass clazz, jstring baseModelPathStr, jstring loraCacheStr, jstring outputModelPathStr, float outputScale) {
+    static jlong xlm_AdapterTrainer_open(JNIEnv *env, jclass clazz, jstring baseModelPathStr, jstring loraCacheStr, jstring outputAdapterPathStr, float outputScale) {
         auto *state = new AdapterTrainerState();
         state->baseModelPath   = jstring2string(env, baseModelPathStr);
         state->loraCachePath   = jstring2string(env, loraCacheStr);
-        state->outputModelPath = jstring2string(env, outputModelPathStr);
+        state->outputAdapterPath = jstring2string(env, outputAdapterPathStr);
         state->outputScale = outputScale;
 
         state->env = env;
@@ -165,9 +234,7 @@ namespace latinime {
         state->AddTrainingExample(jstring2string(env, exampleStr));
     }
 
-    // TODO: Callback for progress
-    static void xlm_AdapterTrainer_train(JNIEnv *env, jobject instance, jlong statePtr) {
-
+    static void SetCallbacks(JNIEnv *env, jobject instance, AdapterTrainerState *state) {
         jclass clazz = env->GetObjectClass(instance);
         ASSERT(clazz);
 
@@ -176,59 +243,71 @@ namespace latinime {
         ASSERT(progressMethodId);
         ASSERT(lossMethodId);
 
-        auto *state = reinterpret_cast<AdapterTrainerState *>(statePtr);
         state->env = env;
         state->lossMethodId = lossMethodId;
         state->progressMethodId = progressMethodId;
         state->callbackObject = instance;
+    }
 
-        std::chrono::system_clock::time_point start, end;
-        start = std::chrono::system_clock::now();
-
-        int result = state->Train();
-        if(result != 0) {
-            AKLOGE("train returned with non-zero code %d", result);
-            return;
+    // The adapter is evaluated on top of the base model at runtime, so only the LoRA matrices are
+    // exported. Written to a temporary file first so the keyboard never loads a partial adapter
+    static bool ExportAdapter(AdapterTrainerState *state) {
+        std::string summary = state->GetTrainingSummary(state->trainingStart, state->trainingTime);
+        AKLOGI("%s", summary.c_str());
+
+        std::string tmpPath = state->outputAdapterPath + ".tmp";
+        if(!export_lora_adapter(state->loraCachePath.c_str(), tmpPath.c_str(), state->outputScale)) {
+            AKLOGE("Failed to export LoRA adapter");
+            std::remove(tmpPath.c_str());
+            return false;
         }
 
-        end = std::chrono::system_clock::now();
+        if(std::rename(tmpPath.c_str(), state->outputAdapterPath.c_str()) != 0) {
+            AKLOGE("Failed to move LoRA adapter to %s", state->outputAdapterPath.c_str());
+            std::remove(tmpPath.c_str());
+            return false;
+        }
 
-        // Increment count and add history
-        state->UpdateHistoryAndCount(start, end);
+        // The adapter is already in place, so a failure here only leaves the run out of the count
+        std::string historyPath = state->outputAdapterPath + LORA_ADAPTER_HISTORY_SUFFIX;
+        FILE *history = fopen(historyPath.c_str(), "a");
+        if(history == nullptr || fprintf(history, "%s\n", summary.c_str()) < 0) {
+            AKLOGE("Failed to append to %s", historyPath.c_str());
+        }
+        if(history != nullptr) fclose(history);
 
-        // Apply LoRA
-        llama_model_params model_params = llama_model_default_params();
-        model_params.use_mmap = false;
+        return true;
+    }
 
-        llama_model *model = llama_load_model_from_file(state->baseModelPath.c_str(), model_params);
+    // Trains for at most maxTimeMs milliseconds (0 = until done), resuming from the checkpoint of a
+    // previous slice if there is one. Returns FINETUNE_FINISHED once the adapter has been exported,
+    // FINETUNE_SLICE_ENDED if another slice is needed, or a negative value on error.
+    static jint xlm_AdapterTrainer_trainSlice(JNIEnv *env, jobject instance, jlong statePtr, jlong maxTimeMs) {
+        auto *state = reinterpret_cast<AdapterTrainerState *>(statePtr);
+        SetCallbacks(env, instance, state);
 
-        if(model == nullptr) {
-            AKLOGE("failed to load model for exporting LoRA");
-            return;
+        int result = state->Train(maxTimeMs);
+        if(result == FINETUNE_SLICE_ENDED) {
+            return result;
+        } else if(result != FINETUNE_FINISHED) {
+            AKLOGE("train returned with non-zero code %d", result);
+            return result < 0 ? result : -1;
         }
 
-        int err = llama_model_apply_lora_from_file(
-                model,
-               state->loraCachePath.c_str(),
-               state->outputScale,
-               nullptr,
-               4
-        );
-        if(err != 0) {
-            AKLOGE("Failed to apply lora: %d", err);
-            return;
+        state->DiscardCheckpoint();
+        if(!ExportAdapter(state)) {
+            return -2;
         }
 
-        int status = save_llama_model_file(
-            state->outputModelPath.c_str(),
-            state->baseModelPath.c_str(),
-            model,
-            state->metadata
-        );
-        if(status != 0) {
-            AKLOGE("Failed to save model! %d", status);
-            return;
-        }
+        return FINETUNE_FINISHED;
+    }
+
+    static void xlm_AdapterTrainer_train(JNIEnv *env, jobject instance, jlong statePtr) {
+        auto *state = reinterpret_cast<AdapterTrainerState *>(statePtr);
+
+        // A monolithic run always starts from scratch
+        state->DiscardCheckpoint();
+        xlm_AdapterTrainer_trainSlice(env, instance, statePtr, 0);
     }
 
     static const JNINativeMethod sMethods[] = {
@@ -252,6 +331,11 @@ namespace latinime {
                     const_cast<char *>("(J)V"),
                     reinterpret_cast<void *>(xlm_AdapterTrainer_train)
             },
+            {
+                    const_cast<char *>("trainSliceNative"),
+                    const_cast<char *>("(JJ)I"),
+                    reinterpret_cast<void *>(xlm_AdapterTrainer_trainSlice)
+            },
 
     };
 
@@ -1,4 +1,5 @@
 #include <jni.h>
+#include <fstream>
 #include <string>
 #include "org_futo_inputmethod_latin_xlm_ModelInfoLoader.h"
 #include "defines.h"
@@ -12,7 +13,7 @@ namespace latinime {
 
     jobject metadata_open(JNIEnv *env, jobject thiz, jstring pathString) {
         std::string path = jstring2string(env, pathString);
-        auto metadata = loadModelMetadata(path);
+        auto metadata = loadModelMetadata(path, false);
 
         if(metadata.error) {
             AKLOGE("ModelInfoLoader: loading metadata for %s failed", path.c_str());
@@ -79,12 +80,65 @@ namespace latinime {
         return modelInfo;
     }
 
+    // Writes the model with the adapter merged into its weights, and the history of the adapter added to its
+    // metadata, so that the exported file carries the finetuning like models used to before runtime adapters
+    jboolean metadata_exportWithAdapter(JNIEnv *env, jobject thiz, jstring pathString, jstring adapterPathString, jstring outPathString) {
+        std::string path = jstring2string(env, pathString);
+        std::string adapterPath = jstring2string(env, adapterPathString);
+        std::string outPath = jstring2string(env, outPathString);
+
+        auto metadata = loadModelMetadata(path);
+        if(metadata.error) {
+            AKLOGE("ModelInfoLoader: loading metadata for %s failed", path.c_str());
+            return false;
+        }
+
+        std::ifstream history(adapterPath + LORA_ADAPTER_HISTORY_SUFFIX);
+        std::string line;
+        while(std::getline(history, line)) {
+            if(line.empty()) continue;
+            metadata.finetuning_count += 1;
+            metadata.history.append("\n" + line);
+        }
+
+        llama_model_params model_params = llama_model_default_params();
+        model_params.use_mmap = false;
+
+        llama_model *model = llama_load_model_from_file(path.c_str(), model_params);
+        if(model == nullptr) {
+            AKLOGE("ModelInfoLoader: failed to load %s for exporting", path.c_str());
+            return false;
+        }
+
+        // The scale was baked into the exported adapter
+        int err = llama_model_apply_lora_from_file(model, adapterPath.c_str(), 1.0f, nullptr, 4);
+        if(err != 0) {
+            AKLOGE("ModelInfoLoader: failed to apply adapter: %d", err);
+            llama_free_model(model);
+            return false;
+        }
+
+        int status = save_llama_model_file(outPath.c_str(), path.c_str(), model, metadata);
+        llama_free_model(model);
+        if(status != 0) {
+            AKLOGE("ModelInfoLoader: failed to save model: %d", status);
+            return false;
+        }
+
+        return true;
+    }
+
     static const JNINativeMethod sMethods[] = {
             {
                     const_cast<char *>("loadNative"),
                     const_cast<char *>("(Ljava/lang/String;)Lorg/futo/inputmethod/latin/xlm/ModelInfo;"),
                     reinterpret_cast<void *>(metadata_open)
             },
+            {
+                    const_cast<char *>("exportWithAdapterNative"),
+                    const_cast<char *>("(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)Z"),
+                    reinterpret_cast<void *>(metadata_exportWithAdapter)
+            },
     };
 
     int register_ModelInfoLoader(JNIEnv *env) {
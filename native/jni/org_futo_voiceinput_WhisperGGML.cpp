@@ -16,11 +16,16 @@ struct WhisperModelState {
     int n_threads = 4;
     struct whisper_context *context = nullptr;
 
-    std::vector<int> last_forbidden_languages;
-
     volatile int cancel_flag = 0;
 };
 
+static int get_num_threads() {
+    long num_procs = sysconf(_SC_NPROCESSORS_ONLN);
+    if(num_procs < 2 || num_procs > 16) num_procs = 6; // Make sure the number is sane
+
+    return (int)num_procs;
+}
+
 static jlong WhisperGGML_open(JNIEnv *env, jclass clazz, jstring model_dir) {
     std::string model_dir_str = jstring2string(env, model_dir);
 
@@ -81,21 +86,16 @@ static jstring WhisperGGML_infer(JNIEnv *env, jobject instance, jlong handle, jf
         forbidden_languages.push_back(whisper_lang_id(str.c_str()));
     }
 
-    state->last_forbidden_languages = forbidden_languages;
-
     size_t num_samples = env->GetArrayLength(samples_array);
     jfloat *samples = env->GetFloatArrayElements(samples_array, nullptr);
 
-    long num_procs = sysconf(_SC_NPROCESSORS_ONLN);
-    if(num_procs < 2 || num_procs > 16) num_procs = 6; // Make sure the number is sane
-
     whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
     wparams.print_progress = false;
     wparams.print_realtime = false;
     wparams.print_special = false;
     wparams.print_timestamps = false;
     wparams.max_tokens = 256;
-    wparams.n_threads = (int)num_procs;
+    wparams.n_threads = get_num_threads();
 
     wparams.audio_ctx = std::max(160, std::min(1500, (int)ceil((double)num_samples / (double)(320.0)) + 32));
     wparams.temperature_inc = 0.0f;
@@ -125,6 +125,9 @@ static jstring WhisperGGML_infer(JNIEnv *env, jobject instance, jlong handle, jf
         wparams.allowed_langs_size = allowed_languages.size();
     }
 
+    wparams.bail_langs = forbidden_languages.data();
+    wparams.bail_langs_size = forbidden_languages.size();
+
     std::string prompt_str = jstring2string(env, prompt);
     wparams.initial_prompt = prompt_str.c_str();
     AKLOGI("Initial prompt is [%s]", prompt_str.c_str());
@@ -164,12 +167,6 @@ static jstring WhisperGGML_infer(JNIEnv *env, jobject instance, jlong handle, jf
     wparams.abort_callback = [](void * user_data) -> bool {
         auto *wstate = reinterpret_cast<WhisperModelState *>(user_data);
 
-        if(std::find(wstate->last_forbidden_languages.begin(),
-                     wstate->last_forbidden_languages.end(),
-                     whisper_full_lang_id(wstate->context)) != wstate->last_forbidden_languages.end()) {
-            return true;
-        }
-
         if(wstate->cancel_flag) {
             AKLOGI("cancel flag set! Aborting...");
             return true;
@@ -209,6 +206,22 @@ static jstring WhisperGGML_infer(JNIEnv *env, jobject instance, jlong handle, jf
     return jstr;
 }
 
+// Keeps the whisper_state warm between dictation requests: decoders, mel buffers and compute buffers
+// are sized once for the maximum audio_ctx, so subsequent whisper_full calls only reuse them
+static jboolean WhisperGGML_warmup(JNIEnv *env, jclass clazz, jlong handle) {
+    auto *state = reinterpret_cast<WhisperModelState *>(handle);
+    if(!state) return false;
+
+    AKLOGI("Warming up whisper state...");
+    int res = whisper_warmup(state->context, get_num_threads());
+    if(res != 0) {
+        AKLOGE("WhisperGGML whisper_warmup failed with non-zero code %d", res);
+        return false;
+    }
+
+    return true;
+}
+
 static void WhisperGGML_close(JNIEnv *env, jclass clazz, jlong handle) {
     auto *state = reinterpret_cast<WhisperModelState *>(handle);
     if(!state) return;
@@ -240,6 +253,11 @@ static const JNINativeMethod sMethods[] = {
                 const_cast<char *>("(J[FLjava/lang/String;[Ljava/lang/String;[Ljava/lang/String;IZ)Ljava/lang/String;"),
                 reinterpret_cast<void *>(WhisperGGML_infer)
         },
+        {
+                const_cast<char *>("warmupNative"),
+                const_cast<char *>("(J)Z"),
+                reinterpret_cast<void *>(WhisperGGML_warmup)
+        },
         {
                 const_cast<char *>("cancelNative"),
                 const_cast<char *>("(J)V"),
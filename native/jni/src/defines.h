@@ -280,6 +280,9 @@ static inline void showStackTrace() {
 // (MAX_PREV_WORD_COUNT_FOR_N_GRAM + 1)-gram is supported.
 #define MAX_PREV_WORD_COUNT_FOR_N_GRAM 3
 
+// The max number of dictionaries traversed together in one suggestion pass.
+#define MAX_DICTIONARY_COUNT_IN_SESSION 4
+
 #define DISALLOW_DEFAULT_CONSTRUCTOR(TypeName) \
   TypeName() = delete
 
@@ -125,6 +125,8 @@ class HeaderPolicy : public DictionaryHeaderStructurePolicy {
                 return FormatUtils::VERSION_402;
             case FormatUtils::VERSION_403:
                 return FormatUtils::VERSION_403;
+            case FormatUtils::VERSION_FLAT:
+                return FormatUtils::VERSION_FLAT;
             default:
                 return FormatUtils::UNKNOWN_VERSION;
         }
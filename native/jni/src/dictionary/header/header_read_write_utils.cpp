@@ -111,12 +111,14 @@ typedef DictionaryHeaderStructurePolicy::AttributeMap AttributeMap;
     switch (version) {
         case FormatUtils::VERSION_2:
         case FormatUtils::VERSION_201:
-        case FormatUtils::VERSION_202:
             // None of the static dictionaries (v2x) support writing
             return false;
+        case FormatUtils::VERSION_202:
+            // Only rewritten as a whole by Ver2ReverseIndexWriter.
         case FormatUtils::VERSION_4_ONLY_FOR_TESTING:
         case FormatUtils::VERSION_402:
         case FormatUtils::VERSION_403:
+        case FormatUtils::VERSION_FLAT:
             return buffer->writeUintAndAdvancePosition(version /* data */,
                     HEADER_DICTIONARY_VERSION_SIZE, writingPos);
         default:
@@ -31,6 +31,7 @@ namespace latinime {
 class DicNode;
 class DicNodeVector;
 class DictionaryHeaderStructurePolicy;
+class InputEventBatch;
 class MultiBigramMap;
 class NgramListener;
 class NgramContext;
@@ -91,6 +92,11 @@ class DictionaryStructureWithBufferPolicy {
             const CodePointArrayView wordCodePoints, const bool isValidWord,
             const HistoricalInfo historicalInfo) = 0;
 
+    // Applies the entries of the batch from startIndex, stopping at endIndex or as soon as the
+    // dictionary needs GC. Returns the index of the first entry that was not applied.
+    virtual int updateEntriesForInputEvents(const InputEventBatch *const inputEventBatch,
+            const int startIndex, const int endIndex) = 0;
+
     // Returns whether the flush was success or not.
     virtual bool flush(const char *const filePath) = 0;
 
@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/property/input_event_batch.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace latinime {
+
+bool InputEventBatch::readFrom(const IntArrayView packedEvents, const int eventCount) {
+    mCodePoints.clear();
+    mEvents.clear();
+    mEntries.clear();
+    mEvents.reserve(eventCount);
+    int pos = 0;
+    for (int i = 0; i < eventCount; ++i) {
+        if (pos + 3 > static_cast<int>(packedEvents.size())) {
+            AKLOGE("Input event %d is truncated.", i);
+            return false;
+        }
+        Event event = {};
+        event.mTimestamp = packedEvents[pos++];
+        event.mIsValidWord = packedEvents[pos++] != 0;
+        event.mPrevWordCount = packedEvents[pos++];
+        if (event.mPrevWordCount < 0 || event.mPrevWordCount > MAX_PREV_WORD_COUNT_FOR_N_GRAM) {
+            AKLOGE("Input event %d has an invalid previous word count: %d", i,
+                    event.mPrevWordCount);
+            return false;
+        }
+        for (int j = 0; j < event.mPrevWordCount; ++j) {
+            if (pos >= static_cast<int>(packedEvents.size())) {
+                AKLOGE("Input event %d is truncated.", i);
+                return false;
+            }
+            event.mIsBeginningOfSentence[j] = packedEvents[pos++] != 0;
+            if (!readCodePoints(packedEvents, &pos, &event.mPrevWordStart[j],
+                    &event.mPrevWordLength[j])) {
+                AKLOGE("Input event %d has an invalid previous word.", i);
+                return false;
+            }
+        }
+        if (!readCodePoints(packedEvents, &pos, &event.mWordStart, &event.mWordLength)
+                || event.mWordLength == 0) {
+            AKLOGE("Input event %d has an invalid word.", i);
+            return false;
+        }
+        mEvents.push_back(event);
+    }
+    mergeEvents();
+    return true;
+}
+
+const NgramContext InputEventBatch::getNgramContext(const int entryIndex) const {
+    const int eventIndex = mEntries[entryIndex].mLastEventIndex;
+    const Event &event = mEvents[eventIndex];
+    int prevWordCodePoints[MAX_PREV_WORD_COUNT_FOR_N_GRAM][MAX_WORD_LENGTH];
+    for (int i = 0; i < event.mPrevWordCount; ++i) {
+        const CodePointArrayView prevWord = getPrevWordCodePointsOfEvent(eventIndex, i);
+        std::copy(prevWord.begin(), prevWord.end(), prevWordCodePoints[i]);
+    }
+    return NgramContext(prevWordCodePoints, event.mPrevWordLength, event.mIsBeginningOfSentence,
+            event.mPrevWordCount);
+}
+
+bool InputEventBatch::hasSameWordAsPreviousEntry(const int entryIndex) const {
+    return entryIndex > 0 && compareCodePoints(getWordCodePoints(entryIndex - 1),
+            getWordCodePoints(entryIndex)) == 0;
+}
+
+bool InputEventBatch::readCodePoints(const IntArrayView packedEvents, int *const pos,
+        int *const outStart, int *const outLength) {
+    if (*pos >= static_cast<int>(packedEvents.size())) {
+        return false;
+    }
+    const int codePointCount = packedEvents[(*pos)++];
+    if (codePointCount < 0 || codePointCount > MAX_WORD_LENGTH
+            || *pos + codePointCount > static_cast<int>(packedEvents.size())) {
+        return false;
+    }
+    *outStart = static_cast<int>(mCodePoints.size());
+    *outLength = codePointCount;
+    mCodePoints.insert(mCodePoints.end(), packedEvents.begin() + *pos,
+            packedEvents.begin() + *pos + codePointCount);
+    *pos += codePointCount;
+    return true;
+}
+
+/* static */ int InputEventBatch::compareCodePoints(const CodePointArrayView codePoints0,
+        const CodePointArrayView codePoints1) {
+    const size_t commonLength = std::min(codePoints0.size(), codePoints1.size());
+    for (size_t i = 0; i < commonLength; ++i) {
+        if (codePoints0[i] != codePoints1[i]) {
+            return codePoints0[i] < codePoints1[i] ? -1 : 1;
+        }
+    }
+    if (codePoints0.size() == codePoints1.size()) {
+        return 0;
+    }
+    return codePoints0.size() < codePoints1.size() ? -1 : 1;
+}
+
+// Orders events by word first, and then by what else makes them update different entries.
+int InputEventBatch::compareEvents(const int eventIndex0, const int eventIndex1) const {
+    const int wordResult = compareCodePoints(getWordCodePointsOfEvent(eventIndex0),
+            getWordCodePointsOfEvent(eventIndex1));
+    if (wordResult != 0) {
+        return wordResult;
+    }
+    const Event &event0 = mEvents[eventIndex0];
+    const Event &event1 = mEvents[eventIndex1];
+    if (event0.mIsValidWord != event1.mIsValidWord) {
+        return event0.mIsValidWord ? 1 : -1;
+    }
+    if (event0.mPrevWordCount != event1.mPrevWordCount) {
+        return event0.mPrevWordCount < event1.mPrevWordCount ? -1 : 1;
+    }
+    for (int i = 0; i < event0.mPrevWordCount; ++i) {
+        if (event0.mIsBeginningOfSentence[i] != event1.mIsBeginningOfSentence[i]) {
+            return event0.mIsBeginningOfSentence[i] ? 1 : -1;
+        }
+        const int prevWordResult = compareCodePoints(
+                getPrevWordCodePointsOfEvent(eventIndex0, i),
+                getPrevWordCodePointsOfEvent(eventIndex1, i));
+        if (prevWordResult != 0) {
+            return prevWordResult;
+        }
+    }
+    return 0;
+}
+
+void InputEventBatch::mergeEvents() {
+    std::vector<int> sortedEventIndices(mEvents.size());
+    std::iota(sortedEventIndices.begin(), sortedEventIndices.end(), 0);
+    // Stable, so that the events merged into an entry stay in input order.
+    std::stable_sort(sortedEventIndices.begin(), sortedEventIndices.end(),
+            [this](const int eventIndex0, const int eventIndex1) {
+                return compareEvents(eventIndex0, eventIndex1) < 0;
+            });
+    for (const int eventIndex : sortedEventIndices) {
+        if (!mEntries.empty() && compareEvents(mEntries.back().mLastEventIndex, eventIndex) == 0) {
+            mEntries.back().mLastEventIndex = eventIndex;
+            mEntries.back().mEventCount += 1;
+        } else {
+            mEntries.push_back({eventIndex, eventIndex, 1 /* eventCount */,
+                    false /* hasFirstEventOfWord */});
+        }
+    }
+    int firstEntryIndexOfWord = 0;
+    for (int i = 0; i <= getEntryCount(); ++i) {
+        if (i < getEntryCount() && hasSameWordAsPreviousEntry(i)) {
+            continue;
+        }
+        if (i > 0) {
+            const auto first = std::min_element(mEntries.begin() + firstEntryIndexOfWord,
+                    mEntries.begin() + i, [](const Entry &entry0, const Entry &entry1) {
+                        return entry0.mFirstEventIndex < entry1.mFirstEventIndex;
+                    });
+            first->mHasFirstEventOfWord = true;
+        }
+        firstEntryIndexOfWord = i;
+    }
+}
+
+} // namespace latinime
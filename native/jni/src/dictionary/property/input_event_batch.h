@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_INPUT_EVENT_BATCH_H
+#define LATINIME_INPUT_EVENT_BATCH_H
+
+#include <vector>
+
+#include "defines.h"
+#include "dictionary/property/historical_info.h"
+#include "dictionary/property/ngram_context.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+
+/**
+ * Input events read from a packed buffer, with the events of the same word in the same context
+ * merged into one entry. Entries are sorted by word so that the entries of a word are adjacent.
+ *
+ * Each event is packed as ints in the following order:
+ *   timestamp, isValidWord (0 or 1), prevWordCount,
+ *   for each previous word: isBeginningOfSentence (0 or 1), codePointCount, codePoints...,
+ *   codePointCount, codePoints... of the word.
+ */
+class InputEventBatch {
+ public:
+    InputEventBatch() : mCodePoints(), mEvents(), mEntries() {}
+
+    // Returns false if the buffer doesn't contain eventCount well-formed events.
+    bool readFrom(const IntArrayView packedEvents, const int eventCount);
+
+    int getEntryCount() const {
+        return static_cast<int>(mEntries.size());
+    }
+
+    const CodePointArrayView getWordCodePoints(const int entryIndex) const {
+        return getWordCodePointsOfEvent(mEntries[entryIndex].mLastEventIndex);
+    }
+
+    const NgramContext getNgramContext(const int entryIndex) const;
+
+    bool isValidWord(const int entryIndex) const {
+        return mEvents[mEntries[entryIndex].mLastEventIndex].mIsValidWord;
+    }
+
+    // The timestamp of the latest event and the number of merged events.
+    const HistoricalInfo getHistoricalInfo(const int entryIndex) const {
+        const Entry &entry = mEntries[entryIndex];
+        return HistoricalInfo(mEvents[entry.mLastEventIndex].mTimestamp, 0 /* level */,
+                entry.mEventCount);
+    }
+
+    bool hasSameWordAsPreviousEntry(const int entryIndex) const;
+
+    // Whether the entry has the earliest event of its word, which is the one that adds the word
+    // when the word is not in the dictionary.
+    bool hasFirstEventOfWord(const int entryIndex) const {
+        return mEntries[entryIndex].mHasFirstEventOfWord;
+    }
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(InputEventBatch);
+
+    struct Event {
+        int mTimestamp;
+        bool mIsValidWord;
+        int mPrevWordCount;
+        bool mIsBeginningOfSentence[MAX_PREV_WORD_COUNT_FOR_N_GRAM];
+        // Positions in mCodePoints.
+        int mPrevWordStart[MAX_PREV_WORD_COUNT_FOR_N_GRAM];
+        int mPrevWordLength[MAX_PREV_WORD_COUNT_FOR_N_GRAM];
+        int mWordStart;
+        int mWordLength;
+    };
+
+    struct Entry {
+        int mFirstEventIndex;
+        int mLastEventIndex;
+        int mEventCount;
+        bool mHasFirstEventOfWord;
+    };
+
+    const CodePointArrayView getWordCodePointsOfEvent(const int eventIndex) const {
+        return CodePointArrayView(mCodePoints.data() + mEvents[eventIndex].mWordStart,
+                mEvents[eventIndex].mWordLength);
+    }
+
+    const CodePointArrayView getPrevWordCodePointsOfEvent(const int eventIndex,
+            const int n) const {
+        return CodePointArrayView(mCodePoints.data() + mEvents[eventIndex].mPrevWordStart[n],
+                mEvents[eventIndex].mPrevWordLength[n]);
+    }
+
+    bool readCodePoints(const IntArrayView packedEvents, int *const pos, int *const outStart,
+            int *const outLength);
+    static int compareCodePoints(const CodePointArrayView codePoints0,
+            const CodePointArrayView codePoints1);
+    int compareEvents(const int eventIndex0, const int eventIndex1) const;
+    void mergeEvents();
+
+    std::vector<int> mCodePoints;
+    std::vector<Event> mEvents;
+    std::vector<Entry> mEntries;
+};
+} // namespace latinime
+#endif // LATINIME_INPUT_EVENT_BATCH_H
@@ -29,6 +29,7 @@
 #include "suggest/core/dicnode/dic_node.h"
 #include "suggest/core/dicnode/dic_node_vector.h"
 #include "dictionary/interface/ngram_listener.h"
+#include "dictionary/property/input_event_batch.h"
 #include "dictionary/property/ngram_context.h"
 #include "dictionary/property/ngram_property.h"
 #include "dictionary/property/unigram_property.h"
@@ -472,6 +473,28 @@ bool Ver4PatriciaTriePolicy::updateEntriesForWordWithNgramContext(
     return true;
 }
 
+int Ver4PatriciaTriePolicy::updateEntriesForInputEvents(
+        const InputEventBatch *const inputEventBatch, const int startIndex, const int endIndex) {
+    if (!mBuffers->isUpdatable()) {
+        AKLOGI("Warning: updateEntriesForInputEvents() is called for non-updatable dictionary.");
+        return startIndex;
+    }
+    for (int i = startIndex; i < endIndex; ++i) {
+        const NgramContext ngramContext = inputEventBatch->getNgramContext(i);
+        const HistoricalInfo historicalInfo = inputEventBatch->getHistoricalInfo(i);
+        // Each update of this format is for a single input of the word.
+        for (int j = 0; j < historicalInfo.getCount(); ++j) {
+            updateEntriesForWordWithNgramContext(&ngramContext,
+                    inputEventBatch->getWordCodePoints(i), inputEventBatch->isValidWord(i),
+                    HistoricalInfo(historicalInfo.getTimestamp(), 0 /* level */, 1 /* count */));
+        }
+        if (needsToRunGC(true /* mindsBlockByGC */)) {
+            return i + 1;
+        }
+    }
+    return endIndex;
+}
+
 bool Ver4PatriciaTriePolicy::flush(const char *const filePath) {
     if (!mBuffers->isUpdatable()) {
         AKLOGI("Warning: flush() is called for non-updatable dictionary. filePath: %s", filePath);
@@ -121,6 +121,9 @@ class Ver4PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
             const CodePointArrayView wordCodePoints, const bool isValidWord,
             const HistoricalInfo historicalInfo);
 
+    int updateEntriesForInputEvents(const InputEventBatch *const inputEventBatch,
+            const int startIndex, const int endIndex);
+
     bool flush(const char *const filePath);
 
     bool flushWithGC(const char *const filePath);
@@ -22,6 +22,7 @@
 #include "dictionary/structure/backward/v402/ver4_dict_buffers.h"
 #include "dictionary/structure/backward/v402/ver4_dict_constants.h"
 #include "dictionary/structure/backward/v402/ver4_patricia_trie_policy.h"
+#include "dictionary/structure/flat/flat_patricia_trie_policy.h"
 #include "dictionary/structure/pt_common/dynamic_pt_writing_utils.h"
 #include "dictionary/structure/v2/patricia_trie_policy.h"
 #include "dictionary/structure/v4/ver4_dict_buffers.h"
@@ -118,6 +119,9 @@ template<class DictConstants, class DictBuffers, class DictBuffersPtr, class Str
         case FormatUtils::VERSION_202:
             AKLOGE("Given path is a directory but the format is version 2xx. path: %s", path);
             break;
+        case FormatUtils::VERSION_FLAT:
+            AKLOGE("Given path is a directory but the format is the flat format. path: %s", path);
+            break;
         case FormatUtils::VERSION_402: {
             return newPolicyForV4Dict<backward::v402::Ver4DictConstants,
                     backward::v402::Ver4DictBuffers,
@@ -183,6 +187,9 @@ template<class DictConstants, class DictBuffers, class DictBuffersPtr, class Str
         case FormatUtils::VERSION_202:
             return DictionaryStructureWithBufferPolicy::StructurePolicyPtr(
                     new PatriciaTriePolicy(std::move(mmappedBuffer)));
+        case FormatUtils::VERSION_FLAT:
+            return DictionaryStructureWithBufferPolicy::StructurePolicyPtr(
+                    new FlatPatriciaTriePolicy(std::move(mmappedBuffer)));
         case FormatUtils::VERSION_4_ONLY_FOR_TESTING:
         case FormatUtils::VERSION_402:
         case FormatUtils::VERSION_403:
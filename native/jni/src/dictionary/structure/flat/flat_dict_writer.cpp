@@ -0,0 +1,326 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/structure/flat/flat_dict_writer.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "dictionary/header/header_policy.h"
+#include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
+#include "dictionary/property/word_property.h"
+#include "dictionary/structure/flat/flat_pt_node_reading_utils.h"
+#include "dictionary/utils/buffer_with_extendable_buffer.h"
+#include "dictionary/utils/dict_file_writing_utils.h"
+#include "dictionary/utils/entry_counters.h"
+#include "dictionary/utils/format_utils.h"
+#include "utils/int_array_view.h"
+#include "utils/ngram_utils.h"
+
+namespace latinime {
+
+namespace {
+
+struct WritingPtNode {
+    WritingPtNode()
+            : mCodePoints(), mChildren(), mWordIndex(NOT_AN_INDEX), mPtNodePos(NOT_A_DICT_POS),
+              mChildrenPos(NOT_A_DICT_POS), mAttributePos(NOT_A_DICT_POS), mBigrams() {}
+
+    std::vector<int> mCodePoints;
+    // Keyed by the first code point, so children are written in the order the reader expects.
+    std::map<int, std::unique_ptr<WritingPtNode>> mChildren;
+    int mWordIndex;
+    int mPtNodePos;
+    int mChildrenPos;
+    int mAttributePos;
+    // Pairs of (target PtNode position, probability) sorted by position.
+    std::vector<std::pair<int, int>> mBigrams;
+};
+
+int clampProbability(const int probability) {
+    return std::min(std::max(probability, 0), MAX_PROBABILITY);
+}
+
+// Merges chains of non-terminal PtNodes that have a single child.
+void mergeSingleChildPtNodes(WritingPtNode *const ptNode) {
+    for (auto &entry : ptNode->mChildren) {
+        WritingPtNode *const child = entry.second.get();
+        while (child->mWordIndex == NOT_AN_INDEX && child->mChildren.size() == 1
+                && child->mCodePoints.size() < MAX_WORD_LENGTH) {
+            std::unique_ptr<WritingPtNode> grandChild = std::move(child->mChildren.begin()->second);
+            child->mChildren.clear();
+            child->mCodePoints.insert(child->mCodePoints.end(), grandChild->mCodePoints.begin(),
+                    grandChild->mCodePoints.end());
+            child->mWordIndex = grandChild->mWordIndex;
+            child->mChildren.swap(grandChild->mChildren);
+        }
+        mergeSingleChildPtNodes(child);
+    }
+}
+
+// Assigns positions to PtNode arrays in depth-first pre-order.
+void layoutPtNodeArrays(WritingPtNode *const ptNode, int *const pos,
+        std::vector<WritingPtNode *> *const outPtNodesOfWords) {
+    ptNode->mChildrenPos = *pos;
+    *pos += FlatPtNodeReadingUtils::PT_NODE_ARRAY_SIZE_FIELD_SIZE
+            + static_cast<int>(ptNode->mChildren.size()) * FlatPtNodeReadingUtils::PT_NODE_SIZE;
+    int index = 0;
+    for (auto &entry : ptNode->mChildren) {
+        WritingPtNode *const child = entry.second.get();
+        child->mPtNodePos = FlatPtNodeReadingUtils::getPtNodePos(ptNode->mChildrenPos, index++);
+        if (child->mWordIndex != NOT_AN_INDEX) {
+            outPtNodesOfWords->at(child->mWordIndex) = child;
+        }
+    }
+    for (auto &entry : ptNode->mChildren) {
+        if (!entry.second->mChildren.empty()) {
+            layoutPtNodeArrays(entry.second.get(), pos, outPtNodesOfWords);
+        }
+    }
+}
+
+int getAttributeSize(const WritingPtNode *const ptNode,
+        const std::vector<WordProperty> &wordProperties) {
+    int size = static_cast<int>(ptNode->mCodePoints.size() - 1)
+            * FlatPtNodeReadingUtils::CODE_POINT_FIELD_SIZE;
+    if (!ptNode->mBigrams.empty()) {
+        size += 4 /* bigram count */ + static_cast<int>(ptNode->mBigrams.size())
+                * FlatPtNodeReadingUtils::BIGRAM_ENTRY_SIZE;
+    }
+    if (ptNode->mWordIndex != NOT_AN_INDEX) {
+        for (const auto &shortcut
+                : wordProperties[ptNode->mWordIndex].getUnigramProperty().getShortcuts()) {
+            size += 4 /* shortcut header */ + std::min(
+                    static_cast<int>(shortcut.getTargetCodePoints()->size()), MAX_WORD_LENGTH)
+                            * FlatPtNodeReadingUtils::CODE_POINT_FIELD_SIZE;
+        }
+    }
+    return size;
+}
+
+void layoutAttributes(WritingPtNode *const ptNode,
+        const std::vector<WordProperty> &wordProperties, int *const pos) {
+    for (auto &entry : ptNode->mChildren) {
+        WritingPtNode *const child = entry.second.get();
+        const int attributeSize = getAttributeSize(child, wordProperties);
+        if (attributeSize > 0) {
+            child->mAttributePos = *pos;
+            *pos += attributeSize;
+        }
+        layoutAttributes(child, wordProperties, pos);
+    }
+}
+
+bool writePtNodeArrays(const WritingPtNode *const ptNode,
+        const std::vector<WordProperty> &wordProperties, const int bodyPos,
+        BufferWithExtendableBuffer *const buffer, int *const writingPos) {
+    if (*writingPos != bodyPos + ptNode->mChildrenPos) {
+        AKLOGE("PtNode array is written at an unexpected position. %d, expected: %d",
+                *writingPos - bodyPos, ptNode->mChildrenPos);
+        return false;
+    }
+    if (!buffer->writeUintAndAdvancePosition(ptNode->mChildren.size(),
+            FlatPtNodeReadingUtils::PT_NODE_ARRAY_SIZE_FIELD_SIZE, writingPos)) {
+        return false;
+    }
+    for (const auto &entry : ptNode->mChildren) {
+        const WritingPtNode *const child = entry.second.get();
+        const bool isTerminal = child->mWordIndex != NOT_AN_INDEX;
+        int probability = 0;
+        FlatPtNodeReadingUtils::NodeFlags flags = 0;
+        if (isTerminal) {
+            const UnigramProperty &unigramProperty =
+                    wordProperties[child->mWordIndex].getUnigramProperty();
+            probability = clampProbability(unigramProperty.getProbability());
+            flags = FlatPtNodeReadingUtils::createAndGetFlags(true /* isTerminal */,
+                    !child->mBigrams.empty(), !unigramProperty.getShortcuts().empty(),
+                    unigramProperty.isNotAWord(), unigramProperty.isPossiblyOffensive(),
+                    unigramProperty.representsBeginningOfSentence());
+        }
+        if (!buffer->writeUintAndAdvancePosition(child->mCodePoints[0], 4, writingPos)
+                || !buffer->writeUintAndAdvancePosition(child->mChildrenPos, 4, writingPos)
+                || !buffer->writeUintAndAdvancePosition(child->mAttributePos, 4, writingPos)
+                || !buffer->writeUintAndAdvancePosition(flags, 1, writingPos)
+                || !buffer->writeUintAndAdvancePosition(probability, 1, writingPos)
+                || !buffer->writeUintAndAdvancePosition(child->mCodePoints.size(), 1, writingPos)
+                || !buffer->writeUintAndAdvancePosition(0 /* reserved */, 1, writingPos)) {
+            return false;
+        }
+    }
+    for (const auto &entry : ptNode->mChildren) {
+        if (!entry.second->mChildren.empty() && !writePtNodeArrays(entry.second.get(),
+                wordProperties, bodyPos, buffer, writingPos)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool writeAttributes(const WritingPtNode *const ptNode,
+        const std::vector<WordProperty> &wordProperties, const int bodyPos,
+        BufferWithExtendableBuffer *const buffer, int *const writingPos) {
+    for (const auto &entry : ptNode->mChildren) {
+        const WritingPtNode *const child = entry.second.get();
+        if (child->mAttributePos != NOT_A_DICT_POS) {
+            if (*writingPos != bodyPos + child->mAttributePos) {
+                AKLOGE("Attributes are written at an unexpected position. %d, expected: %d",
+                        *writingPos - bodyPos, child->mAttributePos);
+                return false;
+            }
+            for (size_t i = 1; i < child->mCodePoints.size(); ++i) {
+                if (!buffer->writeUintAndAdvancePosition(child->mCodePoints[i],
+                        FlatPtNodeReadingUtils::CODE_POINT_FIELD_SIZE, writingPos)) {
+                    return false;
+                }
+            }
+            if (!child->mBigrams.empty()) {
+                if (!buffer->writeUintAndAdvancePosition(child->mBigrams.size(), 4, writingPos)) {
+                    return false;
+                }
+                for (const auto &bigram : child->mBigrams) {
+                    if (!buffer->writeUintAndAdvancePosition(bigram.first, 4, writingPos)
+                            || !buffer->writeUintAndAdvancePosition(bigram.second, 4,
+                                    writingPos)) {
+                        return false;
+                    }
+                }
+            }
+            if (child->mWordIndex != NOT_AN_INDEX) {
+                const std::vector<UnigramProperty::ShortcutProperty> &shortcuts =
+                        wordProperties[child->mWordIndex].getUnigramProperty().getShortcuts();
+                for (size_t i = 0; i < shortcuts.size(); ++i) {
+                    const std::vector<int> *const targetCodePoints =
+                            shortcuts[i].getTargetCodePoints();
+                    const int codePointCount = std::min(
+                            static_cast<int>(targetCodePoints->size()), MAX_WORD_LENGTH);
+                    const uint32_t header = FlatPtNodeReadingUtils::createAndGetShortcutHeader(
+                            i + 1 < shortcuts.size() /* hasNext */,
+                            clampProbability(shortcuts[i].getProbability()), codePointCount);
+                    if (!buffer->writeUintAndAdvancePosition(header, 4, writingPos)) {
+                        return false;
+                    }
+                    for (int j = 0; j < codePointCount; ++j) {
+                        if (!buffer->writeUintAndAdvancePosition((*targetCodePoints)[j],
+                                FlatPtNodeReadingUtils::CODE_POINT_FIELD_SIZE, writingPos)) {
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+        if (!writeAttributes(child, wordProperties, bodyPos, buffer, writingPos)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+/* static */ bool FlatDictWriter::writeFlatDictFile(
+        DictionaryStructureWithBufferPolicy *const sourcePolicy, const char *const filePath) {
+    // Read all the words of the source dictionary.
+    std::vector<WordProperty> wordProperties;
+    std::map<std::vector<int>, int> wordIndices;
+    WritingPtNode root;
+    int codePoints[MAX_WORD_LENGTH];
+    int codePointCount = 0;
+    int token = 0;
+    do {
+        token = sourcePolicy->getNextWordAndNextToken(token, codePoints, &codePointCount);
+        if (codePointCount <= 0) {
+            continue;
+        }
+        const CodePointArrayView wordCodePoints(codePoints, codePointCount);
+        WordProperty wordProperty = sourcePolicy->getWordProperty(wordCodePoints);
+        // The flat format has no blacklist, so blacklisted words are left out instead.
+        if (wordProperty.getUnigramProperty().isBlacklisted()) {
+            continue;
+        }
+        WritingPtNode *ptNode = &root;
+        for (const int codePoint : wordCodePoints) {
+            std::unique_ptr<WritingPtNode> &child = ptNode->mChildren[codePoint];
+            if (!child) {
+                child.reset(new WritingPtNode());
+                child->mCodePoints.push_back(codePoint);
+            }
+            ptNode = child.get();
+        }
+        ptNode->mWordIndex = static_cast<int>(wordProperties.size());
+        wordIndices[wordCodePoints.toVector()] = ptNode->mWordIndex;
+        wordProperties.push_back(std::move(wordProperty));
+    } while (token != 0);
+    if (sourcePolicy->isCorrupted()) {
+        AKLOGE("Source dictionary is corrupted.");
+        return false;
+    }
+    mergeSingleChildPtNodes(&root);
+
+    // Lay out the PtNode arrays followed by the attributes.
+    std::vector<WritingPtNode *> ptNodesOfWords(wordProperties.size(), nullptr);
+    int bodySize = 0;
+    layoutPtNodeArrays(&root, &bodySize, &ptNodesOfWords);
+    MutableEntryCounters entryCounters;
+    for (size_t i = 0; i < wordProperties.size(); ++i) {
+        WritingPtNode *const ptNode = ptNodesOfWords[i];
+        entryCounters.incrementNgramCount(NgramType::Unigram);
+        for (const NgramProperty &ngramProperty : wordProperties[i].getNgramProperties()) {
+            if (ngramProperty.getNgramContext()->getPrevWordCount() != 1) {
+                continue;
+            }
+            const auto it = wordIndices.find(*ngramProperty.getTargetCodePoints());
+            if (it == wordIndices.end()) {
+                continue;
+            }
+            ptNode->mBigrams.emplace_back(ptNodesOfWords[it->second]->mPtNodePos,
+                    clampProbability(ngramProperty.getProbability()));
+            entryCounters.incrementNgramCount(NgramType::Bigram);
+        }
+        std::sort(ptNode->mBigrams.begin(), ptNode->mBigrams.end());
+    }
+    layoutAttributes(&root, wordProperties, &bodySize);
+
+    // Write the header and the body into one buffer.
+    const DictionaryHeaderStructurePolicy *const sourceHeaderPolicy =
+            sourcePolicy->getHeaderStructurePolicy();
+    const HeaderPolicy headerPolicy(FormatUtils::VERSION_FLAT, *sourceHeaderPolicy->getLocale(),
+            sourceHeaderPolicy->getAttributeMap());
+    BufferWithExtendableBuffer buffer(
+            BufferWithExtendableBuffer::DEFAULT_MAX_ADDITIONAL_BUFFER_SIZE + bodySize);
+    if (!headerPolicy.fillInAndWriteHeaderToBuffer(false /* updatesLastDecayedTime */,
+            entryCounters.getEntryCounts(), 0 /* extendedRegionSize */, &buffer)) {
+        AKLOGE("Cannot write the header of the flat dictionary.");
+        return false;
+    }
+    const int bodyPos = buffer.getTailPosition();
+    int writingPos = bodyPos;
+    if (!writePtNodeArrays(&root, wordProperties, bodyPos, &buffer, &writingPos)
+            || !writeAttributes(&root, wordProperties, bodyPos, &buffer, &writingPos)) {
+        AKLOGE("Cannot write the body of the flat dictionary.");
+        return false;
+    }
+    if (writingPos != bodyPos + bodySize) {
+        AKLOGE("Unexpected flat dictionary size. %d, expected: %d", writingPos - bodyPos,
+                bodySize);
+        return false;
+    }
+    return DictFileWritingUtils::flushBufferToFile(filePath, &buffer);
+}
+
+} // namespace latinime
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_FLAT_DICT_WRITER_H
+#define LATINIME_FLAT_DICT_WRITER_H
+
+#include "defines.h"
+
+namespace latinime {
+
+class DictionaryStructureWithBufferPolicy;
+
+// Converts a readable dictionary into the flat format. Unigrams, bigrams and shortcuts are kept;
+// longer n-grams and historical information are dropped as the flat format is for static
+// dictionaries.
+class FlatDictWriter {
+ public:
+    static bool writeFlatDictFile(DictionaryStructureWithBufferPolicy *const sourcePolicy,
+            const char *const filePath);
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(FlatDictWriter);
+};
+} // namespace latinime
+#endif // LATINIME_FLAT_DICT_WRITER_H
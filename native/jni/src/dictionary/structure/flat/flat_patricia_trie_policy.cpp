@@ -0,0 +1,478 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/structure/flat/flat_patricia_trie_policy.h"
+
+#include "defines.h"
+#include "suggest/core/dicnode/dic_node.h"
+#include "suggest/core/dicnode/dic_node_vector.h"
+#include "dictionary/interface/ngram_listener.h"
+#include "dictionary/property/ngram_context.h"
+#include "dictionary/structure/flat/flat_pt_node_reading_utils.h"
+#include "dictionary/utils/binary_dictionary_shortcut_iterator.h"
+#include "dictionary/utils/byte_array_utils.h"
+#include "dictionary/utils/multi_bigram_map.h"
+#include "dictionary/utils/probability_utils.h"
+#include "utils/char_utils.h"
+
+namespace latinime {
+
+void FlatPatriciaTriePolicy::createAndGetAllChildDicNodes(const DicNode *const dicNode,
+        DicNodeVector *const childDicNodes) const {
+    if (!dicNode->hasChildren()) {
+        return;
+    }
+    const int ptNodeArrayPos = dicNode->getChildrenPtNodeArrayPos();
+    if (!isValidPtNodeArrayPos(ptNodeArrayPos)) {
+        AKLOGE("Children PtNode array position is invalid. pos: %d, dict size: %zd",
+                ptNodeArrayPos, mBuffer.size());
+        mIsCorrupted = true;
+        ASSERT(false);
+        return;
+    }
+    const uint8_t *const buffer = mBuffer.data();
+    const int endPos = FlatPtNodeReadingUtils::getPtNodeArrayEndPos(buffer, ptNodeArrayPos);
+    int mergedNodeCodePoints[MAX_WORD_LENGTH];
+    for (int ptNodePos = FlatPtNodeReadingUtils::getPtNodePos(ptNodeArrayPos, 0);
+            ptNodePos < endPos; ptNodePos += FlatPtNodeReadingUtils::PT_NODE_SIZE) {
+        const int childrenPos = FlatPtNodeReadingUtils::getChildrenPos(buffer, ptNodePos);
+        if (childrenPos != NOT_A_DICT_POS) {
+            // The children of the surviving nodes are expanded next, so start loading them now.
+            __builtin_prefetch(buffer + childrenPos);
+        }
+        // Skip PtNodes don't start with Unicode code point because they represent non-word
+        // information.
+        if (!CharUtils::isInUnicodeSpace(
+                FlatPtNodeReadingUtils::getFirstCodePoint(buffer, ptNodePos))) {
+            continue;
+        }
+        const int mergedNodeCodePointCount = FlatPtNodeReadingUtils::getCodePoints(buffer,
+                ptNodePos, MAX_WORD_LENGTH, mergedNodeCodePoints);
+        const int wordId = FlatPtNodeReadingUtils::isTerminal(
+                FlatPtNodeReadingUtils::getFlags(buffer, ptNodePos)) ? ptNodePos : NOT_A_WORD_ID;
+        childDicNodes->pushLeavingChild(dicNode, childrenPos, wordId,
+                CodePointArrayView(mergedNodeCodePoints, mergedNodeCodePointCount));
+    }
+}
+
+int FlatPatriciaTriePolicy::getCodePointsAndReturnCodePointCount(const int wordId,
+        const int maxCodePointCount, int *const outCodePoints) const {
+    return getCodePointsAndProbabilityAndReturnCodePointCount(wordId, maxCodePointCount,
+            outCodePoints, nullptr /* outUnigramProbability */);
+}
+
+// PtNode arrays are written in depth-first pre-order, so the PtNode we are looking for is either in
+// the current array or in the subtree of the last PtNode whose children position is not after it.
+int FlatPatriciaTriePolicy::getCodePointsAndProbabilityAndReturnCodePointCount(
+        const int wordId, const int maxCodePointCount, int *const outCodePoints,
+        int *const outUnigramProbability) const {
+    if (outUnigramProbability) {
+        *outUnigramProbability = NOT_A_PROBABILITY;
+    }
+    const int ptNodePos = getTerminalPtNodePosFromWordId(wordId);
+    if (!isValidTerminalPtNodePos(ptNodePos)) {
+        return 0;
+    }
+    const uint8_t *const buffer = mBuffer.data();
+    int ptNodeArrayPos = getRootPosition();
+    int wordPos = 0;
+    while (wordPos < maxCodePointCount) {
+        if (!isValidPtNodeArrayPos(ptNodeArrayPos)) {
+            AKLOGE("PtNode array position is invalid. pos: %d, dict size: %zd",
+                    ptNodeArrayPos, mBuffer.size());
+            mIsCorrupted = true;
+            ASSERT(false);
+            return 0;
+        }
+        const int firstPtNodePos = FlatPtNodeReadingUtils::getPtNodePos(ptNodeArrayPos, 0);
+        const int endPos = FlatPtNodeReadingUtils::getPtNodeArrayEndPos(buffer, ptNodeArrayPos);
+        int nextPtNodePos = NOT_A_DICT_POS;
+        if (ptNodePos < endPos) {
+            if (ptNodePos < firstPtNodePos
+                    || (ptNodePos - firstPtNodePos) % FlatPtNodeReadingUtils::PT_NODE_SIZE != 0) {
+                return 0;
+            }
+            nextPtNodePos = ptNodePos;
+        } else {
+            for (int pos = firstPtNodePos; pos < endPos;
+                    pos += FlatPtNodeReadingUtils::PT_NODE_SIZE) {
+                const int childrenPos = FlatPtNodeReadingUtils::getChildrenPos(buffer, pos);
+                if (childrenPos == NOT_A_DICT_POS) {
+                    continue;
+                }
+                if (childrenPos > ptNodePos) {
+                    break;
+                }
+                nextPtNodePos = pos;
+            }
+            if (nextPtNodePos == NOT_A_DICT_POS) {
+                return 0;
+            }
+        }
+        const int codePointCount = FlatPtNodeReadingUtils::getCodePoints(buffer, nextPtNodePos,
+                maxCodePointCount - wordPos, outCodePoints + wordPos);
+        if (codePointCount <= 0) {
+            AKLOGE("PtNode without code points. pos: %d", nextPtNodePos);
+            mIsCorrupted = true;
+            return 0;
+        }
+        wordPos += codePointCount;
+        if (nextPtNodePos == ptNodePos) {
+            if (!FlatPtNodeReadingUtils::isTerminal(
+                    FlatPtNodeReadingUtils::getFlags(buffer, ptNodePos))) {
+                return 0;
+            }
+            if (outUnigramProbability) {
+                *outUnigramProbability = FlatPtNodeReadingUtils::getProbability(buffer, ptNodePos);
+            }
+            return wordPos;
+        }
+        ptNodeArrayPos = FlatPtNodeReadingUtils::getChildrenPos(buffer, nextPtNodePos);
+    }
+    return 0;
+}
+
+int FlatPatriciaTriePolicy::getWordId(const CodePointArrayView wordCodePoints,
+        const bool forceLowerCaseSearch) const {
+    const int length = static_cast<int>(wordCodePoints.size());
+    if (length <= 0 || length > MAX_WORD_LENGTH) {
+        return NOT_A_WORD_ID;
+    }
+    int searchCodePoints[length];
+    for (int i = 0; i < length; ++i) {
+        searchCodePoints[i] = forceLowerCaseSearch
+                ? CharUtils::toLowerCase(wordCodePoints[i]) : wordCodePoints[i];
+    }
+    const uint8_t *const buffer = mBuffer.data();
+    int ptNodeArrayPos = getRootPosition();
+    int matchedCodePointCount = 0;
+    int mergedNodeCodePoints[MAX_WORD_LENGTH];
+    while (ptNodeArrayPos != NOT_A_DICT_POS) {
+        if (!isValidPtNodeArrayPos(ptNodeArrayPos)) {
+            AKLOGE("Dictionary reading error in getWordId(). pos: %d", ptNodeArrayPos);
+            mIsCorrupted = true;
+            return NOT_A_WORD_ID;
+        }
+        // Children are sorted by their first code point, and the records have a fixed size.
+        const int codePoint = searchCodePoints[matchedCodePointCount];
+        int low = 0;
+        int high = FlatPtNodeReadingUtils::getPtNodeArraySize(buffer, ptNodeArrayPos) - 1;
+        int ptNodePos = NOT_A_DICT_POS;
+        while (low <= high) {
+            const int middle = (low + high) / 2;
+            const int pos = FlatPtNodeReadingUtils::getPtNodePos(ptNodeArrayPos, middle);
+            const int firstCodePoint = FlatPtNodeReadingUtils::getFirstCodePoint(buffer, pos);
+            if (firstCodePoint < codePoint) {
+                low = middle + 1;
+            } else if (firstCodePoint > codePoint) {
+                high = middle - 1;
+            } else {
+                ptNodePos = pos;
+                break;
+            }
+        }
+        if (ptNodePos == NOT_A_DICT_POS) {
+            return NOT_A_WORD_ID;
+        }
+        const int codePointCount = FlatPtNodeReadingUtils::getCodePoints(buffer, ptNodePos,
+                MAX_WORD_LENGTH, mergedNodeCodePoints);
+        if (matchedCodePointCount + codePointCount > length) {
+            return NOT_A_WORD_ID;
+        }
+        for (int i = 1; i < codePointCount; ++i) {
+            if (mergedNodeCodePoints[i] != searchCodePoints[matchedCodePointCount + i]) {
+                return NOT_A_WORD_ID;
+            }
+        }
+        matchedCodePointCount += codePointCount;
+        if (matchedCodePointCount == length) {
+            return FlatPtNodeReadingUtils::isTerminal(
+                    FlatPtNodeReadingUtils::getFlags(buffer, ptNodePos))
+                            ? getWordIdFromTerminalPtNodePos(ptNodePos) : NOT_A_WORD_ID;
+        }
+        ptNodeArrayPos = FlatPtNodeReadingUtils::getChildrenPos(buffer, ptNodePos);
+    }
+    return NOT_A_WORD_ID;
+}
+
+const WordAttributes FlatPatriciaTriePolicy::getWordAttributesInContext(
+        const WordIdArrayView prevWordIds, const int wordId,
+        MultiBigramMap *const multiBigramMap) const {
+    if (wordId == NOT_A_WORD_ID) {
+        return WordAttributes();
+    }
+    const int ptNodePos = getTerminalPtNodePosFromWordId(wordId);
+    const int unigramProbability =
+            FlatPtNodeReadingUtils::getProbability(mBuffer.data(), ptNodePos);
+    if (multiBigramMap) {
+        const int probability =  multiBigramMap->getBigramProbability(this /* structurePolicy */,
+                prevWordIds, wordId, unigramProbability);
+        return getWordAttributes(probability, ptNodePos);
+    }
+    if (!prevWordIds.empty()) {
+        const int bigramProbability = getProbabilityOfWord(prevWordIds, wordId);
+        if (bigramProbability != NOT_A_PROBABILITY) {
+            return getWordAttributes(bigramProbability, ptNodePos);
+        }
+    }
+    return getWordAttributes(getProbability(unigramProbability, NOT_A_PROBABILITY), ptNodePos);
+}
+
+const WordAttributes FlatPatriciaTriePolicy::getWordAttributes(const int probability,
+        const int ptNodePos) const {
+    const FlatPtNodeReadingUtils::NodeFlags flags =
+            FlatPtNodeReadingUtils::getFlags(mBuffer.data(), ptNodePos);
+    return WordAttributes(probability, false /* isBlacklisted */,
+            FlatPtNodeReadingUtils::isNotAWord(flags),
+            FlatPtNodeReadingUtils::isPossiblyOffensive(flags));
+}
+
+// Bigram probabilities are stored as absolute probabilities, so they don't need to be combined
+// with the unigram probability.
+int FlatPatriciaTriePolicy::getProbability(const int unigramProbability,
+        const int bigramProbability) const {
+    if (unigramProbability == NOT_A_PROBABILITY) {
+        return NOT_A_PROBABILITY;
+    } else if (bigramProbability == NOT_A_PROBABILITY) {
+        return ProbabilityUtils::backoff(unigramProbability);
+    } else {
+        return bigramProbability;
+    }
+}
+
+int FlatPatriciaTriePolicy::getProbabilityOfWord(const WordIdArrayView prevWordIds,
+        const int wordId) const {
+    if (wordId == NOT_A_WORD_ID) {
+        return NOT_A_PROBABILITY;
+    }
+    const int ptNodePos = getTerminalPtNodePosFromWordId(wordId);
+    if (FlatPtNodeReadingUtils::isNotAWord(
+            FlatPtNodeReadingUtils::getFlags(mBuffer.data(), ptNodePos))) {
+        // If this is not a word, it should behave as having no probability outside of the
+        // suggestion process (where it should be used for shortcuts).
+        return NOT_A_PROBABILITY;
+    }
+    if (!prevWordIds.empty()) {
+        return getBigramProbability(getTerminalPtNodePosFromWordId(prevWordIds[0]), ptNodePos);
+    }
+    return getProbability(FlatPtNodeReadingUtils::getProbability(mBuffer.data(), ptNodePos),
+            NOT_A_PROBABILITY);
+}
+
+// Bigram entries are sorted by target word id.
+int FlatPatriciaTriePolicy::getBigramProbability(const int prevWordPtNodePos,
+        const int ptNodePos) const {
+    if (!isValidTerminalPtNodePos(prevWordPtNodePos)) {
+        return NOT_A_PROBABILITY;
+    }
+    const uint8_t *const buffer = mBuffer.data();
+    int bigramListPos = FlatPtNodeReadingUtils::getBigramListPos(buffer, prevWordPtNodePos);
+    if (bigramListPos == NOT_A_DICT_POS) {
+        return NOT_A_PROBABILITY;
+    }
+    int low = 0;
+    int high = static_cast<int>(
+            ByteArrayUtils::readUint32AndAdvancePosition(buffer, &bigramListPos)) - 1;
+    while (low <= high) {
+        const int middle = (low + high) / 2;
+        const int entryPos = bigramListPos + middle * FlatPtNodeReadingUtils::BIGRAM_ENTRY_SIZE;
+        const int targetPos = static_cast<int>(ByteArrayUtils::readUint32(buffer, entryPos));
+        if (targetPos < ptNodePos) {
+            low = middle + 1;
+        } else if (targetPos > ptNodePos) {
+            high = middle - 1;
+        } else {
+            return static_cast<int>(ByteArrayUtils::readUint32(buffer, entryPos + 4));
+        }
+    }
+    return NOT_A_PROBABILITY;
+}
+
+void FlatPatriciaTriePolicy::iterateNgramEntries(const WordIdArrayView prevWordIds,
+        NgramListener *const listener) const {
+    if (prevWordIds.empty()) {
+        return;
+    }
+    const int prevWordPtNodePos = getTerminalPtNodePosFromWordId(prevWordIds[0]);
+    if (!isValidTerminalPtNodePos(prevWordPtNodePos)) {
+        return;
+    }
+    const uint8_t *const buffer = mBuffer.data();
+    int pos = FlatPtNodeReadingUtils::getBigramListPos(buffer, prevWordPtNodePos);
+    if (pos == NOT_A_DICT_POS) {
+        return;
+    }
+    const int bigramCount = static_cast<int>(
+            ByteArrayUtils::readUint32AndAdvancePosition(buffer, &pos));
+    for (int i = 0; i < bigramCount; ++i) {
+        const int targetPos = static_cast<int>(
+                ByteArrayUtils::readUint32AndAdvancePosition(buffer, &pos));
+        const int probability = static_cast<int>(
+                ByteArrayUtils::readUint32AndAdvancePosition(buffer, &pos));
+        listener->onVisitEntry(probability, getWordIdFromTerminalPtNodePos(targetPos));
+    }
+}
+
+BinaryDictionaryShortcutIterator FlatPatriciaTriePolicy::getShortcutIterator(
+        const int wordId) const {
+    const int ptNodePos = getTerminalPtNodePosFromWordId(wordId);
+    const int shortcutPos = isValidTerminalPtNodePos(ptNodePos)
+            ? FlatPtNodeReadingUtils::getShortcutListPos(mBuffer.data(), ptNodePos)
+            : NOT_A_DICT_POS;
+    return BinaryDictionaryShortcutIterator(&mShortcutListPolicy, shortcutPos);
+}
+
+const WordProperty FlatPatriciaTriePolicy::getWordProperty(
+        const CodePointArrayView wordCodePoints) const {
+    const int wordId = getWordId(wordCodePoints, false /* forceLowerCaseSearch */);
+    if (wordId == NOT_A_WORD_ID) {
+        AKLOGE("getWordProperty was called for invalid word.");
+        return WordProperty();
+    }
+    const uint8_t *const buffer = mBuffer.data();
+    const int ptNodePos = getTerminalPtNodePosFromWordId(wordId);
+    const FlatPtNodeReadingUtils::NodeFlags flags =
+            FlatPtNodeReadingUtils::getFlags(buffer, ptNodePos);
+    // Fetch bigram information.
+    std::vector<NgramProperty> ngrams;
+    int bigramListPos = FlatPtNodeReadingUtils::getBigramListPos(buffer, ptNodePos);
+    if (bigramListPos != NOT_A_DICT_POS) {
+        int bigramWord1CodePoints[MAX_WORD_LENGTH];
+        const int bigramCount = static_cast<int>(
+                ByteArrayUtils::readUint32AndAdvancePosition(buffer, &bigramListPos));
+        for (int i = 0; i < bigramCount; ++i) {
+            const int targetPos = static_cast<int>(
+                    ByteArrayUtils::readUint32AndAdvancePosition(buffer, &bigramListPos));
+            const int probability = static_cast<int>(
+                    ByteArrayUtils::readUint32AndAdvancePosition(buffer, &bigramListPos));
+            const int word1CodePointCount = getCodePointsAndReturnCodePointCount(
+                    getWordIdFromTerminalPtNodePos(targetPos), MAX_WORD_LENGTH,
+                    bigramWord1CodePoints);
+            ngrams.emplace_back(
+                    NgramContext(wordCodePoints.data(), wordCodePoints.size(),
+                            FlatPtNodeReadingUtils::representsBeginningOfSentence(flags)),
+                    CodePointArrayView(bigramWord1CodePoints, word1CodePointCount).toVector(),
+                    probability, HistoricalInfo());
+        }
+    }
+    // Fetch shortcut information.
+    std::vector<UnigramProperty::ShortcutProperty> shortcuts;
+    int shortcutPos = FlatPtNodeReadingUtils::getShortcutListPos(buffer, ptNodePos);
+    if (shortcutPos != NOT_A_DICT_POS) {
+        int shortcutTargetCodePoints[MAX_WORD_LENGTH];
+        bool hasNext = true;
+        while (hasNext) {
+            const int shortcutProbability = FlatPtNodeReadingUtils::getShortcutProbability(
+                    ByteArrayUtils::readUint32(buffer, shortcutPos));
+            int shortcutTargetLength = 0;
+            mShortcutListPolicy.getNextShortcut(MAX_WORD_LENGTH, shortcutTargetCodePoints,
+                    &shortcutTargetLength, nullptr /* outIsWhitelist */, &hasNext, &shortcutPos);
+            shortcuts.emplace_back(
+                    CodePointArrayView(shortcutTargetCodePoints, shortcutTargetLength).toVector(),
+                    shortcutProbability);
+        }
+    }
+    const UnigramProperty unigramProperty(
+            FlatPtNodeReadingUtils::representsBeginningOfSentence(flags),
+            FlatPtNodeReadingUtils::isNotAWord(flags),
+            FlatPtNodeReadingUtils::isPossiblyOffensive(flags),
+            FlatPtNodeReadingUtils::getProbability(buffer, ptNodePos), HistoricalInfo(),
+            std::move(shortcuts));
+    return WordProperty(wordCodePoints.toVector(), unigramProperty, ngrams);
+}
+
+int FlatPatriciaTriePolicy::getNextWordAndNextToken(const int token, int *const outCodePoints,
+        int *const outCodePointCount) {
+    *outCodePointCount = 0;
+    if (token == 0) {
+        // Start iterating the dictionary.
+        mTerminalPtNodePositionsForIteratingWords.clear();
+        const uint8_t *const buffer = mBuffer.data();
+        // A well-formed dictionary has at most one PtNode array per PtNode plus the root array.
+        const int maxPtNodeArrayCount =
+                static_cast<int>(mBuffer.size()) / FlatPtNodeReadingUtils::PT_NODE_SIZE + 1;
+        std::vector<int> ptNodeArrayPositions(1, getRootPosition());
+        int visitedPtNodeArrayCount = 0;
+        while (!ptNodeArrayPositions.empty()) {
+            const int ptNodeArrayPos = ptNodeArrayPositions.back();
+            ptNodeArrayPositions.pop_back();
+            if (!isValidPtNodeArrayPos(ptNodeArrayPos)
+                    || ++visitedPtNodeArrayCount > maxPtNodeArrayCount) {
+                AKLOGE("Dictionary reading error while iterating words. pos: %d", ptNodeArrayPos);
+                mIsCorrupted = true;
+                mTerminalPtNodePositionsForIteratingWords.clear();
+                return 0;
+            }
+            const int endPos = FlatPtNodeReadingUtils::getPtNodeArrayEndPos(buffer,
+                    ptNodeArrayPos);
+            for (int pos = FlatPtNodeReadingUtils::getPtNodePos(ptNodeArrayPos, 0); pos < endPos;
+                    pos += FlatPtNodeReadingUtils::PT_NODE_SIZE) {
+                if (FlatPtNodeReadingUtils::isTerminal(
+                        FlatPtNodeReadingUtils::getFlags(buffer, pos))) {
+                    mTerminalPtNodePositionsForIteratingWords.push_back(pos);
+                }
+                const int childrenPos = FlatPtNodeReadingUtils::getChildrenPos(buffer, pos);
+                if (childrenPos != NOT_A_DICT_POS) {
+                    ptNodeArrayPositions.push_back(childrenPos);
+                }
+            }
+        }
+    }
+    const int terminalPtNodePositionsVectorSize =
+            static_cast<int>(mTerminalPtNodePositionsForIteratingWords.size());
+    if (token < 0 || token >= terminalPtNodePositionsVectorSize) {
+        AKLOGE("Given token %d is invalid.", token);
+        return 0;
+    }
+    const int terminalPtNodePos = mTerminalPtNodePositionsForIteratingWords[token];
+    *outCodePointCount = getCodePointsAndReturnCodePointCount(
+            getWordIdFromTerminalPtNodePos(terminalPtNodePos), MAX_WORD_LENGTH, outCodePoints);
+    const int nextToken = token + 1;
+    if (nextToken >= terminalPtNodePositionsVectorSize) {
+        // All words have been iterated.
+        mTerminalPtNodePositionsForIteratingWords.clear();
+        return 0;
+    }
+    return nextToken;
+}
+
+int FlatPatriciaTriePolicy::getWordIdFromTerminalPtNodePos(const int ptNodePos) const {
+    return ptNodePos == NOT_A_DICT_POS ? NOT_A_WORD_ID : ptNodePos;
+}
+
+int FlatPatriciaTriePolicy::getTerminalPtNodePosFromWordId(const int wordId) const {
+    return wordId == NOT_A_WORD_ID ? NOT_A_DICT_POS : wordId;
+}
+
+bool FlatPatriciaTriePolicy::isValidPtNodeArrayPos(const int ptNodeArrayPos) const {
+    const int bufferSize = static_cast<int>(mBuffer.size());
+    if (ptNodeArrayPos < 0
+            || ptNodeArrayPos + FlatPtNodeReadingUtils::PT_NODE_ARRAY_SIZE_FIELD_SIZE > bufferSize) {
+        return false;
+    }
+    const int ptNodeCount =
+            FlatPtNodeReadingUtils::getPtNodeArraySize(mBuffer.data(), ptNodeArrayPos);
+    return ptNodeCount >= 0 && ptNodeCount <= (bufferSize - ptNodeArrayPos
+            - FlatPtNodeReadingUtils::PT_NODE_ARRAY_SIZE_FIELD_SIZE)
+                    / FlatPtNodeReadingUtils::PT_NODE_SIZE;
+}
+
+bool FlatPatriciaTriePolicy::isValidTerminalPtNodePos(const int ptNodePos) const {
+    return ptNodePos >= 0
+            && ptNodePos + FlatPtNodeReadingUtils::PT_NODE_SIZE <= static_cast<int>(mBuffer.size());
+}
+
+} // namespace latinime
@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_FLAT_PT_NODE_READING_UTILS_H
+#define LATINIME_FLAT_PT_NODE_READING_UTILS_H
+
+#include <algorithm>
+#include <cstdint>
+
+#include "defines.h"
+#include "dictionary/utils/byte_array_utils.h"
+
+namespace latinime {
+
+/*
+ * Layout of the flat dictionary body. All integers are big endian like the rest of the dictionary
+ * formats, and all positions are relative to the beginning of the body.
+ *
+ * PtNode array:
+ *   PtNode count (4 bytes)
+ *   PtNode count * fixed size PtNode record
+ *
+ * PtNode record (PT_NODE_SIZE bytes):
+ *   First code point (4 bytes)
+ *   Children PtNode array position (4 bytes), or NOT_A_DICT_POS
+ *   Attribute position (4 bytes), or NOT_A_DICT_POS
+ *   Flags (1 byte)
+ *   Probability (1 byte)
+ *   Code point count (1 byte)
+ *   Reserved (1 byte)
+ *
+ * Attributes of a PtNode, only present when the PtNode has any of them:
+ *   Code points following the first one, 4 bytes each
+ *   Bigram list when FLAG_HAS_BIGRAMS is set:
+ *     Bigram count (4 bytes)
+ *     Bigram count * (target word id (4 bytes), probability (4 bytes))
+ *   Shortcut list when FLAG_HAS_SHORTCUTS is set:
+ *     Shortcut count * (shortcut header (4 bytes), code points (4 bytes each))
+ *
+ * PtNode arrays are laid out in depth-first pre-order, so the whole subtree of a PtNode lies
+ * between its children position and the children position of the next sibling that has
+ * children. Children in an array are sorted by first code point.
+ */
+class FlatPtNodeReadingUtils {
+ public:
+    typedef uint8_t NodeFlags;
+
+    static const int PT_NODE_ARRAY_SIZE_FIELD_SIZE = 4;
+    static const int PT_NODE_SIZE = 16;
+    static const int CODE_POINT_FIELD_SIZE = 4;
+    static const int BIGRAM_ENTRY_SIZE = 8;
+
+    static const NodeFlags FLAG_IS_TERMINAL = 0x01;
+    static const NodeFlags FLAG_HAS_BIGRAMS = 0x02;
+    static const NodeFlags FLAG_HAS_SHORTCUTS = 0x04;
+    static const NodeFlags FLAG_IS_NOT_A_WORD = 0x08;
+    static const NodeFlags FLAG_IS_POSSIBLY_OFFENSIVE = 0x10;
+    static const NodeFlags FLAG_REPRESENTS_BEGINNING_OF_SENTENCE = 0x20;
+
+    static const uint32_t SHORTCUT_HAS_NEXT_MASK = 0x80000000;
+    static const int SHORTCUT_PROBABILITY_SHIFT = 8;
+    static const uint32_t SHORTCUT_PROBABILITY_MASK = 0xFF;
+    static const uint32_t SHORTCUT_CODE_POINT_COUNT_MASK = 0xFF;
+
+    static AK_FORCE_INLINE int getPtNodeArraySize(const uint8_t *const buffer,
+            const int ptNodeArrayPos) {
+        return static_cast<int>(ByteArrayUtils::readUint32(buffer, ptNodeArrayPos));
+    }
+
+    static AK_FORCE_INLINE int getPtNodePos(const int ptNodeArrayPos, const int index) {
+        return ptNodeArrayPos + PT_NODE_ARRAY_SIZE_FIELD_SIZE + index * PT_NODE_SIZE;
+    }
+
+    static AK_FORCE_INLINE int getPtNodeArrayEndPos(const uint8_t *const buffer,
+            const int ptNodeArrayPos) {
+        return getPtNodePos(ptNodeArrayPos, getPtNodeArraySize(buffer, ptNodeArrayPos));
+    }
+
+    static AK_FORCE_INLINE int getFirstCodePoint(const uint8_t *const buffer,
+            const int ptNodePos) {
+        return static_cast<int>(ByteArrayUtils::readUint32(buffer, ptNodePos));
+    }
+
+    static AK_FORCE_INLINE int getChildrenPos(const uint8_t *const buffer, const int ptNodePos) {
+        return static_cast<int>(ByteArrayUtils::readUint32(buffer, ptNodePos + 4));
+    }
+
+    static AK_FORCE_INLINE int getAttributePos(const uint8_t *const buffer, const int ptNodePos) {
+        return static_cast<int>(ByteArrayUtils::readUint32(buffer, ptNodePos + 8));
+    }
+
+    static AK_FORCE_INLINE NodeFlags getFlags(const uint8_t *const buffer, const int ptNodePos) {
+        return ByteArrayUtils::readUint8(buffer, ptNodePos + 12);
+    }
+
+    static AK_FORCE_INLINE int getProbability(const uint8_t *const buffer, const int ptNodePos) {
+        return isTerminal(getFlags(buffer, ptNodePos))
+                ? ByteArrayUtils::readUint8(buffer, ptNodePos + 13) : NOT_A_PROBABILITY;
+    }
+
+    static AK_FORCE_INLINE int getCodePointCount(const uint8_t *const buffer,
+            const int ptNodePos) {
+        return ByteArrayUtils::readUint8(buffer, ptNodePos + 14);
+    }
+
+    // Returns the number of read code points.
+    static AK_FORCE_INLINE int getCodePoints(const uint8_t *const buffer, const int ptNodePos,
+            const int maxCodePointCount, int *const outCodePoints) {
+        const int codePointCount = std::min(getCodePointCount(buffer, ptNodePos),
+                maxCodePointCount);
+        if (codePointCount <= 0) {
+            return 0;
+        }
+        outCodePoints[0] = getFirstCodePoint(buffer, ptNodePos);
+        int pos = getAttributePos(buffer, ptNodePos);
+        for (int i = 1; i < codePointCount; ++i) {
+            outCodePoints[i] = static_cast<int>(
+                    ByteArrayUtils::readUint32AndAdvancePosition(buffer, &pos));
+        }
+        return codePointCount;
+    }
+
+    static AK_FORCE_INLINE int getBigramListPos(const uint8_t *const buffer,
+            const int ptNodePos) {
+        if (!hasBigrams(getFlags(buffer, ptNodePos))) {
+            return NOT_A_DICT_POS;
+        }
+        return getAttributePos(buffer, ptNodePos)
+                + (getCodePointCount(buffer, ptNodePos) - 1) * CODE_POINT_FIELD_SIZE;
+    }
+
+    static AK_FORCE_INLINE int getShortcutListPos(const uint8_t *const buffer,
+            const int ptNodePos) {
+        const NodeFlags flags = getFlags(buffer, ptNodePos);
+        if (!hasShortcutTargets(flags)) {
+            return NOT_A_DICT_POS;
+        }
+        int pos = getAttributePos(buffer, ptNodePos)
+                + (getCodePointCount(buffer, ptNodePos) - 1) * CODE_POINT_FIELD_SIZE;
+        if (hasBigrams(flags)) {
+            const int bigramCount = static_cast<int>(
+                    ByteArrayUtils::readUint32AndAdvancePosition(buffer, &pos));
+            pos += bigramCount * BIGRAM_ENTRY_SIZE;
+        }
+        return pos;
+    }
+
+    /**
+     * Node Flags
+     */
+    static AK_FORCE_INLINE bool isTerminal(const NodeFlags flags) {
+        return (flags & FLAG_IS_TERMINAL) != 0;
+    }
+
+    static AK_FORCE_INLINE bool hasBigrams(const NodeFlags flags) {
+        return (flags & FLAG_HAS_BIGRAMS) != 0;
+    }
+
+    static AK_FORCE_INLINE bool hasShortcutTargets(const NodeFlags flags) {
+        return (flags & FLAG_HAS_SHORTCUTS) != 0;
+    }
+
+    static AK_FORCE_INLINE bool isNotAWord(const NodeFlags flags) {
+        return (flags & FLAG_IS_NOT_A_WORD) != 0;
+    }
+
+    static AK_FORCE_INLINE bool isPossiblyOffensive(const NodeFlags flags) {
+        return (flags & FLAG_IS_POSSIBLY_OFFENSIVE) != 0;
+    }
+
+    static AK_FORCE_INLINE bool representsBeginningOfSentence(const NodeFlags flags) {
+        return (flags & FLAG_REPRESENTS_BEGINNING_OF_SENTENCE) != 0;
+    }
+
+    static AK_FORCE_INLINE NodeFlags createAndGetFlags(const bool isTerminal,
+            const bool hasBigrams, const bool hasShortcuts, const bool isNotAWord,
+            const bool isPossiblyOffensive, const bool representsBeginningOfSentence) {
+        NodeFlags flags = 0;
+        flags |= isTerminal ? FLAG_IS_TERMINAL : 0;
+        flags |= hasBigrams ? FLAG_HAS_BIGRAMS : 0;
+        flags |= hasShortcuts ? FLAG_HAS_SHORTCUTS : 0;
+        flags |= isNotAWord ? FLAG_IS_NOT_A_WORD : 0;
+        flags |= isPossiblyOffensive ? FLAG_IS_POSSIBLY_OFFENSIVE : 0;
+        flags |= representsBeginningOfSentence ? FLAG_REPRESENTS_BEGINNING_OF_SENTENCE : 0;
+        return flags;
+    }
+
+    /**
+     * Shortcut header
+     */
+    static AK_FORCE_INLINE bool shortcutHasNext(const uint32_t shortcutHeader) {
+        return (shortcutHeader & SHORTCUT_HAS_NEXT_MASK) != 0;
+    }
+
+    static AK_FORCE_INLINE int getShortcutProbability(const uint32_t shortcutHeader) {
+        return (shortcutHeader >> SHORTCUT_PROBABILITY_SHIFT) & SHORTCUT_PROBABILITY_MASK;
+    }
+
+    static AK_FORCE_INLINE int getShortcutCodePointCount(const uint32_t shortcutHeader) {
+        return shortcutHeader & SHORTCUT_CODE_POINT_COUNT_MASK;
+    }
+
+    static AK_FORCE_INLINE uint32_t createAndGetShortcutHeader(const bool hasNext,
+            const int probability, const int codePointCount) {
+        return (hasNext ? SHORTCUT_HAS_NEXT_MASK : 0)
+                | ((probability & SHORTCUT_PROBABILITY_MASK) << SHORTCUT_PROBABILITY_SHIFT)
+                | (codePointCount & SHORTCUT_CODE_POINT_COUNT_MASK);
+    }
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(FlatPtNodeReadingUtils);
+};
+} // namespace latinime
+#endif /* LATINIME_FLAT_PT_NODE_READING_UTILS_H */
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_FLAT_SHORTCUT_LIST_POLICY_H
+#define LATINIME_FLAT_SHORTCUT_LIST_POLICY_H
+
+#include <algorithm>
+#include <cstdint>
+
+#include "defines.h"
+#include "dictionary/interface/dictionary_shortcuts_structure_policy.h"
+#include "dictionary/structure/flat/flat_pt_node_reading_utils.h"
+#include "dictionary/structure/pt_common/shortcut/shortcut_list_reading_utils.h"
+#include "dictionary/utils/byte_array_utils.h"
+#include "utils/byte_array_view.h"
+
+namespace latinime {
+
+class FlatShortcutListPolicy : public DictionaryShortcutsStructurePolicy {
+ public:
+    explicit FlatShortcutListPolicy(const ReadOnlyByteArrayView buffer) : mBuffer(buffer) {}
+
+    ~FlatShortcutListPolicy() {}
+
+    int getStartPos(const int pos) const {
+        return pos;
+    }
+
+    void getNextShortcut(const int maxCodePointCount, int *const outCodePoint,
+            int *const outCodePointCount, bool *const outIsWhitelist, bool *const outHasNext,
+            int *const pos) const {
+        const uint32_t header = ByteArrayUtils::readUint32AndAdvancePosition(mBuffer.data(), pos);
+        const int codePointCount = FlatPtNodeReadingUtils::getShortcutCodePointCount(header);
+        if (outHasNext) {
+            *outHasNext = FlatPtNodeReadingUtils::shortcutHasNext(header);
+        }
+        if (outIsWhitelist) {
+            *outIsWhitelist = ShortcutListReadingUtils::isWhitelist(
+                    FlatPtNodeReadingUtils::getShortcutProbability(header));
+        }
+        if (outCodePoint) {
+            const int readCount = std::min(codePointCount, maxCodePointCount);
+            int readingPos = *pos;
+            for (int i = 0; i < readCount; ++i) {
+                outCodePoint[i] = static_cast<int>(
+                        ByteArrayUtils::readUint32AndAdvancePosition(mBuffer.data(), &readingPos));
+            }
+            *outCodePointCount = readCount;
+        }
+        *pos += codePointCount * FlatPtNodeReadingUtils::CODE_POINT_FIELD_SIZE;
+    }
+
+    void skipAllShortcuts(int *const pos) const {
+        bool hasNext = true;
+        while (hasNext) {
+            getNextShortcut(0 /* maxCodePointCount */, nullptr /* outCodePoint */,
+                    nullptr /* outCodePointCount */, nullptr /* outIsWhitelist */, &hasNext, pos);
+        }
+    }
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(FlatShortcutListPolicy);
+
+    const ReadOnlyByteArrayView mBuffer;
+};
+} // namespace latinime
+#endif // LATINIME_FLAT_SHORTCUT_LIST_POLICY_H
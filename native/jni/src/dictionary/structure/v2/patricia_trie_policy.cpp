@@ -16,6 +16,8 @@
 
 #include "dictionary/structure/v2/patricia_trie_policy.h"
 
+#include <algorithm>
+
 #include "defines.h"
 #include "suggest/core/dicnode/dic_node.h"
 #include "suggest/core/dicnode/dic_node_vector.h"
@@ -83,6 +85,10 @@ int PatriciaTriePolicy::getCodePointsAndProbabilityAndReturnCodePointCount(
         const int wordId, const int maxCodePointCount, int *const outCodePoints,
         int *const outUnigramProbability) const {
     const int ptNodePos = getTerminalPtNodePosFromWordId(wordId);
+    if (mReverseIndex.isAvailable()) {
+        return getCodePointsAndProbabilityUsingReverseIndex(ptNodePos, maxCodePointCount,
+                outCodePoints, outUnigramProbability);
+    }
     int pos = getRootPosition();
     int wordPos = 0;
     const int *const codePointTable = mHeaderPolicy.getCodePointTable();
@@ -275,6 +281,58 @@ int PatriciaTriePolicy::getCodePointsAndProbabilityAndReturnCodePointCount(
     return 0;
 }
 
+// Same as above for dictionaries with a reverse index. The PtNodes from the terminal up to the root
+// PtNode array are found with one lookup each, and only those PtNodes are read.
+int PatriciaTriePolicy::getCodePointsAndProbabilityUsingReverseIndex(const int ptNodePos,
+        const int maxCodePointCount, int *const outCodePoints,
+        int *const outUnigramProbability) const {
+    if (outUnigramProbability) {
+        *outUnigramProbability = NOT_A_PROBABILITY;
+    }
+    int ptNodePositions[MAX_WORD_LENGTH];
+    int ptNodeCount = 0;
+    const int maxPtNodeCount = std::min(maxCodePointCount, MAX_WORD_LENGTH);
+    for (int pos = ptNodePos; pos != NOT_A_DICT_POS;
+            pos = mReverseIndex.getParentPtNodePos(pos)) {
+        if (!isValidPos(pos)) {
+            AKLOGE("PtNode position is invalid. pos: %d, dict size: %zd", pos, mBuffer.size());
+            mIsCorrupted = true;
+            ASSERT(false);
+            return 0;
+        }
+        if (ptNodeCount >= maxPtNodeCount) {
+            // Each PtNode has at least one code point, so the word is too long or the index is
+            // broken.
+            return 0;
+        }
+        ptNodePositions[ptNodeCount++] = pos;
+    }
+    const int *const codePointTable = mHeaderPolicy.getCodePointTable();
+    int wordPos = 0;
+    for (int i = ptNodeCount - 1; i >= 0; --i) {
+        int pos = ptNodePositions[i];
+        const PatriciaTrieReadingUtils::NodeFlags flags =
+                PatriciaTrieReadingUtils::getFlagsAndAdvancePosition(mBuffer.data(), &pos);
+        int codePoint = PatriciaTrieReadingUtils::getCodePointAndAdvancePosition(
+                mBuffer.data(), codePointTable, &pos);
+        do {
+            if (wordPos >= maxCodePointCount) {
+                return 0;
+            }
+            outCodePoints[wordPos++] = codePoint;
+            codePoint = PatriciaTrieReadingUtils::hasMultipleChars(flags)
+                    ? PatriciaTrieReadingUtils::getCodePointAndAdvancePosition(
+                            mBuffer.data(), codePointTable, &pos)
+                    : NOT_A_CODE_POINT;
+        } while (codePoint != NOT_A_CODE_POINT);
+        if (i == 0 && outUnigramProbability && PatriciaTrieReadingUtils::isTerminal(flags)) {
+            *outUnigramProbability = PatriciaTrieReadingUtils::readProbabilityAndAdvancePosition(
+                    mBuffer.data(), &pos);
+        }
+    }
+    return wordPos;
+}
+
 // This function gets the position of the terminal PtNode of the exact matching word in the
 // dictionary. If no match is found, it returns NOT_A_WORD_ID.
 int PatriciaTriePolicy::getWordId(const CodePointArrayView wordCodePoints,
@@ -22,11 +22,13 @@
 
 #include "defines.h"
 #include "dictionary/header/header_policy.h"
+#include "dictionary/header/header_read_write_utils.h"
 #include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
 #include "dictionary/structure/v2/bigram/bigram_list_policy.h"
 #include "dictionary/structure/v2/shortcut/shortcut_list_policy.h"
 #include "dictionary/structure/v2/ver2_patricia_trie_node_reader.h"
 #include "dictionary/structure/v2/ver2_pt_node_array_reader.h"
+#include "dictionary/structure/v2/ver2_reverse_index.h"
 #include "dictionary/utils/format_utils.h"
 #include "dictionary/utils/mmapped_buffer.h"
 #include "utils/byte_array_view.h"
@@ -49,8 +51,11 @@ class PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
               mBigramListPolicy(mBuffer), mShortcutListPolicy(mBuffer),
               mPtNodeReader(mBuffer, &mBigramListPolicy, &mShortcutListPolicy,
                       mHeaderPolicy.getCodePointTable()),
-              mPtNodeArrayReader(mBuffer), mTerminalPtNodePositionsForIteratingWords(),
-              mIsCorrupted(false) {}
+              mPtNodeArrayReader(mBuffer),
+              mReverseIndex(mBuffer, HeaderReadWriteUtils::readIntAttributeValue(
+                      mHeaderPolicy.getAttributeMap(), Ver2ReverseIndex::REVERSE_INDEX_POS_KEY,
+                      NOT_A_DICT_POS)),
+              mTerminalPtNodePositionsForIteratingWords(), mIsCorrupted(false) {}
 
     AK_FORCE_INLINE int getRootPosition() const {
         return 0;
@@ -115,6 +120,13 @@ class PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
         return false;
     }
 
+    int updateEntriesForInputEvents(const InputEventBatch *const inputEventBatch,
+            const int startIndex, const int endIndex) {
+        // This method should not be called for non-updatable dictionary.
+        AKLOGI("Warning: updateEntriesForInputEvents() is called for non-updatable dictionary.");
+        return startIndex;
+    }
+
     bool flush(const char *const filePath) {
         // This method should not be called for non-updatable dictionary.
         AKLOGI("Warning: flush() is called for non-updatable dictionary.");
@@ -160,12 +172,16 @@ class PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
     const ShortcutListPolicy mShortcutListPolicy;
     const Ver2ParticiaTrieNodeReader mPtNodeReader;
     const Ver2PtNodeArrayReader mPtNodeArrayReader;
+    const Ver2ReverseIndex mReverseIndex;
     std::vector<int> mTerminalPtNodePositionsForIteratingWords;
     mutable bool mIsCorrupted;
 
     int getCodePointsAndProbabilityAndReturnCodePointCount(const int wordId,
             const int maxCodePointCount, int *const outCodePoints,
             int *const outUnigramProbability) const;
+    int getCodePointsAndProbabilityUsingReverseIndex(const int ptNodePos,
+            const int maxCodePointCount, int *const outCodePoints,
+            int *const outUnigramProbability) const;
     int getShortcutPositionOfPtNode(const int ptNodePos) const;
     int getBigramsPositionOfPtNode(const int ptNodePos) const;
     int createAndGetLeavingChildNode(const DicNode *const dicNode, const int ptNodePos,
@@ -0,0 +1,27 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/structure/v2/ver2_reverse_index.h"
+
+namespace latinime {
+
+const char *const Ver2ReverseIndex::REVERSE_INDEX_POS_KEY = "REVERSE_INDEX_POS";
+const int Ver2ReverseIndex::ENTRY_COUNT_FIELD_SIZE = 4;
+const int Ver2ReverseIndex::POSITION_FIELD_SIZE = 3;
+const int Ver2ReverseIndex::ENTRY_SIZE = POSITION_FIELD_SIZE * 2;
+const int Ver2ReverseIndex::MAX_POSITION = (1 << (POSITION_FIELD_SIZE * 8)) - 1;
+
+} // namespace latinime
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_VER2_REVERSE_INDEX_H
+#define LATINIME_VER2_REVERSE_INDEX_H
+
+#include <cstdint>
+
+#include "defines.h"
+#include "dictionary/utils/byte_array_utils.h"
+#include "utils/byte_array_view.h"
+
+namespace latinime {
+
+// Optional section appended to the body of a v2 dictionary by Ver2ReverseIndexWriter. It maps
+// every PtNode array to the PtNode owning it, so a word can be rebuilt from its terminal PtNode by
+// walking up to the root instead of searching the whole trie from the root.
+//
+// The position of the section is stored in the header attribute REVERSE_INDEX_POS_KEY. Positions
+// are relative to the body start and values are big-endian.
+//   entry count (4 bytes)
+//   entries sorted by PtNode array position:
+//     PtNode array position (3 bytes) | parent PtNode position (3 bytes)
+class Ver2ReverseIndex {
+ public:
+    static const char *const REVERSE_INDEX_POS_KEY;
+    static const int ENTRY_COUNT_FIELD_SIZE;
+    static const int POSITION_FIELD_SIZE;
+    static const int ENTRY_SIZE;
+    static const int MAX_POSITION;
+
+    Ver2ReverseIndex(const ReadOnlyByteArrayView buffer, const int indexPos)
+            : mBuffer(buffer), mEntriesPos(NOT_A_DICT_POS), mEntryCount(0) {
+        if (indexPos == NOT_A_DICT_POS) {
+            return;
+        }
+        if (indexPos < 0 || indexPos + ENTRY_COUNT_FIELD_SIZE > static_cast<int>(buffer.size())) {
+            AKLOGE("Reverse index position is invalid. pos: %d, dict size: %zd", indexPos,
+                    buffer.size());
+            return;
+        }
+        const int entryCount = static_cast<int>(ByteArrayUtils::readUint32(buffer.data(),
+                indexPos));
+        const int entriesPos = indexPos + ENTRY_COUNT_FIELD_SIZE;
+        if (entryCount < 0 || entryCount > (static_cast<int>(buffer.size()) - entriesPos)
+                / ENTRY_SIZE) {
+            AKLOGE("Reverse index entry count is invalid. count: %d, pos: %d, dict size: %zd",
+                    entryCount, indexPos, buffer.size());
+            return;
+        }
+        mEntriesPos = entriesPos;
+        mEntryCount = entryCount;
+    }
+
+    bool isAvailable() const {
+        return mEntriesPos != NOT_A_DICT_POS;
+    }
+
+    // Returns the position of the PtNode whose children contain the given PtNode, or
+    // NOT_A_DICT_POS when the given PtNode is in the root PtNode array.
+    int getParentPtNodePos(const int ptNodePos) const {
+        // Find the last PtNode array starting at or before ptNodePos. PtNode arrays don't overlap,
+        // so that is the array containing the PtNode. The root array isn't in the index and is
+        // placed before every other array.
+        int low = 0;
+        int high = mEntryCount;
+        while (low < high) {
+            const int middle = low + (high - low) / 2;
+            if (getPtNodeArrayPos(middle) <= ptNodePos) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        if (low == 0) {
+            return NOT_A_DICT_POS;
+        }
+        return static_cast<int>(ByteArrayUtils::readUint24(mBuffer.data(),
+                getEntryPos(low - 1) + POSITION_FIELD_SIZE));
+    }
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(Ver2ReverseIndex);
+
+    const ReadOnlyByteArrayView mBuffer;
+    int mEntriesPos;
+    int mEntryCount;
+
+    AK_FORCE_INLINE int getEntryPos(const int index) const {
+        return mEntriesPos + index * ENTRY_SIZE;
+    }
+
+    AK_FORCE_INLINE int getPtNodeArrayPos(const int index) const {
+        return static_cast<int>(ByteArrayUtils::readUint24(mBuffer.data(), getEntryPos(index)));
+    }
+};
+} // namespace latinime
+#endif // LATINIME_VER2_REVERSE_INDEX_H
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/structure/v2/ver2_reverse_index_writer.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "dictionary/header/header_policy.h"
+#include "dictionary/header/header_read_write_utils.h"
+#include "dictionary/structure/pt_common/dynamic_pt_reading_helper.h"
+#include "dictionary/structure/pt_common/pt_node_params.h"
+#include "dictionary/structure/v2/bigram/bigram_list_policy.h"
+#include "dictionary/structure/v2/shortcut/shortcut_list_policy.h"
+#include "dictionary/structure/v2/ver2_patricia_trie_node_reader.h"
+#include "dictionary/structure/v2/ver2_pt_node_array_reader.h"
+#include "dictionary/structure/v2/ver2_reverse_index.h"
+#include "dictionary/utils/buffer_with_extendable_buffer.h"
+#include "dictionary/utils/dict_file_writing_utils.h"
+#include "dictionary/utils/format_utils.h"
+#include "dictionary/utils/mmapped_buffer.h"
+
+namespace latinime {
+
+namespace {
+
+// Collects (children PtNode array position, parent PtNode position) for every PtNode that has
+// children.
+class TraversePolicyToGetAllChildrenPositions
+        : public DynamicPtReadingHelper::TraversingEventListener {
+ public:
+    TraversePolicyToGetAllChildrenPositions(std::vector<std::pair<int, int>> *const entries)
+            : mEntries(entries) {}
+    bool onAscend() { return true; }
+    bool onDescend(const int ptNodeArrayPos) { return true; }
+    bool onReadingPtNodeArrayTail() { return true; }
+    bool onVisitingPtNode(const PtNodeParams *const ptNodeParams) {
+        if (ptNodeParams->hasChildren()) {
+            mEntries->emplace_back(ptNodeParams->getChildrenPos(), ptNodeParams->getHeadPos());
+        }
+        return true;
+    }
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(TraversePolicyToGetAllChildrenPositions);
+
+    std::vector<std::pair<int, int>> *const mEntries;
+};
+
+} // namespace
+
+/* static */ bool Ver2ReverseIndexWriter::writeDictFileWithReverseIndex(
+        const char *const sourceFilePath, const char *const filePath) {
+    const MmappedBuffer::MmappedBufferPtr mmappedBuffer =
+            MmappedBuffer::openBuffer(sourceFilePath, false /* isUpdatable */);
+    if (!mmappedBuffer) {
+        AKLOGE("Cannot open the source dictionary: %s", sourceFilePath);
+        return false;
+    }
+    const ReadOnlyByteArrayView dictBuffer = mmappedBuffer->getReadOnlyByteArrayView();
+    const FormatUtils::FORMAT_VERSION formatVersion = FormatUtils::detectFormatVersion(dictBuffer);
+    if (formatVersion != FormatUtils::VERSION_202) {
+        AKLOGE("The reverse index is only supported by version 202 dictionaries. version: %d",
+                formatVersion);
+        return false;
+    }
+    const HeaderPolicy headerPolicy(dictBuffer.data(), formatVersion);
+    // Drop the index of the source dictionary if there is one; it is always placed last.
+    const int oldIndexPos = HeaderReadWriteUtils::readIntAttributeValue(
+            headerPolicy.getAttributeMap(), Ver2ReverseIndex::REVERSE_INDEX_POS_KEY,
+            NOT_A_DICT_POS);
+    const ReadOnlyByteArrayView bodyBuffer = dictBuffer.skip(headerPolicy.getSize());
+    const int bodySize = (oldIndexPos == NOT_A_DICT_POS) ? static_cast<int>(bodyBuffer.size())
+            : std::min(oldIndexPos, static_cast<int>(bodyBuffer.size()));
+    if (bodySize > Ver2ReverseIndex::MAX_POSITION) {
+        AKLOGE("The dictionary is too large for the reverse index. body size: %d", bodySize);
+        return false;
+    }
+
+    const BigramListPolicy bigramListPolicy(bodyBuffer);
+    const ShortcutListPolicy shortcutListPolicy(bodyBuffer);
+    const Ver2ParticiaTrieNodeReader ptNodeReader(bodyBuffer, &bigramListPolicy,
+            &shortcutListPolicy, headerPolicy.getCodePointTable());
+    const Ver2PtNodeArrayReader ptNodeArrayReader(bodyBuffer);
+    std::vector<std::pair<int, int>> entries;
+    TraversePolicyToGetAllChildrenPositions traversePolicy(&entries);
+    DynamicPtReadingHelper readingHelper(&ptNodeReader, &ptNodeArrayReader);
+    readingHelper.initWithPtNodeArrayPos(0 /* rootPos */);
+    // The result is not checked as in PatriciaTriePolicy::getNextWordAndNextToken(). Reading the
+    // forward link after the last PtNode array of a v2 body is reported as an error although all
+    // PtNodes have been visited.
+    readingHelper.traverseAllPtNodesInPostorderDepthFirstManner(&traversePolicy);
+    std::sort(entries.begin(), entries.end());
+
+    DictionaryHeaderStructurePolicy::AttributeMap attributeMap(*headerPolicy.getAttributeMap());
+    HeaderReadWriteUtils::setIntAttribute(&attributeMap, Ver2ReverseIndex::REVERSE_INDEX_POS_KEY,
+            bodySize);
+    BufferWithExtendableBuffer buffer(BufferWithExtendableBuffer::DEFAULT_MAX_ADDITIONAL_BUFFER_SIZE
+            + bodySize + Ver2ReverseIndex::ENTRY_COUNT_FIELD_SIZE
+            + static_cast<int>(entries.size()) * Ver2ReverseIndex::ENTRY_SIZE);
+    int writingPos = 0;
+    if (!HeaderReadWriteUtils::writeDictionaryVersion(&buffer, formatVersion, &writingPos)
+            || !HeaderReadWriteUtils::writeDictionaryFlags(&buffer,
+                    HeaderReadWriteUtils::getFlags(dictBuffer.data()), &writingPos)) {
+        return false;
+    }
+    // Temporarily writes a placeholder header size.
+    int headerSizeFieldPos = writingPos;
+    if (!HeaderReadWriteUtils::writeDictionaryHeaderSize(&buffer, 0 /* size */, &writingPos)
+            || !HeaderReadWriteUtils::writeHeaderAttributes(&buffer, &attributeMap, &writingPos)
+            || !HeaderReadWriteUtils::writeDictionaryHeaderSize(&buffer, writingPos,
+                    &headerSizeFieldPos)) {
+        AKLOGE("Cannot write the header.");
+        return false;
+    }
+    for (int i = 0; i < bodySize; ++i) {
+        if (!buffer.writeUintAndAdvancePosition(bodyBuffer.data()[i], 1 /* size */, &writingPos)) {
+            AKLOGE("Cannot copy the body.");
+            return false;
+        }
+    }
+    if (!buffer.writeUintAndAdvancePosition(entries.size(),
+            Ver2ReverseIndex::ENTRY_COUNT_FIELD_SIZE, &writingPos)) {
+        return false;
+    }
+    for (const auto &entry : entries) {
+        if (!buffer.writeUintAndAdvancePosition(entry.first,
+                        Ver2ReverseIndex::POSITION_FIELD_SIZE, &writingPos)
+                || !buffer.writeUintAndAdvancePosition(entry.second,
+                        Ver2ReverseIndex::POSITION_FIELD_SIZE, &writingPos)) {
+            AKLOGE("Cannot write the reverse index.");
+            return false;
+        }
+    }
+    return DictFileWritingUtils::flushBufferToFile(filePath, &buffer);
+}
+
+} // namespace latinime
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_VER2_REVERSE_INDEX_WRITER_H
+#define LATINIME_VER2_REVERSE_INDEX_WRITER_H
+
+#include "defines.h"
+
+namespace latinime {
+
+// Rewrites a v2 dictionary with a Ver2ReverseIndex appended to its body. The trie is copied
+// unchanged, so PtNode positions and word ids stay the same. An existing index is replaced.
+class Ver2ReverseIndexWriter {
+ public:
+    static bool writeDictFileWithReverseIndex(const char *const sourceFilePath,
+            const char *const filePath);
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(Ver2ReverseIndexWriter);
+};
+} // namespace latinime
+#endif // LATINIME_VER2_REVERSE_INDEX_WRITER_H
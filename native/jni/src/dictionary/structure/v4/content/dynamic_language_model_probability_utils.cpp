@@ -16,6 +16,10 @@
 
 #include "dictionary/structure/v4/content/dynamic_language_model_probability_utils.h"
 
+#include <cmath>
+
+#include "dictionary/utils/probability_utils.h"
+
 namespace latinime {
 
 // Used to provide stable probabilities even if the user's input count is small.
@@ -31,4 +35,25 @@ const int DynamicLanguageModelProbabilityUtils::ENCODED_BACKOFF_WEIGHTS[] = {-32
 const int DynamicLanguageModelProbabilityUtils::DURATION_TO_DISCARD_ENTRY_IN_SECONDS =
         300 * 24 * 60 * 60; // 300 days
 
+const int DynamicLanguageModelProbabilityUtils::DECAY_TIME_STEP_DURATION_IN_SECONDS =
+        DURATION_TO_DISCARD_ENTRY_IN_SECONDS / ELAPSED_TIME_STEP_COUNT;
+
+// The time it takes for the probability of an entry to halve, for each decay level.
+const int DynamicLanguageModelProbabilityUtils::HALF_LIFE_IN_TIME_STEPS[DECAY_LEVEL_COUNT] =
+        {7, 14, 30, 60, 120};
+
+const DynamicLanguageModelProbabilityUtils::DecayTable
+        DynamicLanguageModelProbabilityUtils::sDecayTable;
+
+DynamicLanguageModelProbabilityUtils::DecayTable::DecayTable() : mPenalties() {
+    for (int decayLevel = 0; decayLevel < DECAY_LEVEL_COUNT; ++decayLevel) {
+        for (int timeStepCount = 0; timeStepCount < ELAPSED_TIME_STEP_COUNT; ++timeStepCount) {
+            const float decayRate = powf(2.0f, -static_cast<float>(timeStepCount)
+                    / static_cast<float>(HALF_LIFE_IN_TIME_STEPS[decayLevel]));
+            mPenalties[decayLevel][timeStepCount] = static_cast<uint8_t>(
+                    MAX_PROBABILITY - ProbabilityUtils::encodeRawProbability(decayRate));
+        }
+    }
+}
+
 } // namespace latinime
@@ -18,6 +18,7 @@
 #define LATINIME_DYNAMIC_LANGUAGE_MODEL_PROBABILITY_UTILS_H
 
 #include <algorithm>
+#include <cstdint>
 
 #include "defines.h"
 #include "dictionary/property/historical_info.h"
@@ -40,21 +41,29 @@ class DynamicLanguageModelProbabilityUtils {
         return std::min(std::max(probability, NOT_A_PROBABILITY), MAX_PROBABILITY);
     }
 
+    // Decay is computed when the entry is read, from the timestamp of the last input and the
+    // decay level, so entries never have to be rewritten to age them.
     static int getDecayedProbability(const int probability, const HistoricalInfo historicalInfo) {
         const int elapsedTime = TimeKeeper::peekCurrentTime() - historicalInfo.getTimestamp();
         if (elapsedTime < 0) {
             AKLOGE("The elapsed time is negatime value. Timestamp overflow?");
             return NOT_A_PROBABILITY;
         }
-        // TODO: Improve this logic.
-        // We don't modify probability depending on the elapsed time.
-        return probability;
+        const int decayPenalty = getDecayPenalty(elapsedTime, historicalInfo);
+        if (decayPenalty >= MAX_PROBABILITY) {
+            return NOT_A_PROBABILITY;
+        }
+        return std::max(probability - decayPenalty, 0);
     }
 
-    static int shouldRemoveEntryDuringGC(const HistoricalInfo historicalInfo) {
-        // TODO: Improve this logic.
+    // Dead entries can't be suggested anymore whatever their counts are.
+    static bool isDeadEntry(const HistoricalInfo historicalInfo) {
         const int elapsedTime = TimeKeeper::peekCurrentTime() - historicalInfo.getTimestamp();
-        return elapsedTime > DURATION_TO_DISCARD_ENTRY_IN_SECONDS;
+        return elapsedTime >= 0 && getDecayPenalty(elapsedTime, historicalInfo) >= MAX_PROBABILITY;
+    }
+
+    static int shouldRemoveEntryDuringGC(const HistoricalInfo historicalInfo) {
+        return isDeadEntry(historicalInfo);
     }
 
     static int getPriorityToPreventFromEviction(const HistoricalInfo historicalInfo) {
@@ -66,11 +75,54 @@ class DynamicLanguageModelProbabilityUtils {
 private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(DynamicLanguageModelProbabilityUtils);
 
+    // Decay levels are floor(log2(count)), clamped to the last level.
+    static const int DECAY_LEVEL_COUNT = 5;
+    // One step per day; entries older than DURATION_TO_DISCARD_ENTRY_IN_SECONDS are dead.
+    static const int ELAPSED_TIME_STEP_COUNT = 300;
+
+    // Encoded probability penalties indexed by decay level and elapsed time step. A penalty of
+    // MAX_PROBABILITY means the entry is dead.
+    class DecayTable {
+     public:
+        DecayTable();
+
+        int getPenalty(const int decayLevel, const int elapsedTimeStepCount) const {
+            return mPenalties[decayLevel][elapsedTimeStepCount];
+        }
+
+     private:
+        DISALLOW_COPY_AND_ASSIGN(DecayTable);
+
+        uint8_t mPenalties[DECAY_LEVEL_COUNT][ELAPSED_TIME_STEP_COUNT];
+    };
+
     static_assert(MAX_PREV_WORD_COUNT_FOR_N_GRAM <= 3, "Max supported Ngram is Quadgram.");
 
     static const int ASSUMED_MIN_COUNTS[];
     static const int ENCODED_BACKOFF_WEIGHTS[];
     static const int DURATION_TO_DISCARD_ENTRY_IN_SECONDS;
+    static const int DECAY_TIME_STEP_DURATION_IN_SECONDS;
+    static const int HALF_LIFE_IN_TIME_STEPS[];
+    static const DecayTable sDecayTable;
+
+    static int getDecayPenalty(const int elapsedTime, const HistoricalInfo &historicalInfo) {
+        const int elapsedTimeStepCount = elapsedTime / DECAY_TIME_STEP_DURATION_IN_SECONDS;
+        if (elapsedTimeStepCount >= ELAPSED_TIME_STEP_COUNT) {
+            return MAX_PROBABILITY;
+        }
+        return sDecayTable.getPenalty(getDecayLevel(historicalInfo.getCount()),
+                elapsedTimeStepCount);
+    }
+
+    // The stored level isn't used by this format, so the decay level is derived from the count:
+    // entries input more often decay more slowly.
+    static int getDecayLevel(const int count) {
+        int decayLevel = 0;
+        while (decayLevel < DECAY_LEVEL_COUNT - 1 && (count >> (decayLevel + 1)) > 0) {
+            ++decayLevel;
+        }
+        return decayLevel;
+    }
 };
 
 } // namespace latinime
@@ -230,7 +230,7 @@ bool LanguageModelDictContent::updateAllEntriesOnInputWord(const WordIdArrayView
     if (!setProbabilityEntry(wordId, &updatedUnigramProbabilityEntry)) {
         return false;
     }
-    mGlobalCounters.incrementTotalCount();
+    mGlobalCounters.addToTotalCount(historicalInfo.getCount());
     mGlobalCounters.updateMaxValueOfCounters(
             updatedUnigramProbabilityEntry.getHistoricalInfo()->getCount());
     for (size_t i = 0; i < prevWordIds.size(); ++i) {
@@ -261,7 +261,11 @@ bool LanguageModelDictContent::updateAllEntriesOnInputWord(const WordIdArrayView
 const ProbabilityEntry LanguageModelDictContent::createUpdatedEntryFrom(
         const ProbabilityEntry &originalProbabilityEntry, const bool isValid,
         const HistoricalInfo historicalInfo, const HeaderPolicy *const headerPolicy) const {
-    const HistoricalInfo updatedHistoricalInfo = HistoricalInfo(historicalInfo.getTimestamp(),
+    // Keep the latest timestamp so that merged updates of the same entry can be applied in any
+    // order.
+    const HistoricalInfo updatedHistoricalInfo = HistoricalInfo(
+            std::max(historicalInfo.getTimestamp(),
+                    originalProbabilityEntry.getHistoricalInfo()->getTimestamp()),
             0 /* level */, originalProbabilityEntry.getHistoricalInfo()->getCount()
                     + historicalInfo.getCount());
     if (originalProbabilityEntry.isValid()) {
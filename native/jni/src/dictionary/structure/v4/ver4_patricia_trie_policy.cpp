@@ -22,11 +22,13 @@
 #include "suggest/core/dicnode/dic_node.h"
 #include "suggest/core/dicnode/dic_node_vector.h"
 #include "dictionary/interface/ngram_listener.h"
+#include "dictionary/property/input_event_batch.h"
 #include "dictionary/property/ngram_context.h"
 #include "dictionary/property/ngram_property.h"
 #include "dictionary/property/unigram_property.h"
 #include "dictionary/property/word_property.h"
 #include "dictionary/structure/pt_common/dynamic_pt_reading_helper.h"
+#include "dictionary/structure/v4/content/dynamic_language_model_probability_utils.h"
 #include "dictionary/structure/v4/ver4_patricia_trie_node_reader.h"
 #include "dictionary/utils/forgetting_curve_utils.h"
 #include "dictionary/utils/multi_bigram_map.h"
@@ -149,6 +151,11 @@ void Ver4PatriciaTriePolicy::iterateNgramEntries(const WordIdArrayView prevWordI
             }
             int probability = NOT_A_PROBABILITY;
             if (probabilityEntry.hasHistoricalInfo()) {
+                if (DynamicLanguageModelProbabilityUtils::isDeadEntry(
+                        *probabilityEntry.getHistoricalInfo())) {
+                    // Not evicted by GC yet.
+                    continue;
+                }
                 // TODO: Quit checking count here.
                 // If count <= 1, the word can be an invaild word. The actual probability should
                 // be checked using getWordAttributesInContext() in onVisitEntry().
@@ -377,16 +384,10 @@ bool Ver4PatriciaTriePolicy::updateEntriesForWordWithNgramContext(
                 "dictionary.");
         return false;
     }
-    const bool updateAsAValidWord = ngramContext->isNthPrevWordBeginningOfSentence(1 /* n */) ?
-            false : isValidWord;
     int wordId = getWordId(wordCodePoints, false /* tryLowerCaseSearch */);
     if (wordId == NOT_A_WORD_ID) {
         // The word is not in the dictionary.
-        const UnigramProperty unigramProperty(false /* representsBeginningOfSentence */,
-                false /* isNotAWord */, false /* isBlacklisted */, false /* isPossiblyOffensive */,
-                NOT_A_PROBABILITY, HistoricalInfo(historicalInfo.getTimestamp(), 0 /* level */,
-                0 /* count */));
-        if (!addUnigramEntry(wordCodePoints, &unigramProperty)) {
+        if (!addUnigramEntryForInputWord(wordCodePoints, historicalInfo.getTimestamp())) {
             AKLOGE("Cannot add unigarm entry in updateEntriesForWordWithNgramContext().");
             return false;
         }
@@ -395,6 +396,74 @@ bool Ver4PatriciaTriePolicy::updateEntriesForWordWithNgramContext(
         }
         wordId = getWordId(wordCodePoints, false /* tryLowerCaseSearch */);
     }
+    return updateEntriesForWordIdWithNgramContext(ngramContext, wordId, isValidWord,
+            historicalInfo);
+}
+
+int Ver4PatriciaTriePolicy::updateEntriesForInputEvents(
+        const InputEventBatch *const inputEventBatch, const int startIndex, const int endIndex) {
+    if (!mBuffers->isUpdatable()) {
+        AKLOGI("Warning: updateEntriesForInputEvents() is called for non-updatable dictionary.");
+        return startIndex;
+    }
+    // Entries are sorted by word, so each word is looked up once for all of its contexts. All
+    // words are added before counting so that, like when the events are applied one by one, the
+    // previous words of the contexts are in the dictionary.
+    std::vector<int> wordIds(endIndex - startIndex, NOT_A_WORD_ID);
+    std::vector<bool> skipsFirstEvent(endIndex - startIndex, false);
+    for (int i = startIndex; i < endIndex; ++i) {
+        if (i != startIndex && inputEventBatch->hasSameWordAsPreviousEntry(i)) {
+            wordIds[i - startIndex] = wordIds[i - startIndex - 1];
+            continue;
+        }
+        const CodePointArrayView wordCodePoints = inputEventBatch->getWordCodePoints(i);
+        int wordId = getWordId(wordCodePoints, false /* tryLowerCaseSearch */);
+        if (wordId == NOT_A_WORD_ID) {
+            if (!addUnigramEntryForInputWord(wordCodePoints,
+                    inputEventBatch->getHistoricalInfo(i).getTimestamp())) {
+                AKLOGE("Cannot add unigarm entry in updateEntriesForInputEvents().");
+                continue;
+            }
+            wordId = getWordId(wordCodePoints, false /* tryLowerCaseSearch */);
+            // Like updateEntriesForWordWithNgramContext(), the event that adds an invalid word
+            // is not counted.
+            for (int j = i; j < endIndex && (j == i
+                    || inputEventBatch->hasSameWordAsPreviousEntry(j)); ++j) {
+                skipsFirstEvent[j - startIndex] = inputEventBatch->hasFirstEventOfWord(j)
+                        && !inputEventBatch->isValidWord(j);
+            }
+        }
+        wordIds[i - startIndex] = wordId;
+    }
+    for (int i = startIndex; i < endIndex; ++i) {
+        const HistoricalInfo historicalInfo = inputEventBatch->getHistoricalInfo(i);
+        const int count = historicalInfo.getCount() - (skipsFirstEvent[i - startIndex] ? 1 : 0);
+        if (wordIds[i - startIndex] != NOT_A_WORD_ID && count > 0) {
+            const NgramContext ngramContext = inputEventBatch->getNgramContext(i);
+            updateEntriesForWordIdWithNgramContext(&ngramContext, wordIds[i - startIndex],
+                    inputEventBatch->isValidWord(i),
+                    HistoricalInfo(historicalInfo.getTimestamp(), 0 /* level */, count));
+        }
+        if (needsToRunGC(true /* mindsBlockByGC */)) {
+            return i + 1;
+        }
+    }
+    return endIndex;
+}
+
+bool Ver4PatriciaTriePolicy::addUnigramEntryForInputWord(const CodePointArrayView wordCodePoints,
+        const int timestamp) {
+    const UnigramProperty unigramProperty(false /* representsBeginningOfSentence */,
+            false /* isNotAWord */, false /* isBlacklisted */, false /* isPossiblyOffensive */,
+            NOT_A_PROBABILITY, HistoricalInfo(timestamp, 0 /* level */, 0 /* count */));
+    return addUnigramEntry(wordCodePoints, &unigramProperty);
+}
+
+bool Ver4PatriciaTriePolicy::updateEntriesForWordIdWithNgramContext(
+        const NgramContext *const ngramContext, const int wordId, const bool isValidWord,
+        const HistoricalInfo historicalInfo) {
+    const bool updateAsAValidWord = ngramContext->isNthPrevWordBeginningOfSentence(1 /* n */) ?
+            false : isValidWord;
 
     WordIdArray<MAX_PREV_WORD_COUNT_FOR_N_GRAM> prevWordIdArray;
     const WordIdArrayView prevWordIds = ngramContext->getPrevWordIds(this, &prevWordIdArray,
@@ -470,7 +539,8 @@ bool Ver4PatriciaTriePolicy::needsToRunGC(const bool mindsBlockByGC) const {
         // Needs to reduce dictionary size.
         return true;
     } else if (mHeaderPolicy->isDecayingDict()) {
-        return ForgettingCurveUtils::needsToDecay(mindsBlockByGC, mEntryCounters.getEntryCounts(),
+        // Decay is applied when entries are read, so GC is only needed to evict entries.
+        return ForgettingCurveUtils::exceedsEntryCountHardLimit(mEntryCounters.getEntryCounts(),
                 mHeaderPolicy);
     }
     return false;
@@ -100,6 +100,9 @@ class Ver4PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
             const CodePointArrayView wordCodePoints, const bool isValidWord,
             const HistoricalInfo historicalInfo);
 
+    int updateEntriesForInputEvents(const InputEventBatch *const inputEventBatch,
+            const int startIndex, const int endIndex);
+
     bool flush(const char *const filePath);
 
     bool flushWithGC(const char *const filePath);
@@ -144,6 +147,13 @@ class Ver4PatriciaTriePolicy : public DictionaryStructureWithBufferPolicy {
     mutable bool mIsCorrupted;
 
     int getShortcutPositionOfWord(const int wordId) const;
+
+    // Adds a word that is not in the dictionary for its first input, without counting it.
+    bool addUnigramEntryForInputWord(const CodePointArrayView wordCodePoints,
+            const int timestamp);
+
+    bool updateEntriesForWordIdWithNgramContext(const NgramContext *const ngramContext,
+            const int wordId, const bool isValidWord, const HistoricalInfo historicalInfo);
 };
 } // namespace latinime
 #endif // LATINIME_VER4_PATRICIA_TRIE_POLICY_H
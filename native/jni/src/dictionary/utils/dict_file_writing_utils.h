@@ -41,6 +41,9 @@ class DictFileWritingUtils {
     static bool writeBufferToFileTail(FILE *const file,
             const BufferWithExtendableBuffer *const buffer);
 
+    static bool flushBufferToFile(const char *const filePath,
+            const BufferWithExtendableBuffer *const buffer);
+
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(DictFileWritingUtils);
 
@@ -57,9 +60,6 @@ class DictFileWritingUtils {
             const DictionaryHeaderStructurePolicy::AttributeMap *const attributeMap,
             const FormatUtils::FORMAT_VERSION formatVersion);
 
-    static bool flushBufferToFile(const char *const filePath,
-            const BufferWithExtendableBuffer *const buffer);
-
     static bool writeBufferToFile(FILE *const file,
             const BufferWithExtendableBuffer *const buffer);
 };
@@ -126,13 +126,8 @@ const ForgettingCurveUtils::ProbabilityTable ForgettingCurveUtils::sProbabilityT
 
 /* static */ bool ForgettingCurveUtils::needsToDecay(const bool mindsBlockByDecay,
         const EntryCounts &entryCounts, const HeaderPolicy *const headerPolicy) {
-    const EntryCounts &maxNgramCounts = headerPolicy->getMaxNgramCounts();
-    for (const auto ngramType : AllNgramTypes::ASCENDING) {
-        if (entryCounts.getNgramCount(ngramType)
-                >= getEntryCountHardLimit(maxNgramCounts.getNgramCount(ngramType))) {
-            // Unigram count exceeds the limit.
-            return true;
-        }
+    if (exceedsEntryCountHardLimit(entryCounts, headerPolicy)) {
+        return true;
     }
     if (mindsBlockByDecay) {
         return false;
@@ -145,6 +140,19 @@ const ForgettingCurveUtils::ProbabilityTable ForgettingCurveUtils::sProbabilityT
     return false;
 }
 
+/* static */ bool ForgettingCurveUtils::exceedsEntryCountHardLimit(
+        const EntryCounts &entryCounts, const HeaderPolicy *const headerPolicy) {
+    const EntryCounts &maxNgramCounts = headerPolicy->getMaxNgramCounts();
+    for (const auto ngramType : AllNgramTypes::ASCENDING) {
+        if (entryCounts.getNgramCount(ngramType)
+                >= getEntryCountHardLimit(maxNgramCounts.getNgramCount(ngramType))) {
+            // Ngram count exceeds the limit.
+            return true;
+        }
+    }
+    return false;
+}
+
 // See comments in ProbabilityUtils::backoff().
 /* static */ int ForgettingCurveUtils::backoff(const int unigramProbability) {
     // See TODO comments in ForgettingCurveUtils::getProbability().
@@ -46,6 +46,9 @@ class ForgettingCurveUtils {
     static bool needsToDecay(const bool mindsBlockByDecay, const EntryCounts &entryCounters,
             const HeaderPolicy *const headerPolicy);
 
+    static bool exceedsEntryCountHardLimit(const EntryCounts &entryCounts,
+            const HeaderPolicy *const headerPolicy);
+
     // TODO: Improve probability computation method and remove this.
     static int getProbabilityBiasForNgram(const int n) {
         return (n - 1) * MULTIPLIER_TWO_IN_PROBABILITY_SCALE;
@@ -39,6 +39,8 @@ const size_t FormatUtils::DICTIONARY_MINIMUM_SIZE = 12;
             return VERSION_402;
         case VERSION_403:
             return VERSION_403;
+        case VERSION_FLAT:
+            return VERSION_FLAT;
         default:
             return UNKNOWN_VERSION;
     }
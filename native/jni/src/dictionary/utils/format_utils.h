@@ -40,6 +40,8 @@ class FormatUtils {
         VERSION_4_ONLY_FOR_TESTING = 399,
         VERSION_402 = 402,
         VERSION_403 = 403,
+        // Read-only format with fixed size PtNode records for the shipped main dictionaries.
+        VERSION_FLAT = 501,
         UNKNOWN_VERSION = -1
     };
 
@@ -5,12 +5,14 @@
 #include <sentencepiece/sentencepiece_processor.h>
 #include "LanguageModel.h"
 #include "ModelMeta.h"
+#include "../utils/stats_registry.h"
 
 LanguageModel::LanguageModel(LlamaAdapter *adapter): adapter(adapter) { }
 
 LlamaAdapter::~LlamaAdapter() {
-    llama_free_model(model);
     llama_free(context);
+    if(loraAdapter != nullptr) llama_lora_adapter_free(loraAdapter);
+    llama_free_model(model);
 }
 
 int LlamaAdapter::getVocabSize() const {
@@ -24,13 +26,19 @@ const char *LlamaAdapter::getToken(int id) const {
 }
 
 bool LlamaAdapter::eval(int nPast, token_sequence input, std::vector<float> &outLogits) {
-    // TODO
-    ASSERT(nPast + input.size() < LLAMA_CONTEXT_SIZE);
-
-    if(llama_eval(context, input.data(), input.size(), nPast) != 0) {
+    // LanguageModel::updateContext trims the context to fit, this only trips on oversized inputs
+    if(nPast + input.size() >= (size_t)n_ctx) {
+        AKLOGE("Evaluating %d tokens at %d would exceed the context size", (int)input.size(), nPast);
         return false;
     }
 
+    for(size_t i = 0; i < input.size(); i += n_batch) {
+        int n_tokens = (int)std::min(input.size() - i, (size_t)n_batch);
+        if(llama_eval(context, input.data() + i, n_tokens, nPast + (int)i) != 0) {
+            return false;
+        }
+    }
+
     // TODO: Zero-copy
     outLogits.resize(llama_n_vocab(model));
     memcpy(outLogits.data(), llama_get_logits(context), llama_n_vocab(model) * sizeof(float));
@@ -38,10 +46,112 @@ bool LlamaAdapter::eval(int nPast, token_sequence input, std::vector<float> &out
     return true;
 }
 
+void LlamaAdapter::shiftContext(const transformer_context_shift &shift) {
+    if(shift.discard == 0) return;
+
+    llama_kv_cache_seq_rm(context, -1, shift.keep, shift.keep + shift.discard);
+    llama_kv_cache_seq_shift(context, 0, shift.keep + shift.discard, -1, -shift.discard);
+}
+
+bool LlamaAdapter::trimContext(token_sequence &tokens, size_t reserve) const {
+    size_t limit = (size_t)n_ctx - LLAMA_CONTEXT_MARGIN - std::min(reserve, (size_t)n_ctx / 2);
+    if(tokens.size() <= limit) return false;
+
+    // A quarter of the budget is dropped on top of the excess, so the following calls do not all
+    // trim (and shift the KV cache) again
+    size_t excess = std::min(tokens.size() - limit + n_ctx / 4, tokens.size() - 1);
+    tokens.erase(tokens.begin() + 1, tokens.begin() + 1 + excess);
+    return true;
+}
+
 std::vector<int> LlamaAdapter::tokenize(const char *text) {
+    latinime::StatsScopedTimer timer(latinime::StatsStage::TOKENIZE);
+    return tokenizeUntimed(text);
+}
+
+std::vector<int> LlamaAdapter::tokenizeUntimed(const std::string &text) const {
     return spm.EncodeAsIds(text);
 }
 
+void LlamaAdapter::encodeWithOffsets(const std::string &text, token_sequence &outTokens, std::vector<uint32_t> &outBegins) const {
+    auto spt = spm.EncodeAsImmutableProto(text);
+
+    outTokens.clear();
+    outBegins.clear();
+    for(const auto &piece : spt.pieces()) {
+        outTokens.push_back((int)piece.id());
+        outBegins.push_back(piece.begin());
+    }
+}
+
+// Number of word boundaries re-encoded before the first change, used to check that the new encoding
+// lines up with the cached one before splicing them together
+#define TOKENIZE_SYNC_WORDS 2
+
+std::vector<int> LlamaAdapter::tokenizeIncremental(const std::string &text) {
+    latinime::StatsScopedTimer timer(latinime::StatsStage::TOKENIZE);
+    auto &cache = tokenizeCache;
+
+    size_t common = 0;
+    size_t maxCommon = std::min(text.size(), cache.text.size());
+    while(common < maxCommon && text[common] == cache.text[common]) {
+        common++;
+    }
+
+    if(common == text.size() && common == cache.text.size()) {
+        return cache.tokens;
+    }
+
+    // Word boundaries are tokens whose surface starts at a space within the unchanged prefix. The tail
+    // is re-encoded from syncBoundary, whose tokens up to lastBoundary must match the cached ones
+    int lastBoundary = -1;
+    int syncBoundary = -1;
+    int boundariesSeen = 0;
+    for(int i = (int)cache.tokens.size() - 1; i > 0; i--) {
+        uint32_t begin = cache.begins[i];
+        if(begin >= common || cache.text[begin] != ' ') continue;
+
+        if(lastBoundary == -1) {
+            lastBoundary = i;
+        } else if(++boundariesSeen == TOKENIZE_SYNC_WORDS) {
+            syncBoundary = i;
+            break;
+        }
+    }
+
+    if(syncBoundary != -1) {
+        // The space itself is represented by the dummy prefix SentencePiece adds to the tail
+        uint32_t tailStart = cache.begins[syncBoundary] + 1;
+
+        token_sequence tailTokens;
+        std::vector<uint32_t> tailBegins;
+        encodeWithOffsets(text.substr(tailStart), tailTokens, tailBegins);
+
+        size_t numSync = lastBoundary - syncBoundary;
+        bool aligned = tailTokens.size() > numSync
+                && tailBegins[numSync] + tailStart == cache.begins[lastBoundary]
+                && std::equal(tailTokens.begin(), tailTokens.begin() + numSync, cache.tokens.begin() + syncBoundary);
+
+        if(aligned) {
+            cache.tokens.resize(syncBoundary);
+            cache.begins.resize(syncBoundary);
+
+            cache.tokens.insert(cache.tokens.end(), tailTokens.begin(), tailTokens.end());
+            cache.begins.push_back(tailStart - 1);
+            for(size_t i = 1; i < tailBegins.size(); i++) {
+                cache.begins.push_back(tailBegins[i] + tailStart);
+            }
+
+            cache.text = text;
+            return cache.tokens;
+        }
+    }
+
+    encodeWithOffsets(text, cache.tokens, cache.begins);
+    cache.text = text;
+    return cache.tokens;
+}
+
 int LlamaAdapter::tokenToId(const char *text) {
     return spm.PieceToId(text);
 }
@@ -50,16 +160,93 @@ std::string LlamaAdapter::decode(const token_sequence &tokens) const {
     return spm.DecodeIds(tokens);
 }
 
-LanguageModel *LlamaAdapter::createLanguageModel(const std::string &modelPath) {
-    auto adapter = new LlamaAdapter();
-    adapter->metadata = loadModelMetadata(modelPath);
+bool LlamaAdapter::setLoraAdapter(const std::string &adapterPath) {
+    llama_lora_adapter *newAdapter = nullptr;
+    if(!adapterPath.empty()) {
+        newAdapter = llama_lora_adapter_init(model, adapterPath.c_str(), 1.0f);
+        if(newAdapter == nullptr) {
+            AKLOGE("Failed to load LoRA adapter %s", adapterPath.c_str());
+            return false;
+        }
+    }
 
-    llama_context_params ctx_params = llama_context_default_params();
-    ctx_params.n_ctx = LLAMA_CONTEXT_SIZE;
-    ctx_params.n_threads = 1;
-    ctx_params.n_threads_batch = 1;
+    if(llama_set_lora_adapters(context, &newAdapter, newAdapter != nullptr ? 1 : 0) != 0) {
+        AKLOGE("Failed to set LoRA adapter %s", adapterPath.c_str());
+        if(newAdapter != nullptr) llama_lora_adapter_free(newAdapter);
+        return false;
+    }
+
+    if(loraAdapter != nullptr) llama_lora_adapter_free(loraAdapter);
+    loraAdapter = newAdapter;
+
+    resetEmbeddings();
+    return true;
+}
 
-    adapter->n_batch = ctx_params.n_batch;
+const float *LlamaAdapter::getTokenEmbedding(int token) {
+    auto it = embeddingRows.find(token);
+    if(it != embeddingRows.end()) {
+        return it->second.data();
+    }
+
+    auto tensor = llama_get_model_tensor(model, "token_embd.weight");
+    ASSERT(tensor);
+
+    const int n_embd = llama_n_embd(model);
+    ASSERT(tensor->ne[0] == n_embd);
+    ASSERT(token >= 0 && token < tensor->ne[1]);
+
+    std::vector<float> row(n_embd);
+    const char *src = (const char *)tensor->data + token * tensor->nb[1];
+    if (tensor->type != GGML_TYPE_F32) {
+        ggml_internal_get_type_traits(tensor->type).to_float(src, row.data(), n_embd);
+    } else {
+        memcpy(row.data(), src, n_embd * sizeof(float));
+    }
+
+    // Mixed embeddings bypass the token embedding lookup in the graph, so the update is added here
+    if(loraAdapter != nullptr) {
+        llama_lora_adapter_add_tok_embd(loraAdapter, token, row.data());
+    }
+
+    return embeddingRows.emplace(token, std::move(row)).first->second.data();
+}
+
+void LlamaAdapter::resetEmbeddings() {
+    embeddingRows.clear();
+
+    if(metadata.HasFeature(FEATURE_ENCODER)) {
+        encoder_weight.resize(llama_n_embd(model) * 2);
+        encoder_bias.resize(llama_n_embd(model));
+
+        const float *w_x = getTokenEmbedding(FEATURE_ENCODER_W_X_ID);
+        const float *w_y = getTokenEmbedding(FEATURE_ENCODER_W_Y_ID);
+        const float *b   = getTokenEmbedding(FEATURE_ENCODER_B_ID);
+
+        for(int i = 0; i < llama_n_embd(model); i++) {
+            encoder_weight[i*2]     = w_x[i];
+            encoder_weight[i*2 + 1] = w_y[i];
+            encoder_bias[i]         = b[i];
+        }
+    }
+}
+
+// Only the types the keyboard is tested with are accepted from the metadata
+static bool parseKVCacheType(const std::string &name, ggml_type &outType) {
+    for(ggml_type type : { GGML_TYPE_F16, GGML_TYPE_F32, GGML_TYPE_Q8_0 }) {
+        if(name == ggml_type_name(type)) {
+            outType = type;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+LanguageModel *LlamaAdapter::createLanguageModel(const std::string &modelPath, const std::string &adapterPath) {
+    auto adapter = new LlamaAdapter();
+
+    const int64_t loadStart = ggml_time_us();
 
     llama_model_params model_params = llama_model_default_params();
 
@@ -70,55 +257,85 @@ LanguageModel *LlamaAdapter::createLanguageModel(const std::string &modelPath) {
         return nullptr;
     }
 
-    adapter->context = llama_new_context_with_model(adapter->model, ctx_params);
+    // The metadata and tokenizer are read from the GGUF the model was just loaded from instead of opening
+    // the file again. The tokenizer is parsed straight from the array kept by the model
+    const gguf_context *ctx_gguf = llama_model_get_gguf(adapter->model);
+    adapter->metadata = loadModelMetadata(ctx_gguf, false);
 
-    if(adapter->metadata.ext_tokenizer_type == ExternalTokenizerType::SentencePiece) {
-        auto spm_load_result = adapter->spm.LoadFromSerializedProto(adapter->metadata.ext_tokenizer_data);
-        if(!spm_load_result.ok()) {
-            AKLOGE("SPM load failed: %s", spm_load_result.ToString().c_str());
-            llama_free(adapter->context);
-            llama_free_model(adapter->model);
-            delete adapter;
-            return nullptr;
-        }
-    } else {
+    if(adapter->metadata.ext_tokenizer_type != ExternalTokenizerType::SentencePiece) {
         AKLOGE("TODO: Non SPM models");
-        llama_free(adapter->context);
-        llama_free_model(adapter->model);
         delete adapter;
         return nullptr;
     }
 
-    adapter->batch = llama_batch_init(LLAMA_CONTEXT_SIZE, 0, 1);
+    const char *tokenizer_data;
+    size_t tokenizer_size;
+    if(!getModelTokenizerData(ctx_gguf, &tokenizer_data, &tokenizer_size)) {
+        delete adapter;
+        return nullptr;
+    }
 
-    if(adapter->metadata.HasFeature(FEATURE_EMBED_MIXING)) {
-        adapter->embeddings.resize(llama_n_embd(adapter->model) * llama_n_vocab(adapter->model));
+    auto spm_load_result = adapter->spm.LoadFromSerializedProto(absl::string_view(tokenizer_data, tokenizer_size));
+    if(!spm_load_result.ok()) {
+        AKLOGE("SPM load failed: %s", spm_load_result.ToString().c_str());
+        delete adapter;
+        return nullptr;
+    }
 
-        auto tensor = llama_get_model_tensor(adapter->model, "token_embd.weight");
-        ASSERT(tensor);
+    llama_context_params ctx_params = llama_context_default_params();
+    ctx_params.n_ctx = LLAMA_CONTEXT_SIZE;
+    ctx_params.n_batch = LLAMA_BATCH_SIZE;
+    ctx_params.n_threads = 1;
+    ctx_params.n_threads_batch = 1;
 
-        if (tensor->type != GGML_TYPE_F32) {
-            ggml_internal_get_type_traits(tensor->type).to_float(tensor->data,
-                                                                 adapter->embeddings.data(),
-                                                                 adapter->embeddings.size());
-        } else {
-            ASSERT((tensor->ne[0] * tensor->ne[1]) == adapter->embeddings.size());
-            memcpy(adapter->embeddings.data(), tensor->data,
-                   adapter->embeddings.size() * sizeof(float));
-        }
+    if(adapter->metadata.context_length != 0) {
+        ctx_params.n_ctx = std::max(adapter->metadata.context_length, (uint32_t)LLAMA_CONTEXT_MARGIN * 4);
     }
 
-    if(adapter->metadata.HasFeature(FEATURE_ENCODER)) {
-        adapter->encoder_weight.resize(llama_n_embd(adapter->model) * 2);
-        adapter->encoder_bias.resize(llama_n_embd(adapter->model));
+    if(!adapter->metadata.kv_cache_type.empty()
+        && !parseKVCacheType(adapter->metadata.kv_cache_type, ctx_params.type_k)) {
+        AKLOGE("Unsupported KV cache type %s, using %s", adapter->metadata.kv_cache_type.c_str(), ggml_type_name(ctx_params.type_k));
+    }
+
+    // V stays in f16 for a quantized K, it is stored transposed and cannot be split into quantization blocks
+    ctx_params.type_v = ctx_params.type_k == GGML_TYPE_F32 ? GGML_TYPE_F32 : GGML_TYPE_F16;
 
-        for(int i = 0; i < llama_n_embd(adapter->model); i++) {
-            adapter->encoder_weight[i*2]     = adapter->embeddings.data()[FEATURE_ENCODER_W_X_ID * llama_n_embd(adapter->model) + i];
-            adapter->encoder_weight[i*2 + 1] = adapter->embeddings.data()[FEATURE_ENCODER_W_Y_ID * llama_n_embd(adapter->model) + i];
-            adapter->encoder_bias[i]         = adapter->embeddings.data()[FEATURE_ENCODER_B_ID   * llama_n_embd(adapter->model) + i];
+    adapter->n_ctx = (int)ctx_params.n_ctx;
+    adapter->n_batch = (int)std::min(ctx_params.n_batch, ctx_params.n_ctx);
+
+    adapter->context = llama_new_context_with_model(adapter->model, ctx_params);
+    if(adapter->context == nullptr) {
+        AKLOGE("Failed to create the context (n_ctx %d, K %s)", adapter->n_ctx, ggml_type_name(ctx_params.type_k));
+        delete adapter;
+        return nullptr;
+    }
+
+    adapter->batch = llama_batch_init(adapter->n_batch, 0, 1);
+
+    if(!adapterPath.empty()) {
+        // Predictions still work without the personalisation, so a bad adapter is not fatal
+        if(!adapter->setLoraAdapter(adapterPath)) {
+            AKLOGE("Continuing without LoRA adapter");
         }
     }
 
+    if(adapter->loraAdapter == nullptr) {
+        adapter->resetEmbeddings();
+    }
+
+    adapter->memoryUsage.weights = llama_model_size(adapter->model);
+    adapter->memoryUsage.kvCache = llama_kv_cache_size(adapter->context);
+    adapter->memoryUsage.compute = llama_compute_buffer_size(adapter->context);
+    adapter->memoryUsage.loadTimeUs = ggml_time_us() - loadStart;
+
+    AKLOGI("Loaded %s in %.1f ms: weights %.2f MiB, KV cache %.2f MiB (n_ctx %d, K %s, V %s), compute %.2f MiB",
+           adapter->metadata.name.c_str(),
+           adapter->memoryUsage.loadTimeUs / 1000.0,
+           adapter->memoryUsage.weights / 1024.0 / 1024.0,
+           adapter->memoryUsage.kvCache / 1024.0 / 1024.0,
+           adapter->n_ctx, ggml_type_name(ctx_params.type_k), ggml_type_name(ctx_params.type_v),
+           adapter->memoryUsage.compute / 1024.0 / 1024.0);
+
     return new LanguageModel(adapter);
 }
 
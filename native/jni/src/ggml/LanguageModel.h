@@ -6,6 +6,7 @@
 #define LATINIME_LANGUAGEMODEL_H
 
 #include <vector>
+#include <unordered_map>
 #include <unordered_set>
 #include <sentencepiece/sentencepiece_processor.h>
 #include "context.h"
@@ -25,27 +26,71 @@
 
 class LanguageModel;
 
-#define LLAMA_CONTEXT_SIZE 2048
+// Default number of KV cache positions, models may ask for a different budget in their metadata. The
+// context is trimmed to a few hundred characters before it gets here and the mixes and beams only add
+// a few dozen positions on top of it, so a bigger cache would mostly stay unused
+#define LLAMA_CONTEXT_SIZE 512
+
+// Tokens decoded per llama_decode call. The compute buffer is sized for the worst case batch
+#define LLAMA_BATCH_SIZE 128
+
+// Room kept free past the context for tokens evaluated on top of it (mixes, sampling)
+#define LLAMA_CONTEXT_MARGIN 64
+
+// Trimmed contexts are only shifted in the KV cache if at least this many tokens can be reused
+#define LLAMA_CONTEXT_MIN_SHIFT_REUSE 4
 class LlamaAdapter {
 public:
     int getVocabSize() const;
     const char *getToken(int id) const;
     bool eval(int nPast, token_sequence input, std::vector<float> &outLogits);
+
+    // Removes the discarded positions from the KV cache and moves the following ones back (re-roped
+    // on the next decode), so the cache matches the context after transformer_context_apply_shift
+    void shiftContext(const transformer_context_shift &shift);
+
+    // Drops the oldest tokens after the first (BOS) one until the context leaves LLAMA_CONTEXT_MARGIN
+    // plus reserve positions free. Returns whether anything was dropped
+    bool trimContext(token_sequence &tokens, size_t reserve = 0) const;
     std::vector<int> tokenize(const char *text);
+
+    // Same as tokenize, but not recorded in the TOKENIZE stage, for bulk work off the typing path
+    std::vector<int> tokenizeUntimed(const std::string &text) const;
+
+    // Same result as tokenize, but reuses the tokens of the previous call up to the last word boundary
+    // before the first changed byte, so typing at the end of a long context only re-encodes the tail
+    std::vector<int> tokenizeIncremental(const std::string &text);
     int tokenToId(const char *text);
     std::string decode(const token_sequence &tokens) const;
 
-    static LanguageModel *createLanguageModel(const std::string &paths);
+    // adapterPath may be empty. A missing or broken adapter is logged and the base model is used alone
+    static LanguageModel *createLanguageModel(const std::string &paths, const std::string &adapterPath = "");
+
+    // Swaps the LoRA adapter evaluated on top of the base model, an empty path removes it. Clears the KV cache
+    bool setLoraAdapter(const std::string &adapterPath);
+
     llama_context *context{};
     llama_model *model{};
+    llama_lora_adapter *loraAdapter{};
     llama_batch batch{};
 
-    std::vector<float> embeddings;
+    // Row of the token embeddings (with the adapter's update) for embedding mixing. Rows are dequantized
+    // on first use, mixing only ever touches a few dozen tokens out of the whole vocabulary
+    const float *getTokenEmbedding(int token);
 
     std::vector<float> encoder_weight = {};
     std::vector<float> encoder_bias = {};
 
     int n_batch{};
+    int n_ctx{};
+
+    // Resident memory of the model, filled in when it is loaded
+    struct {
+        size_t weights = 0;
+        size_t kvCache = 0;
+        size_t compute = 0;
+        int64_t loadTimeUs = 0;
+    } memoryUsage;
 
     ModelMetadata metadata;
 
@@ -58,7 +103,20 @@ public:
 private:
     LlamaAdapter();
 
+    // Drops the cached embedding rows and recomputes the encoder from the current weights
+    void resetEmbeddings();
+
+    std::unordered_map<int, std::vector<float>> embeddingRows;
+
     sentencepiece::SentencePieceProcessor spm;
+
+    void encodeWithOffsets(const std::string &text, token_sequence &outTokens, std::vector<uint32_t> &outBegins) const;
+
+    struct {
+        std::string text;
+        token_sequence tokens;
+        std::vector<uint32_t> begins; // byte offset in text where the surface of each token begins
+    } tokenizeCache;
 };
 
 
@@ -73,6 +131,12 @@ public:
     AK_FORCE_INLINE std::vector<int> tokenize(const std::string &text) const {
         return tokenize(text.c_str());
     }
+    AK_FORCE_INLINE std::vector<int> tokenizeUntimed(const std::string &text) const {
+        return adapter->tokenizeUntimed(text);
+    }
+    AK_FORCE_INLINE std::vector<int> tokenizeIncremental(const std::string &text) const {
+        return adapter->tokenizeIncremental(text);
+    }
     AK_FORCE_INLINE int tokenToId(const char *text) const {
         return adapter->tokenToId(text);
     }
@@ -81,13 +145,21 @@ public:
         return adapter->decode(tokens);
     }
 
-    // Fast forward the context
+    // Fast forward the context. Tokens trimmed from the front are shifted out of the KV cache
+    // instead of evaluating everything after them again
     AK_FORCE_INLINE void updateContext(const std::vector<int> &newContext) {
-        auto result = transformer_context_fastforward(transformerContext, newContext);
+        pendingContext = newContext;
+
+        adapter->trimContext(pendingContext);
+
+        pendingShift = transformer_context_find_shift(transformerContext, pendingContext, LLAMA_CONTEXT_MIN_SHIFT_REUSE);
+
+        transformer_context shifted = transformerContext;
+        transformer_context_apply_shift(shifted, pendingShift);
+
+        auto result = transformer_context_fastforward(shifted, pendingContext);
         pendingEvaluationSequence = result.first;
         pendingNPast = result.second;
-
-        pendingContext = newContext;
     }
     AK_FORCE_INLINE void updateContext(const char *text) {
         return updateContext(tokenize(text));
@@ -105,6 +177,12 @@ public:
             return outLogits;
         }
 
+        if(pendingShift.discard > 0) {
+            adapter->shiftContext(pendingShift);
+            transformer_context_apply_shift(transformerContext, pendingShift);
+            pendingShift = { };
+        }
+
         if(!adapter->eval(pendingNPast, pendingEvaluationSequence, outLogits)) {
             ASSERT(false);
         }
@@ -149,12 +227,25 @@ public:
         return adapter->model;
     }
 
+    // The KV cache no longer matches the context after swapping the adapter, so it is evaluated again
+    bool setLoraAdapter(const std::string &adapterPath) {
+        if(!adapter->setLoraAdapter(adapterPath)) return false;
+
+        transformerContext.active_context.clear();
+        pendingEvaluationSequence.clear();
+        pendingNPast = 0;
+        pendingShift = { };
+        updateContext(pendingContext);
+        return true;
+    }
+
     std::unique_ptr<LlamaAdapter> adapter;
     transformer_context transformerContext;
 private:
     token_sequence pendingContext;
     token_sequence pendingEvaluationSequence;
     int pendingNPast = 0;
+    transformer_context_shift pendingShift;
 
     std::vector<float> outLogits;
     std::vector<float> tmpOutLogits;
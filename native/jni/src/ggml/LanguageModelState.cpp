@@ -0,0 +1,1372 @@
+#define LOG_TAG "LatinIME: LanguageModelState"
+
+#include "LanguageModelState.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring> // for memset()
+
+#include "../suggest/core/layout/proximity_info.h"
+#include "../utils/stats_registry.h"
+
+#define EPS 0.0001
+
+#if false
+#define TIME_START(name)  const int64_t start_##name = ggml_time_us();
+#define TIME_END(name)    const int64_t end_##name = ggml_time_us(); \
+                          const int64_t time_taken_##name = (end_##name - start_##name) / 1000L; \
+                          AKLOGI("%s:     Time taken by %s: %d ms\n", __func__, #name, (int)time_taken_##name);
+#else
+#define TIME_START(name)
+#define TIME_END(name)
+#endif
+
+static std::string trim(const std::string &s) {
+    auto start = s.begin();
+    while (start != s.end() && std::isspace(*start)) {
+        start++;
+    }
+
+    auto end = s.end();
+    do {
+        end--;
+    } while (std::distance(start, end) > 0 && std::isspace(*end));
+
+    return {start, end + 1};
+}
+
+template<typename T>
+bool sortProbabilityPairDescending(const std::pair<float, T>& a, const std::pair<float, T>& b) {
+    return a.first > b.first;
+}
+
+template<typename T>
+static inline void sortProbabilityPairVectorDescending(std::vector<std::pair<float, T>> &vec) {
+    std::sort(vec.begin(), vec.end(), sortProbabilityPairDescending<T>);
+}
+
+template<typename T>
+static inline void sortProbabilityPairVectorDescending(std::vector<std::pair<float, T>> &vec, size_t partial) {
+    if(partial > vec.size()) partial = vec.size();
+    std::partial_sort(vec.begin(), vec.begin() + partial, vec.end(), sortProbabilityPairDescending<T>);
+}
+
+static int compute_sequence_hash(const token_sequence &seq) {
+    int hash = 0;
+    for(llama_token t : seq) {
+        hash = (hash + t) % 999999999;
+    }
+    return hash;
+}
+
+static int append_sequence_hash(int hash, llama_token t) {
+    return (hash + t) % 999999999;
+}
+
+static void softmax(float * input, size_t input_len) {
+    float m = -INFINITY;
+    for (size_t i = 0; i < input_len; i++) {
+        if (input[i] > m) {
+            m = input[i];
+        }
+    }
+
+    float sum = 0.0;
+    for (size_t i = 0; i < input_len; i++) {
+        sum += expf(input[i] - m);
+    }
+
+    float offset = m + logf(sum);
+    for (size_t i = 0; i < input_len; i++) {
+        input[i] = expf(input[i] - offset);
+    }
+}
+
+// log(sum(exp(input))), the normalizer of softmax in log space
+static float logsumexp(const float * input, size_t input_len) {
+    float m = -INFINITY;
+    for (size_t i = 0; i < input_len; i++) {
+        if (input[i] > m) {
+            m = input[i];
+        }
+    }
+
+    float sum = 0.0;
+    for (size_t i = 0; i < input_len; i++) {
+        sum += expf(input[i] - m);
+    }
+
+    return m + logf(sum);
+}
+
+// Entropy in nats of a probability distribution, entries banned after the softmax are skipped
+static float entropy(const float * probs, size_t input_len) {
+    float h = 0.0f;
+    for (size_t i = 0; i < input_len; i++) {
+        if (probs[i] > 0.0f) {
+            h -= probs[i] * logf(probs[i]);
+        }
+    }
+
+    return h;
+}
+
+static bool isFirstCharLowercase(const char* str) {
+    if (str == nullptr || str[0] == '\0')
+        return false;
+    return islower(static_cast<unsigned char>(str[0])) != 0;
+}
+
+
+static bool hasLowercase(const char* str) {
+    if (str == nullptr)
+        return false;
+
+    for (; *str != '\0'; ++str) {
+        if (islower(static_cast<unsigned char>(*str)))
+            return true;
+    }
+    return false;
+}
+
+static bool isExactMatch(const std::string &a, const std::string &b){
+    auto preprocess = [](const std::string &str) -> std::string {
+        std::string result;
+        for(char c : str) {
+            if(c != '\'' && c != '-' && c != ' ') {
+                result += (char)tolower(c);
+            }
+        }
+        return result;
+    };
+
+    return preprocess(a) == preprocess(b);
+}
+
+static bool isTokenMixRoughlyEqual(const TokenMix &a, const TokenMix &b) {
+    return (a.mixes[0].token == b.mixes[0].token) && std::abs(a.mixes[0].weight - b.mixes[0].weight) < EPS &&
+            (a.mixes[1].token == b.mixes[1].token) && std::abs(a.mixes[1].weight - b.mixes[1].weight) < EPS &&
+            (a.mixes[2].token == b.mixes[2].token) && std::abs(a.mixes[2].weight - b.mixes[2].weight) < EPS &&
+            (a.mixes[3].token == b.mixes[3].token) && std::abs(a.mixes[3].weight - b.mixes[3].weight) < EPS;
+}
+
+bool LanguageModelState::Initialize(const std::string &paths, const std::string &adapterPath) {
+    model = std::unique_ptr<LanguageModel>(LlamaAdapter::createLanguageModel(paths, adapterPath));
+
+    if(!model) {
+        AKLOGE("GGMLDict: Could not load model");
+        return false;
+    }
+
+    specialTokens.SPACE = model->tokenToId("▁"); // ▁
+    specialTokens.DASH = model->tokenToId("-");
+    specialTokens.STAR = model->tokenToId("*");
+
+    if(model->adapter->hasFeature(FEATURE_AUTOCORRECT)) {
+        specialTokens.XBU = model->tokenToId("<XBU>");
+        specialTokens.XBC = model->tokenToId("<XBC>");
+        specialTokens.XEC = model->tokenToId("<XEC>");
+
+        specialTokens.LETTERS_TO_IDS[0] = model->tokenToId("<CHAR_A>");
+
+        ASSERT(specialTokens.XBU != 0);
+        ASSERT(specialTokens.XBC != 0);
+        ASSERT(specialTokens.XEC != 0);
+        ASSERT(specialTokens.LETTERS_TO_IDS[0] != 0);
+
+        for(int i = 1; i < 26; i++) {
+            specialTokens.LETTERS_TO_IDS[i] = specialTokens.LETTERS_TO_IDS[0] + i;
+        }
+
+        if(model->adapter->hasFeature(FEATURE_SWIPE_TYPING)) {
+            specialTokens.XC0_SWIPE_MODE = model->tokenToId("<XC0>");
+            ASSERT(specialTokens.XC0_SWIPE_MODE != 0);
+        }
+    } else {
+        specialTokens.XBU = -1;
+        specialTokens.XBC = -1;
+        specialTokens.XEC = -1;
+    }
+
+    specialTokens.banned_tokens_word_separators = { };
+    specialTokens.general_banned_tokens = { model->tokenToId("-▁") };
+
+    //int permitted_period_token = model->tokenToId(".");
+
+    const char *blacklist_symbols = ".!@#$%^&*()_=?/,\\][{};:\"><+`~|\r\n\t\x0b\x0c";
+    for(int i = 0; i < model->getVocabSize(); i++) {
+        //if(i == permitted_period_token) continue;
+
+        const char *token = model->getToken(i);
+
+        bool has_symbol = false;
+        for(char c : std::string(token)){
+            if(strchr(blacklist_symbols, c) != nullptr) {
+                has_symbol = true;
+                break;
+            }
+        }
+
+        if(has_symbol) {
+            specialTokens.banned_tokens_word_separators.emplace_back(i);
+        }
+    }
+
+    size_t n_vocab = llama_n_vocab(model->model());
+    for(int i=0; i < (int)n_vocab; i++) {
+        const char *text = model->adapter->getToken(i);
+        if(isFirstCharLowercase(text)) {
+            specialTokens.banned_tokens_for_first_capital.push_back(i);
+            specialTokens.banned_tokens_for_all_capitals.push_back(i);
+        }else if(hasLowercase(text)){
+            specialTokens.banned_tokens_for_all_capitals.push_back(i);
+        }
+
+        if(text[0] == '\'' || text[0] == '-') {
+            specialTokens.banned_start_of_word_tokens.push_back(i);
+        }
+    }
+
+    return true;
+}
+
+bool LanguageModelState::transform_logits(float *logits, size_t n_vocab, bool is_first_token, bool allow_correction_token, WordCapitalizeMode capitals, llama_token prev_token) {
+    for(size_t i = 0; i < n_vocab; i++) {
+        if(std::isnan(logits[i])){
+            return false;
+        }
+    }
+
+    softmax(logits, n_vocab);
+
+    for(int x : specialTokens.banned_tokens_word_separators) {
+        if(allow_correction_token && x == specialTokens.XEC) continue;
+
+        logits[specialTokens.SPACE] += std::max(0.0f, logits[x]);
+        logits[x] = -999.0f;
+    }
+
+    if(is_first_token) {
+        logits[specialTokens.SPACE] = -999.0f;
+
+        for(int i : specialTokens.banned_start_of_word_tokens) {
+            logits[i] = -999.0f;
+        }
+    }
+
+    for(int i : specialTokens.general_banned_tokens) {
+        logits[i] = -999.0f;
+    }
+
+    if(prev_token == specialTokens.DASH) {
+        logits[specialTokens.DASH] = -999.0f;
+    }
+
+    if(capitals == WordCapitalizeMode::FirstCapital && is_first_token) {
+        for(int i : specialTokens.banned_tokens_for_first_capital) {
+            logits[i] = -999.0f;
+        }
+    }else if(capitals == WordCapitalizeMode::AllCapitals) {
+        // Note: In case the word is something like "AMD's" we may not wish to ban lowercase completely
+        for(int i : specialTokens.banned_tokens_for_all_capitals) {
+            logits[i] = -999.0f;
+        }
+    }
+    return true;
+}
+
+int LanguageModelState::GetCachedMixAmount(const std::vector<TokenMix> &mixes) {
+    TIME_START(GetcachedMixAmount)
+    size_t i;
+    for(i = 0; i < std::min(past_mixes.size(), mixes.size()); i++) {
+        if(!isTokenMixRoughlyEqual(past_mixes[i], mixes[i])) break;
+    }
+
+    TIME_END(GetcachedMixAmount)
+
+    return (int)i;
+}
+
+DecodeResult LanguageModelState::DecodePromptAndMixes(token_sequence prompt, const std::vector<TokenMix> &mixes) {
+    TIME_START(PromptDecode)
+    STATS_TIMER_START(promptDecode);
+    llama_context *ctx = model->context();
+    llama_batch batch = model->adapter->batch;
+    LlamaAdapter *llamaAdapter = model->adapter.get();
+
+    // The mixes and the XBC token are decoded after the prompt, so they need room in the cache too
+    llamaAdapter->trimContext(prompt, mixes.size() + 1);
+
+    size_t n_embd = llama_n_embd(llama_get_model(ctx));
+    size_t n_vocab = llama_n_vocab(llama_get_model(ctx));
+
+    // When the oldest words were trimmed off the context, shift them out of the KV cache so only
+    // the new tokens at the end need to be decoded
+    auto shift = transformer_context_find_shift(model->transformerContext, prompt, LLAMA_CONTEXT_MIN_SHIFT_REUSE);
+    if(shift.discard > 0) {
+        llamaAdapter->shiftContext(shift);
+        transformer_context_apply_shift(model->transformerContext, shift);
+    }
+
+    auto prompt_ff = transformer_context_fastforward(model->transformerContext, prompt, !mixes.empty());
+
+    int n_batch = llamaAdapter->n_batch;
+
+    int head = -1;
+    if(!prompt_ff.first.empty()) {
+        for (size_t b = 0; b < (prompt_ff.first.size() + n_batch - 1) / n_batch; b++) {
+            batch.n_tokens = std::min((int)n_batch, (int)(prompt_ff.first.size() - b*n_batch));
+            for (int i = 0; i < batch.n_tokens; i++) {
+                batch.token[i] = prompt_ff.first[n_batch*b + i];
+                batch.pos[i] = (llama_pos)(prompt_ff.second + n_batch*b + i);
+                batch.seq_id[i][0] = 0;
+                batch.n_seq_id[i] = 1;
+                batch.logits[i] = false;
+            }
+
+            batch.logits[batch.n_tokens - 1] = (int8_t)(mixes.empty());
+            if(mixes.empty()) head = batch.n_tokens - 1;
+
+            llama_kv_cache_seq_rm(ctx, 0, (llama_pos)prompt_ff.second, -1);
+
+            if (llama_decode(ctx, batch) != 0) {
+                AKLOGE("llama_decode() failed");
+                return {};
+            }
+        }
+    } else {
+        //AKLOGI("No need to recompute prompt, proceeding to mixes");
+    }
+
+    transformer_context_apply(model->transformerContext, prompt_ff);
+    TIME_END(PromptDecode)
+    STATS_TIMER_END(promptDecode, PROMPT_DECODE, prompt_ff.first.size());
+
+    TIME_START(EmbedMixing)
+    STATS_TIMER_START(embedMix);
+    size_t size = prompt.size();
+
+    std::vector<float> embeds;
+
+    bool useEncoder = !llamaAdapter->encoder_weight.empty();
+    //AKLOGI("DecodePromptAndMixes: useEncoder=%d", useEncoder);
+
+    for(auto &mix : mixes) {
+
+        int num_added = 0;
+
+        std::vector<float> mix_f(n_embd, 0.0f);
+
+        if(useEncoder && mix.x >= 0.0f && mix.y >= 0.0f) {
+            num_added = 1;
+
+            for(size_t i=0; i<n_embd; i++) {
+                mix_f[i] = llamaAdapter->encoder_bias[i]
+                        + llamaAdapter->encoder_weight[i*2]*mix.x
+                        + llamaAdapter->encoder_weight[i*2 + 1]*mix.y;
+            }
+
+            //AKLOGI("DEBUG: pos %.4f %.4f got this: [%.4f %.4f %.4f %.4f %.4f %.4f %.4f ...",
+            //       mix.x, mix.y,
+            //             mix_f[0], mix_f[1], mix_f[2], mix_f[3], mix_f[4], mix_f[5], mix_f[6]);
+        } else {
+            for (auto &t: mix.mixes) {
+                if (t.weight < EPS) continue;
+                if (t.token < 0 || t.token >= (int)n_vocab) continue;
+
+                const float *src = llamaAdapter->getTokenEmbedding(t.token);
+                float weight = t.weight;
+
+                for (size_t i = 0; i < n_embd; i++) {
+                    mix_f[i] += src[i] * weight;
+                }
+
+                num_added++;
+            }
+        }
+
+        if(num_added == 0){
+            AKLOGE("Somehow a token mix had 0 weight for everything");
+            ASSERT(false);
+        }
+
+        embeds.insert(embeds.end(), mix_f.begin(), mix_f.end());
+        size++;
+    }
+    TIME_END(EmbedMixing)
+
+    TIME_START(CachedMixAmount)
+    int n_tokens = int32_t(mixes.size());
+    int n_past = GetCachedMixAmount(mixes);
+    past_mixes = mixes;
+
+    if(!prompt_ff.first.empty()) n_past = 0; // We have to recompute embeds completely if prompt changed
+    llama_kv_cache_seq_rm(ctx, 0, (llama_pos)prompt.size() + n_past, -1);
+    TIME_END(CachedMixAmount)
+
+    if(!embeds.empty()) {
+        TIME_START(DecodeEmbeds)
+        // TODO: This is only processing one embd at a time, increasing n_tokens doesn't seem to work
+        for(int h = n_past; h < n_tokens; h++ ) {
+            llama_batch embd_batch = {
+                    1,
+
+                    nullptr,
+                    embeds.data() + h*n_embd,
+                    batch.pos,
+                    batch.n_seq_id,
+                    batch.seq_id,
+                    batch.logits,
+
+                    batch.all_pos_0,
+                    batch.all_pos_1,
+                    batch.all_seq_id
+            };
+
+            batch.pos[0] = (llama_pos)(prompt.size() + h);
+            batch.seq_id[0][0] = 0;
+            batch.n_seq_id[0] = 1;
+            batch.logits[0] = false;
+
+            if (llama_decode(ctx, embd_batch) != 0) {
+                AKLOGE("llama_decode() with embeds failed");
+                return {};
+            }
+        }
+        TIME_END(DecodeEmbeds)
+        STATS_TIMER_END(embedMix, EMBED_MIX, n_tokens - n_past);
+
+        TIME_START(DecodeXBC)
+        STATS_TIMER_START(decodeXBC);
+
+        // We always force an XBC token after
+        size += 1;
+        batch.n_tokens = 1;
+        batch.token[0] = specialTokens.XBC;
+        batch.seq_id[0][0] = 0;
+        batch.n_seq_id[0] = 1;
+        batch.logits[0] = true;
+        batch.pos[0] = (llama_pos)(prompt.size() + n_tokens);
+        head = 0;
+
+        if (llama_decode(ctx, batch) != 0) {
+            AKLOGE("llama_decode() for XBC failed");
+            return {};
+        }
+
+        TIME_END(DecodeXBC)
+        STATS_TIMER_END(decodeXBC, XBC_DECODE, 1);
+
+        ASSERT(size == prompt.size() + n_tokens + 1);
+        ASSERT(size == prompt.size() + (embeds.size() / n_embd) + 1);
+    } else {
+        ASSERT(size == prompt.size());
+        //ASSERT(head == prompt_ff.first.size() - 1);
+    }
+
+    //AKLOGI("-- Decode");
+    //AKLOGI("First we processed the prompt (%d):", prompt_ff.first.size());
+    //for(auto t : prompt) {
+    //    AKLOGI(" - [%s]", model->getToken(t));
+    //}
+    //AKLOGI("Then %d embeds (cached %d)", embeds.size(), n_past);
+    //AKLOGI("The final size is %d and head is %d", size, head);
+
+    TIME_START(FinishRm)
+
+    llama_kv_cache_seq_rm(ctx, 0, (llama_pos)size, -1);
+
+    TIME_END(FinishRm)
+    return {
+        head,
+        (int)size
+    };
+}
+
+bool LanguageModelState::MatchesBanned(const token_sequence &prior, int prior_hash, llama_token next, const std::vector<banned_sequence> &banned_sequences) const {
+    int new_hash = append_sequence_hash(prior_hash, next);
+    for(const auto &banned_sequence : banned_sequences) {
+        if(banned_sequence.sequence.back() == specialTokens.STAR && (prior.size() >= banned_sequence.sequence.size() - 1)) {
+            bool matches = true;
+            for(size_t i = 0; i < banned_sequence.sequence.size() - 1; i++) {
+                if(prior[i] != banned_sequence.sequence[i]) {
+                    matches = false;
+                    break;
+                }
+            }
+
+            if(matches){
+                auto priorTxt = model->decode(prior);
+                auto nextTxt = model->decode({next});
+                auto bannedTxt = model->decode(banned_sequence.sequence);
+                //AKLOGI("Tokens [%s] + [%s] matches banned wildcard [%s]", priorTxt.c_str(), nextTxt.c_str(), bannedTxt.c_str());
+                return true;
+            }
+        }else if((banned_sequence.sequence.size() == prior.size() + 1) && (banned_sequence.hash == new_hash)) {
+            if(banned_sequence.sequence.back() == next) {
+                bool matches = true;
+                for(size_t i = 0; i < prior.size(); i++) {
+                    if(prior[i] != banned_sequence.sequence[i]) {
+                        matches = false;
+                        break;
+                    }
+                }
+
+                if(matches) {
+                    auto priorTxt = model->decode(prior);
+                    auto nextTxt = model->decode({next});
+                    auto bannedTxt = model->decode(banned_sequence.sequence);
+                    //AKLOGI("Tokens [%s] + [%s] matches banned [%s]", priorTxt.c_str(), nextTxt.c_str(), bannedTxt.c_str());
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+int LanguageModelState::GetBeamWidth(int n_needed, float max_entropy) {
+    if(max_entropy < SAMPLE_HIGH_ENTROPY) return n_needed;
+    return std::max(n_needed, std::min(n_needed * 2, SAMPLE_MAX_BEAM_WIDTH));
+}
+
+void LanguageModelState::BuildLexicon(TokenLexicon &lexicon, const std::vector<std::string> &words) const {
+    // Timed as a whole, the per-word tokenizations would swamp the TOKENIZE histogram of the typing path
+    latinime::StatsScopedTimer timer(latinime::StatsStage::LEXICON_BUILD);
+    timer.setItemCount((int)words.size());
+
+    std::vector<token_sequence> sequences;
+    sequences.reserve(words.size() * 2);
+    for(const std::string &w : words) {
+        std::string word = trim(w);
+        if(word.empty()) continue;
+
+        sequences.push_back(model->tokenizeUntimed(word + " "));
+        sequences.push_back(model->tokenizeUntimed(word));
+    }
+
+    lexicon.Build(std::move(sequences));
+}
+
+void LanguageModelState::SetLexicon(TokenLexicon &&lexicon) {
+    lexicons[LEXICON_DICTIONARY] = std::move(lexicon);
+}
+
+bool LanguageModelState::UseLexicon(WordCapitalizeMode capitals) {
+    if(lexicons[LEXICON_DICTIONARY].IsEmpty() || capitals != WordCapitalizeMode::IgnoredCapitals) return false;
+
+    const WordSet &glossary_words = wordSets[WORD_SET_GLOSSARY];
+    if(glossary_lexicon_version != glossary_words.version) {
+        BuildLexicon(lexicons[LEXICON_GLOSSARY], glossary_words.words);
+        glossary_lexicon_version = glossary_words.version;
+    }
+
+    return true;
+}
+
+void LanguageModelState::GetLexiconCandidates(const float *probs, const int *lexicon_nodes, bool allow_correction_token, std::vector<std::pair<float, int>> &outCandidates) const {
+    std::vector<int> tokens;
+    bool is_word_end = false;
+    for(int i = 0; i < NUM_LEXICONS; i++) {
+        const int node = lexicon_nodes[i];
+        if(node == TOKEN_LEXICON_NO_NODE) continue;
+
+        const int *children = lexicons[i].ChildTokens(node);
+        tokens.insert(tokens.end(), children, children + lexicons[i].ChildCount(node));
+        is_word_end = is_word_end || lexicons[i].IsWordEnd(node);
+    }
+
+    // transform_logits moved the probability of the other word separators to SPACE
+    if(is_word_end) {
+        tokens.push_back(specialTokens.SPACE);
+        if(allow_correction_token && specialTokens.XEC != -1) tokens.push_back(specialTokens.XEC);
+    }
+
+    std::sort(tokens.begin(), tokens.end());
+    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+
+    outCandidates.clear();
+    for(int token : tokens) {
+        // Banned by transform_logits
+        if(probs[token] <= 0.0f) continue;
+        outCandidates.emplace_back(probs[token], token);
+    }
+}
+
+std::vector<std::pair<float, token_sequence>> LanguageModelState::Sample(DecodeResult decodeResult, int n_results, WordCapitalizeMode capitals, const std::vector<banned_sequence> &banned_sequences, int64_t time_budget_us) {
+    const int64_t deadline = ggml_time_us() + time_budget_us;
+
+    llama_context *ctx = model->context();
+    llama_batch batch = model->adapter->batch;
+
+    size_t n_vocab = llama_n_vocab(llama_get_model(ctx));
+
+    n_results = std::min(n_results, SAMPLE_MAX_BEAM_WIDTH);
+
+    std::vector<potential_sequence> sequences;
+
+    bool allow_correction_token = decodeResult.logits_head == 0;
+
+    float *logits = llama_get_logits_ith(ctx, decodeResult.logits_head);
+    //AKLOGI("Value of [the ] before transform: %f", logits[561]);
+
+    bool is_bugged = logits[561] == 0.0f;
+
+    if(!transform_logits(logits, n_vocab, true, allow_correction_token, capitals, 0)) {
+        AKLOGE("logits have NaN!");
+        return { };
+    }
+
+    // TODO: This should really not be here
+    is_bugged = is_bugged && logits[561] < -990.0f && logits[561] > -1100.0f;
+    if(is_bugged) {
+        AKLOGE("Detected bug!!!! Trying to mitigate. Let's just reset cache and exit");
+        llama_kv_cache_seq_rm(ctx, -1, -1, -1);
+        model->transformerContext.active_context = { };
+        return { };
+    }
+
+    //AKLOGI("Value of [the ] after transform: %f", logits[561]);
+
+    int beam_width = GetBeamWidth(n_results, entropy(logits, n_vocab));
+
+    // Only the words' tokens are ranked instead of the whole vocabulary, and beams cannot be spent on
+    // non-words
+    const bool use_lexicon = UseLexicon(capitals);
+    int root_nodes[NUM_LEXICONS];
+    for(int i = 0; i < NUM_LEXICONS; i++) {
+        root_nodes[i] = (use_lexicon && !lexicons[i].IsEmpty()) ? TOKEN_LEXICON_ROOT : TOKEN_LEXICON_NO_NODE;
+    }
+
+    std::vector<std::pair<float, int>> index_value;
+    if(use_lexicon) {
+        GetLexiconCandidates(logits, root_nodes, allow_correction_token, index_value);
+    } else {
+        for (size_t i = 0; i < n_vocab; i++) {
+            index_value.emplace_back(logits[i], i);
+        }
+    }
+
+
+    sortProbabilityPairVectorDescending(index_value, beam_width * 2);
+    const token_sequence blank = {};
+    for(int i = 0; i < std::min(beam_width * 2, (int)index_value.size()); i++) {
+        if(MatchesBanned(blank, 0, index_value[i].second, banned_sequences)) {
+            index_value[i].first = 0.0f;
+        }
+    }
+    sortProbabilityPairVectorDescending(index_value, beam_width);
+    if(use_lexicon) {
+        beam_width = std::min(beam_width, (int)index_value.size());
+        while(beam_width > 0 && index_value[beam_width - 1].first <= 0.0f) beam_width--;
+        if(beam_width == 0) return { };
+    }
+
+    sequences.reserve(beam_width);
+    for (int i = 0; i < beam_width; i++) {
+        potential_sequence_data data { {index_value[i].second}, i, {} };
+        for(int j = 0; j < NUM_LEXICONS; j++) {
+            data.lexicon_nodes[j] = root_nodes[j] == TOKEN_LEXICON_NO_NODE ? TOKEN_LEXICON_NO_NODE
+                    : lexicons[j].Child(root_nodes[j], index_value[i].second);
+        }
+        sequences.emplace_back(index_value[i].first, std::move(data));
+    }
+
+    // TODO: This should really not be here
+    is_bugged = true;
+    for(const auto &seq : sequences) {
+        if(seq.second.tokens.front() > 48 || seq.first != sequences[0].first) {
+            is_bugged = false;
+            break;
+        }
+    }
+    if(is_bugged) {
+        AKLOGE("Detected bug2!!!! Trying to mitigate. Let's just reset cache and exit");
+        llama_kv_cache_seq_rm(ctx, -1, -1, -1);
+        model->transformerContext.active_context = { };
+        return { };
+    }
+
+
+    STATS_TIMER_START(initialCopies);
+    int num_copies = 0;
+    for (auto &sequence: sequences) {
+        if (sequence.second.seq_id == 0) continue;
+
+        llama_kv_cache_seq_rm(ctx, sequence.second.seq_id, -1, -1);
+        llama_kv_cache_seq_cp(ctx, 0, sequence.second.seq_id, 0, decodeResult.size);
+        num_copies++;
+    }
+    if(num_copies > 0) STATS_TIMER_END(initialCopies, KV_COPY, num_copies);
+
+    std::vector<potential_sequence> next_sequences;
+
+    std::vector<std::pair<float, token_sequence>> outputs;
+
+    for(int tok=0; tok<SAMPLE_MAX_TOKENS; tok++) {
+        next_sequences.clear();
+        for (auto sequence: std::move(sequences)) {
+            int next_token = sequence.second.tokens[sequence.second.tokens.size() - 1];
+
+            // Check if this is the end of correction
+            if (next_token == specialTokens.XEC) {
+                token_sequence resulting_tokens = std::move(sequence.second.tokens);
+                resulting_tokens.resize(resulting_tokens.size() - 1);
+                outputs.emplace_back(sequence.first, resulting_tokens);
+                continue;
+            }
+
+            // Check if this is the end of a word
+            std::string token = model->getToken(next_token);
+            if (token.size() >= 3 && (token[token.size() - 1] == '\x81') &&
+                (token[token.size() - 2] == '\x96') && token[token.size() - 3] == '\xe2') {
+                outputs.emplace_back(sequence.first, std::move(sequence.second.tokens));
+                continue;
+            }
+
+            next_sequences.emplace_back(sequence);
+        }
+
+        sequences = next_sequences;
+        next_sequences.clear();
+
+        // Probability of the n_results-th best finished word, open beams below it cannot make it into
+        // the results anymore
+        float cutoff = 0.0f;
+        if((int)outputs.size() >= n_results) {
+            sortProbabilityPairVectorDescending(outputs, n_results);
+            cutoff = outputs[n_results - 1].first;
+        }
+
+        sequences.erase(std::remove_if(sequences.begin(), sequences.end(), [&](const potential_sequence &seq) {
+            return seq.first <= cutoff;
+        }), sequences.end());
+
+        if (sequences.empty()) {
+            break;
+        }
+
+        if (ggml_time_us() > deadline) {
+            AKLOGI("Sample: time budget exceeded after %d tokens, returning %d results", tok, (int)outputs.size());
+            break;
+        }
+
+        latinime::StatsScopedTimer stepTimer(latinime::StatsStage::SAMPLE_STEP);
+        stepTimer.setItemCount((int)sequences.size());
+
+        int n_needed = std::max(1, n_results - (int)outputs.size());
+        batch.n_tokens = 0;
+
+        //for(int i=0; i<batch.n_tokens; i++) batch.logits[i] = false;
+        for (auto &sequence: sequences) {
+            batch.token[batch.n_tokens] = sequence.second.tokens[sequence.second.tokens.size() - 1];
+            batch.pos[batch.n_tokens] = (llama_pos)(decodeResult.size + (sequence.second.tokens.size() - 1));
+            batch.seq_id[batch.n_tokens][0] = sequence.second.seq_id;
+            batch.n_seq_id[batch.n_tokens] = 1;
+            batch.logits[batch.n_tokens] = true;
+
+            batch.n_tokens += 1;
+        }
+
+        if (llama_decode(ctx, batch) != 0) {
+            AKLOGE("llama_decode() for sampling failed");
+            break;
+        }
+
+        float max_entropy = 0.0f;
+        for (int seq = 0; seq < (int)sequences.size(); seq++) {
+            const potential_sequence &parent_seq = sequences[seq];
+            auto hash = compute_sequence_hash(parent_seq.second.tokens);
+
+            llama_token prev_token = 0;
+            if(!parent_seq.second.tokens.empty()) prev_token = parent_seq.second.tokens.back();
+
+            logits = llama_get_logits_ith(ctx, seq);
+            if(!transform_logits(logits, n_vocab, false, allow_correction_token, capitals, prev_token)) {
+                AKLOGE("Logits have NaN!");
+                return { };
+            }
+
+            max_entropy = std::max(max_entropy, entropy(logits, n_vocab));
+
+            index_value.clear();
+            if(use_lexicon) {
+                GetLexiconCandidates(logits, parent_seq.second.lexicon_nodes, allow_correction_token, index_value);
+            } else {
+                for (size_t i = 0; i < n_vocab; i++) {
+                    index_value.emplace_back(logits[i], i);
+                }
+            }
+
+            // Enough children to fill the widest beam the next step may use
+            int n_children = std::min(GetBeamWidth(n_needed, INFINITY), (int)index_value.size());
+
+            sortProbabilityPairVectorDescending(index_value, n_children * 2);
+            for(int i = 0; i < std::min(n_children * 2, (int)index_value.size()); i++) {
+                if(MatchesBanned(parent_seq.second.tokens, hash, index_value[i].second, banned_sequences)) {
+                    index_value[i].first = 0.0f;
+                }
+            }
+            sortProbabilityPairVectorDescending(index_value, n_children);
+
+            for (int i = 0; i < n_children; i++) {
+                float probability = index_value[i].first * parent_seq.first;
+
+                // Children are sorted, the remaining ones cannot beat the finished words either
+                if (probability <= cutoff) break;
+
+                token_sequence new_sequence = parent_seq.second.tokens;
+                new_sequence.push_back(index_value[i].second);
+
+                if (index_value[i].first > 1.0f || index_value[i].first < 0.0f) {
+                    AKLOGE("Expected index_value to be probability [%.2f]",
+                           index_value[i].first);
+                }
+
+                potential_sequence_data data { new_sequence, parent_seq.second.seq_id, {} };
+                for(int j = 0; j < NUM_LEXICONS; j++) {
+                    const int node = parent_seq.second.lexicon_nodes[j];
+                    data.lexicon_nodes[j] = (!use_lexicon || node == TOKEN_LEXICON_NO_NODE) ? TOKEN_LEXICON_NO_NODE
+                            : lexicons[j].Child(node, index_value[i].second);
+                }
+
+                next_sequences.emplace_back(probability, std::move(data));
+            }
+        }
+
+        beam_width = GetBeamWidth(n_needed, max_entropy);
+
+        sortProbabilityPairVectorDescending(next_sequences, beam_width);
+        if ((int)next_sequences.size() > beam_width) next_sequences.resize(beam_width);
+        sequences.clear();
+
+        // In some cases we may have picked a sequence from the same parent sequence
+        // We must re-assign the seq_id
+        int seq_id_use_count[SAMPLE_MAX_BEAM_WIDTH];
+        for (int i = 0; i < SAMPLE_MAX_BEAM_WIDTH; i++) seq_id_use_count[i] = 0;
+
+        for (auto &seq: next_sequences) seq_id_use_count[seq.second.seq_id] += 1;
+
+        for (auto &seq: next_sequences) {
+            if (seq_id_use_count[seq.second.seq_id] > 1) {
+                int old_seq_id = seq.second.seq_id;
+
+                int new_seq_id = -1;
+                for (int i = 0; i < SAMPLE_MAX_BEAM_WIDTH; i++) {
+                    if (seq_id_use_count[i] == 0) {
+                        new_seq_id = i;
+                        break;
+                    }
+                }
+
+                if (new_seq_id == -1) {
+                    AKLOGE("Couldn't find an empty sequence id to use. This should never happen.");
+                    return {};
+                }
+
+                seq_id_use_count[old_seq_id]--;
+                seq_id_use_count[new_seq_id]++;
+
+                // The tokens a dropped beam left under this id must not be attended to
+                STATS_TIMER_START(beamCopy);
+                llama_kv_cache_seq_rm(ctx, new_seq_id, decodeResult.size, -1);
+                llama_kv_cache_seq_cp(
+                        ctx,
+                        old_seq_id,
+                        new_seq_id,
+                        0, // ids beyond the first beam width do not hold the prompt yet
+                        (llama_pos)(decodeResult.size + (seq.second.tokens.size() - 1))
+                );
+                STATS_TIMER_END(beamCopy, KV_COPY, 1);
+
+                seq.second.seq_id = new_seq_id;
+            }
+        }
+
+        sequences = next_sequences;
+    }
+
+    for (int i = 1; i < SAMPLE_MAX_BEAM_WIDTH; i++) {
+        llama_kv_cache_seq_rm(ctx, i, 0, -1);
+    }
+
+    sortProbabilityPairVectorDescending(outputs);
+    if ((int)outputs.size() > n_results) outputs.resize(n_results);
+
+    return outputs;
+}
+
+std::vector<float> LanguageModelState::ScoreSequences(const DecodeResult &decodeResult, const std::vector<token_sequence> &sequences) {
+    llama_context *ctx = model->context();
+    llama_batch batch = model->adapter->batch;
+
+    size_t n_vocab = llama_n_vocab(llama_get_model(ctx));
+
+    // Cells of the previous chunk are freed before the next one, but the prompt's stay in use
+    int n_batch = std::min(model->adapter->n_batch, model->adapter->n_ctx - decodeResult.size);
+
+    std::vector<float> scores(sequences.size(), -INFINITY);
+
+    // The first token of every sequence is scored from the logits at the end of the prompt, which the
+    // decode below overwrites
+    const float *head_logits = llama_get_logits_ith(ctx, decodeResult.logits_head);
+    const float head_offset = logsumexp(head_logits, n_vocab);
+    for(size_t i = 0; i < sequences.size(); i++) {
+        if(sequences[i].empty()) continue;
+        scores[i] = head_logits[sequences[i][0]] - head_offset;
+    }
+
+    // Logits at the position of each token score the token after it, so the last token of a sequence
+    // is never decoded. targets[b] is the sequence and the token scored by the logits of batch index b
+    std::vector<std::pair<size_t, llama_token>> targets;
+
+    size_t next = 0;
+    while(next < sequences.size()) {
+        batch.n_tokens = 0;
+        targets.clear();
+
+        size_t first = next;
+        for(; next < sequences.size(); next++) {
+            const token_sequence &sequence = sequences[next];
+            if(sequence.size() < 2) continue;
+
+            int n_tokens = (int)sequence.size() - 1;
+            if(n_tokens > n_batch) {
+                AKLOGE("Sequence of %d tokens does not fit in a batch, leaving it unscored", (int)sequence.size());
+                scores[next] = -INFINITY;
+                continue;
+            }
+
+            if(batch.n_tokens + n_tokens > n_batch) break;
+
+            llama_seq_id seq_id = (llama_seq_id)(next + 1);
+            STATS_TIMER_START(candidateCopy);
+            llama_kv_cache_seq_cp(ctx, 0, seq_id, 0, decodeResult.size);
+            STATS_TIMER_END(candidateCopy, KV_COPY, 1);
+
+            for(int j = 0; j < n_tokens; j++) {
+                batch.token[batch.n_tokens] = sequence[j];
+                batch.pos[batch.n_tokens] = (llama_pos)(decodeResult.size + j);
+                batch.seq_id[batch.n_tokens][0] = seq_id;
+                batch.n_seq_id[batch.n_tokens] = 1;
+                batch.logits[batch.n_tokens] = true;
+                batch.n_tokens++;
+
+                targets.emplace_back(next, sequence[j + 1]);
+            }
+        }
+
+        if(batch.n_tokens > 0) {
+            if(llama_decode(ctx, batch) != 0) {
+                AKLOGE("llama_decode() for rescoring failed");
+                for(size_t i = first; i < next; i++) scores[i] = -INFINITY;
+            } else {
+                for(int b = 0; b < batch.n_tokens; b++) {
+                    const float *logits = llama_get_logits_ith(ctx, b);
+                    scores[targets[b].first] += logits[targets[b].second] - logsumexp(logits, n_vocab);
+                }
+            }
+        }
+
+        for(size_t i = first; i < next; i++) {
+            llama_kv_cache_seq_rm(ctx, (llama_seq_id)(i + 1), -1, -1);
+        }
+    }
+
+    return scores;
+}
+
+int64_t LanguageModelState::UpdateWordSet(int set, bool clear, const std::vector<std::string> &added, const std::vector<std::string> &removed) {
+    if(set < 0 || set >= NUM_WORD_SETS) {
+        AKLOGE("Unknown word set %d", set);
+        return -1;
+    }
+
+    WordSet &wordSet = wordSets[set];
+    if(clear) {
+        wordSet.words.clear();
+        wordSet.index.clear();
+    }
+
+    if(!removed.empty()) {
+        std::unordered_set<std::string> toRemove(removed.begin(), removed.end());
+        wordSet.words.erase(std::remove_if(wordSet.words.begin(), wordSet.words.end(),
+                [&](const std::string &w) { return toRemove.count(w) != 0; }), wordSet.words.end());
+        for(const std::string &w : removed) {
+            wordSet.index.erase(w);
+            if(set == WORD_SET_BANNED) banned_sequence_cache.erase(w);
+        }
+    }
+
+    for(const std::string &w : added) {
+        if(wordSet.index.insert(w).second) wordSet.words.push_back(w);
+    }
+
+    if(clear && set == WORD_SET_BANNED) banned_sequence_cache.clear();
+
+    return ++wordSet.version;
+}
+
+const std::vector<banned_sequence> &LanguageModelState::GetBannedSequences() {
+    const WordSet &banned_words = wordSets[WORD_SET_BANNED];
+    if(banned_sequences_version == banned_words.version) return banned_sequences;
+
+    banned_sequences.clear();
+    banned_sequences.reserve(banned_words.words.size() * 2);
+    for(const std::string &bw : banned_words.words) {
+        auto it = banned_sequence_cache.find(bw);
+        if(it == banned_sequence_cache.end()) {
+            auto tokenized = model->tokenize(trim(bw) + " ");
+            auto tokenized2 = model->tokenize(trim(bw));
+
+            it = banned_sequence_cache.emplace(bw, std::make_pair(
+                    banned_sequence { tokenized, compute_sequence_hash(tokenized) },
+                    banned_sequence { tokenized2, compute_sequence_hash(tokenized2) }
+            )).first;
+        }
+
+        banned_sequences.push_back(it->second.first);
+        banned_sequences.push_back(it->second.second);
+    }
+
+    banned_sequences_version = banned_words.version;
+    return banned_sequences;
+}
+
+std::string LanguageModelState::AddGlossary(const std::string &context) {
+    const WordSet &glossary_words = wordSets[WORD_SET_GLOSSARY];
+    if(glossary_version != glossary_words.version) {
+        glossary.clear();
+        for(const std::string &w : glossary_words.words) {
+            std::string word = trim(w);
+            if(word.empty()) continue;
+            glossary += glossary.empty() ? "(Glossary: " : ", ";
+            glossary += word;
+        }
+        if(!glossary.empty()) glossary += ")\n\n";
+
+        glossary_version = glossary_words.version;
+    }
+
+    if(glossary.empty()) return context;
+    return glossary + context;
+}
+
+std::vector<std::pair<float, std::string>> LanguageModelState::PredictNextWord(const std::string &context) {
+    const std::vector<banned_sequence> &banned_sequences = GetBannedSequences();
+
+    token_sequence next_context = model->tokenizeIncremental(trim(AddGlossary(context)) + " ");
+    next_context.insert(next_context.begin(), 1); // BOS
+
+    auto decoding_result = DecodePromptAndMixes(next_context, { });
+    auto results = Sample(decoding_result, 3, WordCapitalizeMode::IgnoredCapitals, banned_sequences);
+
+    std::vector<std::pair<float, std::string>> str_results;
+    str_results.reserve(results.size());
+    for(const auto& result : results) {
+        str_results.emplace_back(result.first, model->decode(result.second));
+    }
+
+    return str_results;
+}
+
+std::vector<std::pair<float, std::string>> LanguageModelState::PredictCorrection(const std::string &context, const std::vector<TokenMix> &mixes, bool swipe_mode, WordCapitalizeMode capitals) {
+    if(specialTokens.XBU == -1) return { };
+
+    const std::vector<banned_sequence> &banned_sequences = GetBannedSequences();
+
+    const std::string full_context = AddGlossary(context);
+    token_sequence next_context;
+    if(!full_context.empty()) {
+        next_context = model->tokenizeIncremental(trim(full_context) + " ");
+    }
+
+    next_context.insert(next_context.begin(), 1); // BOS
+    next_context.push_back(specialTokens.XBU);
+
+    if(swipe_mode) {
+        next_context.push_back(specialTokens.XC0_SWIPE_MODE);
+    }
+
+    auto decoding_result = DecodePromptAndMixes(next_context, mixes);
+    auto results = Sample(decoding_result, 3, capitals, banned_sequences);
+
+    std::vector<std::pair<float, std::string>> str_results;
+    str_results.reserve(results.size());
+    for(const auto& result : results) {
+        str_results.emplace_back(result.first, model->decode(result.second));
+    }
+
+    return str_results;
+}
+std::vector<TokenMix> LanguageModelState::BuildTokenMixes(const latinime::ProximityInfo *pInfo, const std::string &partialWord, const int *xCoordinates, const int *yCoordinates, size_t inputSize) const {
+    TIME_START(GettingMixes)
+    if(partialWord.size() < inputSize) inputSize = partialWord.size();
+
+    std::vector<TokenMix> mixes;
+    int numSkippedDueToNoCoordinate = 0;
+    for(size_t i=0; i<inputSize; i++) {
+        char wc = partialWord[i];
+        if (!(wc >= 'a' && wc <= 'z') && !(wc >= 'A' && wc <= 'Z')) {
+            //AKLOGI("%d | Char %c skipped due to not within range", i, wc);
+            continue;
+        }
+        if (xCoordinates[i] == -1 || yCoordinates[i] == -1) {
+            //AKLOGI("%d | Char %c skipped due to -1", i, wc);
+            numSkippedDueToNoCoordinate++;
+            continue;
+        }
+
+        std::vector<float> proportions = pInfo->decomposeTapPosition(xCoordinates[i], yCoordinates[i]);
+        for(float &f : proportions) {
+            if(f < 0.05f) f = 0.0f;
+        }
+
+        std::vector<std::pair<float, int>> index_value;
+        index_value.clear();
+        for (size_t k = 0; k < proportions.size(); k++) {
+            index_value.emplace_back(proportions[k], k);
+        }
+
+        sortProbabilityPairVectorDescending(index_value, NUM_TOKEN_MIX);
+
+        bool needs_resorting = false;
+        int num_symbols = 0;
+        for(int s=0; s<4; s++) {
+            num_symbols = 0;
+            for (int j = 0; j < NUM_TOKEN_MIX; j++) {
+                char c = (char) (pInfo->getKeyCodePoint(index_value[j].second));
+
+                if (c >= 'a' && c <= 'z') {
+                } else if (c >= 'A' && c <= 'Z') {
+                } else if(index_value[j].first > 0.0f) {
+                    index_value[j].first = 0.0f;
+                    needs_resorting = true;
+                    num_symbols++;
+                }
+            }
+            if(num_symbols == NUM_TOKEN_MIX) break;
+            if(!needs_resorting) break;
+            sortProbabilityPairVectorDescending(index_value, NUM_TOKEN_MIX);
+        }
+        if(num_symbols == NUM_TOKEN_MIX) {
+            //AKLOGI("%d | Char %c skipped due to num_symbols == NUM_TOKEN_MIX", i, wc);
+            continue;
+        } // Skip the symbol character
+
+        float total_sum = 0.0f;
+        for(int j=0; j<NUM_TOKEN_MIX; j++) {
+            total_sum += index_value[j].first;
+        }
+
+        if(total_sum == 0.0f) {
+            numSkippedDueToNoCoordinate++;
+            continue;
+        }
+
+        for(int j=0; j<NUM_TOKEN_MIX; j++) {
+            index_value[j].first /= total_sum;
+        }
+
+        TokenMix results {};
+        results.x = ((float)xCoordinates[i]) / ((float)pInfo->getKeyboardWidth());
+        results.y = ((float)yCoordinates[i]) / ((float)pInfo->getKeyboardHeight());
+
+        //AKLOGI("%d | Char %c, pos %.6f %.6f, nearest is %c at %.2f, then %c at %.2f, finally %c at %.2f", i, partialWord[i],
+        //       results.x, results.y,
+        //       (char)(pInfo->getKeyCodePoint(index_value[0].second)), (float)(index_value[0].first),
+        //       (char)(pInfo->getKeyCodePoint(index_value[1].second)), (float)(index_value[1].first),
+        //       (char)(pInfo->getKeyCodePoint(index_value[2].second)), (float)(index_value[2].first)
+        //   );
+
+
+        for(int j=0; j<NUM_TOKEN_MIX; j++) {
+            char c = (char) (pInfo->getKeyCodePoint(index_value[j].second));
+            float w = index_value[j].first;
+
+            results.mixes[j].weight = w;
+            if(c >= 'a' && c <= 'z') {
+                results.mixes[j].token = (specialTokens.LETTERS_TO_IDS[c - 'a']);
+            }else if(c >= 'A' && c <= 'Z') {
+                results.mixes[j].token = (specialTokens.LETTERS_TO_IDS[c - 'A']);
+            } else {
+                //AKLOGI("ignoring character in partial word [%c]", c);
+                results.mixes[j].weight = 0.0f;
+            }
+        }
+
+        mixes.push_back(results);
+    }
+
+    if(mixes.empty() && numSkippedDueToNoCoordinate > 0) {
+        AKLOGI("BUG: Mixes is empty due to lacking input coordinates. Falling back to non-mixing");
+        for(size_t i=0; i<inputSize; i++) {
+            char wc = partialWord[i];
+            if (!(wc >= 'a' && wc <= 'z') && !(wc >= 'A' && wc <= 'Z')) {
+                continue;
+            }
+
+
+            TokenMix results {};
+            results.x = -1.0f;
+            results.y = -1.0f;
+
+            for(int j=0; j<NUM_TOKEN_MIX; j++) {
+                results.mixes[j].weight = 0.0f;
+
+                if(wc >= 'a' && wc <= 'z') {
+                    results.mixes[j].token = (specialTokens.LETTERS_TO_IDS[wc - 'a']);
+                }else if(wc >= 'A' && wc <= 'Z') {
+                    results.mixes[j].token = (specialTokens.LETTERS_TO_IDS[wc - 'A']);
+                }
+            }
+
+            results.mixes[0].weight = 1.0f;
+
+            mixes.push_back(results);
+        }
+
+    }
+
+    TIME_END(GettingMixes)
+    return mixes;
+}
+
+const char *LanguageModelState::GetSuggestions(const latinime::ProximityInfo *pInfo, const std::string &context, const std::string &partialWord, int inputMode, const int *xCoordinates, const int *yCoordinates, size_t inputSize, float autocorrectThreshold, std::vector<std::pair<float, std::string>> &outResults) {
+    WordCapitalizeMode capitals = WordCapitalizeMode::IgnoredCapitals;
+
+    if(!partialWord.empty() && !isFirstCharLowercase(partialWord.c_str())) {
+        if(partialWord.size() > 1 && !hasLowercase(partialWord.c_str())) {
+            capitals = WordCapitalizeMode::AllCapitals;
+        } else {
+            capitals = WordCapitalizeMode::FirstCapital;
+        }
+    }
+
+    //AKLOGI("LanguageModel context [%s]", context.c_str());
+
+    std::vector<std::pair<float, std::string>> &results = outResults;
+    if(partialWord.empty()) {
+        results = PredictNextWord(context);
+
+        //for(const auto &result : results) {
+        //    AKLOGI("LanguageModel suggestion %.2f [%s]", result.first, result.second.c_str());
+        //}
+    } else {
+        std::vector<TokenMix> mixes = BuildTokenMixes(pInfo, partialWord, xCoordinates, yCoordinates, inputSize);
+
+        bool swipeMode = inputMode == 1;
+        results = PredictCorrection(context, mixes, swipeMode, capitals);
+
+        //for(const auto &result : results) {
+        //    AKLOGI("LanguageModel correction %.2f [%s] -> [%s]", result.first, partialWord.c_str(), result.second.c_str());
+        //}
+
+        // Exact match rule
+        bool hasExactMatch = false;
+        for(const auto &result : results) {
+            if(isExactMatch(result.second, partialWord)) {
+                hasExactMatch = true;
+            }
+        }
+        if(hasExactMatch){
+            for(auto &result : results) {
+                if(!isExactMatch(result.second, partialWord)) {
+                    result.first -= 1.0f;
+                }
+            }
+        }
+    }
+
+    // Probability check
+    sortProbabilityPairVectorDescending(results);
+
+    const char *result_probability_mode;
+    if(results.size() < 2) {
+        // Not sure what to do here
+        result_probability_mode = RETURNVAL_UNCERTAIN;
+    }else if(results[0].first > autocorrectThreshold * results[1].first) {
+        result_probability_mode = RETURNVAL_AUTOCORRECT;
+    }else if(results[0].first > (autocorrectThreshold * 0.1f) * results[1].first) {
+        result_probability_mode = RETURNVAL_UNCERTAIN;
+    } else {
+        result_probability_mode = RETURNVAL_CLUELESS;
+        // TODO: If we end up here, we could try sampling differently / etc
+    }
+
+    // No way it's correct if it's way shorter! (unless we're swipe typing)
+    if(!results.empty() && !partialWord.empty() && (results[0].second.size() * 2 < partialWord.size()) && inputMode != 1) {
+        result_probability_mode = RETURNVAL_CLUELESS;
+    }
+
+    return result_probability_mode;
+}
+
+struct SuggestionItemToRescore {
+    int index;
+
+    int originalScore;
+    float transformedScore;
+
+    std::string word;
+    token_sequence tokens;
+};
+
+std::vector<int> LanguageModelState::RescoreSuggestions(const std::string &context, const std::vector<std::string> &words, const std::vector<int> &scores) {
+    float maxScore = -INFINITY;
+    float minScore = INFINITY;
+    for(int score : scores) {
+        auto scoref = (float)score;
+
+        if(scoref > maxScore) maxScore = scoref;
+        if(scoref < minScore) minScore = scoref;
+    }
+
+    minScore -= (maxScore - minScore) * 0.33f;
+
+    std::vector<SuggestionItemToRescore> items;
+    for(size_t i=0; i<words.size(); i++) {
+        SuggestionItemToRescore item = {
+            (int) i,
+            scores[i],
+            ((float)scores[i] - minScore) / (maxScore - minScore),
+            words[i],
+            {}
+        };
+
+        item.tokens = model->tokenize(trim(item.word) + " ");
+        items.push_back(item);
+    }
+
+
+    // The context is only decoded again where it changed since the last call
+    token_sequence next_context = model->tokenizeIncremental(trim(AddGlossary(context)) + " ");
+    next_context.insert(next_context.begin(), 1); // BOS
+
+    auto decoding_result = DecodePromptAndMixes(next_context, { });
+
+    std::vector<token_sequence> sequences;
+    sequences.reserve(items.size());
+    for(const auto &entry : items) {
+        sequences.push_back(entry.tokens);
+    }
+
+    std::vector<float> logLikelihoods = ScoreSequences(decoding_result, sequences);
+
+    for(size_t i = 0; i < items.size(); i++) {
+        auto &entry = items[i];
+        float probability = expf(logLikelihoods[i]);
+        if(DEBUG_DICT) {
+            AKLOGI("Word [%s], %d tokens, log-likelihood = %.4f", entry.word.c_str(), (int)entry.tokens.size(), logLikelihoods[i]);
+        }
+        entry.transformedScore *= probability * RESCORE_PROBABILITY_SCALE;
+    }
+
+    std::vector<int> outScores(scores.size(), 0);
+    for(const auto &entry : items) {
+        outScores[entry.index] = (int)(entry.transformedScore * (maxScore - minScore) + minScore);
+    }
+
+    return outScores;
+}
@@ -0,0 +1,196 @@
+//
+// Keyboard language model engine: prompt decoding with embedding mixing, beam search sampling and
+// rescoring, independent of JNI so it can also run in host tools
+//
+
+#ifndef LATINIME_LANGUAGEMODELSTATE_H
+#define LATINIME_LANGUAGEMODELSTATE_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "LanguageModel.h"
+#include "TokenLexicon.h"
+
+namespace latinime {
+    class ProximityInfo;
+} // namespace latinime
+
+#define RETURNVAL_AUTOCORRECT "autocorrect"
+#define RETURNVAL_UNCERTAIN "uncertain"
+#define RETURNVAL_CLUELESS "clueless"
+
+// Word lists Sample can limit its beams to
+#define LEXICON_DICTIONARY 0
+#define LEXICON_GLOSSARY 1
+#define NUM_LEXICONS 2
+
+typedef struct potential_sequence_data {
+    token_sequence tokens;
+    llama_seq_id seq_id{};
+    // Node of the tokens in each lexicon, TOKEN_LEXICON_NO_NODE once they leave it
+    int lexicon_nodes[NUM_LEXICONS];
+} potential_sequence_data;
+
+// P = P(tokens[0]) * P(tokens[1]) * [...]
+typedef std::pair<float, potential_sequence_data> potential_sequence;
+
+
+typedef struct banned_sequence {
+    token_sequence sequence;
+    int hash;
+} banned_sequence;
+
+// Maximum number of tokens Sample generates for a word
+#define SAMPLE_MAX_TOKENS 10
+
+// Upper bound on the beams (and results) of Sample, each beam holds a seq_id in the KV cache
+#define SAMPLE_MAX_BEAM_WIDTH 6
+
+// Entropy (nats) of the next token distribution above which Sample widens its beam
+#define SAMPLE_HIGH_ENTROPY 2.5f
+
+// Default latency budget of a Sample call in microseconds
+#define SAMPLE_TIME_BUDGET_US 200000
+
+// RescoreSuggestions multiplies the normalized score of each word by its probability under the model
+// and this scale. A word the model gives 1 in 1000 keeps its score, likelier ones move up and less likely
+// ones down: plausible candidates for the next word mostly fall around that probability, so the scale
+// keeps the rescored words within the range the dictionary scores are mapped back to
+#define RESCORE_PROBABILITY_SCALE 1000.0f
+
+#define NUM_TOKEN_MIX 4
+
+// Word sets kept by LanguageModelState, must match LanguageModel.kt
+#define WORD_SET_BANNED 0
+#define WORD_SET_GLOSSARY 1
+#define NUM_WORD_SETS 2
+struct TokenMix {
+    float x;
+    float y;
+    struct {
+        float weight;
+        llama_token token;
+    } mixes[NUM_TOKEN_MIX];
+};
+
+
+struct DecodeResult {
+    int logits_head;
+    int size;
+};
+
+enum WordCapitalizeMode {
+    IgnoredCapitals, // partialWord = "t"  or partialWord = "test"
+    FirstCapital,    // partialWord = "T"  or partialWord = "Test"
+    AllCapitals      // partialWord = "TE" or partialWord = "TEST"
+};
+
+
+struct LanguageModelState {
+    std::unique_ptr<LanguageModel> model;
+
+    struct {
+        int SPACE = 0;
+
+        int XBU = 0;
+        int XBC = 0;
+        int XEC = 0;
+
+        int XC0_SWIPE_MODE = 0;
+
+        int DASH = 0;
+        int STAR = 0;
+
+        int LETTERS_TO_IDS[26] = { 0 };
+
+        std::vector<int> banned_start_of_word_tokens;
+        std::vector<int> banned_tokens_for_first_capital;
+        std::vector<int> banned_tokens_for_all_capitals;
+        std::vector<int> banned_tokens_word_separators; // probabilities add to space token
+        std::vector<int> general_banned_tokens;
+    } specialTokens;
+
+    bool Initialize(const std::string &paths, const std::string &adapterPath);
+
+    bool transform_logits(float *logits, size_t n_vocab, bool is_first_token, bool allow_correction_token, WordCapitalizeMode capitals, llama_token prev_token);
+
+    std::vector<TokenMix> past_mixes = { };
+    int GetCachedMixAmount(const std::vector<TokenMix> &mixes);
+
+    DecodeResult DecodePromptAndMixes(token_sequence prompt, const std::vector<TokenMix> &mixes);
+
+    bool MatchesBanned(const token_sequence &prior, int prior_hash, llama_token next, const std::vector<banned_sequence> &banned_sequences) const;
+
+    // Number of beams for the next step. Once the candidates for the next token get uncertain, more
+    // beams than results are kept so a likely word does not get lost behind an unlikely first token
+    static int GetBeamWidth(int n_needed, float max_entropy);
+
+    // Beam search for up to n_results words. Words are finished by a word separator token or XEC, open
+    // beams which can no longer beat the finished words are dropped (a beam's probability only goes down
+    // as tokens are added), and the words finished so far are returned once time_budget_us has passed.
+    // While a lexicon is set, beams only take tokens that continue one of its words
+    std::vector<std::pair<float, token_sequence>> Sample(DecodeResult decodeResult, int n_results, WordCapitalizeMode capitals, const std::vector<banned_sequence> &banned_sequences, int64_t time_budget_us = SAMPLE_TIME_BUDGET_US);
+
+    // Log-likelihood of each sequence following the decoded prompt. The sequences are packed into one
+    // batch, each under its own seq_id sharing the prompt's cells in the KV cache, so all of them are
+    // scored by a single decode unless they do not fit in a batch
+    std::vector<float> ScoreSequences(const DecodeResult &decodeResult, const std::vector<token_sequence> &sequences);
+
+    // Banned words and the personal dictionary rarely change between keystrokes, so they live
+    // here and Java only sends the words that were added or removed
+    struct WordSet {
+        std::vector<std::string> words; // in the order they were added
+        std::unordered_set<std::string> index;
+        int64_t version = 0;
+    } wordSets[NUM_WORD_SETS];
+
+    int64_t UpdateWordSet(int set, bool clear, const std::vector<std::string> &added, const std::vector<std::string> &removed);
+
+    std::unordered_map<std::string, std::pair<banned_sequence, banned_sequence>> banned_sequence_cache;
+    std::vector<banned_sequence> banned_sequences;
+    int64_t banned_sequences_version = -1;
+    const std::vector<banned_sequence> &GetBannedSequences();
+
+    // The personal dictionary is listed before the context, as the model was trained with
+    std::string glossary;
+    int64_t glossary_version = -1;
+    std::string AddGlossary(const std::string &context);
+
+    // The main dictionary, built by the caller and handed over with SetLexicon, and the personal
+    // dictionary, rebuilt from the glossary word set. While the main dictionary's is empty, Sample is
+    // unconstrained
+    TokenLexicon lexicons[NUM_LEXICONS];
+    int64_t glossary_lexicon_version = -1;
+
+    // Words are tokenized as they end before a space and before XEC. Only reads the tokenizer, so it
+    // may run on another thread than Sample
+    void BuildLexicon(TokenLexicon &lexicon, const std::vector<std::string> &words) const;
+    void SetLexicon(TokenLexicon &&lexicon);
+
+    // Lexicon words are spelled as listed, so the capitalized modes are not constrained
+    bool UseLexicon(WordCapitalizeMode capitals);
+
+    // Tokens continuing a word from the nodes, and the word separators if a word ends there, with their
+    // probability
+    void GetLexiconCandidates(const float *probs, const int *lexicon_nodes, bool allow_correction_token, std::vector<std::pair<float, int>> &outCandidates) const;
+
+    std::vector<std::pair<float, std::string>> PredictNextWord(const std::string &context);
+
+    std::vector<std::pair<float, std::string>> PredictCorrection(const std::string &context, const std::vector<TokenMix> &mixes, bool swipe_mode, WordCapitalizeMode capitals);
+
+    // Tap positions of the partial word as mixes of the letters under them, for embedding mixing
+    std::vector<TokenMix> BuildTokenMixes(const latinime::ProximityInfo *pInfo, const std::string &partialWord, const int *xCoordinates, const int *yCoordinates, size_t inputSize) const;
+
+    // Next word predictions (empty partialWord) or corrections of the partial word, sorted by probability.
+    // Returns one of the RETURNVAL_ modes telling how confident the top result is
+    const char *GetSuggestions(const latinime::ProximityInfo *pInfo, const std::string &context, const std::string &partialWord, int inputMode, const int *xCoordinates, const int *yCoordinates, size_t inputSize, float autocorrectThreshold, std::vector<std::pair<float, std::string>> &outResults);
+
+    // Scores of the dictionary suggestions weighted by how likely the language model finds each word
+    std::vector<int> RescoreSuggestions(const std::string &context, const std::vector<std::string> &words, const std::vector<int> &scores);
+};
+
+#endif //LATINIME_LANGUAGEMODELSTATE_H
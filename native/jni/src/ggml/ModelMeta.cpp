@@ -18,9 +18,26 @@ do { \
     } \
 } while (0)
 
-struct ModelMetadata loadModelMetadata(const std::string &modelPath) {
-    struct ModelMetadata result;
+bool getModelTokenizerData(const gguf_context *ctx_gguf, const char **data, size_t *size) {
+    const int kid = gguf_find_key(ctx_gguf, META_KEY_TOKENIZER_DATA_ARR);
+    if (kid < 0) {
+        AKLOGE("key not found in model: %s", META_KEY_TOKENIZER_DATA_ARR);
+        return false;
+    }
 
+    enum gguf_type ktype = gguf_get_kv_type(ctx_gguf, kid);
+    if (ktype != GGUF_TYPE_ARRAY) {
+        AKLOGE("key %s has wrong type: %s", META_KEY_TOKENIZER_DATA_ARR,
+               gguf_type_name(ktype));
+        return false;
+    }
+
+    *data = (const char*)gguf_get_arr_data(ctx_gguf, kid);
+    *size = gguf_get_arr_n(ctx_gguf, kid);
+    return true;
+}
+
+struct ModelMetadata loadModelMetadata(const std::string &modelPath, bool loadTokenizerData) {
     struct gguf_init_params params = {
             /*.no_alloc = */ true,
             /*.ctx      = */ nullptr,
@@ -28,10 +45,21 @@ struct ModelMetadata loadModelMetadata(const std::string &modelPath) {
 
     struct gguf_context *ctx_gguf = gguf_init_from_file(modelPath.c_str(), params);
     if(ctx_gguf == NULL) {
+        struct ModelMetadata result;
         result.error = true;
         return result;
     }
 
+    struct ModelMetadata result = loadModelMetadata(ctx_gguf, loadTokenizerData);
+
+    gguf_free(ctx_gguf);
+
+    return result;
+}
+
+struct ModelMetadata loadModelMetadata(const gguf_context *ctx_gguf, bool loadTokenizerData) {
+    struct ModelMetadata result;
+
     std::string languages;
     std::string features;
     std::string ext_tokenizer_type;
@@ -48,28 +76,16 @@ struct ModelMetadata loadModelMetadata(const std::string &modelPath) {
     GGUF_GET_KEY(ctx_gguf, result.history, gguf_get_val_str, GGUF_TYPE_STRING, false, META_KEY_HISTORY_STR);
     GGUF_GET_KEY(ctx_gguf, features, gguf_get_val_str, GGUF_TYPE_STRING, false, META_KEY_FEATURES_STR);
     GGUF_GET_KEY(ctx_gguf, ext_tokenizer_type, gguf_get_val_str, GGUF_TYPE_STRING, false, META_KEY_TOKENIZER_TYPE_STR);
+    GGUF_GET_KEY(ctx_gguf, result.context_length, gguf_get_val_u32, GGUF_TYPE_UINT32, false, META_KEY_CONTEXT_LENGTH_U32);
+    GGUF_GET_KEY(ctx_gguf, result.kv_cache_type, gguf_get_val_str, GGUF_TYPE_STRING, false, META_KEY_KV_CACHE_TYPE_STR);
 
     // Get tokenizer data
-    const int kid = gguf_find_key(ctx_gguf, META_KEY_TOKENIZER_DATA_ARR);
-    if (kid >= 0) {
-        enum gguf_type ktype = gguf_get_kv_type(ctx_gguf, kid);
-        if (ktype != GGUF_TYPE_ARRAY) {
-            AKLOGE("key %s has wrong type: %s", META_KEY_TOKENIZER_DATA_ARR,
-                   gguf_type_name(ktype));
-        }
-
-        const char *data = (const char*)gguf_get_arr_data(ctx_gguf, kid);
-        size_t len = gguf_get_arr_n(ctx_gguf, kid);
-
-        // sentencepiece library wants string_view, so we'll just store it as string
-        result.ext_tokenizer_data = std::string(data, len);
-    } else {
-        AKLOGE("key not found in model: %s", META_KEY_TOKENIZER_DATA_ARR);
+    const char *tokenizer_data;
+    size_t tokenizer_size;
+    if(loadTokenizerData && getModelTokenizerData(ctx_gguf, &tokenizer_data, &tokenizer_size)) {
+        result.ext_tokenizer_data = std::string(tokenizer_data, tokenizer_size);
     }
 
-    gguf_free(ctx_gguf);
-
-
     std::istringstream languages_iss(languages);
     std::string temp;
     while (languages_iss >> temp) {
@@ -123,6 +139,14 @@ int writeModelMetadata(gguf_context *fctx, const ModelMetadata &metadata) {
     gguf_set_val_str(fctx, META_KEY_HISTORY_STR, metadata.history.c_str());
     gguf_set_val_str(fctx, META_KEY_FEATURES_STR, features_combined.c_str());
 
+    if(metadata.context_length != 0) {
+        gguf_set_val_u32(fctx, META_KEY_CONTEXT_LENGTH_U32, metadata.context_length);
+    }
+
+    if(!metadata.kv_cache_type.empty()) {
+        gguf_set_val_str(fctx, META_KEY_KV_CACHE_TYPE_STR, metadata.kv_cache_type.c_str());
+    }
+
     const char *tokenizer_type;
     switch(metadata.ext_tokenizer_type) {
         case ExternalTokenizerType::None:
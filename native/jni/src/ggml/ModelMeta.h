@@ -18,6 +18,8 @@
 #define META_KEY_FEATURES_STR           "keyboardlm.features"
 #define META_KEY_TOKENIZER_TYPE_STR     "keyboardlm.ext_tokenizer_type"
 #define META_KEY_TOKENIZER_DATA_ARR     "keyboardlm.ext_tokenizer_data"
+#define META_KEY_CONTEXT_LENGTH_U32     "keyboardlm.context_length"
+#define META_KEY_KV_CACHE_TYPE_STR      "keyboardlm.kv_cache_type"
 
 #define META_TOKENIZER_SENTENCEPIECE "sentencepiece"
 
@@ -46,13 +48,23 @@ public:
     ExternalTokenizerType ext_tokenizer_type = None;
     std::string ext_tokenizer_data = "";
 
+    // Context budget and KV cache element type (ggml type name, e.g. "q8_0") the keyboard should run the
+    // model with. 0 and empty leave the defaults
+    uint32_t context_length = 0;
+    std::string kv_cache_type = "";
+
     inline bool HasFeature(const std::string &feature) const {
         return features.find(feature) != features.end();
     }
 };
 
 
-struct ModelMetadata loadModelMetadata(const std::string &modelPath);
+// Listing models does not need the tokenizer, which is the bulk of the metadata, so it can be skipped
+struct ModelMetadata loadModelMetadata(const std::string &modelPath, bool loadTokenizerData = true);
+struct ModelMetadata loadModelMetadata(const gguf_context *ctx_gguf, bool loadTokenizerData = true);
+
+// Points the tokenizer data at the array stored in ctx_gguf without copying it. Returns false if there is none
+bool getModelTokenizerData(const gguf_context *ctx_gguf, const char **data, size_t *size);
 int writeModelMetadata(gguf_context *fctx, const ModelMetadata &metadata);
 
 #endif
\ No newline at end of file
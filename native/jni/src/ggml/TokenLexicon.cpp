@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TokenLexicon.h"
+
+#include <algorithm>
+
+void TokenLexicon::Build(std::vector<token_sequence> sequences) {
+    Clear();
+
+    sequences.erase(std::remove_if(sequences.begin(), sequences.end(),
+            [](const token_sequence &seq) { return seq.empty(); }), sequences.end());
+
+    // Sorted, the sequences below a node form one range and its children are subranges of it
+    std::sort(sequences.begin(), sequences.end());
+    sequences.erase(std::unique(sequences.begin(), sequences.end()), sequences.end());
+
+    BuildNode(TOKEN_LEXICON_ROOT, sequences, 0, sequences.size(), 0);
+
+    nodes.shrink_to_fit();
+    child_tokens.shrink_to_fit();
+    child_nodes.shrink_to_fit();
+}
+
+void TokenLexicon::Clear() {
+    nodes.assign(1, Node { 0, 0, false });
+    child_tokens.clear();
+    child_nodes.clear();
+}
+
+void TokenLexicon::BuildNode(int node, const std::vector<token_sequence> &sequences, size_t begin, size_t end, size_t depth) {
+    // The sequence ending here sorts before the ones it is a prefix of
+    if(begin < end && sequences[begin].size() == depth) {
+        nodes[node].is_word_end = true;
+        begin++;
+    }
+
+    std::vector<size_t> child_begins;
+    for(size_t i = begin; i < end; i++) {
+        if(i == begin || sequences[i][depth] != sequences[i - 1][depth]) child_begins.push_back(i);
+    }
+    child_begins.push_back(end);
+
+    const int child_count = (int)child_begins.size() - 1;
+    const int first_child = (int)child_tokens.size();
+    nodes[node].first_child = first_child;
+    nodes[node].child_count = child_count;
+
+    // The whole block of children is laid out before any grandchild
+    for(int i = 0; i < child_count; i++) {
+        child_tokens.push_back(sequences[child_begins[i]][depth]);
+        child_nodes.push_back((int32_t)nodes.size());
+        nodes.push_back(Node { 0, 0, false });
+    }
+
+    for(int i = 0; i < child_count; i++) {
+        BuildNode(child_nodes[first_child + i], sequences, child_begins[i], child_begins[i + 1], depth + 1);
+    }
+}
+
+int TokenLexicon::Child(int node, int token) const {
+    const int *begin = ChildTokens(node);
+    const int *end = begin + ChildCount(node);
+    const int *it = std::lower_bound(begin, end, token);
+    if(it == end || *it != token) return TOKEN_LEXICON_NO_NODE;
+    return child_nodes[nodes[node].first_child + (it - begin)];
+}
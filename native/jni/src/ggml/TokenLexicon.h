@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Trie over the token sequences of a word list, so that beam search can be limited to tokens that
+// continue some word of the list
+//
+
+#ifndef LATINIME_TOKENLEXICON_H
+#define LATINIME_TOKENLEXICON_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "context.h"
+
+#define TOKEN_LEXICON_ROOT 0
+#define TOKEN_LEXICON_NO_NODE -1
+
+class TokenLexicon {
+public:
+    TokenLexicon() { Clear(); }
+
+    // Replaces the trie. A word may be listed under several tokenizations, each one ends a word
+    void Build(std::vector<token_sequence> sequences);
+
+    void Clear();
+
+    bool IsEmpty() const { return nodes.size() <= 1; }
+
+    // TOKEN_LEXICON_NO_NODE if no word continues with the token
+    int Child(int node, int token) const;
+
+    // Whether a word of the list ends at the node
+    bool IsWordEnd(int node) const { return nodes[node].is_word_end; }
+
+    // Tokens continuing a word from the node, in ascending order
+    const int *ChildTokens(int node) const { return child_tokens.data() + nodes[node].first_child; }
+    int ChildCount(int node) const { return nodes[node].child_count; }
+
+private:
+    struct Node {
+        int32_t first_child;
+        int32_t child_count;
+        bool is_word_end;
+    };
+
+    void BuildNode(int node, const std::vector<token_sequence> &sequences, size_t begin, size_t end, size_t depth);
+
+    // The children of a node are adjacent in child_tokens and child_nodes
+    std::vector<Node> nodes;
+    std::vector<int> child_tokens;
+    std::vector<int32_t> child_nodes;
+};
+
+#endif //LATINIME_TOKENLEXICON_H
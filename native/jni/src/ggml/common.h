@@ -6,6 +6,7 @@
 
 #define LOG_NO_FILE_LINE_FUNCTION
 
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <random>
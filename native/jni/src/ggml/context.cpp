@@ -39,4 +39,50 @@ void transformer_context_apply(transformer_context &ctx, const std::pair<token_s
     for(auto i : fastforward_info.first) {
         ctx.active_context.emplace_back(i);
     }
-}
\ No newline at end of file
+}
+
+transformer_context_shift transformer_context_find_shift(const transformer_context &ctx, const token_sequence &next_context, int min_reuse) {
+    const token_sequence &active = ctx.active_context;
+
+    int keep = 0;
+    int max_length = std::min(active.size(), next_context.size());
+    while(keep < max_length && active[keep] == next_context[keep]) {
+        keep++;
+    }
+
+    if(keep == (int)active.size() || keep == (int)next_context.size()) {
+        return { keep, 0 };
+    }
+
+    // Find where next_context continues within the active context, preferring the longest match
+    int best_discard = 0;
+    int best_length = 0;
+    for(int discard = 1; keep + discard < (int)active.size(); discard++) {
+        int remaining = (int)active.size() - keep - discard;
+        if(remaining <= best_length) break;
+
+        int length = 0;
+        int max_match = std::min(remaining, (int)next_context.size() - keep);
+        while(length < max_match && active[keep + discard + length] == next_context[keep + length]) {
+            length++;
+        }
+
+        if(length > best_length) {
+            best_length = length;
+            best_discard = discard;
+        }
+    }
+
+    if(best_length < min_reuse) {
+        return { keep, 0 };
+    }
+
+    return { keep, best_discard };
+}
+
+void transformer_context_apply_shift(transformer_context &ctx, const transformer_context_shift &shift) {
+    if(shift.discard == 0) return;
+
+    ctx.active_context.erase(ctx.active_context.begin() + shift.keep,
+                             ctx.active_context.begin() + shift.keep + shift.discard);
+}
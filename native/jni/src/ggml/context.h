@@ -8,5 +8,17 @@ struct transformer_context {
     token_sequence active_context;
 };
 
+// Tokens [keep, keep + discard) of the active context were dropped from the new context. Removing
+// them and shifting the following positions back by discard lets the rest of the cache be reused
+struct transformer_context_shift {
+    int keep = 0;
+    int discard = 0;
+};
+
 std::pair<token_sequence, token_sequence::size_type> transformer_context_fastforward(const transformer_context &ctx, const token_sequence &next_context, bool allow_empty = false);
-void transformer_context_apply(transformer_context &ctx, const std::pair<token_sequence, int> &fastforward_info);
\ No newline at end of file
+void transformer_context_apply(transformer_context &ctx, const std::pair<token_sequence, int> &fastforward_info);
+
+// Detects tokens trimmed from the front of the context (after any common prefix such as BOS). A shift
+// is only returned if at least min_reuse tokens of the active context can be reused after it
+transformer_context_shift transformer_context_find_shift(const transformer_context &ctx, const token_sequence &next_context, int min_reuse);
+void transformer_context_apply_shift(transformer_context &ctx, const transformer_context_shift &shift);
@@ -1100,6 +1100,19 @@ struct llama_file {
     }
 };
 
+static const uint32_t LLAMA_FILE_MAGIC_LORA = 0x67676C61; // 'ggla'
+
+static void write_tensor_data(struct llama_file * file, const char * name, uint32_t type, uint32_t nd, const uint32_t * ne, const void * data, size_t size) {
+    uint32_t name_len = strlen(name);
+    file->write_u32(nd);
+    file->write_u32(name_len);
+    file->write_u32(type);
+    file->write_raw(ne, sizeof(ne[0]) * nd);
+    file->write_raw(name, name_len);
+    file->seek((0-file->tell()) & 31, SEEK_CUR);
+    file->write_raw(data, size);
+}
+
 static void write_tensor(struct llama_file * file, struct ggml_tensor * tensor, const char * name) {
     if (tensor == NULL) {
         file->write_u32(0);
@@ -1111,19 +1124,102 @@ static void write_tensor(struct llama_file * file, struct ggml_tensor * tensor,
     if (name == NULL) {
         name = ggml_get_name(tensor);
     }
-    uint32_t name_len = strlen(name);
-    uint32_t nd = tensor->n_dims;
     uint32_t ne[4] = { (uint32_t)tensor->ne[0],
                        (uint32_t)tensor->ne[1],
                        (uint32_t)tensor->ne[2],
                        (uint32_t)tensor->ne[3] };
-    file->write_u32(nd);
-    file->write_u32(name_len);
-    file->write_u32(tensor->type);
-    file->write_raw(ne, sizeof(ne[0]) * nd);
-    file->write_raw(name, name_len);
-    file->seek((0-file->tell()) & 31, SEEK_CUR);
-    file->write_raw(tensor->data, ggml_nbytes(tensor));
+    write_tensor_data(file, name, tensor->type, tensor->n_dims, ne, tensor->data, ggml_nbytes(tensor));
+}
+
+struct llama_lora_file_tensor {
+    std::string        name;
+    uint32_t           ne[2];
+    std::vector<float> data;
+};
+
+// Reads an adapter written by save_as_llama_lora. Returns false if the file does not exist, throws if it is malformed
+static bool read_llama_lora(const char * filename, uint32_t * lora_r, uint32_t * lora_alpha, std::vector<llama_lora_file_tensor> & tensors) {
+    struct llama_file file(filename, "rb");
+    if (file.fp == NULL) {
+        return false;
+    }
+
+    const uint32_t magic   = file.read_u32();
+    const uint32_t version = file.read_u32();
+    if (magic != LLAMA_FILE_MAGIC_LORA || version != 1) {
+        die_fmt("%s is not a lora adapter", filename);
+    }
+    *lora_r     = file.read_u32();
+    *lora_alpha = file.read_u32();
+
+    while (file.tell() < file.size) {
+        const uint32_t nd       = file.read_u32();
+        const uint32_t name_len = file.read_u32();
+        const uint32_t type     = file.read_u32();
+        if (nd != 2 || type != GGML_TYPE_F32 || name_len == 0 || name_len >= GGML_MAX_NAME) {
+            die_fmt("unsupported tensor in %s", filename);
+        }
+
+        llama_lora_file_tensor tensor;
+        file.read_raw(tensor.ne, sizeof(tensor.ne));
+        tensor.name = file.read_string(name_len);
+        file.seek((0-file.tell()) & 31, SEEK_CUR);
+        tensor.data.resize((size_t) tensor.ne[0] * tensor.ne[1]);
+        file.read_raw(tensor.data.data(), tensor.data.size() * sizeof(float));
+
+        tensors.push_back(std::move(tensor));
+    }
+
+    return true;
+}
+
+// Continues from an adapter saved by an earlier run instead of random weights. Returns false if there is none or it
+// does not match the ranks of lora, which must already be allocated
+static bool load_lora_from_adapter(const char * filename, struct my_llama_lora * lora, float b_scale) {
+    uint32_t lora_r;
+    uint32_t lora_alpha;
+    std::vector<llama_lora_file_tensor> tensors;
+    try {
+        if (!read_llama_lora(filename, &lora_r, &lora_alpha, tensors)) {
+            return false;
+        }
+    } catch (const std::exception & err) {
+        AKLOGE("%s: %s\n", __func__, err.what());
+        return false;
+    }
+
+    std::unordered_map<std::string, const llama_lora_file_tensor *> tensors_by_name;
+    for (const auto & tensor : tensors) {
+        tensors_by_name[tensor.name] = &tensor;
+    }
+
+    int n_loaded = 0;
+    for (struct ggml_tensor * t = ggml_get_first_tensor(lora->ctx); t != NULL; t = ggml_get_next_tensor(lora->ctx, t)) {
+        // "<weight>.lora_a" is saved as "<weight>.loraA", gradients and other tensors are skipped
+        std::string name = ggml_get_name(t);
+        const size_t pos = name.rfind(".lora_");
+        if (pos == std::string::npos || pos + 7 != name.size()) {
+            continue;
+        }
+        const bool is_b = name.back() == 'b';
+        name = name.substr(0, pos) + (is_b ? ".loraB" : ".loraA");
+
+        const auto it = tensors_by_name.find(name);
+        if (it == tensors_by_name.end() || t->type != GGML_TYPE_F32 || t->ne[0] != it->second->ne[0] || t->ne[1] != it->second->ne[1]) {
+            AKLOGE("%s: %s does not match the lora, starting from scratch\n", __func__, name.c_str());
+            return false;
+        }
+
+        float * dst = (float *) t->data;
+        const std::vector<float> & src = it->second->data;
+        for (size_t i = 0; i < src.size(); i++) {
+            dst[i] = is_b ? src[i] * b_scale : src[i];
+        }
+        n_loaded++;
+    }
+
+    AKLOGI("%s: continuing from %s (%d tensors)\n", __func__, filename, n_loaded);
+    return n_loaded > 0;
 }
 
 static void save_as_llama_lora(const char * filename, struct my_llama_lora * lora) {
@@ -1148,7 +1244,6 @@ static void save_as_llama_lora(const char * filename, struct my_llama_lora * lor
         return tn_buf.data();
     };
 
-    uint32_t LLAMA_FILE_MAGIC_LORA = 0x67676C61; // 'ggla'
     // write_magic
     file.write_u32(LLAMA_FILE_MAGIC_LORA);   // magic
     file.write_u32(1); // version
@@ -1243,6 +1338,108 @@ static int64_t get_parameter_count(struct my_llama_lora* lora) {
     return nx;
 }
 
+void train_token_arena::add_sample(const llama_token * data, size_t n_tokens) {
+    samples_begin.push_back(tokens.size());
+    samples_size.push_back(n_tokens);
+    tokens.insert(tokens.end(), data, data + n_tokens);
+}
+
+void train_token_arena::append(const struct train_token_arena & other) {
+    const size_t offset = tokens.size();
+    tokens.insert(tokens.end(), other.tokens.begin(), other.tokens.end());
+    for (size_t i = 0; i < other.samples_begin.size(); ++i) {
+        samples_begin.push_back(offset + other.samples_begin[i]);
+        samples_size.push_back(other.samples_size[i]);
+    }
+}
+
+void train_token_arena::clear() {
+    tokens.clear();
+    samples_begin.clear();
+    samples_size.clear();
+}
+
+struct train_token_arena pack_train_samples(const struct train_token_arena & samples, int n_ctx, llama_token sep) {
+    GGML_ASSERT(n_ctx > 0);
+    const size_t capacity = (size_t) n_ctx;
+
+    // a piece is a [begin, begin + size) range of samples.tokens that fits in one window
+    struct piece {
+        size_t begin;
+        size_t size;
+    };
+
+    std::vector<piece> pieces;
+    pieces.reserve(samples.samples_size.size());
+    for (size_t i = 0; i < samples.samples_size.size(); ++i) {
+        size_t begin = samples.samples_begin[i];
+        size_t size  = samples.samples_size[i];
+        while (size > 0) {
+            const size_t n = std::min(size, capacity);
+            pieces.push_back({ begin, n });
+            begin += n;
+            size  -= n;
+        }
+    }
+
+    // length buckets, longest first, keeping the original order inside a bucket
+    std::vector<std::vector<size_t>> by_length(capacity + 1);
+    for (size_t i = 0; i < pieces.size(); ++i) {
+        by_length[pieces[i].size].push_back(i);
+    }
+
+    // best-fit: bins_by_space[r] holds the open bins with exactly r tokens of space left
+    std::vector<std::vector<size_t>> bins;
+    std::vector<size_t> bins_used;
+    std::vector<std::vector<size_t>> bins_by_space(capacity + 1);
+    for (size_t len = capacity; len > 0; --len) {
+        for (const size_t ip : by_length[len]) {
+            size_t bin = SIZE_MAX;
+            // joining an open bin costs one extra separator token
+            for (size_t space = len + 1; space <= capacity; ++space) {
+                if (!bins_by_space[space].empty()) {
+                    bin = bins_by_space[space].back();
+                    bins_by_space[space].pop_back();
+                    break;
+                }
+            }
+
+            if (bin == SIZE_MAX) {
+                bin = bins.size();
+                bins.emplace_back();
+                bins_used.push_back(0);
+            } else {
+                bins_used[bin] += 1;
+            }
+
+            bins[bin].push_back(ip);
+            bins_used[bin] += len;
+            bins_by_space[capacity - bins_used[bin]].push_back(bin);
+        }
+    }
+
+    struct train_token_arena packed;
+    packed.tokens.reserve(samples.tokens.size() + pieces.size());
+    packed.samples_begin.reserve(bins.size());
+    packed.samples_size.reserve(bins.size());
+    for (size_t bin = 0; bin < bins.size(); ++bin) {
+        const size_t begin = packed.tokens.size();
+        for (size_t j = 0; j < bins[bin].size(); ++j) {
+            const piece & p = pieces[bins[bin][j]];
+            if (j > 0) {
+                packed.tokens.push_back(sep);
+            }
+            packed.tokens.insert(packed.tokens.end(),
+                                 samples.tokens.begin() + p.begin,
+                                 samples.tokens.begin() + p.begin + p.size);
+        }
+        packed.samples_begin.push_back(begin);
+        packed.samples_size.push_back(packed.tokens.size() - begin);
+    }
+
+    return packed;
+}
+
 int finetune_train(struct train_params params) {
     if (params.common.seed == LLAMA_DEFAULT_SEED) {
         params.common.seed = time(NULL);
@@ -1366,13 +1563,27 @@ int finetune_train(struct train_params params) {
         }
     } else { // existed == false
         init_lora(&model, &lora);
-        randomize_lora(&lora, params.common.seed, 0.0f, 1.0f, -1.0f, +1.0f);
+        if (strlen(params.fn_lora_in) == 0 || !load_lora_from_adapter(params.fn_lora_in, &lora, params.lora_in_scale)) {
+            randomize_lora(&lora, params.common.seed, 0.0f, 1.0f, -1.0f, +1.0f);
+        }
         if (!params.only_write_lora) {
             ggml_opt_init(opt->ctx, opt, opt->params, get_parameter_count(&lora));
         }
     }
     opt->iter = train->train_its;
 
+    // iteration counts are totals over all slices of a checkpointed run
+    if ((int64_t) train->train_its >= params.common.adam_n_iter) {
+        AKLOGI("%s: checkpoint already completed %llu iterations\n", __func__, (long long unsigned) train->train_its);
+        ggml_free(opt->ctx);
+        free_train_state(train);
+        ggml_free(lora.ctx);
+        llama_free(lctx);
+        llama_free_model(lmodel);
+        return FINETUNE_FINISHED;
+    }
+    opt->params.adam.n_iter = params.common.adam_n_iter - (int) train->train_its;
+
     print_params(&model.hparams);
     print_lora_params(&lora.hparams);
     AKLOGI("%s: total train_iterations %llu\n", __func__, (long long unsigned) train->train_its);
@@ -1510,16 +1721,16 @@ int finetune_train(struct train_params params) {
     );
     ggml_allocr_free(alloc);
 
-    // flatten training data
-    std::vector<llama_token> train_tokens;
-    std::vector<size_t> train_samples_begin;
-    std::vector<size_t> train_samples_size;
-
-    for(std::vector<llama_token> example : params.training_data) {
-        train_samples_begin.push_back(train_tokens.size());
-        train_samples_size.push_back(example.size());
-        train_tokens.insert(train_tokens.end(), example.begin(), example.end());
+    GGML_ASSERT(params.training_data != nullptr);
+    struct train_token_arena packed_data;
+    if (params.pack_samples) {
+        packed_data = pack_train_samples(*params.training_data, n_tokens, llama_token_bos(lmodel));
+        AKLOGI("%s: packed %zu samples into %zu windows\n", __func__, params.training_data->samples_size.size(), packed_data.samples_size.size());
     }
+    const struct train_token_arena & train_data = params.pack_samples ? packed_data : *params.training_data;
+    const std::vector<llama_token> & train_tokens = train_data.tokens;
+    const std::vector<size_t> & train_samples_begin = train_data.samples_begin;
+    const std::vector<size_t> & train_samples_size = train_data.samples_size;
     GGML_ASSERT(train_samples_begin.size() == train_samples_size.size());
 
     AKLOGI("%s: number of training tokens: %zu\n", __func__, train_tokens.size());
@@ -1536,8 +1747,9 @@ int finetune_train(struct train_params params) {
     }
     AKLOGI("%s: number of unique tokens: %d\n", __func__, n_unique_tokens);
 
-    //size_t shuffle_samples_hash = compute_samples_hash(params.common.fn_train_data, train_samples_begin.data(), train_samples_size.data(), train_samples_size.size());
-    const bool changed_train_data = true;// || (shuffle_samples_hash != train->shuffle_samples_hash) || (train->shuffle_sample_count != train_samples_size.size());
+    // the same examples packed the same way resume the shuffled epoch stored in the checkpoint
+    size_t shuffle_samples_hash = compute_samples_hash(params.common.fn_train_data, train_samples_begin.data(), train_samples_size.data(), train_samples_size.size());
+    const bool changed_train_data = (shuffle_samples_hash != train->shuffle_samples_hash) || (train->shuffle_sample_count != train_samples_size.size());
     if (changed_train_data) {
         AKLOGI("%s: train data seems to have changed. restarting shuffled epoch.\n", __func__);
     }
@@ -1548,7 +1760,7 @@ int finetune_train(struct train_params params) {
         train->shuffle_rng_state_current = mt19937_seed_to_state(params.common.seed);
         train->shuffle_sample_count = train_samples_size.size();
         train->shuffle_next_sample = 0;
-        train->shuffle_samples_hash = -1;
+        train->shuffle_samples_hash = shuffle_samples_hash;
     }
     std::vector<size_t> train_shuffled_samples_offs;
     std::vector<size_t> train_shuffled_samples_begin;
@@ -1593,10 +1805,13 @@ int finetune_train(struct train_params params) {
     opt_cb_data.tokens_input           = tokens_input;
     opt_cb_data.target_probs           = target_probs;
     opt_cb_data.first_iter             = opt->iter;
-    opt_cb_data.first_epoch            = train->train_epochs;
+    opt_cb_data.first_epoch            = 0;
     opt_cb_data.iter_at_last_epoch     = -1;
     opt_cb_data.last_time              = ggml_time_ms();
     opt_cb_data.millis_per_iter        = 0.0;
+    // the budget only counts training, loading the model and the checkpoint can take a while on a phone
+    opt_cb_data.deadline_ms            = params.max_time_ms > 0 ? ggml_time_ms() + params.max_time_ms : 0;
+    opt_cb_data.deadline_reached       = false;
 
     // measure required memory for work buffer
     size_t max_work_size = ggml_graph_plan(gb, params.common.n_threads).work_size + GGML_OBJECT_SIZE;
@@ -1632,10 +1847,56 @@ int finetune_train(struct train_params params) {
         opt_cb_data.last_save_iter = opt->iter;
     }
 
+    if (opt_cb_data.deadline_reached) {
+        AKLOGI("%s: time budget of %lld ms used up after %d iterations\n", __func__, (long long) params.max_time_ms, opt->iter);
+    }
+    const bool slice_ended = opt_cb_data.deadline_reached;
+
     ggml_free(opt->ctx);
     free_train_state(train);
     ggml_free(lora.ctx);
     llama_free(lctx);
     llama_free_model(lmodel);
-    return 0;
+    return slice_ended ? FINETUNE_SLICE_ENDED : FINETUNE_FINISHED;
+}
+
+bool export_lora_adapter(const char * fn_lora, const char * fn_out, float scale) {
+    uint32_t lora_r;
+    uint32_t lora_alpha;
+    std::vector<llama_lora_file_tensor> tensors;
+    try {
+        if (!read_llama_lora(fn_lora, &lora_r, &lora_alpha, tensors)) {
+            AKLOGE("%s: failed to open %s\n", __func__, fn_lora);
+            return false;
+        }
+    } catch (const std::exception & err) {
+        AKLOGE("%s: %s\n", __func__, err.what());
+        return false;
+    }
+
+    struct llama_file file(fn_out, "wb");
+    if (file.fp == NULL) {
+        AKLOGE("%s: failed to open %s for writing\n", __func__, fn_out);
+        return false;
+    }
+
+    try {
+        file.write_u32(LLAMA_FILE_MAGIC_LORA);
+        file.write_u32(1);
+        file.write_u32(lora_r);
+        file.write_u32(lora_alpha);
+        for (auto & tensor : tensors) {
+            if (tensor.name.back() == 'B') {
+                for (float & x : tensor.data) {
+                    x *= scale;
+                }
+            }
+            write_tensor_data(&file, tensor.name.c_str(), GGML_TYPE_F32, 2, tensor.ne, tensor.data.data(), tensor.data.size() * sizeof(float));
+        }
+    } catch (const std::exception & err) {
+        AKLOGE("%s: %s\n", __func__, err.what());
+        return false;
+    }
+
+    return true;
 }
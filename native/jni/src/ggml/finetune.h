@@ -7,14 +7,52 @@
 #include "common.h"
 #include "train.h"
 
+// Training samples stored back to back in one contiguous token buffer.
+// Sample i is tokens[samples_begin[i], samples_begin[i] + samples_size[i])
+struct train_token_arena {
+    std::vector<llama_token> tokens;
+    std::vector<size_t>      samples_begin;
+    std::vector<size_t>      samples_size;
+
+    void add_sample(const llama_token * data, size_t n_tokens);
+    void append(const struct train_token_arena & other);
+    void clear();
+};
+
+// Repacks samples into training windows of at most n_ctx tokens. Samples are bucketed by length and
+// placed best-fit, joined with `sep` (the token get_example_targets_batch uses between samples), so that
+// each 64-token window is filled with whole messages instead of random slices of the token stream.
+// Samples longer than n_ctx are split into n_ctx sized chunks.
+struct train_token_arena pack_train_samples(const struct train_token_arena & samples, int n_ctx, llama_token sep);
+
+// Return values of finetune_train()
+enum finetune_result {
+    FINETUNE_FINISHED     = 0, // adam_n_iter iterations or n_epochs epochs are done
+    FINETUNE_SLICE_ENDED  = 1, // max_time_ms ran out, resume later from fn_checkpoint_out
+};
+
 struct train_params {
     struct train_params_common common;
 
-    std::vector<std::vector<llama_token>> training_data;
+    // not owned, must outlive finetune_train()
+    const struct train_token_arena * training_data;
+
+    // repack training_data with pack_train_samples() before training
+    bool pack_samples;
+
+    // if > 0, training stops between iterations after this many milliseconds and saves the checkpoint.
+    // adam_n_iter and n_epochs count from the start of the checkpointed run, so calling finetune_train()
+    // again with fn_checkpoint_in = fn_checkpoint_out continues where the last slice stopped.
+    int64_t max_time_ms;
 
     const char * fn_model_base;
     const char * fn_lora_out;
 
+    // adapter to continue training from when there is no checkpoint, "" or a missing file starts from random
+    // weights. Its B matrices are multiplied by lora_in_scale, to undo the scale applied by export_lora_adapter()
+    const char * fn_lora_in;
+    float lora_in_scale;
+
     bool only_write_lora;
 
     float f_norm_rms_eps;
@@ -59,8 +97,13 @@ struct train_params {
 static struct train_params get_default_train_params() {
     struct train_params params;
     params.common = get_default_train_params_common();
+    params.training_data     = nullptr;
+    params.pack_samples      = false;
+    params.max_time_ms       = 0;
     params.fn_model_base     = "";
     params.fn_lora_out       = "ggml-lora-ITERATION-f32.gguf";
+    params.fn_lora_in        = "";
+    params.lora_in_scale     = 1.0f;
 
     params.only_write_lora = false;
 
@@ -105,6 +148,15 @@ static struct train_params get_default_train_params() {
     return params;
 }
 
+// Returns a finetune_result
 int finetune_train(struct train_params params);
 
+// Writes the adapter fn_lora (as saved to fn_lora_out) to fn_out with its update scaled by scale, for use with
+// llama_lora_adapter_init(). Returns false on failure
+bool export_lora_adapter(const char * fn_lora, const char * fn_out, float scale);
+
+// The base model is not rewritten by finetuning, so each run appends a line to this file next to the adapter
+// instead of the history in the model metadata. The number of lines is the finetuning count of the adapter
+#define LORA_ADAPTER_HISTORY_SUFFIX ".history"
+
 #endif //LATINIME_FINETUNE_H
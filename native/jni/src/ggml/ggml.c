@@ -2011,6 +2011,11 @@ float ggml_type_sizef(enum ggml_type type) {
     return ((float)(type_traits[type].type_size))/type_traits[type].blck_size;
 }
 
+size_t ggml_row_size(enum ggml_type type, int64_t ne) {
+    assert(ne % ggml_blck_size(type) == 0);
+    return ggml_type_size(type)*ne/ggml_blck_size(type);
+}
+
 const char * ggml_type_name(enum ggml_type type) {
     return type_traits[type].type_name;
 }
@@ -6778,6 +6783,42 @@ static void ggml_compute_forward_dup_f32(
     }
 }
 
+// dequantize contiguous rows to f32, used to read back a quantized KV cache
+static void ggml_compute_forward_dup_q(
+        const struct ggml_compute_params * params,
+        const struct ggml_tensor * src0,
+        struct ggml_tensor * dst) {
+    GGML_ASSERT(ggml_nelements(dst) == ggml_nelements(src0));
+    GGML_ASSERT(ggml_is_contiguous(src0) && ggml_is_contiguous(dst));
+    GGML_ASSERT(dst->type == GGML_TYPE_F32);
+
+    if (params->type == GGML_TASK_INIT || params->type == GGML_TASK_FINALIZE) {
+        return;
+    }
+
+    ggml_to_float_t const dequantize_row_q = type_traits[src0->type].to_float;
+    GGML_ASSERT(dequantize_row_q != NULL);
+
+    const int ith = params->ith; // thread index
+    const int nth = params->nth; // number of threads
+
+    const int64_t ne00 = src0->ne[0];
+
+    // parallelize by rows
+    const int64_t nr  = ggml_nrows(src0);
+    const int64_t dr  = (nr + nth - 1)/nth;
+    const int64_t ir0 = dr*ith;
+    const int64_t ir1 = MIN(ir0 + dr, nr);
+
+    const size_t row_size = ggml_row_size(src0->type, ne00);
+
+    for (int64_t ir = ir0; ir < ir1; ++ir) {
+        dequantize_row_q(
+                (const char *) src0->data + ir*row_size,
+                (float *) ((char *) dst->data + ir*ne00*sizeof(float)), ne00);
+    }
+}
+
 static void ggml_compute_forward_dup(
         const struct ggml_compute_params * params,
         const struct ggml_tensor * src0,
@@ -6795,6 +6836,14 @@ static void ggml_compute_forward_dup(
             {
                 ggml_compute_forward_dup_f32(params, src0, dst);
             } break;
+        case GGML_TYPE_Q4_0:
+        case GGML_TYPE_Q4_1:
+        case GGML_TYPE_Q5_0:
+        case GGML_TYPE_Q5_1:
+        case GGML_TYPE_Q8_0:
+            {
+                ggml_compute_forward_dup_q(params, src0, dst);
+            } break;
         default:
             {
                 GGML_ASSERT(false);
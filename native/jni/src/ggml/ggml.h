@@ -625,6 +625,7 @@ GGML_API size_t  ggml_nbytes_split(const struct ggml_tensor * tensor, int nrows_
 GGML_API int     ggml_blck_size (enum ggml_type type);
 GGML_API size_t  ggml_type_size (enum ggml_type type); // size in bytes for all elements in a block
 GGML_API float   ggml_type_sizef(enum ggml_type type); // ggml_type_size()/ggml_blck_size() as float
+GGML_API size_t  ggml_row_size  (enum ggml_type type, int64_t ne); // size in bytes for ne elements, ne must be a multiple of the block size
 
 GGML_API const char * ggml_type_name(enum ggml_type type);
 GGML_API const char * ggml_op_name  (enum ggml_op   op);
@@ -1387,6 +1387,9 @@ struct llama_model {
     // gguf metadata
     std::unordered_map<std::string, std::string> gguf_kv;
 
+    // gguf context the model was loaded from, kept so array metadata can be read without parsing the file again
+    struct gguf_context * ctx_gguf = NULL;
+
     // context
     struct ggml_context * ctx = NULL;
 
@@ -1411,6 +1414,10 @@ struct llama_model {
             ggml_free(ctx);
         }
 
+        if (ctx_gguf) {
+            gguf_free(ctx_gguf);
+        }
+
 #ifdef GGML_USE_CUBLAS
         if (ggml_cublas_loaded()) {
             for (size_t i = 0; i < tensors_by_name.size(); ++i) {
@@ -1428,6 +1435,30 @@ struct llama_model {
     }
 };
 
+// low-rank update W' = W + scale*BA of one model weight, kept in the layout the graph consumes it in
+struct llama_lora_weight {
+    struct ggml_tensor * a     = nullptr; // A^T [n_in, r] for matrices, A [r, n_embd] for tok_embd
+    struct ggml_tensor * b     = nullptr; // B [r, n_out], pre-multiplied by the scale
+    struct ggml_tensor * delta = nullptr; // scale*BA for 1d weights (norms)
+};
+
+struct llama_lora_adapter {
+    ~llama_lora_adapter() {
+        if (ctx) {
+            ggml_free(ctx);
+        }
+    }
+
+    const llama_model * model = nullptr;
+
+    struct ggml_context * ctx = nullptr;
+
+    // keyed by the model tensor the update applies to
+    std::unordered_map<const struct ggml_tensor *, llama_lora_weight> weights;
+};
+
+using llama_lora_adapters = std::vector<struct llama_lora_adapter *>;
+
 struct llama_context {
     llama_context(const llama_model & model) : model(model), t_start_us(model.t_start_us), t_load_us(model.t_load_us) {}
     ~llama_context() {
@@ -1472,6 +1503,9 @@ struct llama_context {
     // reusable buffer for `struct ggml_graph_plan.work_data`
     std::vector<uint8_t> work_buffer;
 
+    // adapters evaluated in the graph on top of the model weights, not owned
+    llama_lora_adapters lora_adapters;
+
     // memory buffers used to evaluate the model
     llama_buffer buf_compute;
 
@@ -1494,7 +1528,8 @@ struct llama_context {
 static bool llama_kv_cache_init(
         const struct llama_hparams & hparams,
         struct llama_kv_cache & cache,
-        ggml_type   wtype,
+        ggml_type   type_k,
+        ggml_type   type_v,
         uint32_t   n_ctx,
         int   n_gpu_layers) {
     const uint32_t n_embd  = hparams.n_embd_gqa();
@@ -1511,7 +1546,7 @@ static bool llama_kv_cache_init(
     cache.cells.clear();
     cache.cells.resize(n_ctx);
 
-    cache.buf.resize(2u*n_elements*ggml_type_size(wtype) + 2u*ggml_tensor_overhead());
+    cache.buf.resize(ggml_row_size(type_k, n_elements) + ggml_row_size(type_v, n_elements) + 2u*ggml_tensor_overhead());
     memset(cache.buf.data, 0, cache.buf.size);
 
     struct ggml_init_params params;
@@ -1526,8 +1561,8 @@ static bool llama_kv_cache_init(
         return false;
     }
 
-    cache.k = ggml_new_tensor_1d(cache.ctx, wtype, n_elements);
-    cache.v = ggml_new_tensor_1d(cache.ctx, wtype, n_elements);
+    cache.k = ggml_new_tensor_1d(cache.ctx, type_k, n_elements);
+    cache.v = ggml_new_tensor_1d(cache.ctx, type_v, n_elements);
     ggml_set_name(cache.k, "cache_k");
     ggml_set_name(cache.v, "cache_v");
 
@@ -3390,13 +3425,14 @@ static bool llama_model_load(const std::string & fname, llama_model & model, con
 
         if (params.vocab_only) {
             LLAMA_LOG_INFO("%s: vocab only - skipping tensors\n", __func__);
-            return true;
+        } else {
+            llm_load_tensors(
+                    ml, model, params.n_gpu_layers, params.main_gpu, params.tensor_split, params.use_mlock,
+                    params.progress_callback, params.progress_callback_user_data
+            );
         }
 
-        llm_load_tensors(
-                ml, model, params.n_gpu_layers, params.main_gpu, params.tensor_split, params.use_mlock,
-                params.progress_callback, params.progress_callback_user_data
-        );
+        std::swap(model.ctx_gguf, ml.ctx_gguf);
     } catch (const std::exception & err) {
         LLAMA_LOG_ERROR("error loading model: %s\n", err.what());
         return false;
@@ -3434,12 +3470,66 @@ enum llm_norm_type {
     LLM_NORM_RMS,
 };
 
+// w*cur plus B*(A*cur) for every adapter that updates w, BA itself is never materialized
+static struct ggml_tensor * llm_build_lora_mm(
+        struct ggml_context * ctx,
+        const llama_lora_adapters * loras,
+        struct ggml_tensor * w,
+        struct ggml_tensor * cur,
+        const llm_build_cb & cb,
+        int   il) {
+    struct ggml_tensor * res = ggml_mul_mat(ctx, w, cur);
+
+    if (loras) {
+        for (const auto * adapter : *loras) {
+            const auto it = adapter->weights.find(w);
+            if (it == adapter->weights.end() || !it->second.b) {
+                continue;
+            }
+
+            struct ggml_tensor * a_cur = ggml_mul_mat(ctx, it->second.a, cur);
+            cb(a_cur, "lora_a", il);
+
+            struct ggml_tensor * ba_cur = ggml_mul_mat(ctx, it->second.b, a_cur);
+            cb(ba_cur, "lora_ba", il);
+
+            res = ggml_add(ctx, res, ba_cur);
+            cb(res, "lora_out", il);
+        }
+    }
+
+    return res;
+}
+
+// 1d weights are small, so their update is added to the weight directly
+static struct ggml_tensor * llm_build_lora_weight(
+        struct ggml_context * ctx,
+        const llama_lora_adapters * loras,
+        struct ggml_tensor * w,
+        const llm_build_cb & cb,
+        int   il) {
+    if (!loras || !w) {
+        return w;
+    }
+
+    for (const auto * adapter : *loras) {
+        const auto it = adapter->weights.find(w);
+        if (it != adapter->weights.end() && it->second.delta) {
+            w = ggml_add(ctx, w, it->second.delta);
+            cb(w, "lora_weight", il);
+        }
+    }
+
+    return w;
+}
+
 static struct ggml_tensor * llm_build_inp_embd(
         struct ggml_context * ctx,
         const llama_hparams & hparams,
         const llama_batch & batch,
         struct ggml_tensor * tok_embd,
-        const llm_build_cb & cb) {
+        const llm_build_cb & cb,
+        const llama_lora_adapters * loras = nullptr) {
     const int64_t n_embd = hparams.n_embd;
 
     struct ggml_tensor * inpL;
@@ -3449,6 +3539,25 @@ static struct ggml_tensor * llm_build_inp_embd(
         cb(inp_tokens, "inp_tokens", -1);
 
         inpL = ggml_get_rows(ctx, tok_embd, inp_tokens);
+
+        if (loras) {
+            // the rows of BA for the input tokens: A * (rows of B)
+            for (const auto * adapter : *loras) {
+                const auto it = adapter->weights.find(tok_embd);
+                if (it == adapter->weights.end() || !it->second.b) {
+                    continue;
+                }
+
+                struct ggml_tensor * b_rows = ggml_get_rows(ctx, it->second.b, inp_tokens);
+                cb(b_rows, "lora_b_rows", -1);
+
+                struct ggml_tensor * ab_rows = ggml_mul_mat(ctx, it->second.a, b_rows);
+                cb(ab_rows, "lora_ab_rows", -1);
+
+                inpL = ggml_add(ctx, inpL, ab_rows);
+                cb(inpL, "lora_inp_embd", -1);
+            }
+        }
     } else {
 #ifdef GGML_USE_MPI
         GGML_ASSERT(false && "not implemented");
@@ -3497,19 +3606,39 @@ static void llm_build_k_shift(
         case LLM_ROPE_GLM:  rope_type = 4; break;
     }
 
+    const bool k_quantized = ggml_is_quantized(kv.k->type);
+
     for (int il = 0; il < n_layer; ++il) {
+        struct ggml_tensor * k_layer =
+                ggml_view_2d(ctx, kv.k,
+                             n_embd_gqa, n_ctx,
+                             ggml_row_size(kv.k->type, n_embd_gqa),
+                             ggml_row_size(kv.k->type, n_embd_gqa)*n_ctx*il);
+
+        // rope cannot work on quantized blocks, so a quantized layer is dequantized, rotated and written back
+        struct ggml_tensor * k_rope = k_layer;
+        if (k_quantized) {
+            k_rope = ggml_cpy(ctx, k_layer, ggml_new_tensor_2d(ctx, GGML_TYPE_F32, n_embd_gqa, n_ctx));
+            cb(k_rope, "K_dequant", il);
+        }
+
         struct ggml_tensor * tmp =
                 // we rotate only the first n_rot dimensions
                 ggml_rope_custom_inplace(ctx,
-                                         ggml_view_3d(ctx, kv.k,
+                                         ggml_view_3d(ctx, k_rope,
                                                       n_rot, n_head_kv, n_ctx,
-                                                      ggml_element_size(kv.k)*n_embd_head,
-                                                      ggml_element_size(kv.k)*n_embd_gqa,
-                                                      ggml_element_size(kv.k)*n_embd_gqa*n_ctx*il),
+                                                      ggml_element_size(k_rope)*n_embd_head,
+                                                      ggml_element_size(k_rope)*n_embd_gqa,
+                                                      0),
                                          K_shift, n_rot, rope_type, 0, n_orig_ctx, freq_base, freq_scale,
                                          ext_factor, attn_factor, beta_fast, beta_slow);
         cb(tmp, "K_shifted", il);
         ggml_build_forward_expand(graph, tmp);
+
+        if (k_quantized) {
+            // nodes run in the order they were added, so this copies the rotated rows
+            ggml_build_forward_expand(graph, ggml_cpy(ctx, k_rope, k_layer));
+        }
     }
 }
 
@@ -3533,7 +3662,7 @@ static void llm_build_kv_store(
     cb(v_cur_t, "v_cur_t", il);
 
     struct ggml_tensor * k_cache_view = ggml_view_1d(ctx, kv.k, n_tokens*n_embd_gqa,
-                                                     (ggml_element_size(kv.k)*n_embd_gqa)*(il*n_ctx + kv_head));
+                                                     ggml_row_size(kv.k->type, n_embd_gqa)*(il*n_ctx + kv_head));
     cb(k_cache_view, "k_cache_view", il);
 
     struct ggml_tensor * v_cache_view = ggml_view_2d(ctx, kv.v, n_tokens, n_embd_gqa,
@@ -3590,8 +3719,9 @@ static struct ggml_tensor * llm_build_ffn(
         llm_ffn_op_type   type_op,
         llm_ffn_gate_type   type_gate,
         const llm_build_cb & cb,
-        int   il) {
-    struct ggml_tensor * tmp = ggml_mul_mat(ctx, up, cur);
+        int   il,
+        const llama_lora_adapters * loras = nullptr) {
+    struct ggml_tensor * tmp = llm_build_lora_mm(ctx, loras, up, cur, cb, il);
     cb(tmp, "ffn_up", il);
 
     if (up_b) {
@@ -3603,12 +3733,12 @@ static struct ggml_tensor * llm_build_ffn(
         switch (type_gate) {
             case LLM_FFN_SEQ:
             {
-                cur = ggml_mul_mat(ctx, gate, tmp);
+                cur = llm_build_lora_mm(ctx, loras, gate, tmp, cb, il);
                 cb(cur, "ffn_gate", il);
             } break;
             case LLM_FFN_PAR:
             {
-                cur = ggml_mul_mat(ctx, gate, cur);
+                cur = llm_build_lora_mm(ctx, loras, gate, cur, cb, il);
                 cb(cur, "ffn_gate", il);
             } break;
         }
@@ -3652,7 +3782,7 @@ static struct ggml_tensor * llm_build_ffn(
         cb(cur, "ffn_gate_par", il);
     }
 
-    cur = ggml_mul_mat(ctx, down, cur);
+    cur = llm_build_lora_mm(ctx, loras, down, cur, cb, il);
     if (down_b) {
         cb(cur, "ffn_down", il);
     }
@@ -3679,7 +3809,8 @@ static struct ggml_tensor * llm_build_kqv(
         int32_t   n_kv,
         float     max_alibi_bias,
         const llm_build_cb & cb,
-        int       il) {
+        int       il,
+        const llama_lora_adapters * loras = nullptr) {
     const int64_t n_embd      = hparams.n_embd;
     const int64_t n_head      = hparams.n_head;
     const int64_t n_head_kv   = hparams.n_head_kv;
@@ -3692,9 +3823,9 @@ static struct ggml_tensor * llm_build_kqv(
     struct ggml_tensor * k =
             ggml_view_3d(ctx, kv.k,
                          n_embd_head, n_kv, n_head_kv,
-                         ggml_element_size(kv.k)*n_embd_gqa,
-                         ggml_element_size(kv.k)*n_embd_head,
-                         ggml_element_size(kv.k)*n_embd_gqa*n_ctx*il);
+                         ggml_row_size(kv.k->type, n_embd_gqa),
+                         ggml_row_size(kv.k->type, n_embd_head),
+                         ggml_row_size(kv.k->type, n_embd_gqa)*n_ctx*il);
     cb(k, "k", il);
 
     struct ggml_tensor * kq = ggml_mul_mat(ctx, k, q);
@@ -3735,7 +3866,7 @@ static struct ggml_tensor * llm_build_kqv(
     struct ggml_tensor * cur = ggml_cont_2d(ctx, kqv_merged, n_embd, n_tokens);
     cb(cur, "kqv_merged_cont", il);
 
-    cur = ggml_mul_mat(ctx, wo, cur);
+    cur = llm_build_lora_mm(ctx, loras, wo, cur, cb, il);
     if (wo_b) {
         cb(cur, "kqv_wo", il);
     }
@@ -3780,6 +3911,8 @@ struct llm_build_context {
 
     const llm_build_cb & cb;
 
+    const llama_lora_adapters & loras;
+
     llama_buffer & buf_compute;
 
     struct ggml_context * ctx0 = nullptr;
@@ -3816,6 +3949,7 @@ struct llm_build_context {
             n_orig_ctx    (cparams.n_yarn_orig_ctx),
             do_rope_shift (worst_case || kv_self.has_shift),
             cb            (cb),
+            loras         (lctx.lora_adapters),
             buf_compute   (lctx.buf_compute) {
         GGML_ASSERT(!!kv_self.ctx);
 
@@ -3847,7 +3981,7 @@ struct llm_build_context {
         struct ggml_tensor * cur;
         struct ggml_tensor * inpL;
 
-        inpL = llm_build_inp_embd(ctx0, hparams, batch, model.tok_embd, cb);
+        inpL = llm_build_inp_embd(ctx0, hparams, batch, model.tok_embd, cb, &loras);
         cb(inpL, "inp_embd", -1);
 
         // inp_pos - contains the positions
@@ -3872,20 +4006,20 @@ struct llm_build_context {
 
             // norm
             cur = llm_build_norm(ctx0, inpL, hparams,
-                                 model.layers[il].attn_norm, NULL,
+                                 llm_build_lora_weight(ctx0, &loras, model.layers[il].attn_norm, cb, il), NULL,
                                  LLM_NORM_RMS, cb, il);
             cb(cur, "attn_norm", il);
 
             // self-attention
             {
                 // compute Q and K and RoPE them
-                struct ggml_tensor * Qcur = ggml_mul_mat(ctx0, model.layers[il].wq, cur);
+                struct ggml_tensor * Qcur = llm_build_lora_mm(ctx0, &loras, model.layers[il].wq, cur, cb, il);
                 cb(Qcur, "Qcur", il);
 
-                struct ggml_tensor * Kcur = ggml_mul_mat(ctx0, model.layers[il].wk, cur);
+                struct ggml_tensor * Kcur = llm_build_lora_mm(ctx0, &loras, model.layers[il].wk, cur, cb, il);
                 cb(Kcur, "Kcur", il);
 
-                struct ggml_tensor * Vcur = ggml_mul_mat(ctx0, model.layers[il].wv, cur);
+                struct ggml_tensor * Vcur = llm_build_lora_mm(ctx0, &loras, model.layers[il].wv, cur, cb, il);
                 cb(Vcur, "Vcur", il);
 
                 Qcur = ggml_rope_custom(
@@ -3906,7 +4040,7 @@ struct llm_build_context {
 
                 cur = llm_build_kqv(ctx0, hparams, kv_self,
                                     model.layers[il].wo, NULL,
-                                    Qcur, KQ_scale, KQ_mask, n_ctx, n_tokens, n_kv, -1.0f, cb, il);
+                                    Qcur, KQ_scale, KQ_mask, n_ctx, n_tokens, n_kv, -1.0f, cb, il, &loras);
                 cb(cur, "kqv_out", il);
             }
 
@@ -3916,7 +4050,7 @@ struct llm_build_context {
             // feed-forward network
             {
                 cur = llm_build_norm(ctx0, ffn_inp, hparams,
-                                     model.layers[il].ffn_norm, NULL,
+                                     llm_build_lora_weight(ctx0, &loras, model.layers[il].ffn_norm, cb, il), NULL,
                                      LLM_NORM_RMS, cb, il);
                 cb(cur, "ffn_norm", il);
 
@@ -3924,7 +4058,7 @@ struct llm_build_context {
                                     model.layers[il].ffn_up,   NULL,
                                     model.layers[il].ffn_gate, NULL,
                                     model.layers[il].ffn_down, NULL,
-                                    LLM_FFN_SILU, LLM_FFN_PAR, cb, il);
+                                    LLM_FFN_SILU, LLM_FFN_PAR, cb, il, &loras);
                 cb(cur, "ffn_out", il);
             }
 
@@ -3938,12 +4072,12 @@ struct llm_build_context {
         cur = inpL;
 
         cur = llm_build_norm(ctx0, cur, hparams,
-                             model.output_norm, NULL,
+                             llm_build_lora_weight(ctx0, &loras, model.output_norm, cb, -1), NULL,
                              LLM_NORM_RMS, cb, -1);
         cb(cur, "result_norm", -1);
 
         // lm_head
-        cur = ggml_mul_mat(ctx0, model.output, cur);
+        cur = llm_build_lora_mm(ctx0, &loras, model.output, cur, cb, -1);
         cb(cur, "result_output", -1);
 
         ggml_build_forward_expand(gf, cur);
@@ -5499,7 +5633,8 @@ static int llama_decode_internal(
     ggml_allocr_alloc_graph(lctx.alloc, gf);
 
     struct ggml_tensor * res        = gf->nodes[gf->n_nodes - 1];
-    struct ggml_tensor * embeddings = gf->nodes[gf->n_nodes - 2];
+    // lora adapters on the output add nodes after the final norm
+    struct ggml_tensor * embeddings = lctx.lora_adapters.empty() ? gf->nodes[gf->n_nodes - 2] : ggml_graph_get_tensor(gf, "result_norm");
 
     GGML_ASSERT(strcmp(res->name,        "result_output") == 0);
     GGML_ASSERT(strcmp(embeddings->name, "result_norm")   == 0);
@@ -8369,8 +8504,9 @@ struct llama_context_params llama_context_default_params() {
             /*.yarn_beta_fast              =*/ 32.0f,
             /*.yarn_beta_slow              =*/ 1.0f,
             /*.yarn_orig_ctx               =*/ 0,
+            /*.type_k                      =*/ GGML_TYPE_F16,
+            /*.type_v                      =*/ GGML_TYPE_F16,
             /*.mul_mat_q                   =*/ true,
-            /*.f16_kv                      =*/ true,
             /*.logits_all                  =*/ false,
             /*.embedding                   =*/ false,
     };
@@ -8522,11 +8658,25 @@ struct llama_context * llama_new_context_with_model(
     ctx->rng = std::mt19937(params.seed);
     ctx->logits_all = params.logits_all;
 
-    ggml_type memory_type = params.f16_kv ? GGML_TYPE_F16 : GGML_TYPE_F32;
+    const ggml_type type_k = params.type_k;
+    const ggml_type type_v = params.type_v;
+
+    if (type_v != GGML_TYPE_F32 && type_v != GGML_TYPE_F16) {
+        LLAMA_LOG_ERROR("%s: V cache type %s is not supported, the V cache is stored transposed\n", __func__, ggml_type_name(type_v));
+        llama_free(ctx);
+        return nullptr;
+    }
+
+    if (ggml_is_quantized(type_k) && hparams.n_embd_head() % ggml_blck_size(type_k) != 0) {
+        LLAMA_LOG_ERROR("%s: K cache type %s needs n_embd_head (%u) to be a multiple of %d\n", __func__,
+                ggml_type_name(type_k), hparams.n_embd_head(), ggml_blck_size(type_k));
+        llama_free(ctx);
+        return nullptr;
+    }
 
     // reserve memory for context buffers
     if (!hparams.vocab_only) {
-        if (!llama_kv_cache_init(ctx->model.hparams, ctx->kv_self, memory_type, cparams.n_ctx, model->n_gpu_layers)) {
+        if (!llama_kv_cache_init(ctx->model.hparams, ctx->kv_self, type_k, type_v, cparams.n_ctx, model->n_gpu_layers)) {
             LLAMA_LOG_ERROR("%s: llama_kv_cache_init() failed for self-attention cache\n", __func__);
             llama_free(ctx);
             return nullptr;
@@ -8534,7 +8684,8 @@ struct llama_context * llama_new_context_with_model(
 
         {
             const size_t memory_size = ggml_nbytes(ctx->kv_self.k) + ggml_nbytes(ctx->kv_self.v);
-            LLAMA_LOG_INFO("%s: kv self size  = %7.2f MiB\n", __func__, memory_size / 1024.0 / 1024.0);
+            LLAMA_LOG_INFO("%s: kv self size  = %7.2f MiB (K %s, V %s)\n", __func__, memory_size / 1024.0 / 1024.0,
+                    ggml_type_name(type_k), ggml_type_name(type_v));
         }
 
         // resized during inference
@@ -8714,6 +8865,10 @@ int llama_model_meta_val_str(const struct llama_model * model, const char * key,
     return snprintf(buf, buf_size, "%s", it->second.c_str());
 }
 
+const struct gguf_context * llama_model_get_gguf(const struct llama_model * model) {
+    return model->ctx_gguf;
+}
+
 int llama_model_meta_count(const struct llama_model * model) {
     return (int)model->gguf_kv.size();
 }
@@ -8800,10 +8955,287 @@ int llama_model_apply_lora_from_file(const struct llama_model * model, const cha
     }
 }
 
+static struct llama_lora_adapter * llama_lora_adapter_init_internal(
+        const struct llama_model & model, const char * path_lora, float scale
+) {
+    LLAMA_LOG_INFO("%s: loading lora adapter from '%s'\n", __func__, path_lora);
+
+    if (model.arch != LLM_ARCH_LLAMA) {
+        LLAMA_LOG_ERROR("%s: runtime lora adapters are only supported for llama models\n", __func__);
+        return nullptr;
+    }
+
+    auto fin = std::ifstream(path_lora, std::ios::binary);
+    if (!fin) {
+        LLAMA_LOG_ERROR("%s: failed to open '%s'\n", __func__, path_lora);
+        return nullptr;
+    }
+
+    // verify magic and version
+    {
+        uint32_t magic = 0;
+        fin.read((char *) &magic, sizeof(magic));
+        uint32_t format_version = 0;
+        fin.read((char *) &format_version, sizeof(format_version));
+
+        if (magic != 0x67676C61 /* 'ggla' */ || format_version != 1) {
+            LLAMA_LOG_ERROR("%s: unsupported file\n", __func__);
+            return nullptr;
+        }
+    }
+
+    int32_t lora_r = 0;
+    int32_t lora_alpha = 0;
+    fin.read((char *) &lora_r, sizeof(lora_r));
+    fin.read((char *) &lora_alpha, sizeof(lora_alpha));
+    if (!fin || lora_r <= 0) {
+        LLAMA_LOG_ERROR("%s: invalid lora header\n", __func__);
+        return nullptr;
+    }
+    const float scaling = scale * (float)lora_alpha / (float)lora_r;
+
+    std::unordered_map<std::string, struct ggml_tensor *> model_tensors;
+    for (const auto & kv : model.tensors_by_name) {
+        model_tensors.insert(kv);
+    }
+
+    // A and B are read first and converted once both halves of a weight are known
+    struct lora_matrix {
+        int64_t ne[2];
+        std::vector<float> data;
+    };
+    std::map<std::string, lora_matrix> matrices;
+
+    while (true) {
+        int32_t n_dims;
+        int32_t length;
+        int32_t ftype;
+
+        fin.read(reinterpret_cast<char *>(&n_dims), sizeof(n_dims));
+        fin.read(reinterpret_cast<char *>(&length), sizeof(length));
+        fin.read(reinterpret_cast<char *>(&ftype),  sizeof(ftype));
+        if (fin.eof()) {
+            break;
+        }
+
+        if (n_dims != 2 || length <= 0 || length >= 1024 || ftype != 0) {
+            LLAMA_LOG_ERROR("%s: unsupported tensor (n_dims = %d, type = %d)\n", __func__, n_dims, ftype);
+            return nullptr;
+        }
+
+        int32_t ne[2] = { 1, 1 };
+        fin.read(reinterpret_cast<char *>(ne), sizeof(ne));
+
+        std::string name(length, '\0');
+        fin.read(&name[0], length);
+
+        const size_t pos = name.rfind(".lora");
+        if (pos == std::string::npos || model_tensors.find(name.substr(0, pos)) == model_tensors.end()) {
+            LLAMA_LOG_ERROR("%s: unknown tensor '%s' in lora adapter\n", __func__, name.c_str());
+            return nullptr;
+        }
+
+        lora_matrix & m = matrices[name];
+        m.ne[0] = ne[0];
+        m.ne[1] = ne[1];
+        m.data.resize((size_t) ne[0] * ne[1]);
+
+        size_t offset = fin.tellg();
+        offset = (offset + 31) & -32;
+        fin.seekg(offset);
+        fin.read((char *) m.data.data(), m.data.size() * sizeof(float));
+        if (!fin) {
+            LLAMA_LOG_ERROR("%s: unexpected end of file\n", __func__);
+            return nullptr;
+        }
+    }
+
+    // measure the context for the converted tensors
+    size_t ctx_size = 0;
+    for (const auto & kv : matrices) {
+        ctx_size += 2 * (ggml_tensor_overhead() + kv.second.data.size() * sizeof(float) + GGML_MEM_ALIGN);
+    }
+
+    struct ggml_init_params params;
+    params.mem_size   = ctx_size + ggml_tensor_overhead();
+    params.mem_buffer = NULL;
+    params.no_alloc   = false;
+
+    std::unique_ptr<llama_lora_adapter> adapter(new llama_lora_adapter());
+    adapter->model = &model;
+    adapter->ctx   = ggml_init(params);
+    if (!adapter->ctx) {
+        LLAMA_LOG_ERROR("%s: failed to allocate %zu bytes for the adapter\n", __func__, params.mem_size);
+        return nullptr;
+    }
+
+    size_t n_bytes = 0;
+    for (const auto & kv : matrices) {
+        const std::string & name = kv.first;
+        if (name.size() < 5 || name.compare(name.size() - 5, 5, "loraA") != 0) {
+            continue;
+        }
+
+        const std::string base_name = name.substr(0, name.size() - 6); // strip ".loraA"
+        const auto it_b = matrices.find(base_name + ".loraB");
+        if (it_b == matrices.end()) {
+            LLAMA_LOG_ERROR("%s: '%s' has no matching loraB\n", __func__, name.c_str());
+            return nullptr;
+        }
+
+        const lora_matrix & A = kv.second;   // [r, n_in]
+        const lora_matrix & B = it_b->second; // [r, n_out]
+        const int64_t r = A.ne[0];
+
+        const struct ggml_tensor * dest = model_tensors.at(base_name);
+        if (B.ne[0] != r || dest->ne[0] != A.ne[1] || dest->ne[1] != B.ne[1]) {
+            LLAMA_LOG_ERROR("%s: incompatible tensor dimensions for '%s';"
+                            " are you sure that this adapter is for this model?\n", __func__, base_name.c_str());
+            return nullptr;
+        }
+
+        llama_lora_weight w;
+        if (dest->n_dims == 1) {
+            w.delta = ggml_new_tensor_1d(adapter->ctx, GGML_TYPE_F32, dest->ne[0]);
+            float * delta = (float *) w.delta->data;
+            for (int64_t i = 0; i < dest->ne[0]; i++) {
+                float sum = 0.0f;
+                for (int64_t k = 0; k < r; k++) {
+                    sum += A.data[i*r + k] * B.data[k];
+                }
+                delta[i] = scaling * sum;
+            }
+            n_bytes += ggml_nbytes(w.delta);
+        } else {
+            if (dest == model.tok_embd) {
+                // used as A * get_rows(B), see llm_build_inp_embd
+                w.a = ggml_new_tensor_2d(adapter->ctx, GGML_TYPE_F32, r, A.ne[1]);
+                memcpy(w.a->data, A.data.data(), ggml_nbytes(w.a));
+            } else {
+                w.a = ggml_new_tensor_2d(adapter->ctx, GGML_TYPE_F32, A.ne[1], r);
+                float * a_t = (float *) w.a->data;
+                for (int64_t i = 0; i < A.ne[1]; i++) {
+                    for (int64_t k = 0; k < r; k++) {
+                        a_t[k*A.ne[1] + i] = A.data[i*r + k];
+                    }
+                }
+            }
+
+            w.b = ggml_new_tensor_2d(adapter->ctx, GGML_TYPE_F32, r, B.ne[1]);
+            float * b = (float *) w.b->data;
+            for (size_t i = 0; i < B.data.size(); i++) {
+                b[i] = scaling * B.data[i];
+            }
+            n_bytes += ggml_nbytes(w.a) + ggml_nbytes(w.b);
+        }
+
+        adapter->weights[dest] = w;
+    }
+
+    LLAMA_LOG_INFO("%s: r = %d, alpha = %d, scaling = %.2f, %zu weights, %.2f MiB\n", __func__,
+                   lora_r, lora_alpha, scaling, adapter->weights.size(), n_bytes / 1024.0 / 1024.0);
+
+    return adapter.release();
+}
+
+struct llama_lora_adapter * llama_lora_adapter_init(struct llama_model * model, const char * path_lora, float scale) {
+    try {
+        return llama_lora_adapter_init_internal(*model, path_lora, scale);
+    } catch (const std::exception & err) {
+        LLAMA_LOG_ERROR("%s: failed to load lora adapter: %s\n", __func__, err.what());
+        return nullptr;
+    }
+}
+
+void llama_lora_adapter_free(struct llama_lora_adapter * adapter) {
+    delete adapter;
+}
+
+void llama_lora_adapter_add_tok_embd(const struct llama_lora_adapter * adapter, llama_token token, float * embd) {
+    const auto it = adapter->weights.find(adapter->model->tok_embd);
+    if (it == adapter->weights.end()) {
+        return;
+    }
+
+    const struct ggml_tensor * a = it->second.a; // [r, n_embd]
+    const struct ggml_tensor * b = it->second.b; // [r, n_vocab]
+    const int64_t r       = a->ne[0];
+    const int64_t n_embd  = a->ne[1];
+
+    GGML_ASSERT(token >= 0 && token < b->ne[1]);
+
+    const float * b_v = (const float *) b->data + token*r;
+    for (int64_t i = 0; i < n_embd; i++) {
+        const float * a_i = (const float *) a->data + i*r;
+        float sum = 0.0f;
+        for (int64_t k = 0; k < r; k++) {
+            sum += a_i[k] * b_v[k];
+        }
+        embd[i] += sum;
+    }
+}
+
+int llama_set_lora_adapters(struct llama_context * ctx, struct llama_lora_adapter ** adapters, int n_adapters) {
+#if defined(GGML_USE_CUBLAS) || defined(GGML_USE_METAL) || defined(GGML_USE_MPI)
+    LLAMA_LOG_ERROR("%s: runtime lora adapters are only supported on the CPU\n", __func__);
+    return 1;
+#endif
+
+    for (int i = 0; i < n_adapters; i++) {
+        if (adapters[i]->model != &ctx->model) {
+            LLAMA_LOG_ERROR("%s: adapter %d was loaded for a different model\n", __func__, i);
+            return 1;
+        }
+    }
+
+    ctx->lora_adapters.assign(adapters, adapters + n_adapters);
+
+    // the cache holds K and V computed with the previous weights
+    llama_kv_cache_clear(ctx->kv_self);
+
+    // the adapter nodes change the size of the worst-case graph
+    {
+        static const size_t tensor_alignment = 32;
+
+        ggml_allocr_free(ctx->alloc);
+        ctx->alloc = ggml_allocr_new_measure(tensor_alignment);
+
+        const auto & cparams = ctx->cparams;
+        int n_tokens = (int)std::min(cparams.n_ctx, cparams.n_batch);
+        int n_past = cparams.n_ctx - n_tokens;
+        llama_token token = llama_token_bos(&ctx->model);
+        ggml_cgraph * gf = llama_build_graph(*ctx, llama_batch_get_one(&token, n_tokens, n_past, 0));
+
+        size_t alloc_size = ggml_allocr_alloc_graph(ctx->alloc, gf) + tensor_alignment;
+
+        LLAMA_LOG_INFO("%s: %d adapters, compute buffer total size = %.2f MiB\n", __func__, n_adapters,
+                       (ctx->buf_compute.size + alloc_size) / 1024.0 / 1024.0);
+
+        ggml_allocr_free(ctx->alloc);
+
+        ctx->buf_alloc.resize(alloc_size);
+        ctx->alloc = ggml_allocr_new(ctx->buf_alloc.data, ctx->buf_alloc.size, tensor_alignment);
+    }
+
+    return 0;
+}
+
 int llama_get_kv_cache_token_count(const struct llama_context * ctx) {
     return ctx->kv_self.head;
 }
 
+size_t llama_kv_cache_size(const struct llama_context * ctx) {
+    if (ctx->kv_self.k == nullptr) {
+        return 0;
+    }
+
+    return ggml_nbytes(ctx->kv_self.k) + ggml_nbytes(ctx->kv_self.v);
+}
+
+size_t llama_compute_buffer_size(const struct llama_context * ctx) {
+    return ctx->buf_compute.size + ctx->buf_alloc.size;
+}
+
 void llama_kv_cache_clear(struct llama_context * ctx) {
     llama_kv_cache_clear(ctx->kv_self);
 }
@@ -8977,28 +9409,28 @@ static void llama_copy_state_data_internal(struct llama_context * ctx, llama_dat
         data_ctx->write(&kv_size,     sizeof(kv_size));
 
         if (kv_buf_size) {
-            const size_t elt_size = ggml_element_size(kv_self.k);
+            const size_t elt_size   = ggml_element_size(kv_self.v);
+            const size_t k_row_size = ggml_row_size(kv_self.k->type, n_embd);
 
             ggml_context * cpy_ctx = ggml_init({ 6*ggml_tensor_overhead() + ggml_graph_overhead(), NULL, /* no_alloc */ true });
             ggml_cgraph * gf = ggml_new_graph(cpy_ctx);
 
-            ggml_tensor * kout3d = ggml_new_tensor_3d(cpy_ctx, kv_self.k->type, n_embd, kv_head, n_layer);
-            std::vector<uint8_t> kout3d_data(ggml_nbytes(kout3d), 0);
-            kout3d->data = kout3d_data.data();
+            // the first kv_head rows of each K layer are contiguous, which also works for quantized K
+            std::vector<uint8_t> kout3d_data(k_row_size*kv_head*n_layer, 0);
+            for (uint32_t il = 0; il < n_layer; ++il) {
+                memcpy(kout3d_data.data() + k_row_size*kv_head*il,
+                       (const uint8_t *) kv_self.k->data + k_row_size*n_ctx*il,
+                       k_row_size*kv_head);
+            }
 
             ggml_tensor * vout3d = ggml_new_tensor_3d(cpy_ctx, kv_self.v->type, kv_head, n_embd, n_layer);
             std::vector<uint8_t> vout3d_data(ggml_nbytes(vout3d), 0);
             vout3d->data = vout3d_data.data();
 
-            ggml_tensor * k3d = ggml_view_3d(cpy_ctx, kv_self.k,
-                                             n_embd, kv_head, n_layer,
-                                             elt_size*n_embd, elt_size*n_embd*n_ctx, 0);
-
             ggml_tensor * v3d = ggml_view_3d(cpy_ctx, kv_self.v,
                                              kv_head, n_embd, n_layer,
                                              elt_size*n_ctx, elt_size*n_ctx*n_embd, 0);
 
-            ggml_build_forward_expand(gf, ggml_cpy(cpy_ctx, k3d, kout3d));
             ggml_build_forward_expand(gf, ggml_cpy(cpy_ctx, v3d, vout3d));
             ggml_graph_compute_helper(ctx->work_buffer, gf, /*n_threads*/ 1);
 
@@ -9105,28 +9537,25 @@ size_t llama_set_state_data(struct llama_context * ctx, uint8_t * src) {
         if (kv_buf_size) {
             GGML_ASSERT(kv_self.buf.size == kv_buf_size);
 
-            const size_t elt_size = ggml_element_size(kv_self.k);
+            const size_t elt_size   = ggml_element_size(kv_self.v);
+            const size_t k_row_size = ggml_row_size(kv_self.k->type, n_embd);
 
             ggml_context * cpy_ctx = ggml_init({ 6*ggml_tensor_overhead() + ggml_graph_overhead(), NULL, /* no_alloc */ true });
             ggml_cgraph * gf = ggml_new_graph(cpy_ctx);
 
-            ggml_tensor * kin3d = ggml_new_tensor_3d(cpy_ctx, kv_self.k->type, n_embd, kv_head, n_layer);
-            kin3d->data = (void *) inp;
-            inp += ggml_nbytes(kin3d);
+            for (int il = 0; il < n_layer; ++il) {
+                memcpy((uint8_t *) kv_self.k->data + k_row_size*n_ctx*il, inp, k_row_size*kv_head);
+                inp += k_row_size*kv_head;
+            }
 
             ggml_tensor * vin3d = ggml_new_tensor_3d(cpy_ctx, kv_self.v->type, kv_head, n_embd, n_layer);
             vin3d->data = (void *) inp;
             inp += ggml_nbytes(vin3d);
 
-            ggml_tensor * k3d = ggml_view_3d(cpy_ctx, kv_self.k,
-                                             n_embd, kv_head, n_layer,
-                                             elt_size*n_embd, elt_size*n_embd*n_ctx, 0);
-
             ggml_tensor * v3d = ggml_view_3d(cpy_ctx, kv_self.v,
                                              kv_head, n_embd, n_layer,
                                              elt_size*n_ctx, elt_size*n_ctx*n_embd, 0);
 
-            ggml_build_forward_expand(gf, ggml_cpy(cpy_ctx, kin3d, k3d));
             ggml_build_forward_expand(gf, ggml_cpy(cpy_ctx, vin3d, v3d));
             ggml_graph_compute_helper(ctx->work_buffer, gf, /*n_threads*/ 1);
 
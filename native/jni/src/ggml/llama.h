@@ -193,9 +193,11 @@ struct llama_context_params {
     float    yarn_beta_slow;   // YaRN high correction dim
     uint32_t yarn_orig_ctx;    // YaRN original context size
 
+    enum ggml_type type_k; // data type for K cache: F32, F16 or a quantized type (n_embd_head must be a multiple of its block size)
+    enum ggml_type type_v; // data type for V cache: F32 or F16, V is stored transposed so it cannot be block-quantized
+
     // Keep the booleans together to avoid misalignment during copy-by-value.
     bool mul_mat_q;  // if true, use experimental mul_mat_q kernels (DEPRECATED - always true)
-    bool f16_kv;     // use fp16 for KV cache, fp32 otherwise
     bool logits_all; // the llama_eval() call computes all logits, not just the last one
     bool embedding;  // embedding mode only
 };
@@ -320,6 +322,10 @@ LLAMA_API int llama_model_meta_key_by_index(const struct llama_model * model, in
 // Get metadata value as a string by index
 LLAMA_API int llama_model_meta_val_str_by_index(const struct llama_model * model, int i, char * buf, size_t buf_size);
 
+// Get the GGUF context the model was loaded from, valid for the lifetime of the model. Unlike the functions
+// above this also gives access to array values, without parsing the file a second time
+LLAMA_API const struct gguf_context * llama_model_get_gguf(const struct llama_model * model);
+
 // Get a string describing the model type
 LLAMA_API int llama_model_desc(const struct llama_model * model, char * buf, size_t buf_size);
 
@@ -359,6 +365,34 @@ LLAMA_API int llama_model_apply_lora_from_file(
         const char * path_base_model,
         int   n_threads);
 
+// Runtime LoRA adapters. Unlike llama_model_apply_lora_from_file the model weights are left untouched (and can
+// stay mmap-ed): the low-rank update is evaluated in the graph, so an adapter costs only its own size in memory
+// and can be swapped without reloading the model. Only llama architecture models are supported.
+struct llama_lora_adapter;
+
+// Loads an adapter in the format read by llama_model_apply_lora_from_file, scaled by scale * alpha / r.
+// Returns NULL on failure. The adapter must be freed before the model
+LLAMA_API struct llama_lora_adapter * llama_lora_adapter_init(
+        struct llama_model * model,
+        const char * path_lora,
+        float   scale);
+
+LLAMA_API void llama_lora_adapter_free(struct llama_lora_adapter * adapter);
+
+// Adds the adapter's update of the embedding of token to embd (n_embd floats). Needed by callers that pass
+// llama_batch.embd rows taken from the model's token embeddings
+LLAMA_API void llama_lora_adapter_add_tok_embd(
+        const struct llama_lora_adapter * adapter,
+        llama_token token,
+        float * embd);
+
+// Replaces the adapters evaluated by the context, n_adapters = 0 removes all of them. The adapters are not
+// owned by the context and must outlive their use in it. Clears the KV cache. Returns 0 on success
+LLAMA_API int llama_set_lora_adapters(
+        struct llama_context * ctx,
+        struct llama_lora_adapter ** adapters,
+        int   n_adapters);
+
 //
 // KV cache
 //
@@ -367,6 +401,12 @@ LLAMA_API int llama_model_apply_lora_from_file(
 LLAMA_API DEPRECATED(int llama_get_kv_cache_token_count(const struct llama_context * ctx),
                      "avoid using this, it will be removed in the future, instead - count the tokens in user code");
 
+// Returns the size of the K and V cache tensors in bytes
+LLAMA_API size_t llama_kv_cache_size(const struct llama_context * ctx);
+
+// Returns the size of the compute buffers (graph and tensor data) in bytes
+LLAMA_API size_t llama_compute_buffer_size(const struct llama_context * ctx);
+
 // Clear the KV cache
 LLAMA_API void llama_kv_cache_clear(
         struct llama_context * ctx);
@@ -2,6 +2,7 @@
 #include "common.h"
 #include "defines.h"
 
+#include <cstring>
 #include <random>
 #include <sstream>
 #include <functional>
@@ -1392,6 +1393,14 @@ void train_opt_callback(void * vdata, int accum_step, float * sched, bool * canc
     int n_ctx = params->n_ctx;
 
     if (accum_step == 0) {
+        // stop between optimizer iterations once the time budget is used up, the caller saves a checkpoint.
+        // the first call comes before any iteration, so every slice makes progress even on a slow device
+        if (data->deadline_ms > 0 && opt->iter > data->first_iter && ggml_time_ms() >= data->deadline_ms) {
+            data->deadline_reached = true;
+            *cancel = true;
+            return;
+        }
+
         // time measurement
         int64_t now = ggml_time_ms();
         if (now > data->last_time && opt->iter > data->first_iter) {
@@ -1407,8 +1416,7 @@ void train_opt_callback(void * vdata, int accum_step, float * sched, bool * canc
         double remaining_millis = 0.0;
         if (data->millis_per_iter > 0.0) {
             const int n_iter = params->adam_n_iter;
-            const int done_iter = opt->iter - data->first_iter;
-            const int remaining_iter = n_iter - done_iter;
+            const int remaining_iter = n_iter - opt->iter;
             remaining_millis = remaining_iter * data->millis_per_iter;
         }
 
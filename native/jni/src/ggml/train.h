@@ -103,10 +103,10 @@ struct train_opt_callback_data {
     void                       * save_data;
     struct llama_context       * lctx;
     int                          last_save_iter;
-    llama_token                * tokens_data;
+    const llama_token          * tokens_data;
     size_t                       tokens_size;
-    size_t                     * samples_begin;
-    size_t                     * samples_size;
+    const size_t               * samples_begin;
+    const size_t               * samples_size;
     size_t                     * shuffled_samples_offs;
     size_t                     * shuffled_samples_begin;
     size_t                     * shuffled_samples_size;
@@ -118,6 +118,8 @@ struct train_opt_callback_data {
     int                          iter_at_last_epoch;
     int64_t                      last_time;
     double                       millis_per_iter;
+    int64_t                      deadline_ms;       // ggml_time_ms() after which training stops, 0 = no deadline
+    bool                         deadline_reached;
 };
 
 struct train_state * init_train_state();
@@ -822,6 +822,12 @@ struct whisper_state {
     std::vector<float> inp_mel;
     std::vector<float> inp_mask;
 
+    // padded PCM work buffer for log_mel_spectrogram, kept across calls to avoid a ~2MB allocation per inference
+    std::vector<float> samples_padded;
+
+    // set by whisper_warmup_with_state() once the buffers below have been sized and touched
+    bool warmed_up = false;
+
     // decode output (2-dimensional array: [n_tokens][n_vocab])
     std::vector<float> logits;
 
@@ -2869,7 +2875,7 @@ static bool log_mel_spectrogram(
     int64_t stage_2_pad = frame_size / 2;
 
     // Initialize a vector and copy data from C array to it.
-    std::vector<float> samples_padded;
+    std::vector<float> & samples_padded = wstate.samples_padded;
     samples_padded.resize(n_samples + stage_1_pad + stage_2_pad * 2);
     std::copy(samples, samples + n_samples, samples_padded.begin() + stage_2_pad);
 
@@ -2892,7 +2898,7 @@ static bool log_mel_spectrogram(
         std::vector<std::thread> workers(n_threads - 1);
         for (int iw = 0; iw < n_threads - 1; ++iw) {
             workers[iw] = std::thread(
-                    log_mel_spectrogram_worker_thread, iw + 1, std::cref(hann), samples_padded,
+                    log_mel_spectrogram_worker_thread, iw + 1, std::cref(hann), std::cref(samples_padded),
                     n_samples + stage_2_pad, frame_size, frame_step, n_threads,
                     std::cref(filters), std::ref(mel));
         }
@@ -3561,6 +3567,85 @@ int whisper_decode(struct whisper_context * ctx, const whisper_token * tokens, i
     return whisper_decode_with_state(ctx, ctx->state, tokens, n_tokens, n_past, n_threads);
 }
 
+int whisper_warmup_with_state(struct whisper_context * ctx, struct whisper_state * state, int n_threads) {
+    if (state->warmed_up) {
+        return 0;
+    }
+
+    // TAGS: WHISPER_DECODER_INIT
+    // size every decoder up-front so whisper_full() does not allocate when the beam size changes
+    for (int j = 1; j < WHISPER_MAX_DECODERS; j++) {
+        auto & decoder = state->decoders[j];
+
+        decoder.sequence.tokens.reserve(state->decoders[0].sequence.tokens.capacity());
+
+        decoder.probs.resize   (ctx->vocab.n_vocab);
+        decoder.logits.resize  (ctx->vocab.n_vocab);
+        decoder.logprobs.resize(ctx->vocab.n_vocab);
+        decoder.logits_id.reserve(ctx->model.hparams.n_vocab);
+    }
+
+    // reserve the mel work buffers for the longest chunk we accept (30s of audio + 30s of padding)
+    {
+        const int64_t n_samples_max = 2*WHISPER_CHUNK_SIZE*WHISPER_SAMPLE_RATE;
+
+        state->samples_padded.reserve(n_samples_max + WHISPER_N_FFT);
+        state->mel.data.reserve(ctx->model.filters.n_mel*(n_samples_max/WHISPER_HOP_LENGTH + 1));
+    }
+
+    // run the full-size encoder and a single decoder step over one second of silence, so that the
+    // compute buffers and the model weights are paged in before the first real request
+    {
+        const std::vector<float> silence(WHISPER_SAMPLE_RATE, 0.0f);
+
+        if (whisper_pcm_to_mel_with_state(ctx, state, silence.data(), (int) silence.size(), n_threads) != 0) {
+            WHISPER_LOG_ERROR("%s: failed to compute mel spectrogram\n", __func__);
+            return -1;
+        }
+
+        state->exp_n_audio_ctx = 0;
+
+        if (whisper_encode_with_state(ctx, state, 0, n_threads) != 0) {
+            WHISPER_LOG_ERROR("%s: failed to encode\n", __func__);
+            return -2;
+        }
+
+        const whisper_token sot = whisper_token_sot(ctx);
+        if (whisper_decode_with_state(ctx, state, &sot, 1, 0, n_threads) != 0) {
+            WHISPER_LOG_ERROR("%s: failed to decode\n", __func__);
+            return -3;
+        }
+
+        whisper_kv_cache_clear(state->kv_self);
+    }
+
+    // the warmup pass should not show up in the timings of the first real request
+    state->t_sample_us = 0;
+    state->t_encode_us = 0;
+    state->t_decode_us = 0;
+    state->t_batchd_us = 0;
+    state->t_prompt_us = 0;
+    state->t_mel_us    = 0;
+    state->n_sample = 0;
+    state->n_encode = 0;
+    state->n_decode = 0;
+    state->n_batchd = 0;
+    state->n_prompt = 0;
+
+    state->warmed_up = true;
+
+    return 0;
+}
+
+int whisper_warmup(struct whisper_context * ctx, int n_threads) {
+    if (ctx->state == nullptr) {
+        WHISPER_LOG_ERROR("%s: ERROR state was not loaded.\n", __func__);
+        return -1;
+    }
+
+    return whisper_warmup_with_state(ctx, ctx->state, n_threads);
+}
+
 int whisper_tokenize(struct whisper_context * ctx, const char * text, whisper_token * tokens, int n_max_tokens) {
     const auto res = tokenize(ctx->vocab, text);
 
@@ -4405,6 +4490,9 @@ struct whisper_full_params whisper_full_default_params(enum whisper_sampling_str
             /*.allowed_langs     =*/ nullptr,
             /*.allowed_langs_size=*/ 0,
 
+            /*.bail_langs        =*/ nullptr,
+            /*.bail_langs_size   =*/ 0,
+
             /*.suppress_blank    =*/ true,
             /*.suppress_non_speech_tokens =*/ false,
 
@@ -5065,7 +5153,9 @@ int whisper_full_with_state(
     if (params.language == nullptr || strlen(params.language) == 0 || strcmp(params.language, "auto") == 0 || params.detect_language) {
         std::vector<float> probs(whisper_lang_max_id() + 1, 0.0f);
 
-        const auto lang_id = whisper_lang_auto_detect_with_state(ctx, state, 0, params.n_threads, probs.data(), params.allowed_langs, params.allowed_langs_size);
+        // detection runs the encoder at the same offset and audio_ctx as the first window of the main
+        // loop, so its output is reused below instead of encoding the same audio twice
+        const auto lang_id = whisper_lang_auto_detect_with_state(ctx, state, params.offset_ms, params.n_threads, probs.data(), params.allowed_langs, params.allowed_langs_size);
         encoding_required = false;
         if (lang_id < 0) {
             WHISPER_LOG_ERROR("%s: failed to auto-detect language\n", __func__);
@@ -5081,6 +5171,18 @@ int whisper_full_with_state(
     }
     TIME_END(detect_lang)
 
+    // bail out on a forbidden language before any decoding (or, for a forced language, any encoding) happens
+    if (params.bail_langs != nullptr && params.bail_langs_size > 0) {
+        const int lang_id = whisper_lang_id(params.language);
+        for (size_t i = 0; i < params.bail_langs_size; i++) {
+            if (params.bail_langs[i] == lang_id) {
+                state->lang_id = lang_id;
+                WHISPER_LOG_INFO("%s: language %s is in bail_langs, stopping before decoding\n", __func__, params.language);
+                return 0;
+            }
+        }
+    }
+
     TIME_START(token_timestamps_energy)
     if (params.token_timestamps) {
         state->t_beg    = 0;
@@ -5252,7 +5354,7 @@ int whisper_full_with_state(
         }
 
         // encode audio features starting at offset seek
-        if(encoding_required || seek > 0) {
+        if(encoding_required || seek != seek_start) {
             if (!whisper_encode_internal(*ctx, *state, seek, params.n_threads,
                                          params.abort_callback, params.abort_callback_user_data)) {
                 WHISPER_LOG_ERROR("%s: failed to encode\n", __func__);
@@ -292,6 +292,20 @@ WHISPER_API int whisper_decode_with_state(
         int   n_past,
         int   n_threads);
 
+// Prepare the state for repeated whisper_full() calls (session mode).
+// Sizes all decoders and mel work buffers for the largest supported input and runs the encoder at the
+// full audio context once, so the compute buffers and weights are resident before the first request.
+// Calling it again on an already warmed state is a no-op.
+// Returns 0 on success
+WHISPER_API int whisper_warmup(
+        struct whisper_context * ctx,
+        int   n_threads);
+
+WHISPER_API int whisper_warmup_with_state(
+        struct whisper_context * ctx,
+        struct whisper_state * state,
+        int   n_threads);
+
 // Convert the provided text into tokens.
 // The tokens pointer must be large enough to hold the resulting tokens.
 // Returns the number of tokens on success, no more than n_max_tokens
@@ -476,9 +490,15 @@ struct whisper_full_params {
     const char * language;
     bool detect_language;
 
+    // restricts auto-detection to these language ids (nullptr = any language)
     const int * allowed_langs;
     size_t allowed_langs_size;
 
+    // if the detected (or forced) language is one of these ids, whisper_full() returns 0 right after
+    // language detection without decoding anything; check whisper_full_lang_id() to tell this case apart
+    const int * bail_langs;
+    size_t bail_langs_size;
+
     // common decoding parameters:
     bool suppress_blank;    // ref: https://github.com/openai/whisper/blob/f82bc59f5ea234d4b97fb2860842ed38519f7e65/whisper/decoding.py#L89
     bool suppress_non_speech_tokens; // ref: https://github.com/openai/whisper/blob/7858aa9c08d98f75575035ecd6481f462d66ca27/whisper/tokenizer.py#L224-L253
@@ -3,6 +3,7 @@
 //
 
 #include "jni_utils.h"
+#include <cstring>
 #include <string>
 #include "defines.h"
 
@@ -105,9 +105,10 @@ class DicNode {
     }
 
     // Init for root with prevWordIds which is used for n-gram
-    void initAsRoot(const int rootPtNodeArrayPos, const WordIdArrayView prevWordIds) {
+    void initAsRoot(const int rootPtNodeArrayPos, const WordIdArrayView prevWordIds,
+            const int dictionaryIndex) {
         mIsCachedForNextSuggestion = false;
-        mDicNodeProperties.init(rootPtNodeArrayPos, prevWordIds);
+        mDicNodeProperties.init(rootPtNodeArrayPos, prevWordIds, dictionaryIndex);
         mDicNodeState.init();
         PROF_NODE_RESET(mProfiler);
     }
@@ -119,7 +120,8 @@ class DicNode {
         newPrevWordIds[0] = dicNode->mDicNodeProperties.getWordId();
         dicNode->getPrevWordIds().limit(newPrevWordIds.size() - 1)
                 .copyToArray(&newPrevWordIds, 1 /* offset */);
-        mDicNodeProperties.init(rootPtNodeArrayPos, WordIdArrayView::fromArray(newPrevWordIds));
+        mDicNodeProperties.init(rootPtNodeArrayPos, WordIdArrayView::fromArray(newPrevWordIds),
+                dicNode->mDicNodeProperties.getDictionaryIndex());
         mDicNodeState.initAsRootWithPreviousWord(&dicNode->mDicNodeState,
                 dicNode->mDicNodeProperties.getDepth());
         PROF_NODE_COPY(&dicNode->mProfiler, mProfiler);
@@ -142,7 +144,8 @@ class DicNode {
         const uint16_t newLeavingDepth = static_cast<uint16_t>(
                 dicNode->mDicNodeProperties.getLeavingDepth() + mergedCodePoints.size());
         mDicNodeProperties.init(childrenPtNodeArrayPos, mergedCodePoints[0],
-                wordId, newDepth, newLeavingDepth, dicNode->mDicNodeProperties.getPrevWordIds());
+                wordId, newDepth, newLeavingDepth, dicNode->mDicNodeProperties.getPrevWordIds(),
+                dicNode->mDicNodeProperties.getDictionaryIndex());
         mDicNodeState.init(&dicNode->mDicNodeState, mergedCodePoints.size(),
                 mergedCodePoints.data());
         PROF_NODE_COPY(&dicNode->mProfiler, mProfiler);
@@ -206,6 +209,10 @@ class DicNode {
         return mDicNodeProperties.getPrevWordIds();
     }
 
+    int getDictionaryIndex() const {
+        return mDicNodeProperties.getDictionaryIndex();
+    }
+
     // Used in DicNodeUtils
     int getChildrenPtNodeArrayPos() const {
         return mDicNodeProperties.getChildrenPtNodeArrayPos();
@@ -29,7 +29,15 @@ namespace latinime {
 /* static */ void DicNodeUtils::initAsRoot(
         const DictionaryStructureWithBufferPolicy *const dictionaryStructurePolicy,
         const WordIdArrayView prevWordIds, DicNode *const newRootDicNode) {
-    newRootDicNode->initAsRoot(dictionaryStructurePolicy->getRootPosition(), prevWordIds);
+    initAsRoot(dictionaryStructurePolicy, prevWordIds, 0 /* dictionaryIndex */, newRootDicNode);
+}
+
+/* static */ void DicNodeUtils::initAsRoot(
+        const DictionaryStructureWithBufferPolicy *const dictionaryStructurePolicy,
+        const WordIdArrayView prevWordIds, const int dictionaryIndex,
+        DicNode *const newRootDicNode) {
+    newRootDicNode->initAsRoot(dictionaryStructurePolicy->getRootPosition(), prevWordIds,
+            dictionaryIndex);
 }
 
 /*static */ void DicNodeUtils::initAsRootWithPreviousWord(
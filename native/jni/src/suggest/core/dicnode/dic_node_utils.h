@@ -32,6 +32,10 @@ class DicNodeUtils {
     static void initAsRoot(
             const DictionaryStructureWithBufferPolicy *const dictionaryStructurePolicy,
             const WordIdArrayView prevWordIds, DicNode *const newRootDicNode);
+    static void initAsRoot(
+            const DictionaryStructureWithBufferPolicy *const dictionaryStructurePolicy,
+            const WordIdArrayView prevWordIds, const int dictionaryIndex,
+            DicNode *const newRootDicNode);
     static void initAsRootWithPreviousWord(
             const DictionaryStructureWithBufferPolicy *const dictionaryStructurePolicy,
             const DicNode *const prevWordLastDicNode, DicNode *const newRootDicNode);
@@ -32,13 +32,15 @@ class DicNodeProperties {
  public:
     AK_FORCE_INLINE DicNodeProperties()
             : mChildrenPtNodeArrayPos(NOT_A_DICT_POS), mDicNodeCodePoint(NOT_A_CODE_POINT),
-              mWordId(NOT_A_WORD_ID), mDepth(0), mLeavingDepth(0), mPrevWordCount(0) {}
+              mWordId(NOT_A_WORD_ID), mDepth(0), mLeavingDepth(0), mPrevWordCount(0),
+              mDictionaryIndex(0) {}
 
     ~DicNodeProperties() {}
 
     // Should be called only once per DicNode is initialized.
     void init(const int childrenPos, const int nodeCodePoint, const int wordId,
-            const uint16_t depth, const uint16_t leavingDepth, const WordIdArrayView prevWordIds) {
+            const uint16_t depth, const uint16_t leavingDepth, const WordIdArrayView prevWordIds,
+            const int dictionaryIndex) {
         mChildrenPtNodeArrayPos = childrenPos;
         mDicNodeCodePoint = nodeCodePoint;
         mWordId = wordId;
@@ -46,10 +48,12 @@ class DicNodeProperties {
         mLeavingDepth = leavingDepth;
         prevWordIds.copyToArray(&mPrevWordIds, 0 /* offset */);
         mPrevWordCount = prevWordIds.size();
+        mDictionaryIndex = dictionaryIndex;
     }
 
     // Init for root with prevWordsPtNodePos which is used for n-gram
-    void init(const int rootPtNodeArrayPos, const WordIdArrayView prevWordIds) {
+    void init(const int rootPtNodeArrayPos, const WordIdArrayView prevWordIds,
+            const int dictionaryIndex) {
         mChildrenPtNodeArrayPos = rootPtNodeArrayPos;
         mDicNodeCodePoint = NOT_A_CODE_POINT;
         mWordId = NOT_A_WORD_ID;
@@ -57,6 +61,7 @@ class DicNodeProperties {
         mLeavingDepth = 0;
         prevWordIds.copyToArray(&mPrevWordIds, 0 /* offset */);
         mPrevWordCount = prevWordIds.size();
+        mDictionaryIndex = dictionaryIndex;
     }
 
     void initByCopy(const DicNodeProperties *const dicNodeProp) {
@@ -68,6 +73,7 @@ class DicNodeProperties {
         const WordIdArrayView prevWordIdArrayView = dicNodeProp->getPrevWordIds();
         prevWordIdArrayView.copyToArray(&mPrevWordIds, 0 /* offset */);
         mPrevWordCount = prevWordIdArrayView.size();
+        mDictionaryIndex = dicNodeProp->mDictionaryIndex;
     }
 
     // Init as passing child
@@ -80,6 +86,7 @@ class DicNodeProperties {
         const WordIdArrayView prevWordIdArrayView = dicNodeProp->getPrevWordIds();
         prevWordIdArrayView.copyToArray(&mPrevWordIds, 0 /* offset */);
         mPrevWordCount = prevWordIdArrayView.size();
+        mDictionaryIndex = dicNodeProp->mDictionaryIndex;
     }
 
     int getChildrenPtNodeArrayPos() const {
@@ -115,6 +122,12 @@ class DicNodeProperties {
         return mWordId;
     }
 
+    // Index of the dictionary in the traverse session whose lexicon this node walks. Word ids and
+    // PtNode positions are only meaningful together with that dictionary.
+    int getDictionaryIndex() const {
+        return mDictionaryIndex;
+    }
+
  private:
     // Caution!!!
     // Use a default copy constructor and an assign operator because shallow copies are ok
@@ -126,6 +139,7 @@ class DicNodeProperties {
     uint16_t mLeavingDepth;
     WordIdArray<MAX_PREV_WORD_COUNT_FOR_N_GRAM> mPrevWordIds;
     size_t mPrevWordCount;
+    int mDictionaryIndex;
 };
 } // namespace latinime
 #endif // LATINIME_DIC_NODE_PROPERTIES_H
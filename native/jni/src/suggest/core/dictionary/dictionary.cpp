@@ -18,8 +18,12 @@
 
 #include "suggest/core/dictionary/dictionary.h"
 
+#include <memory>
+#include <vector>
+
 #include "defines.h"
 #include "dictionary/interface/dictionary_header_structure_policy.h"
+#include "dictionary/property/input_event_batch.h"
 #include "dictionary/property/ngram_context.h"
 #include "suggest/core/dictionary/dictionary_utils.h"
 #include "suggest/core/result/suggestion_results.h"
@@ -30,7 +34,9 @@
 #include "suggest/policyimpl/typing/typing_suggest_policy_factory.h"
 #include "utils/int_array_view.h"
 #include "utils/log_utils.h"
+#include "utils/stats_registry.h"
 #include "utils/time_keeper.h"
+#include "utils/worker_pool.h"
 
 namespace latinime {
 
@@ -38,7 +44,14 @@ const int Dictionary::HEADER_ATTRIBUTE_BUFFER_SIZE = 32;
 
 Dictionary::Dictionary(JNIEnv *env, DictionaryStructureWithBufferPolicy::StructurePolicyPtr
         dictionaryStructureWithBufferPolicy)
+        : Dictionary(env, std::move(dictionaryStructureWithBufferPolicy),
+                nullptr /* replicaPolicy */) {}
+
+Dictionary::Dictionary(JNIEnv *env, DictionaryStructureWithBufferPolicy::StructurePolicyPtr
+        dictionaryStructureWithBufferPolicy,
+        DictionaryStructureWithBufferPolicy::StructurePolicyPtr replicaPolicy)
         : mDictionaryStructureWithBufferPolicy(std::move(dictionaryStructureWithBufferPolicy)),
+          mReplicaPolicy(std::move(replicaPolicy)), mLeftRightSync(), mUpdateMutex(),
           mGestureSuggest(new Suggest(GestureSuggestPolicyFactory::getGestureSuggestPolicy())),
           mTypingSuggest(new Suggest(TypingSuggestPolicyFactory::getTypingSuggestPolicy())) {
     logDictionaryInfo(env);
@@ -50,6 +63,7 @@ void Dictionary::getSuggestions(ProximityInfo *proximityInfo, DicTraverseSession
         const SuggestOptions *const suggestOptions, const float weightOfLangModelVsSpatialModel,
         SuggestionResults *const outSuggestionResults) const {
     TimeKeeper::setCurrentTime();
+    const LeftRightSync::ReadScope readScope(&mLeftRightSync);
     traverseSession->init(this, ngramContext, suggestOptions);
     const auto &suggest = suggestOptions->isGesture() ? mGestureSuggest : mTypingSuggest;
     suggest->getSuggestions(proximityInfo, traverseSession, xcoordinates,
@@ -57,6 +71,72 @@ void Dictionary::getSuggestions(ProximityInfo *proximityInfo, DicTraverseSession
             weightOfLangModelVsSpatialModel, outSuggestionResults);
 }
 
+/* static */ void Dictionary::getSuggestionsForGroup(const Dictionary *const *dictionaries,
+        const int dictionaryCount, ProximityInfo *proximityInfo,
+        DicTraverseSession *traverseSession, int *xcoordinates, int *ycoordinates, int *times,
+        int *pointerIds, int *inputCodePoints, int inputSize,
+        const NgramContext *const ngramContext, const SuggestOptions *const suggestOptions,
+        const float weightOfLangModelVsSpatialModel,
+        SuggestionResults *const outSuggestionResults) {
+    if (dictionaryCount <= 0 || dictionaryCount > MAX_DICTIONARY_COUNT_IN_SESSION) {
+        AKLOGE("Invalid dictionary count for a group: %d", dictionaryCount);
+        return;
+    }
+    TimeKeeper::setCurrentTime();
+    int readerVersionIndices[MAX_DICTIONARY_COUNT_IN_SESSION];
+    for (int i = 0; i < dictionaryCount; ++i) {
+        readerVersionIndices[i] = dictionaries[i]->mLeftRightSync.arriveReader();
+    }
+    traverseSession->init(dictionaries, dictionaryCount, ngramContext, suggestOptions);
+    const Dictionary *const firstDictionary = dictionaries[0];
+    const auto &suggest = suggestOptions->isGesture()
+            ? firstDictionary->mGestureSuggest : firstDictionary->mTypingSuggest;
+    suggest->getSuggestions(proximityInfo, traverseSession, xcoordinates,
+            ycoordinates, times, pointerIds, inputCodePoints, inputSize,
+            weightOfLangModelVsSpatialModel, outSuggestionResults);
+    for (int i = 0; i < dictionaryCount; ++i) {
+        dictionaries[i]->mLeftRightSync.departReader(readerVersionIndices[i]);
+    }
+}
+
+/* static */ void Dictionary::getSuggestionsInParallel(WorkerPool *const workerPool,
+        const Dictionary *const *dictionaries, DicTraverseSession *const *traverseSessions,
+        const SuggestOptions *const *suggestOptions, const float *const weightsForLocale,
+        const int dictionaryCount, ProximityInfo *proximityInfo, int *xcoordinates,
+        int *ycoordinates, int *times, int *pointerIds, int *inputCodePoints, int inputSize,
+        const NgramContext *const ngramContext, const float weightOfLangModelVsSpatialModel,
+        SuggestionResults *const outSuggestionResults) {
+    if (dictionaryCount <= 0) {
+        return;
+    }
+    // Searches only share read-only data: the input, the layout and the n-gram context. Caches
+    // belong to the traverse sessions and results are merged once every search is done.
+    std::vector<std::unique_ptr<SuggestionResults>> suggestionResultsList;
+    for (int i = 0; i < dictionaryCount; ++i) {
+        suggestionResultsList.emplace_back(
+                new SuggestionResults(outSuggestionResults->getMaxSuggestionCount()));
+    }
+    workerPool->run(dictionaryCount, [&](const int dictionaryIndex) {
+        const Dictionary *const dictionary = dictionaries[dictionaryIndex];
+        SuggestionResults *const suggestionResults =
+                suggestionResultsList[dictionaryIndex].get();
+        if (suggestOptions[dictionaryIndex]->isGesture() || inputSize > 0) {
+            dictionary->getSuggestions(proximityInfo, traverseSessions[dictionaryIndex],
+                    xcoordinates, ycoordinates, times, pointerIds, inputCodePoints, inputSize,
+                    ngramContext, suggestOptions[dictionaryIndex],
+                    weightOfLangModelVsSpatialModel, suggestionResults);
+        } else {
+            dictionary->getPredictions(ngramContext, suggestionResults);
+        }
+    });
+    for (int i = 0; i < dictionaryCount; ++i) {
+        outSuggestionResults->mergeSuggestionsFrom(*suggestionResultsList[i], i,
+                weightsForLocale[i]);
+    }
+    outSuggestionResults->setWeightOfLangModelVsSpatialModel(
+            suggestionResultsList[0]->getWeightOfLangModelVsSpatialModel());
+}
+
 Dictionary::NgramListenerForPrediction::NgramListenerForPrediction(
         const NgramContext *const ngramContext, const WordIdArrayView prevWordIds,
         SuggestionResults *const suggestionResults,
@@ -91,13 +171,24 @@ void Dictionary::NgramListenerForPrediction::onVisitEntry(const int ngramProbabi
 void Dictionary::getPredictions(const NgramContext *const ngramContext,
         SuggestionResults *const outSuggestionResults) const {
     TimeKeeper::setCurrentTime();
+    const LeftRightSync::ReadScope readScope(&mLeftRightSync);
+    const DictionaryStructureWithBufferPolicy *const policy = getDictionaryStructurePolicy();
     WordIdArray<MAX_PREV_WORD_COUNT_FOR_N_GRAM> prevWordIdArray;
-    const WordIdArrayView prevWordIds = ngramContext->getPrevWordIds(
-            mDictionaryStructureWithBufferPolicy.get(), &prevWordIdArray,
+    const WordIdArrayView prevWordIds = ngramContext->getPrevWordIds(policy, &prevWordIdArray,
             true /* tryLowerCaseSearch */);
-    NgramListenerForPrediction listener(ngramContext, prevWordIds, outSuggestionResults,
-            mDictionaryStructureWithBufferPolicy.get());
-    mDictionaryStructureWithBufferPolicy->iterateNgramEntries(prevWordIds, &listener);
+    NgramListenerForPrediction listener(ngramContext, prevWordIds, outSuggestionResults, policy);
+    policy->iterateNgramEntries(prevWordIds, &listener);
+}
+
+/* static */ void Dictionary::getPredictionsForGroup(const Dictionary *const *dictionaries,
+        const int dictionaryCount, const NgramContext *const ngramContext,
+        SuggestionResults *const outSuggestionResults) {
+    for (int i = 0; i < dictionaryCount; ++i) {
+        // addPrediction records dictionary index 0, the index is set while merging.
+        SuggestionResults suggestionResults(outSuggestionResults->getMaxSuggestionCount());
+        dictionaries[i]->getPredictions(ngramContext, &suggestionResults);
+        outSuggestionResults->mergeSuggestionsFrom(suggestionResults, i, 1.0f /* scoreWeight */);
+    }
 }
 
 int Dictionary::getProbability(const CodePointArrayView codePoints) const {
@@ -106,24 +197,37 @@ int Dictionary::getProbability(const CodePointArrayView codePoints) const {
 
 int Dictionary::getMaxProbabilityOfExactMatches(const CodePointArrayView codePoints) const {
     TimeKeeper::setCurrentTime();
-    return DictionaryUtils::getMaxProbabilityOfExactMatches(
-            mDictionaryStructureWithBufferPolicy.get(), codePoints);
+    const LeftRightSync::ReadScope readScope(&mLeftRightSync);
+    return DictionaryUtils::getMaxProbabilityOfExactMatches(getDictionaryStructurePolicy(),
+            codePoints);
 }
 
 int Dictionary::getNgramProbability(const NgramContext *const ngramContext,
         const CodePointArrayView codePoints) const {
     TimeKeeper::setCurrentTime();
-    const int wordId = mDictionaryStructureWithBufferPolicy->getWordId(codePoints,
-            false /* forceLowerCaseSearch */);
+    const LeftRightSync::ReadScope readScope(&mLeftRightSync);
+    const DictionaryStructureWithBufferPolicy *const policy = getDictionaryStructurePolicy();
+    const int wordId = policy->getWordId(codePoints, false /* forceLowerCaseSearch */);
     if (wordId == NOT_A_WORD_ID) return NOT_A_PROBABILITY;
     if (!ngramContext) {
-        return getDictionaryStructurePolicy()->getProbabilityOfWord(WordIdArrayView(), wordId);
+        return policy->getProbabilityOfWord(WordIdArrayView(), wordId);
     }
     WordIdArray<MAX_PREV_WORD_COUNT_FOR_N_GRAM> prevWordIdArray;
-    const WordIdArrayView prevWordIds = ngramContext->getPrevWordIds(
-            mDictionaryStructureWithBufferPolicy.get(), &prevWordIdArray,
+    const WordIdArrayView prevWordIds = ngramContext->getPrevWordIds(policy, &prevWordIdArray,
             true /* tryLowerCaseSearch */);
-    return getDictionaryStructurePolicy()->getProbabilityOfWord(prevWordIds, wordId);
+    return policy->getProbabilityOfWord(prevWordIds, wordId);
+}
+
+template <typename Update>
+bool Dictionary::updatePolicies(const Update &update) {
+    std::lock_guard<std::mutex> lock(mUpdateMutex);
+    TimeKeeper::setCurrentTime();
+    if (!mReplicaPolicy) {
+        return update(mDictionaryStructureWithBufferPolicy.get());
+    }
+    return mLeftRightSync.update([&](const int policyIndex) {
+        return update(getPolicy(policyIndex));
+    });
 }
 
 bool Dictionary::addUnigramEntry(const CodePointArrayView codePoints,
@@ -134,63 +238,96 @@ bool Dictionary::addUnigramEntry(const CodePointArrayView codePoints,
         AKLOGE("The dictionary doesn't support Beginning-of-Sentence.");
         return false;
     }
-    TimeKeeper::setCurrentTime();
-    return mDictionaryStructureWithBufferPolicy->addUnigramEntry(codePoints, unigramProperty);
+    return updatePolicies([&](DictionaryStructureWithBufferPolicy *const policy) {
+        return policy->addUnigramEntry(codePoints, unigramProperty);
+    });
 }
 
 bool Dictionary::removeUnigramEntry(const CodePointArrayView codePoints) {
-    TimeKeeper::setCurrentTime();
-    return mDictionaryStructureWithBufferPolicy->removeUnigramEntry(codePoints);
+    return updatePolicies([&](DictionaryStructureWithBufferPolicy *const policy) {
+        return policy->removeUnigramEntry(codePoints);
+    });
 }
 
 bool Dictionary::addNgramEntry(const NgramProperty *const ngramProperty) {
-    TimeKeeper::setCurrentTime();
-    return mDictionaryStructureWithBufferPolicy->addNgramEntry(ngramProperty);
+    return updatePolicies([&](DictionaryStructureWithBufferPolicy *const policy) {
+        return policy->addNgramEntry(ngramProperty);
+    });
 }
 
 bool Dictionary::removeNgramEntry(const NgramContext *const ngramContext,
         const CodePointArrayView codePoints) {
-    TimeKeeper::setCurrentTime();
-    return mDictionaryStructureWithBufferPolicy->removeNgramEntry(ngramContext, codePoints);
+    return updatePolicies([&](DictionaryStructureWithBufferPolicy *const policy) {
+        return policy->removeNgramEntry(ngramContext, codePoints);
+    });
 }
 
 bool Dictionary::updateEntriesForWordWithNgramContext(const NgramContext *const ngramContext,
         const CodePointArrayView codePoints, const bool isValidWord,
         const HistoricalInfo historicalInfo) {
-    TimeKeeper::setCurrentTime();
-    return mDictionaryStructureWithBufferPolicy->updateEntriesForWordWithNgramContext(ngramContext,
-            codePoints, isValidWord, historicalInfo);
+    return updatePolicies([&](DictionaryStructureWithBufferPolicy *const policy) {
+        return policy->updateEntriesForWordWithNgramContext(ngramContext, codePoints,
+                isValidWord, historicalInfo);
+    });
+}
+
+int Dictionary::updateEntriesForInputEvents(const InputEventBatch *const inputEventBatch,
+        const int startIndex) {
+    // All entries are applied in a single update. The second replica stops where the first one
+    // stopped so that both stay the same.
+    int endIndex = inputEventBatch->getEntryCount();
+    updatePolicies([&](DictionaryStructureWithBufferPolicy *const policy) {
+        endIndex = policy->updateEntriesForInputEvents(inputEventBatch, startIndex, endIndex);
+        return true;
+    });
+    return endIndex;
 }
 
 bool Dictionary::flush(const char *const filePath) {
+    std::lock_guard<std::mutex> lock(mUpdateMutex);
     TimeKeeper::setCurrentTime();
-    return mDictionaryStructureWithBufferPolicy->flush(filePath);
+    // Flushing only reads the dictionary, so it can use the copy lookups use.
+    return getPolicy(mLeftRightSync.getReadableIndex())->flush(filePath);
 }
 
 bool Dictionary::flushWithGC(const char *const filePath) {
+    StatsScopedTimer timer(StatsStage::GC);
+    std::lock_guard<std::mutex> lock(mUpdateMutex);
     TimeKeeper::setCurrentTime();
-    return mDictionaryStructureWithBufferPolicy->flushWithGC(filePath);
+    // GC modifies the dictionary it runs on. With snapshot reads it runs on the copy lookups
+    // don't use, which then differs from the other copy until the dictionary is reopened from
+    // the written file, as BinaryDictionary does after every GC.
+    return getPolicy(mReplicaPolicy ? 1 - mLeftRightSync.getReadableIndex() : 0)
+            ->flushWithGC(filePath);
 }
 
 bool Dictionary::needsToRunGC(const bool mindsBlockByGC) {
     TimeKeeper::setCurrentTime();
-    return mDictionaryStructureWithBufferPolicy->needsToRunGC(mindsBlockByGC);
+    const LeftRightSync::ReadScope readScope(&mLeftRightSync);
+    return getPolicy(mLeftRightSync.getReadableIndex())->needsToRunGC(mindsBlockByGC);
 }
 
 void Dictionary::getProperty(const char *const query, const int queryLength, char *const outResult,
         const int maxResultLength) {
     TimeKeeper::setCurrentTime();
-    return mDictionaryStructureWithBufferPolicy->getProperty(query, queryLength, outResult,
-            maxResultLength);
+    const LeftRightSync::ReadScope readScope(&mLeftRightSync);
+    return getPolicy(mLeftRightSync.getReadableIndex())->getProperty(query, queryLength,
+            outResult, maxResultLength);
 }
 
 const WordProperty Dictionary::getWordProperty(const CodePointArrayView codePoints) {
     TimeKeeper::setCurrentTime();
-    return mDictionaryStructureWithBufferPolicy->getWordProperty(codePoints);
+    const LeftRightSync::ReadScope readScope(&mLeftRightSync);
+    return getPolicy(mLeftRightSync.getReadableIndex())->getWordProperty(codePoints);
 }
 
 int Dictionary::getNextWordAndNextToken(const int token, int *const outCodePoints,
         int *const outCodePointCount) {
+    // Iterating keeps its state in the policy, so it always uses the first copy. The update lock
+    // keeps that copy from being updated while a word is read. The token is only valid while there
+    // are no updates, so callers keep updates out for the whole iteration (see
+    // ExpandableBinaryDictionary, which takes its write lock).
+    std::lock_guard<std::mutex> lock(mUpdateMutex);
     TimeKeeper::setCurrentTime();
     return mDictionaryStructureWithBufferPolicy->getNextWordAndNextToken(
             token, outCodePoints, outCodePointCount);
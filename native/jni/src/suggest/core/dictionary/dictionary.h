@@ -18,6 +18,7 @@
 #define LATINIME_DICTIONARY_H
 
 #include <memory>
+#include <mutex>
 
 #include "defines.h"
 #include "jni.h"
@@ -28,15 +29,18 @@
 #include "dictionary/property/word_property.h"
 #include "suggest/core/suggest_interface.h"
 #include "utils/int_array_view.h"
+#include "utils/left_right_sync.h"
 
 namespace latinime {
 
 class DictionaryStructureWithBufferPolicy;
 class DicTraverseSession;
+class InputEventBatch;
 class NgramContext;
 class ProximityInfo;
 class SuggestionResults;
 class SuggestOptions;
+class WorkerPool;
 
 class Dictionary {
  public:
@@ -65,15 +69,56 @@ class Dictionary {
     Dictionary(JNIEnv *env, DictionaryStructureWithBufferPolicy::StructurePolicyPtr
             dictionaryStructureWithBufferPolicy);
 
+    // Creates a dictionary supporting snapshot reads. replicaPolicy must have been opened from
+    // the same source as dictionaryStructureWithBufferPolicy. Updates are applied to both
+    // copies in turn and lookups always use the copy that isn't being updated, so they can run
+    // concurrently with updates without waiting for them.
+    Dictionary(JNIEnv *env, DictionaryStructureWithBufferPolicy::StructurePolicyPtr
+            dictionaryStructureWithBufferPolicy,
+            DictionaryStructureWithBufferPolicy::StructurePolicyPtr replicaPolicy);
+
     void getSuggestions(ProximityInfo *proximityInfo, DicTraverseSession *traverseSession,
             int *xcoordinates, int *ycoordinates, int *times, int *pointerIds, int *inputCodePoints,
             int inputSize, const NgramContext *const ngramContext,
             const SuggestOptions *const suggestOptions, const float weightOfLangModelVsSpatialModel,
             SuggestionResults *const outSuggestionResults) const;
 
+    // Runs a single search over all the given dictionaries. The suggest policy of the first
+    // dictionary is used. Each result records the index of the dictionary it comes from, and a
+    // word found in several dictionaries is output once, from the one that scores it best.
+    static void getSuggestionsForGroup(const Dictionary *const *dictionaries,
+            const int dictionaryCount, ProximityInfo *proximityInfo,
+            DicTraverseSession *traverseSession, int *xcoordinates, int *ycoordinates, int *times,
+            int *pointerIds, int *inputCodePoints, int inputSize,
+            const NgramContext *const ngramContext, const SuggestOptions *const suggestOptions,
+            const float weightOfLangModelVsSpatialModel,
+            SuggestionResults *const outSuggestionResults);
+
+    // Runs getSuggestions, or getPredictions when there is no input, for every dictionary on the
+    // threads of workerPool and merges the results. Each dictionary needs its own traverse
+    // session, and a dictionary must not be listed twice. Each result records the index of the
+    // dictionary it comes from. Scores are scaled by the weight for locale of their dictionary
+    // before the results are merged, so that the best suggestions of every locale compete for
+    // the merged results. A word found in several dictionaries is kept once, with its best scaled
+    // score. The weight of the language model reported is the one of the first dictionary.
+    static void getSuggestionsInParallel(WorkerPool *const workerPool,
+            const Dictionary *const *dictionaries, DicTraverseSession *const *traverseSessions,
+            const SuggestOptions *const *suggestOptions, const float *const weightsForLocale,
+            const int dictionaryCount,
+            ProximityInfo *proximityInfo, int *xcoordinates, int *ycoordinates, int *times,
+            int *pointerIds, int *inputCodePoints, int inputSize,
+            const NgramContext *const ngramContext, const float weightOfLangModelVsSpatialModel,
+            SuggestionResults *const outSuggestionResults);
+
     void getPredictions(const NgramContext *const ngramContext,
             SuggestionResults *const outSuggestionResults) const;
 
+    // Predictions run no search, so there is nothing to share: each dictionary is queried in turn.
+    // Results are recorded and deduplicated as in getSuggestionsForGroup.
+    static void getPredictionsForGroup(const Dictionary *const *dictionaries,
+            const int dictionaryCount, const NgramContext *const ngramContext,
+            SuggestionResults *const outSuggestionResults);
+
     int getProbability(const CodePointArrayView codePoints) const;
 
     int getMaxProbabilityOfExactMatches(const CodePointArrayView codePoints) const;
@@ -95,6 +140,11 @@ class Dictionary {
             const CodePointArrayView codePoints, const bool isValidWord,
             const HistoricalInfo historicalInfo);
 
+    // Applies the entries of the batch from startIndex until the dictionary needs GC. Returns the
+    // index of the first entry that was not applied.
+    int updateEntriesForInputEvents(const InputEventBatch *const inputEventBatch,
+            const int startIndex);
+
     bool flush(const char *const filePath);
 
     bool flushWithGC(const char *const filePath);
@@ -112,8 +162,19 @@ class Dictionary {
     int getNextWordAndNextToken(const int token, int *const outCodePoints,
             int *const outCodePointCount);
 
+    bool supportsSnapshotReads() const {
+        return mReplicaPolicy != nullptr;
+    }
+
+    // Returns the copy lookups have to use. With snapshot reads, the returned policy is only
+    // safe to use while a read scope of this dictionary is open.
     const DictionaryStructureWithBufferPolicy *getDictionaryStructurePolicy() const {
-        return mDictionaryStructureWithBufferPolicy.get();
+        return getPolicy(mLeftRightSync.getReadableIndex());
+    }
+
+    // For read scopes around getDictionaryStructurePolicy() outside of this class.
+    const LeftRightSync *getLeftRightSync() const {
+        return &mLeftRightSync;
     }
 
  private:
@@ -141,9 +202,22 @@ class Dictionary {
 
     const DictionaryStructureWithBufferPolicy::StructurePolicyPtr
             mDictionaryStructureWithBufferPolicy;
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr mReplicaPolicy;
+    // Tracks which of the two copies lookups use. Only used with snapshot reads.
+    LeftRightSync mLeftRightSync;
+    // Serializes updates, and operations that can't run on a snapshot.
+    std::mutex mUpdateMutex;
     const SuggestInterfacePtr mGestureSuggest;
     const SuggestInterfacePtr mTypingSuggest;
 
+    DictionaryStructureWithBufferPolicy *getPolicy(const int index) const {
+        return index == 0 ? mDictionaryStructureWithBufferPolicy.get() : mReplicaPolicy.get();
+    }
+
+    // Applies update to every copy of the dictionary and returns its result for the first one.
+    template <typename Update>
+    bool updatePolicies(const Update &update);
+
     void logDictionaryInfo(JNIEnv *const env) const;
 };
 } // namespace latinime
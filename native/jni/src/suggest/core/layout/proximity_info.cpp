@@ -31,6 +31,9 @@
 
 namespace latinime {
 
+// Has to be incremented when the serialized data or the way the tables are computed changes.
+const int ProximityInfo::SERIALIZED_DATA_VERSION = 1;
+
 static AK_FORCE_INLINE void safeGetOrFillZeroIntArrayRegion(JNIEnv *env, jintArray jArray,
         jsize len, jint *buffer) {
     if (jArray && buffer) {
@@ -57,6 +60,7 @@ ProximityInfo::ProximityInfo(JNIEnv *env, const int keyboardWidth, const int key
         const jfloatArray sweetSpotCenterXs, const jfloatArray sweetSpotCenterYs,
         const jfloatArray sweetSpotRadii)
         : GRID_WIDTH(gridWidth), GRID_HEIGHT(gridHeight), MOST_COMMON_KEY_WIDTH(mostCommonKeyWidth),
+          MOST_COMMON_KEY_HEIGHT(mostCommonKeyHeight),
           MOST_COMMON_KEY_WIDTH_SQUARE(mostCommonKeyWidth * mostCommonKeyWidth),
           NORMALIZED_SQUARED_MOST_COMMON_KEY_HYPOTENUSE(1.0f +
                   GeometryUtils::SQUARE_FLOAT(static_cast<float>(mostCommonKeyHeight) /
@@ -95,10 +99,171 @@ ProximityInfo::ProximityInfo(JNIEnv *env, const int keyboardWidth, const int key
     initializeG();
 }
 
+template<typename T>
+static AK_FORCE_INLINE void safeCopyOrFillZeroArray(const T *const array, const int len,
+        T *const buffer) {
+    if (array && buffer) {
+        memcpy(buffer, array, len * sizeof(buffer[0]));
+    } else if (buffer) {
+        memset(buffer, 0, len * sizeof(buffer[0]));
+    }
+}
+
+ProximityInfo::ProximityInfo(const int keyboardWidth, const int keyboardHeight,
+        const int gridWidth, const int gridHeight, const int mostCommonKeyWidth,
+        const int mostCommonKeyHeight, const int *const proximityChars, const int keyCount,
+        const int *const keyXCoordinates, const int *const keyYCoordinates,
+        const int *const keyWidths, const int *const keyHeights, const int *const keyCharCodes,
+        const float *const sweetSpotCenterXs, const float *const sweetSpotCenterYs,
+        const float *const sweetSpotRadii)
+        : GRID_WIDTH(gridWidth), GRID_HEIGHT(gridHeight), MOST_COMMON_KEY_WIDTH(mostCommonKeyWidth),
+          MOST_COMMON_KEY_HEIGHT(mostCommonKeyHeight),
+          MOST_COMMON_KEY_WIDTH_SQUARE(mostCommonKeyWidth * mostCommonKeyWidth),
+          NORMALIZED_SQUARED_MOST_COMMON_KEY_HYPOTENUSE(1.0f +
+                  GeometryUtils::SQUARE_FLOAT(static_cast<float>(mostCommonKeyHeight) /
+                          static_cast<float>(mostCommonKeyWidth))),
+          CELL_WIDTH((keyboardWidth + gridWidth - 1) / gridWidth),
+          CELL_HEIGHT((keyboardHeight + gridHeight - 1) / gridHeight),
+          KEY_COUNT(std::min(keyCount, MAX_KEY_COUNT_IN_A_KEYBOARD)),
+          KEYBOARD_WIDTH(keyboardWidth), KEYBOARD_HEIGHT(keyboardHeight),
+          KEYBOARD_HYPOTENUSE(hypotf(KEYBOARD_WIDTH, KEYBOARD_HEIGHT)),
+          HAS_TOUCH_POSITION_CORRECTION_DATA(keyCount > 0 && keyXCoordinates && keyYCoordinates
+                  && keyWidths && keyHeights && keyCharCodes && sweetSpotCenterXs
+                  && sweetSpotCenterYs && sweetSpotRadii),
+          mProximityCharsArray(new int[GRID_WIDTH * GRID_HEIGHT * MAX_PROXIMITY_CHARS_SIZE
+                  /* proximityCharsLength */]),
+          mLowerCodePointToKeyMap() {
+    safeCopyOrFillZeroArray(proximityChars, GRID_WIDTH * GRID_HEIGHT * MAX_PROXIMITY_CHARS_SIZE,
+            mProximityCharsArray);
+    safeCopyOrFillZeroArray(keyXCoordinates, KEY_COUNT, mKeyXCoordinates);
+    safeCopyOrFillZeroArray(keyYCoordinates, KEY_COUNT, mKeyYCoordinates);
+    safeCopyOrFillZeroArray(keyWidths, KEY_COUNT, mKeyWidths);
+    safeCopyOrFillZeroArray(keyHeights, KEY_COUNT, mKeyHeights);
+    safeCopyOrFillZeroArray(keyCharCodes, KEY_COUNT, mKeyCodePoints);
+    safeCopyOrFillZeroArray(sweetSpotCenterXs, KEY_COUNT, mSweetSpotCenterXs);
+    safeCopyOrFillZeroArray(sweetSpotCenterYs, KEY_COUNT, mSweetSpotCenterYs);
+    safeCopyOrFillZeroArray(sweetSpotRadii, KEY_COUNT, mSweetSpotRadii);
+    initializeG();
+}
+
 ProximityInfo::~ProximityInfo() {
     delete[] mProximityCharsArray;
 }
 
+ProximityInfo::ProximityInfo(const int keyboardWidth, const int keyboardHeight,
+        const int gridWidth, const int gridHeight, const int mostCommonKeyWidth,
+        const int mostCommonKeyHeight, const int keyCount, const bool hasTouchPositionCorrectionData)
+        : GRID_WIDTH(gridWidth), GRID_HEIGHT(gridHeight), MOST_COMMON_KEY_WIDTH(mostCommonKeyWidth),
+          MOST_COMMON_KEY_HEIGHT(mostCommonKeyHeight),
+          MOST_COMMON_KEY_WIDTH_SQUARE(mostCommonKeyWidth * mostCommonKeyWidth),
+          NORMALIZED_SQUARED_MOST_COMMON_KEY_HYPOTENUSE(1.0f +
+                  GeometryUtils::SQUARE_FLOAT(static_cast<float>(mostCommonKeyHeight) /
+                          static_cast<float>(mostCommonKeyWidth))),
+          CELL_WIDTH((keyboardWidth + gridWidth - 1) / gridWidth),
+          CELL_HEIGHT((keyboardHeight + gridHeight - 1) / gridHeight),
+          KEY_COUNT(keyCount), KEYBOARD_WIDTH(keyboardWidth), KEYBOARD_HEIGHT(keyboardHeight),
+          KEYBOARD_HYPOTENUSE(hypotf(KEYBOARD_WIDTH, KEYBOARD_HEIGHT)),
+          HAS_TOUCH_POSITION_CORRECTION_DATA(hasTouchPositionCorrectionData),
+          mProximityCharsArray(new int[GRID_WIDTH * GRID_HEIGHT * MAX_PROXIMITY_CHARS_SIZE
+                  /* proximityCharsLength */]),
+          mLowerCodePointToKeyMap() {}
+
+template<typename T>
+static AK_FORCE_INLINE void appendArray(const T *const array, const int len,
+        std::vector<uint8_t> *const outData) {
+    const uint8_t *const bytes = reinterpret_cast<const uint8_t *>(array);
+    outData->insert(outData->end(), bytes, bytes + len * sizeof(array[0]));
+}
+
+template<typename T>
+static AK_FORCE_INLINE bool readArray(const ReadOnlyByteArrayView data, const int len,
+        size_t *const pos, T *const outArray) {
+    const size_t size = len * sizeof(outArray[0]);
+    if (*pos + size > data.size()) {
+        return false;
+    }
+    memcpy(outArray, data.data() + *pos, size);
+    *pos += size;
+    return true;
+}
+
+/* static */ ProximityInfo *ProximityInfo::createFromSerializedData(
+        const ReadOnlyByteArrayView data) {
+    // version, keyboard width and height, grid width and height, most common key width and
+    // height, key count and whether there is touch position correction data.
+    int header[9];
+    size_t pos = 0;
+    if (!readArray(data, NELEMS(header), &pos, header) || header[0] != SERIALIZED_DATA_VERSION) {
+        return nullptr;
+    }
+    const int keyCount = header[7];
+    if (header[1] <= 0 || header[2] <= 0 || header[3] <= 0 || header[4] <= 0 || header[5] <= 0
+            || keyCount < 0 || keyCount > MAX_KEY_COUNT_IN_A_KEYBOARD) {
+        AKLOGE("Invalid serialized proximity info.");
+        return nullptr;
+    }
+    ProximityInfo *const proximityInfo = new ProximityInfo(header[1], header[2], header[3],
+            header[4], header[5], header[6], keyCount, header[8] != 0);
+    if (!proximityInfo->readTablesFrom(data, &pos)) {
+        AKLOGE("Serialized proximity info is truncated.");
+        delete proximityInfo;
+        return nullptr;
+    }
+    return proximityInfo;
+}
+
+bool ProximityInfo::readTablesFrom(const ReadOnlyByteArrayView data, size_t *const pos) {
+    if (!readArray(data, GRID_WIDTH * GRID_HEIGHT * MAX_PROXIMITY_CHARS_SIZE, pos,
+                    mProximityCharsArray)
+            || !readArray(data, KEY_COUNT, pos, mKeyXCoordinates)
+            || !readArray(data, KEY_COUNT, pos, mKeyYCoordinates)
+            || !readArray(data, KEY_COUNT, pos, mKeyWidths)
+            || !readArray(data, KEY_COUNT, pos, mKeyHeights)
+            || !readArray(data, KEY_COUNT, pos, mKeyCodePoints)
+            || !readArray(data, KEY_COUNT, pos, mSweetSpotCenterXs)
+            || !readArray(data, KEY_COUNT, pos, mSweetSpotCenterYs)
+            || !readArray(data, KEY_COUNT, pos, mSweetSpotCenterYsG)
+            || !readArray(data, KEY_COUNT, pos, mSweetSpotRadii)
+            || !readArray(data, KEY_COUNT, pos, mKeyIndexToOriginalCodePoint)
+            || !readArray(data, KEY_COUNT, pos, mKeyIndexToLowerCodePointG)
+            || !readArray(data, KEY_COUNT, pos, mCenterXsG)
+            || !readArray(data, KEY_COUNT, pos, mCenterYsG)) {
+        return false;
+    }
+    for (int i = 0; i < KEY_COUNT; ++i) {
+        if (!readArray(data, KEY_COUNT, pos, mKeyKeyDistancesG[i])) {
+            return false;
+        }
+        mLowerCodePointToKeyMap[mKeyIndexToLowerCodePointG[i]] = i;
+    }
+    return true;
+}
+
+void ProximityInfo::writeTo(std::vector<uint8_t> *const outData) const {
+    const int header[] = { SERIALIZED_DATA_VERSION, KEYBOARD_WIDTH, KEYBOARD_HEIGHT, GRID_WIDTH,
+            GRID_HEIGHT, MOST_COMMON_KEY_WIDTH, MOST_COMMON_KEY_HEIGHT, KEY_COUNT,
+            HAS_TOUCH_POSITION_CORRECTION_DATA ? 1 : 0 };
+    appendArray(header, NELEMS(header), outData);
+    appendArray(mProximityCharsArray, GRID_WIDTH * GRID_HEIGHT * MAX_PROXIMITY_CHARS_SIZE,
+            outData);
+    appendArray(mKeyXCoordinates, KEY_COUNT, outData);
+    appendArray(mKeyYCoordinates, KEY_COUNT, outData);
+    appendArray(mKeyWidths, KEY_COUNT, outData);
+    appendArray(mKeyHeights, KEY_COUNT, outData);
+    appendArray(mKeyCodePoints, KEY_COUNT, outData);
+    appendArray(mSweetSpotCenterXs, KEY_COUNT, outData);
+    appendArray(mSweetSpotCenterYs, KEY_COUNT, outData);
+    appendArray(mSweetSpotCenterYsG, KEY_COUNT, outData);
+    appendArray(mSweetSpotRadii, KEY_COUNT, outData);
+    appendArray(mKeyIndexToOriginalCodePoint, KEY_COUNT, outData);
+    appendArray(mKeyIndexToLowerCodePointG, KEY_COUNT, outData);
+    appendArray(mCenterXsG, KEY_COUNT, outData);
+    appendArray(mCenterYsG, KEY_COUNT, outData);
+    for (int i = 0; i < KEY_COUNT; ++i) {
+        appendArray(mKeyKeyDistancesG[i], KEY_COUNT, outData);
+    }
+}
+
 bool ProximityInfo::hasSpaceProximity(const int x, const int y) const {
     if (x < 0 || y < 0) {
         if (DEBUG_DICT) {
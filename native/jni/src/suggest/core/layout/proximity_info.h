@@ -17,12 +17,14 @@
 #ifndef LATINIME_PROXIMITY_INFO_H
 #define LATINIME_PROXIMITY_INFO_H
 
+#include <cstdint>
 #include <unordered_map>
 #include <vector>
 
 #include "defines.h"
 #include "jni.h"
 #include "suggest/core/layout/proximity_info_utils.h"
+#include "utils/byte_array_view.h"
 
 // Thanks to https://stackoverflow.com/a/32698993
 namespace insmat {
@@ -53,7 +55,7 @@ namespace insmat {
         return g(max(-s, min(s, x1)), h, r) - g(max(-s, min(s, x0)), h, r); // integrate the area
     }
 
-    AK_FORCE_INLINE float area(float x0, float x1, float y0, float y1, float r) // area of the intersection of a finite box with a circle centered at the origin with radius r
+    inline float area(float x0, float x1, float y0, float y1, float r) // recursive, so it cannot be force inlined. Area of the intersection of a finite box with a circle centered at the origin with radius r
     {
         if(y0 > y1)
             std::swap(y0, y1); // this will simplify the reasoning
@@ -89,7 +91,23 @@ class ProximityInfo {
             const jintArray keyYCoordinates, const jintArray keyWidths, const jintArray keyHeights,
             const jintArray keyCharCodes, const jfloatArray sweetSpotCenterXs,
             const jfloatArray sweetSpotCenterYs, const jfloatArray sweetSpotRadii);
+    // Same as above from native arrays, for host tools. Null arrays are filled with zeros.
+    ProximityInfo(const int keyboardWidth, const int keyboardHeight,
+            const int gridWidth, const int gridHeight,
+            const int mostCommonKeyWidth, const int mostCommonKeyHeight,
+            const int *const proximityChars, const int keyCount, const int *const keyXCoordinates,
+            const int *const keyYCoordinates, const int *const keyWidths,
+            const int *const keyHeights, const int *const keyCharCodes,
+            const float *const sweetSpotCenterXs, const float *const sweetSpotCenterYs,
+            const float *const sweetSpotRadii);
     ~ProximityInfo();
+
+    // Restores a proximity info written by writeTo() without recomputing its tables. Returns
+    // nullptr if the data was not written by this version or is truncated.
+    static ProximityInfo *createFromSerializedData(const ReadOnlyByteArrayView data);
+    // Writes the layout and the tables computed from it.
+    void writeTo(std::vector<uint8_t> *const outData) const;
+
     bool hasSpaceProximity(const int x, const int y) const;
     float getNormalizedSquaredDistanceFromCenterFloatG(
             const int keyId, const int x, const int y, const bool isGeometric) const;
@@ -194,11 +212,20 @@ class ProximityInfo {
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(ProximityInfo);
 
+    static const int SERIALIZED_DATA_VERSION;
+
+    // For createFromSerializedData(). Tables are left for the caller to fill.
+    ProximityInfo(const int keyboardWidth, const int keyboardHeight, const int gridWidth,
+            const int gridHeight, const int mostCommonKeyWidth, const int mostCommonKeyHeight,
+            const int keyCount, const bool hasTouchPositionCorrectionData);
+
     void initializeG();
+    bool readTablesFrom(const ReadOnlyByteArrayView data, size_t *const pos);
 
     const int GRID_WIDTH;
     const int GRID_HEIGHT;
     const int MOST_COMMON_KEY_WIDTH;
+    const int MOST_COMMON_KEY_HEIGHT;
     const int MOST_COMMON_KEY_WIDTH_SQUARE;
     const float NORMALIZED_SQUARED_MOST_COMMON_KEY_HYPOTENUSE;
     const int CELL_WIDTH;
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "LatinIME: proximity_info_cache.cpp"
+
+#include "suggest/core/layout/proximity_info_cache.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "dictionary/utils/file_utils.h"
+#include "suggest/core/layout/proximity_info.h"
+
+namespace latinime {
+
+const uint32_t ProximityInfoCache::MAGIC_NUMBER = 0x50494331; // "PIC1"
+// A layout takes about 40KB, mostly for the proximity chars of the grid.
+const int ProximityInfoCache::MAX_FILE_SIZE = 2 * 1024 * 1024;
+
+// Each entry is the layout hash, the size of the data and the data written by
+// ProximityInfo::writeTo().
+static const size_t ENTRY_HEADER_SIZE = sizeof(uint64_t) + sizeof(uint32_t);
+
+ProximityInfoCache::ProximityInfoCache(const char *const filePath)
+        : mFilePath(filePath), mMmappedBuffer(nullptr), mMappedEntries(), mAddedEntries(),
+          mPendingLayoutHashes(), mMutex(), mWriteMutex(),
+          mFileSize(FileUtils::getFileSize(filePath)) {
+    if (mFileSize > MAX_FILE_SIZE) {
+        remove(filePath);
+        mFileSize = -1;
+    }
+    if (mFileSize <= 0) {
+        return;
+    }
+    mMmappedBuffer = MmappedBuffer::openBuffer(filePath, false /* isUpdatable */);
+    if (!mMmappedBuffer || !readEntries()) {
+        AKLOGI("Starting over the proximity info cache. path=%s", filePath);
+        mMmappedBuffer = nullptr;
+        mMappedEntries.clear();
+        remove(filePath);
+        mFileSize = -1;
+    }
+}
+
+bool ProximityInfoCache::readEntries() {
+    const ReadOnlyByteArrayView buffer = mMmappedBuffer->getReadOnlyByteArrayView();
+    uint32_t magicNumber = 0;
+    if (buffer.size() < sizeof(magicNumber)) {
+        return false;
+    }
+    memcpy(&magicNumber, buffer.data(), sizeof(magicNumber));
+    if (magicNumber != MAGIC_NUMBER) {
+        return false;
+    }
+    size_t pos = sizeof(magicNumber);
+    while (pos < buffer.size()) {
+        if (pos + ENTRY_HEADER_SIZE > buffer.size()) {
+            return false;
+        }
+        uint64_t layoutHash = 0;
+        uint32_t size = 0;
+        memcpy(&layoutHash, buffer.data() + pos, sizeof(layoutHash));
+        memcpy(&size, buffer.data() + pos + sizeof(layoutHash), sizeof(size));
+        pos += ENTRY_HEADER_SIZE;
+        if (pos + size > buffer.size()) {
+            // The process was killed while appending the entry.
+            return false;
+        }
+        mMappedEntries[layoutHash] = std::make_pair(pos, static_cast<size_t>(size));
+        pos += size;
+    }
+    return true;
+}
+
+ProximityInfo *ProximityInfoCache::createProximityInfo(const uint64_t layoutHash) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    const auto addedIt = mAddedEntries.find(layoutHash);
+    if (addedIt != mAddedEntries.end()) {
+        return ProximityInfo::createFromSerializedData(
+                ReadOnlyByteArrayView(addedIt->second.data(), addedIt->second.size()));
+    }
+    const auto mappedIt = mMappedEntries.find(layoutHash);
+    if (mappedIt == mMappedEntries.end()) {
+        return nullptr;
+    }
+    const ReadOnlyByteArrayView buffer = mMmappedBuffer->getReadOnlyByteArrayView();
+    return ProximityInfo::createFromSerializedData(
+            ReadOnlyByteArrayView(buffer.data() + mappedIt->second.first, mappedIt->second.second));
+}
+
+void ProximityInfoCache::put(const uint64_t layoutHash, const ProximityInfo *const proximityInfo) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mMappedEntries.count(layoutHash) > 0 || mAddedEntries.count(layoutHash) > 0) {
+        return;
+    }
+    proximityInfo->writeTo(&mAddedEntries[layoutHash]);
+    mPendingLayoutHashes.push_back(layoutHash);
+}
+
+void ProximityInfoCache::writePendingEntries() {
+    std::lock_guard<std::mutex> writeLock(mWriteMutex);
+    std::vector<const std::vector<uint8_t> *> pendingEntries;
+    std::vector<uint64_t> pendingLayoutHashes;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        pendingLayoutHashes.swap(mPendingLayoutHashes);
+        for (const uint64_t layoutHash : pendingLayoutHashes) {
+            pendingEntries.push_back(&mAddedEntries[layoutHash]);
+        }
+    }
+    for (size_t i = 0; i < pendingLayoutHashes.size(); ++i) {
+        appendEntry(pendingLayoutHashes[i], *pendingEntries[i]);
+    }
+}
+
+void ProximityInfoCache::appendEntry(const uint64_t layoutHash, const std::vector<uint8_t> &data) {
+    if (mFileSize > MAX_FILE_SIZE) {
+        // Kept in memory only until the next process starts the file over.
+        return;
+    }
+    FILE *const file = fopen(mFilePath.c_str(), "ab");
+    if (!file) {
+        AKLOGI("Cannot open the proximity info cache. path=%s", mFilePath.c_str());
+        return;
+    }
+    const uint32_t size = static_cast<uint32_t>(data.size());
+    bool succeeded = true;
+    if (mFileSize <= 0) {
+        succeeded = fwrite(&MAGIC_NUMBER, sizeof(MAGIC_NUMBER), 1, file) == 1;
+        mFileSize = sizeof(MAGIC_NUMBER);
+    }
+    succeeded = succeeded && fwrite(&layoutHash, sizeof(layoutHash), 1, file) == 1
+            && fwrite(&size, sizeof(size), 1, file) == 1
+            && fwrite(data.data(), data.size(), 1, file) == 1;
+    if (fclose(file) != 0 || !succeeded) {
+        AKLOGE("Cannot write to the proximity info cache. path=%s", mFilePath.c_str());
+        // The partial entry makes the next process start the file over.
+        mFileSize = MAX_FILE_SIZE + 1;
+        return;
+    }
+    mFileSize += ENTRY_HEADER_SIZE + size;
+}
+
+} // namespace latinime
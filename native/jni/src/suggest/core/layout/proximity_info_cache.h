@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_PROXIMITY_INFO_CACHE_H
+#define LATINIME_PROXIMITY_INFO_CACHE_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "defines.h"
+#include "dictionary/utils/mmapped_buffer.h"
+
+namespace latinime {
+
+class ProximityInfo;
+
+/**
+ * File of serialized proximity infos keyed by a hash of the keyboard layout they were computed
+ * from, so that showing a layout that was seen before, even by an earlier process, doesn't have
+ * to recompute its tables.
+ *
+ * The file is mmapped when the cache is created. New layouts are kept in memory by put() and
+ * appended to the file by writePendingEntries(), which is meant to run off the UI thread as
+ * put() is called while the keyboard is being built. The file is started over by the next
+ * process once it grows beyond MAX_FILE_SIZE.
+ */
+class ProximityInfoCache {
+ public:
+    explicit ProximityInfoCache(const char *const filePath);
+
+    // Returns a new proximity info for the layout, or nullptr if the layout is not cached.
+    ProximityInfo *createProximityInfo(const uint64_t layoutHash) const;
+
+    void put(const uint64_t layoutHash, const ProximityInfo *const proximityInfo);
+
+    // Appends the layouts put since the last call to the file.
+    void writePendingEntries();
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(ProximityInfoCache);
+
+    static const uint32_t MAGIC_NUMBER;
+    static const int MAX_FILE_SIZE;
+
+    bool readEntries();
+    void appendEntry(const uint64_t layoutHash, const std::vector<uint8_t> &data);
+
+    const std::string mFilePath;
+    MmappedBuffer::MmappedBufferPtr mMmappedBuffer;
+    // Offsets and sizes of the entries in the mmapped file.
+    std::unordered_map<uint64_t, std::pair<size_t, size_t>> mMappedEntries;
+    // Entries put after the file was mmapped. They are never removed, so their data stays valid
+    // while it is written without holding mMutex.
+    std::unordered_map<uint64_t, std::vector<uint8_t>> mAddedEntries;
+    std::vector<uint64_t> mPendingLayoutHashes;
+    mutable std::mutex mMutex;
+    // Held while writing to the file; guards mFileSize.
+    std::mutex mWriteMutex;
+    int mFileSize;
+};
+} // namespace latinime
+#endif // LATINIME_PROXIMITY_INFO_CACHE_H
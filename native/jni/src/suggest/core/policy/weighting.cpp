@@ -158,9 +158,9 @@ static inline void profile(const CorrectionType correctionType, DicNode *const n
     case CT_COMPLETION:
         return 0.0f;
     case CT_TERMINAL: {
-        const float languageImprobability =
-                DicNodeUtils::getBigramNodeImprobability(
-                        traverseSession->getDictionaryStructurePolicy(), dicNode, multiBigramMap);
+        const float languageImprobability = DicNodeUtils::getBigramNodeImprobability(
+                traverseSession->getDictionaryStructurePolicy(dicNode->getDictionaryIndex()),
+                dicNode, multiBigramMap);
         return weighting->getTerminalLanguageCost(traverseSession, dicNode, languageImprobability);
     }
     case CT_TERMINAL_INSERTION:
@@ -41,10 +41,11 @@ class SuggestedWord {
 
     SuggestedWord(const int *const codePoints, const int codePointCount,
             const int score, const int type, const int indexToPartialCommit,
-            const int autoCommitFirstWordConfidence)
+            const int autoCommitFirstWordConfidence, const int dictionaryIndex)
             : mCodePoints(codePoints, codePoints + codePointCount), mScore(score),
               mType(type), mIndexToPartialCommit(indexToPartialCommit),
-              mAutoCommitFirstWordConfidence(autoCommitFirstWordConfidence) {}
+              mAutoCommitFirstWordConfidence(autoCommitFirstWordConfidence),
+              mDictionaryIndex(dictionaryIndex) {}
 
     const int *getCodePoint() const {
         return &mCodePoints.at(0);
@@ -70,6 +71,12 @@ class SuggestedWord {
         return mAutoCommitFirstWordConfidence;
     }
 
+    // Index of the dictionary the word comes from when several dictionaries are traversed in one
+    // session. Always 0 otherwise.
+    int getDictionaryIndex() const {
+        return mDictionaryIndex;
+    }
+
  private:
     DISALLOW_DEFAULT_CONSTRUCTOR(SuggestedWord);
 
@@ -78,6 +85,7 @@ class SuggestedWord {
     int mType;
     int mIndexToPartialCommit;
     int mAutoCommitFirstWordConfidence;
+    int mDictionaryIndex;
 };
 } // namespace latinime
 #endif /* LATINIME_SUGGESTED_WORD_H */
@@ -16,6 +16,8 @@
 
 #include "suggest/core/result/suggestion_results.h"
 
+#include <algorithm>
+
 #include "utils/jni_data_utils.h"
 
 namespace latinime {
@@ -23,10 +25,10 @@ namespace latinime {
 void SuggestionResults::outputSuggestions(JNIEnv *env, jintArray outSuggestionCount,
         jintArray outputCodePointsArray, jintArray outScoresArray, jintArray outSpaceIndicesArray,
         jintArray outTypesArray, jintArray outAutoCommitFirstWordConfidenceArray,
-        jfloatArray outWeightOfLangModelVsSpatialModel) {
+        jfloatArray outWeightOfLangModelVsSpatialModel, jintArray outDictionaryIndicesArray) {
     int outputIndex = 0;
     while (!mSuggestedWords.empty()) {
-        const SuggestedWord &suggestedWord = mSuggestedWords.top();
+        const SuggestedWord &suggestedWord = mSuggestedWords.front();
         suggestedWord.getCodePointCount();
         const int start = outputIndex * MAX_WORD_LENGTH;
         JniDataUtils::outputCodePoints(env, outputCodePointsArray, start,
@@ -36,12 +38,16 @@ void SuggestionResults::outputSuggestions(JNIEnv *env, jintArray outSuggestionCo
         JniDataUtils::putIntToArray(env, outSpaceIndicesArray, outputIndex,
                 suggestedWord.getIndexToPartialCommit());
         JniDataUtils::putIntToArray(env, outTypesArray, outputIndex, suggestedWord.getType());
+        if (outDictionaryIndicesArray) {
+            JniDataUtils::putIntToArray(env, outDictionaryIndicesArray, outputIndex,
+                    suggestedWord.getDictionaryIndex());
+        }
         if (mSuggestedWords.size() == 1) {
             JniDataUtils::putIntToArray(env, outAutoCommitFirstWordConfidenceArray, 0 /* index */,
                     suggestedWord.getAutoCommitFirstWordConfidence());
         }
         ++outputIndex;
-        mSuggestedWords.pop();
+        popWorstSuggestion();
     }
     JniDataUtils::putIntToArray(env, outSuggestionCount, 0 /* index */, outputIndex);
     JniDataUtils::putFloatToArray(env, outWeightOfLangModelVsSpatialModel, 0 /* index */,
@@ -55,50 +61,98 @@ void SuggestionResults::addPrediction(const int *const codePoints, const int cod
         return;
     }
     addSuggestion(codePoints, codePointCount, probability, Dictionary::KIND_PREDICTION,
-            NOT_AN_INDEX, NOT_A_FIRST_WORD_CONFIDENCE);
+            NOT_AN_INDEX, NOT_A_FIRST_WORD_CONFIDENCE, 0 /* dictionaryIndex */);
 }
 
 void SuggestionResults::addSuggestion(const int *const codePoints, const int codePointCount,
         const int score, const int type, const int indexToPartialCommit,
-        const int autocimmitFirstWordConfindence) {
+        const int autocimmitFirstWordConfindence, const int dictionaryIndex) {
     if (codePointCount <= 0 || codePointCount > MAX_WORD_LENGTH) {
         // Invalid word.
         AKLOGE("Invalid word is added to the suggestion results. codePointCount: %d",
                 codePointCount);
         return;
     }
+    if (!removeWorseDuplicateFromOtherDictionaries(codePoints, codePointCount, score,
+            dictionaryIndex)) {
+        return;
+    }
     if (getSuggestionCount() >= mMaxSuggestionCount) {
-        const SuggestedWord &mWorstSuggestion = mSuggestedWords.top();
+        const SuggestedWord &mWorstSuggestion = mSuggestedWords.front();
         if (score > mWorstSuggestion.getScore() || (score == mWorstSuggestion.getScore()
                 && codePointCount < mWorstSuggestion.getCodePointCount())) {
-            mSuggestedWords.pop();
+            popWorstSuggestion();
         } else {
             return;
         }
     }
-    mSuggestedWords.push(SuggestedWord(codePoints, codePointCount, score, type,
-            indexToPartialCommit, autocimmitFirstWordConfindence));
+    mSuggestedWords.emplace_back(codePoints, codePointCount, score, type,
+            indexToPartialCommit, autocimmitFirstWordConfindence, dictionaryIndex);
+    std::push_heap(mSuggestedWords.begin(), mSuggestedWords.end(), SuggestedWord::Comparator());
+}
+
+// Returns false when the word should not be added because another dictionary already gave it a
+// score that is not lower. A word is only ever kept from one dictionary, but that dictionary may
+// have added it more than once, e.g. for different previous words, so all its copies are removed.
+bool SuggestionResults::removeWorseDuplicateFromOtherDictionaries(const int *const codePoints,
+        const int codePointCount, const int score, const int dictionaryIndex) {
+    const auto isCopyFromOtherDictionary = [&](const SuggestedWord &suggestedWord) {
+        return suggestedWord.getDictionaryIndex() != dictionaryIndex
+                && suggestedWord.getCodePointCount() == codePointCount
+                && std::equal(codePoints, codePoints + codePointCount,
+                        suggestedWord.getCodePoint());
+    };
+    for (const SuggestedWord &suggestedWord : mSuggestedWords) {
+        if (isCopyFromOtherDictionary(suggestedWord) && suggestedWord.getScore() >= score) {
+            return false;
+        }
+    }
+    const auto end = std::remove_if(mSuggestedWords.begin(), mSuggestedWords.end(),
+            isCopyFromOtherDictionary);
+    if (end != mSuggestedWords.end()) {
+        mSuggestedWords.erase(end, mSuggestedWords.end());
+        std::make_heap(mSuggestedWords.begin(), mSuggestedWords.end(),
+                SuggestedWord::Comparator());
+    }
+    return true;
+}
+
+void SuggestionResults::popWorstSuggestion() {
+    std::pop_heap(mSuggestedWords.begin(), mSuggestedWords.end(), SuggestedWord::Comparator());
+    mSuggestedWords.pop_back();
+}
+
+void SuggestionResults::mergeSuggestionsFrom(const SuggestionResults &suggestionResults,
+        const int dictionaryIndex, const float scoreWeight) {
+    for (const SuggestedWord &suggestedWord : suggestionResults.mSuggestedWords) {
+        addSuggestion(suggestedWord.getCodePoint(), suggestedWord.getCodePointCount(),
+                static_cast<int>(suggestedWord.getScore() * scoreWeight), suggestedWord.getType(),
+                suggestedWord.getIndexToPartialCommit(),
+                suggestedWord.getAutoCommitFirstWordConfidence(), dictionaryIndex);
+    }
 }
 
 void SuggestionResults::getSortedScores(int *const outScores) const {
-    auto copyOfSuggestedWords = mSuggestedWords;
+    std::vector<SuggestedWord> copyOfSuggestedWords = mSuggestedWords;
     while (!copyOfSuggestedWords.empty()) {
-        const SuggestedWord &suggestedWord = copyOfSuggestedWords.top();
-        outScores[copyOfSuggestedWords.size() - 1] = suggestedWord.getScore();
-        copyOfSuggestedWords.pop();
+        outScores[copyOfSuggestedWords.size() - 1] = copyOfSuggestedWords.front().getScore();
+        std::pop_heap(copyOfSuggestedWords.begin(), copyOfSuggestedWords.end(),
+                SuggestedWord::Comparator());
+        copyOfSuggestedWords.pop_back();
     }
 }
 
+std::vector<SuggestedWord> SuggestionResults::getSortedSuggestedWords() const {
+    std::vector<SuggestedWord> suggestedWords = mSuggestedWords;
+    std::sort_heap(suggestedWords.begin(), suggestedWords.end(), SuggestedWord::Comparator());
+    return suggestedWords;
+}
+
 void SuggestionResults::dumpSuggestions() const {
     AKLOGE("weight of language model vs spatial model: %f", mWeightOfLangModelVsSpatialModel);
-    std::vector<SuggestedWord> suggestedWords;
-    auto copyOfSuggestedWords = mSuggestedWords;
-    while (!copyOfSuggestedWords.empty()) {
-        suggestedWords.push_back(copyOfSuggestedWords.top());
-        copyOfSuggestedWords.pop();
-    }
+    const std::vector<SuggestedWord> suggestedWords = getSortedSuggestedWords();
     [[maybe_unused]] int index = 0;
-    for (auto it = suggestedWords.rbegin(); it != suggestedWords.rend(); ++it) {
+    for (auto it = suggestedWords.begin(); it != suggestedWords.end(); ++it) {
         DUMP_SUGGESTION(it->getCodePoint(), it->getCodePointCount(), index, it->getScore());
         index++;
     }
@@ -17,7 +17,6 @@
 #ifndef LATINIME_SUGGESTION_RESULTS_H
 #define LATINIME_SUGGESTION_RESULTS_H
 
-#include <queue>
 #include <vector>
 
 #include "defines.h"
@@ -33,22 +32,39 @@ class SuggestionResults {
               mWeightOfLangModelVsSpatialModel(NOT_A_WEIGHT_OF_LANG_MODEL_VS_SPATIAL_MODEL),
               mSuggestedWords() {}
 
-    // Returns suggestion count.
+    // Returns suggestion count. outDictionaryIndicesArray may be null when a single dictionary is
+    // traversed.
     void outputSuggestions(JNIEnv *env, jintArray outSuggestionCount, jintArray outCodePointsArray,
             jintArray outScoresArray, jintArray outSpaceIndicesArray, jintArray outTypesArray,
             jintArray outAutoCommitFirstWordConfidenceArray,
-            jfloatArray outWeightOfLangModelVsSpatialModel);
+            jfloatArray outWeightOfLangModelVsSpatialModel, jintArray outDictionaryIndicesArray);
     void addPrediction(const int *const codePoints, const int codePointCount, const int score);
+    // A word already added from another dictionary is kept only from the dictionary giving it the
+    // best score, so that dictionaries do not compete for slots with the same word.
     void addSuggestion(const int *const codePoints, const int codePointCount,
             const int score, const int type, const int indexToPartialCommit,
-            const int autocimmitFirstWordConfindence);
+            const int autocimmitFirstWordConfindence, const int dictionaryIndex);
+    // Adds all the suggestions of the given results with their scores multiplied by scoreWeight,
+    // recording dictionaryIndex as their source.
+    void mergeSuggestionsFrom(const SuggestionResults &suggestionResults,
+            const int dictionaryIndex, const float scoreWeight);
     void getSortedScores(int *const outScores) const;
+    // Best first.
+    std::vector<SuggestedWord> getSortedSuggestedWords() const;
     void dumpSuggestions() const;
 
     void setWeightOfLangModelVsSpatialModel(const float weightOfLangModelVsSpatialModel) {
         mWeightOfLangModelVsSpatialModel = weightOfLangModelVsSpatialModel;
     }
 
+    float getWeightOfLangModelVsSpatialModel() const {
+        return mWeightOfLangModelVsSpatialModel;
+    }
+
+    int getMaxSuggestionCount() const {
+        return mMaxSuggestionCount;
+    }
+
     int getSuggestionCount() const {
         return mSuggestedWords.size();
     }
@@ -56,10 +72,15 @@ class SuggestionResults {
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(SuggestionResults);
 
+    bool removeWorseDuplicateFromOtherDictionaries(const int *const codePoints,
+            const int codePointCount, const int score, const int dictionaryIndex);
+    void popWorstSuggestion();
+
     const int mMaxSuggestionCount;
     float mWeightOfLangModelVsSpatialModel;
-    std::priority_queue<
-            SuggestedWord, std::vector<SuggestedWord>, SuggestedWord::Comparator> mSuggestedWords;
+    // A heap with the worst suggestion at the front. Unlike a priority_queue, it can be searched for
+    // duplicates.
+    std::vector<SuggestedWord> mSuggestedWords;
 };
 } // namespace latinime
 #endif // LATINIME_SUGGESTION_RESULTS_H
@@ -63,14 +63,11 @@ const int SuggestionsOutputUtils::MIN_LEN_FOR_MULTI_WORD_AUTOCORRECT = 16;
     // TODO: have partial commit work even with multiple pointers.
     const bool outputSecondWordFirstLetterInputIndex =
             traverseSession->isOnlyOnePointerUsed(0 /* pointerId */);
-    const bool boostExactMatches = traverseSession->getDictionaryStructurePolicy()->
-            getHeaderStructurePolicy()->shouldBoostExactMatches();
-
     // Output suggestion results here
     for (auto &terminalDicNode : terminals) {
         outputSuggestionsOfDicNode(scoringPolicy, traverseSession, &terminalDicNode,
-                weightOfLangModelVsSpatialModelToOutputSuggestions, boostExactMatches,
-                forceCommitMultiWords, outputSecondWordFirstLetterInputIndex, outSuggestionResults);
+                weightOfLangModelVsSpatialModelToOutputSuggestions, forceCommitMultiWords,
+                outputSecondWordFirstLetterInputIndex, outSuggestionResults);
     }
     scoringPolicy->getMostProbableString(traverseSession,
             weightOfLangModelVsSpatialModelToOutputSuggestions, outSuggestionResults);
@@ -125,8 +122,7 @@ const int SuggestionsOutputUtils::MIN_LEN_FOR_MULTI_WORD_AUTOCORRECT = 16;
 /* static */ void SuggestionsOutputUtils::outputSuggestionsOfDicNode(
         const Scoring *const scoringPolicy, DicTraverseSession *traverseSession,
         const DicNode *const terminalDicNode, const float weightOfLangModelVsSpatialModel,
-        const bool boostExactMatches, const bool forceCommitMultiWords,
-        const bool outputSecondWordFirstLetterInputIndex,
+        const bool forceCommitMultiWords, const bool outputSecondWordFirstLetterInputIndex,
         SuggestionResults *const outSuggestionResults) {
     if (DEBUG_GEO_FULL) {
         terminalDicNode->dump("OUT:");
@@ -136,9 +132,14 @@ const int SuggestionsOutputUtils::MIN_LEN_FOR_MULTI_WORD_AUTOCORRECT = 16;
     const float compoundDistance =
             terminalDicNode->getCompoundDistance(weightOfLangModelVsSpatialModel)
                     + doubleLetterCost;
-    const WordAttributes wordAttributes = traverseSession->getDictionaryStructurePolicy()
-            ->getWordAttributesInContext(terminalDicNode->getPrevWordIds(),
-                    terminalDicNode->getWordId(), nullptr /* multiBigramMap */);
+    const int dictionaryIndex = terminalDicNode->getDictionaryIndex();
+    const DictionaryStructureWithBufferPolicy *const structurePolicy =
+            traverseSession->getDictionaryStructurePolicy(dictionaryIndex);
+    const bool boostExactMatches =
+            structurePolicy->getHeaderStructurePolicy()->shouldBoostExactMatches();
+    const WordAttributes wordAttributes = structurePolicy->getWordAttributesInContext(
+            terminalDicNode->getPrevWordIds(), terminalDicNode->getWordId(),
+            nullptr /* multiBigramMap */);
     const bool isExactMatch =
             ErrorTypeUtils::isExactMatch(terminalDicNode->getContainedErrorTypes());
     const bool isExactMatchWithIntentionalOmission =
@@ -180,7 +181,8 @@ const int SuggestionsOutputUtils::MIN_LEN_FOR_MULTI_WORD_AUTOCORRECT = 16;
         outSuggestionResults->addSuggestion(codePoints,
                 terminalDicNode->getTotalNodeCodePointCount(),
                 finalScore, Dictionary::KIND_CORRECTION | outputTypeFlags,
-                indexToPartialCommit, computeFirstWordConfidence(terminalDicNode));
+                indexToPartialCommit, computeFirstWordConfidence(terminalDicNode),
+                dictionaryIndex);
     }
 
     // Output shortcuts.
@@ -188,10 +190,10 @@ const int SuggestionsOutputUtils::MIN_LEN_FOR_MULTI_WORD_AUTOCORRECT = 16;
     // TODO: Check shortcuts during traversal for multiple words suggestions.
     if (!terminalDicNode->hasMultipleWords()) {
         BinaryDictionaryShortcutIterator shortcutIt =
-                traverseSession->getDictionaryStructurePolicy()->getShortcutIterator(
-                        terminalDicNode->getWordId());
+                structurePolicy->getShortcutIterator(terminalDicNode->getWordId());
         const bool sameAsTyped = scoringPolicy->sameAsTyped(traverseSession, terminalDicNode);
-        outputShortcuts(&shortcutIt, finalScore, sameAsTyped, outSuggestionResults);
+        outputShortcuts(&shortcutIt, finalScore, sameAsTyped, dictionaryIndex,
+                outSuggestionResults);
     }
 }
 
@@ -249,7 +251,8 @@ const int SuggestionsOutputUtils::MIN_LEN_FOR_MULTI_WORD_AUTOCORRECT = 16;
 
 /* static */ void SuggestionsOutputUtils::outputShortcuts(
         BinaryDictionaryShortcutIterator *const shortcutIt, const int finalScore,
-        const bool sameAsTyped, SuggestionResults *const outSuggestionResults) {
+        const bool sameAsTyped, const int dictionaryIndex,
+        SuggestionResults *const outSuggestionResults) {
     int shortcutTarget[MAX_WORD_LENGTH];
     while (shortcutIt->hasNextShortcutTarget()) {
         bool isWhilelist;
@@ -270,7 +273,7 @@ const int SuggestionsOutputUtils::MIN_LEN_FOR_MULTI_WORD_AUTOCORRECT = 16;
         }
         outSuggestionResults->addSuggestion(shortcutTarget, shortcutTargetStringLength,
                 std::max(S_INT_MIN + 1, shortcutScore) - 1, kind, NOT_AN_INDEX,
-                NOT_A_FIRST_WORD_CONFIDENCE);
+                NOT_A_FIRST_WORD_CONFIDENCE, dictionaryIndex);
     }
 }
 } // namespace latinime
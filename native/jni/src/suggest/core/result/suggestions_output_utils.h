@@ -53,11 +53,11 @@ class SuggestionsOutputUtils {
 
     static void outputSuggestionsOfDicNode(const Scoring *const scoringPolicy,
             DicTraverseSession *traverseSession, const DicNode *const terminalDicNode,
-            const float weightOfLangModelVsSpatialModel, const bool boostExactMatches,
-            const bool forceCommitMultiWords, const bool outputSecondWordFirstLetterInputIndex,
+            const float weightOfLangModelVsSpatialModel, const bool forceCommitMultiWords,
+            const bool outputSecondWordFirstLetterInputIndex,
             SuggestionResults *const outSuggestionResults);
     static void outputShortcuts(BinaryDictionaryShortcutIterator *const shortcutIt,
-            const int finalScore, const bool sameAsTyped,
+            const int finalScore, const bool sameAsTyped, const int dictionaryIndex,
             SuggestionResults *const outSuggestionResults);
     static int computeFirstWordConfidence(const DicNode *const terminalDicNode);
 };
@@ -31,12 +31,31 @@ const int DicTraverseSession::DICTIONARY_SIZE_THRESHOLD_TO_USE_LARGE_CACHE_FOR_S
 
 void DicTraverseSession::init(const Dictionary *const dictionary,
         const NgramContext *const ngramContext, const SuggestOptions *const suggestOptions) {
-    mDictionary = dictionary;
-    mMultiWordCostMultiplier = getDictionaryStructurePolicy()->getHeaderStructurePolicy()
-            ->getMultiWordCostMultiplier();
+    init(&dictionary, 1 /* dictionaryCount */, ngramContext, suggestOptions);
+}
+
+void DicTraverseSession::init(const Dictionary *const *dictionaries, const int dictionaryCount,
+        const NgramContext *const ngramContext, const SuggestOptions *const suggestOptions) {
+    ASSERT(1 <= dictionaryCount && dictionaryCount <= MAX_DICTIONARY_COUNT_IN_SESSION);
+    mDictionarySetChanged = (dictionaryCount != mDictionaryCount);
+    for (int i = 0; i < dictionaryCount; ++i) {
+        // The policy is compared as well: dictionaries supporting snapshot reads switch between
+        // two copies, and cached DicNodes are only valid for the copy they were read from.
+        const DictionaryStructureWithBufferPolicy *const structurePolicy =
+                dictionaries[i]->getDictionaryStructurePolicy();
+        if (mDictionaries[i] != dictionaries[i]
+                || mDictionaryStructurePolicies[i] != structurePolicy) {
+            mDictionarySetChanged = true;
+        }
+        mDictionaries[i] = dictionaries[i];
+        mDictionaryStructurePolicies[i] = structurePolicy;
+        mMultiWordCostMultipliers[i] = structurePolicy->getHeaderStructurePolicy()
+                ->getMultiWordCostMultiplier();
+        mPrevWordIdCounts[i] = ngramContext->getPrevWordIds(structurePolicy,
+                &mPrevWordIdArrays[i], true /* tryLowerCaseSearch */).size();
+    }
+    mDictionaryCount = dictionaryCount;
     mSuggestOptions = suggestOptions;
-    mPrevWordIdCount = ngramContext->getPrevWordIds(getDictionaryStructurePolicy(),
-            &mPrevWordIdArray, true /* tryLowerCaseSearch */).size();
 }
 
 void DicTraverseSession::setupForGetSuggestions(const ProximityInfo *pInfo,
@@ -47,17 +66,24 @@ void DicTraverseSession::setupForGetSuggestions(const ProximityInfo *pInfo,
     mMaxPointerCount = maxPointerCount;
     initializeProximityInfoStates(inputCodePoints, inputXs, inputYs, times, pointerIds, inputSize,
             maxSpatialDistance, maxPointerCount);
+    if (maxPointerCount == MAX_POINTER_COUNT_G) {
+        mGestureMatchCache.onInputUpdated(pInfo,
+                mProximityInfoStates[0].isContinuousSuggestionPossible(),
+                mProximityInfoStates[0].size());
+    }
 }
 
-const DictionaryStructureWithBufferPolicy *DicTraverseSession::getDictionaryStructurePolicy()
-        const {
-    return mDictionary->getDictionaryStructurePolicy();
+const DictionaryStructureWithBufferPolicy *DicTraverseSession::getDictionaryStructurePolicy(
+        const int dictionaryIndex) const {
+    return mDictionaryStructurePolicies[dictionaryIndex];
 }
 
 void DicTraverseSession::resetCache(const int thresholdForNextActiveDicNodes, const int maxWords) {
     mDicNodesCache.reset(thresholdForNextActiveDicNodes /* nextActiveSize */,
             maxWords /* terminalSize */);
-    mMultiBigramMap.clear();
+    for (int i = 0; i < mDictionaryCount; ++i) {
+        mMultiBigramMaps[i].clear();
+    }
 }
 
 void DicTraverseSession::initializeProximityInfoStates(const int *const inputCodePoints,
@@ -74,7 +100,7 @@ void DicTraverseSession::initializeProximityInfoStates(const int *const inputCod
                 // a gesture and whatever is below is type. This is hacky and incorrect, we
                 // should pass the correct information instead.
                 maxPointerCount == MAX_POINTER_COUNT_G,
-                getDictionaryStructurePolicy()->getHeaderStructurePolicy()->getLocale());
+                getDictionaryStructurePolicy(0)->getHeaderStructurePolicy()->getLocale());
         mInputSize += mProximityInfoStates[i].size();
     }
 }
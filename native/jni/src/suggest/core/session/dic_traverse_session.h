@@ -24,6 +24,7 @@
 #include "jni.h"
 #include "suggest/core/dicnode/dic_nodes_cache.h"
 #include "suggest/core/layout/proximity_info_state.h"
+#include "suggest/core/session/gesture_match_cache.h"
 #include "utils/int_array_view.h"
 
 namespace latinime {
@@ -51,9 +52,12 @@ class DicTraverseSession {
     }
 
     AK_FORCE_INLINE DicTraverseSession(JNIEnv *env, jstring localeStr, bool usesLargeCache)
-            : mPrevWordIdCount(0), mProximityInfo(nullptr), mDictionary(nullptr),
-              mSuggestOptions(nullptr), mDicNodesCache(usesLargeCache), mMultiBigramMap(),
-              mInputSize(0), mMaxPointerCount(1), mMultiWordCostMultiplier(1.0f) {
+            : mPrevWordIdCounts(), mProximityInfo(nullptr), mDictionaries(),
+              mDictionaryStructurePolicies(), mDictionaryCount(0),
+              mDictionarySetChanged(false), mSuggestOptions(nullptr),
+              mDicNodesCache(usesLargeCache), mMultiBigramMaps(), mGestureMatchCache(),
+              mInputSize(0),
+              mMaxPointerCount(1), mMultiWordCostMultipliers() {
         // NOTE: mProximityInfoStates is an array of instances.
         // No need to initialize it explicitly here.
     }
@@ -63,6 +67,11 @@ class DicTraverseSession {
 
     void init(const Dictionary *dictionary, const NgramContext *const ngramContext,
             const SuggestOptions *const suggestOptions);
+    // Sets up a single traversal over all the given dictionaries. The spatial state and the
+    // DicNode caches are shared, and each DicNode remembers the index of the dictionary it walks.
+    // The first dictionary provides the locale.
+    void init(const Dictionary *const *dictionaries, const int dictionaryCount,
+            const NgramContext *const ngramContext, const SuggestOptions *const suggestOptions);
     // TODO: Remove and merge into init
     void setupForGetSuggestions(const ProximityInfo *pInfo, const int *inputCodePoints,
             const int inputSize, const int *const inputXs, const int *const inputYs,
@@ -70,21 +79,28 @@ class DicTraverseSession {
             const int maxPointerCount);
     void resetCache(const int thresholdForNextActiveDicNodes, const int maxWords);
 
-    const DictionaryStructureWithBufferPolicy *getDictionaryStructurePolicy() const;
+    const DictionaryStructureWithBufferPolicy *getDictionaryStructurePolicy(
+            const int dictionaryIndex) const;
 
     //--------------------
     // getters and setters
     //--------------------
     const ProximityInfo *getProximityInfo() const { return mProximityInfo; }
     const SuggestOptions *getSuggestOptions() const { return mSuggestOptions; }
-    const WordIdArrayView getPrevWordIds() const {
-        return WordIdArrayView::fromArray(mPrevWordIdArray).limit(mPrevWordIdCount);
+    int getDictionaryCount() const { return mDictionaryCount; }
+    const WordIdArrayView getPrevWordIds(const int dictionaryIndex) const {
+        return WordIdArrayView::fromArray(mPrevWordIdArrays[dictionaryIndex])
+                .limit(mPrevWordIdCounts[dictionaryIndex]);
     }
     DicNodesCache *getDicTraverseCache() { return &mDicNodesCache; }
-    MultiBigramMap *getMultiBigramMap() { return &mMultiBigramMap; }
+    MultiBigramMap *getMultiBigramMap(const int dictionaryIndex) {
+        return &mMultiBigramMaps[dictionaryIndex];
+    }
     const ProximityInfoState *getProximityInfoState(int id) const {
         return &mProximityInfoStates[id];
     }
+    // Weighting only gets a const session, so the cache is mutable.
+    GestureMatchCache *getGestureMatchCache() const { return &mGestureMatchCache; }
     int getInputSize() const { return mInputSize; }
 
     bool isOnlyOnePointerUsed(int *pointerId) const {
@@ -138,6 +154,11 @@ class DicTraverseSession {
             return false;
         }
 
+        // Cached DicNodes point into the dictionaries of the previous call.
+        if (mDictionarySetChanged) {
+            return false;
+        }
+
         // TODO: Not possible for swipe currently
         if (mMaxPointerCount == MAX_POINTER_COUNT_G) {
             return false;
@@ -159,8 +180,8 @@ class DicTraverseSession {
         return mProximityInfoStates[0].touchPositionCorrectionEnabled();
     }
 
-    float getMultiWordCostMultiplier() const {
-        return mMultiWordCostMultiplier;
+    float getMultiWordCostMultiplier(const int dictionaryIndex) const {
+        return mMultiWordCostMultipliers[dictionaryIndex];
     }
 
  private:
@@ -172,23 +193,30 @@ class DicTraverseSession {
             const int *const inputYs, const int *const times, const int *const pointerIds,
             const int inputSize, const float maxSpatialDistance, const int maxPointerCount);
 
-    WordIdArray<MAX_PREV_WORD_COUNT_FOR_N_GRAM> mPrevWordIdArray;
-    size_t mPrevWordIdCount;
+    WordIdArray<MAX_PREV_WORD_COUNT_FOR_N_GRAM> mPrevWordIdArrays[MAX_DICTIONARY_COUNT_IN_SESSION];
+    size_t mPrevWordIdCounts[MAX_DICTIONARY_COUNT_IN_SESSION];
     const ProximityInfo *mProximityInfo;
-    const Dictionary *mDictionary;
+    const Dictionary *mDictionaries[MAX_DICTIONARY_COUNT_IN_SESSION];
+    // Policies of the dictionaries, taken once per search.
+    const DictionaryStructureWithBufferPolicy
+            *mDictionaryStructurePolicies[MAX_DICTIONARY_COUNT_IN_SESSION];
+    int mDictionaryCount;
+    bool mDictionarySetChanged;
     const SuggestOptions *mSuggestOptions;
 
     DicNodesCache mDicNodesCache;
     // Temporary cache for bigram frequencies
-    MultiBigramMap mMultiBigramMap;
+    MultiBigramMap mMultiBigramMaps[MAX_DICTIONARY_COUNT_IN_SESSION];
     ProximityInfoState mProximityInfoStates[MAX_POINTER_COUNT_G];
+    // Scan results kept across the updates of a gesture
+    mutable GestureMatchCache mGestureMatchCache;
 
     int mInputSize;
     int mMaxPointerCount;
 
     /////////////////////////////////
     // Configuration per dictionary
-    float mMultiWordCostMultiplier;
+    float mMultiWordCostMultipliers[MAX_DICTIONARY_COUNT_IN_SESSION];
 
 };
 } // namespace latinime
@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/session/gesture_match_cache.h"
+
+#include <algorithm>
+
+namespace latinime {
+
+// ProximityInfoStateUtils::trimLastTwoTouchPoints() removes two points when the gesture goes on,
+// and sampling the first new point may pop the point before them.
+const int GestureMatchCache::UNSTABLE_TRAILING_POINT_COUNT = 3;
+
+void GestureMatchCache::onInputUpdated(const ProximityInfo *const proximityInfo,
+        const bool isContinuation, const int sampledInputSize) {
+    const int stableInputSize = std::max(0, sampledInputSize - UNSTABLE_TRAILING_POINT_COUNT);
+    // Cached results may cover points up to the previous stable size, which are only guaranteed
+    // to be kept by the next update if the stable size doesn't shrink.
+    if (!isContinuation || proximityInfo != mProximityInfo
+            || stableInputSize < mStableInputSize) {
+        clear();
+    }
+    mProximityInfo = proximityInfo;
+    mStableInputSize = stableInputSize;
+}
+
+void GestureMatchCache::clear() {
+    mKeySearches.clear();
+    mLineDeviations.clear();
+}
+
+} // namespace latinime
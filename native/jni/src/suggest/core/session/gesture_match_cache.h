@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_GESTURE_MATCH_CACHE_H
+#define LATINIME_GESTURE_MATCH_CACHE_H
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "defines.h"
+
+namespace latinime {
+
+class ProximityInfo;
+
+/**
+ * Keeps the results of scanning the sampled points of a gesture while the gesture goes on, so
+ * that each update of the gesture only scans the points that were added since the previous one.
+ *
+ * Continuing a gesture resamples its last two points and may drop the point before them, so
+ * results are only kept for the points before getStableInputSize().
+ */
+class GestureMatchCache {
+ public:
+    // Progress of the search, from a start index, for the point where the gesture passes closest
+    // to a key.
+    struct KeySearch {
+        // The index to resume the search at, or NOT_AN_INDEX once the point was found.
+        int mNextInputIndex;
+        int mMinEdgeIndex;
+        float mMinEdgeDistance;
+        bool mIsHeadingTowardsKey;
+    };
+
+    // Sum of the deviations of the gesture from the line between two keys, from a start index to
+    // mEndInputIndex.
+    struct LineDeviation {
+        int mEndInputIndex;
+        float mDeviation;
+    };
+
+    GestureMatchCache()
+            : mProximityInfo(nullptr), mStableInputSize(0), mKeySearches(),
+              mLineDeviations() {}
+
+    // Has to be called for every update of the input. The cached results are dropped unless the
+    // update continues the gesture of the previous one on the same keyboard.
+    void onInputUpdated(const ProximityInfo *const proximityInfo, const bool isContinuation,
+            const int sampledInputSize);
+
+    // The number of points that will not change while the gesture continues.
+    int getStableInputSize() const {
+        return mStableInputSize;
+    }
+
+    const KeySearch *getKeySearch(const int codePoint, const int startIndex) const {
+        const auto it = mKeySearches.find(getKey(NOT_A_CODE_POINT, codePoint, startIndex));
+        return it != mKeySearches.end() ? &it->second : nullptr;
+    }
+
+    void putKeySearch(const int codePoint, const int startIndex, const KeySearch &keySearch) {
+        mKeySearches[getKey(NOT_A_CODE_POINT, codePoint, startIndex)] = keySearch;
+    }
+
+    const LineDeviation *getLineDeviation(const int codePoint0, const int codePoint1,
+            const int startIndex) const {
+        const auto it = mLineDeviations.find(getKey(codePoint0, codePoint1, startIndex));
+        return it != mLineDeviations.end() ? &it->second : nullptr;
+    }
+
+    void putLineDeviation(const int codePoint0, const int codePoint1, const int startIndex,
+            const LineDeviation &lineDeviation) {
+        mLineDeviations[getKey(codePoint0, codePoint1, startIndex)] = lineDeviation;
+    }
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(GestureMatchCache);
+
+    static const int UNSTABLE_TRAILING_POINT_COUNT;
+
+    // Code points take 21 bits; NOT_A_CODE_POINT maps to a value no code point has.
+    static uint64_t getKey(const int codePoint0, const int codePoint1, const int startIndex) {
+        static const uint64_t CODE_POINT_MASK = (1 << 21) - 1;
+        return ((static_cast<uint64_t>(codePoint0) & CODE_POINT_MASK) << 43)
+                | ((static_cast<uint64_t>(codePoint1) & CODE_POINT_MASK) << 22)
+                | static_cast<uint64_t>(startIndex);
+    }
+
+    void clear();
+
+    const ProximityInfo *mProximityInfo;
+    int mStableInputSize;
+    std::unordered_map<uint64_t, KeySearch> mKeySearches;
+    std::unordered_map<uint64_t, LineDeviation> mLineDeviations;
+};
+} // namespace latinime
+#endif // LATINIME_GESTURE_MATCH_CACHE_H
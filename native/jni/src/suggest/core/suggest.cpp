@@ -30,6 +30,7 @@
 #include "suggest/core/session/dic_traverse_session.h"
 #include "suggest/core/suggest_options.h"
 #include "utils/profiler.h"
+#include "utils/stats_registry.h"
 
 namespace latinime {
 
@@ -92,11 +93,14 @@ void Suggest::initializeSearch(DicTraverseSession *traverseSession) const {
         traverseSession->resetCache(TRAVERSAL->getMaxCacheSize(traverseSession->getInputSize(),
                 traverseSession->getSuggestOptions()->weightForLocale()),
                 TRAVERSAL->getTerminalCacheSize());
-        // Create a new dic node here
-        DicNode rootNode;
-        DicNodeUtils::initAsRoot(traverseSession->getDictionaryStructurePolicy(),
-                traverseSession->getPrevWordIds(), &rootNode);
-        traverseSession->getDicTraverseCache()->copyPushActive(&rootNode);
+        // Create a new dic node here for each dictionary. They all compete in the same caches, so
+        // the spatial computations for the input are shared by the dictionaries.
+        for (int i = 0; i < traverseSession->getDictionaryCount(); ++i) {
+            DicNode rootNode;
+            DicNodeUtils::initAsRoot(traverseSession->getDictionaryStructurePolicy(i),
+                    traverseSession->getPrevWordIds(i), i /* dictionaryIndex */, &rootNode);
+            traverseSession->getDicTraverseCache()->copyPushActive(&rootNode);
+        }
     }
 }
 
@@ -105,6 +109,8 @@ void Suggest::initializeSearch(DicTraverseSession *traverseSession) const {
  * nodes based on the next touch point(s) (or no touch points for lookahead)
  */
 void Suggest::expandCurrentDicNodes(DicTraverseSession *traverseSession) const {
+    StatsScopedTimer timer(StatsStage::DIC_NODE_EXPANSION);
+    timer.setItemCount(0);
     const int inputSize = traverseSession->getInputSize();
     DicNodeVector childDicNodes(TRAVERSAL->getDefaultExpandDicNodeSize());
     DicNode correctionDicNode;
@@ -124,6 +130,7 @@ void Suggest::expandCurrentDicNodes(DicTraverseSession *traverseSession) const {
         if (dicNode.isTotalInputSizeExceedingLimit()) {
             return;
         }
+        timer.addItems(1);
         childDicNodes.clear();
 
         if(TRAVERSAL->isTransition(traverseSession, &dicNode)) {
@@ -170,8 +177,9 @@ void Suggest::expandCurrentDicNodes(DicTraverseSession *traverseSession) const {
                 createNextWordDicNode(traverseSession, &dicNode, true /* spaceSubstitution */);
             }
 
-            DicNodeUtils::getAllChildDicNodes(
-                    &dicNode, traverseSession->getDictionaryStructurePolicy(), &childDicNodes);
+            const DictionaryStructureWithBufferPolicy *const structurePolicy =
+                    traverseSession->getDictionaryStructurePolicy(dicNode.getDictionaryIndex());
+            DicNodeUtils::getAllChildDicNodes(&dicNode, structurePolicy, &childDicNodes);
 
             const int childDicNodesSize = childDicNodes.getSizeAndLock();
             for (int i = 0; i < childDicNodesSize; ++i) {
@@ -182,8 +190,7 @@ void Suggest::expandCurrentDicNodes(DicTraverseSession *traverseSession) const {
                     continue;
                 }
                 if (DigraphUtils::hasDigraphForCodePoint(
-                        traverseSession->getDictionaryStructurePolicy()
-                                ->getHeaderStructurePolicy(),
+                        structurePolicy->getHeaderStructurePolicy(),
                         childDicNode->getNodeCodePoint())) {
                     correctionDicNode.initByCopy(childDicNode);
                     correctionDicNode.advanceDigraphIndex();
@@ -251,10 +258,11 @@ void Suggest::processTerminalDicNode(
     if (TRAVERSAL->needsToTraverseAllUserInput()
             && dicNode->getInputIndex(0) < traverseSession->getInputSize()) {
         Weighting::addCostAndForwardInputIndex(WEIGHTING, CT_TERMINAL_INSERTION, traverseSession, parentDicNode,
-                &terminalDicNode, traverseSession->getMultiBigramMap());
+                &terminalDicNode,
+                traverseSession->getMultiBigramMap(dicNode->getDictionaryIndex()));
     }
     Weighting::addCostAndForwardInputIndex(WEIGHTING, CT_TERMINAL, traverseSession, parentDicNode,
-            &terminalDicNode, traverseSession->getMultiBigramMap());
+            &terminalDicNode, traverseSession->getMultiBigramMap(dicNode->getDictionaryIndex()));
 
     if (terminalDicNode.getCompoundDistance() >= static_cast<float>(MAX_VALUE_FOR_WEIGHTING)) {
         return;
@@ -323,8 +331,9 @@ void Suggest::processDicNodeAsDigraph(DicTraverseSession *traverseSession,
 void Suggest::processDicNodeAsOmission(
         DicTraverseSession *traverseSession, DicNode *dicNode) const {
     DicNodeVector childDicNodes;
-    DicNodeUtils::getAllChildDicNodes(
-            dicNode, traverseSession->getDictionaryStructurePolicy(), &childDicNodes);
+    DicNodeUtils::getAllChildDicNodes(dicNode,
+            traverseSession->getDictionaryStructurePolicy(dicNode->getDictionaryIndex()),
+            &childDicNodes);
 
     const int size = childDicNodes.getSizeAndLock();
     for (int i = 0; i < size; i++) {
@@ -348,7 +357,8 @@ void Suggest::processDicNodeAsInsertion(DicTraverseSession *traverseSession,
         DicNode *dicNode) const {
     const int16_t pointIndex = dicNode->getInputIndex(0);
     DicNodeVector childDicNodes;
-    DicNodeUtils::getAllChildDicNodes(dicNode, traverseSession->getDictionaryStructurePolicy(),
+    DicNodeUtils::getAllChildDicNodes(dicNode,
+            traverseSession->getDictionaryStructurePolicy(dicNode->getDictionaryIndex()),
             &childDicNodes);
     const int size = childDicNodes.getSizeAndLock();
     for (int i = 0; i < size; i++) {
@@ -382,8 +392,9 @@ void Suggest::processDicNodeAsTransposition(DicTraverseSession *traverseSession,
     const int16_t pointIndex = dicNode->getInputIndex(0);
     DicNodeVector childDicNodes1;
     DicNodeVector childDicNodes2;
-    DicNodeUtils::getAllChildDicNodes(dicNode, traverseSession->getDictionaryStructurePolicy(),
-            &childDicNodes1);
+    const DictionaryStructureWithBufferPolicy *const structurePolicy =
+            traverseSession->getDictionaryStructurePolicy(dicNode->getDictionaryIndex());
+    DicNodeUtils::getAllChildDicNodes(dicNode, structurePolicy, &childDicNodes1);
     const int childSize1 = childDicNodes1.getSizeAndLock();
     for (int i = 0; i < childSize1; i++) {
         const ProximityType matchedId1 = traverseSession->getProximityInfoState(0)
@@ -394,8 +405,7 @@ void Suggest::processDicNodeAsTransposition(DicTraverseSession *traverseSession,
         }
         if (childDicNodes1[i]->hasChildren()) {
             childDicNodes2.clear();
-            DicNodeUtils::getAllChildDicNodes(childDicNodes1[i],
-                    traverseSession->getDictionaryStructurePolicy(), &childDicNodes2);
+            DicNodeUtils::getAllChildDicNodes(childDicNodes1[i], structurePolicy, &childDicNodes2);
             const int childSize2 = childDicNodes2.getSizeAndLock();
             for (int j = 0; j < childSize2; j++) {
                 DicNode *const childDicNode2 = childDicNodes2[j];
@@ -434,10 +444,11 @@ void Suggest::weightChildNode(DicTraverseSession *traverseSession, const DicNode
  */
 void Suggest::createNextWordDicNode(DicTraverseSession *traverseSession, DicNode *dicNode,
         const bool spaceSubstitution) const {
+    const int dictionaryIndex = dicNode->getDictionaryIndex();
     const WordAttributes wordAttributes =
-            traverseSession->getDictionaryStructurePolicy()->getWordAttributesInContext(
-                    dicNode->getPrevWordIds(), dicNode->getWordId(),
-                    traverseSession->getMultiBigramMap());
+            traverseSession->getDictionaryStructurePolicy(dictionaryIndex)
+                    ->getWordAttributesInContext(dicNode->getPrevWordIds(), dicNode->getWordId(),
+                            traverseSession->getMultiBigramMap(dictionaryIndex));
     if (SuggestionsOutputUtils::shouldBlockWord(traverseSession->getSuggestOptions(),
             dicNode, wordAttributes, false /* isLastWord */)) {
         return;
@@ -450,11 +461,11 @@ void Suggest::createNextWordDicNode(DicTraverseSession *traverseSession, DicNode
     // Create a non-cached node here.
     DicNode newDicNode;
     DicNodeUtils::initAsRootWithPreviousWord(
-            traverseSession->getDictionaryStructurePolicy(), dicNode, &newDicNode);
+            traverseSession->getDictionaryStructurePolicy(dictionaryIndex), dicNode, &newDicNode);
     const CorrectionType correctionType = spaceSubstitution ?
             CT_NEW_WORD_SPACE_SUBSTITUTION : CT_NEW_WORD_SPACE_OMISSION;
     Weighting::addCostAndForwardInputIndex(WEIGHTING, correctionType, traverseSession, dicNode,
-            &newDicNode, traverseSession->getMultiBigramMap());
+            &newDicNode, traverseSession->getMultiBigramMap(dictionaryIndex));
     if (newDicNode.getCompoundDistance() < static_cast<float>(MAX_VALUE_FOR_WEIGHTING)) {
         // newDicNode is worth continuing to traverse.
         // CAVEAT: This pruning is important for speed. Remove this when we can afford not to prune
@@ -86,10 +86,9 @@ namespace util {
             const latinime::DicTraverseSession *const traverseSession,
             int codePoint0, int codePoint1,
             int lowerLimit, int upperLimit,
-            float threshold
+            float threshold,
+            float totalDistance = 0.0f
     ) {
-        float totalDistance = 0.0;
-
         const int ki_0 = traverseSession->getProximityInfo()->getKeyIndexOf(latinime::CharUtils::toBaseLowerCase(codePoint0));
         const int ki_1 = traverseSession->getProximityInfo()->getKeyIndexOf(latinime::CharUtils::toBaseLowerCase(codePoint1));
 
@@ -140,6 +139,105 @@ namespace util {
         return totalDistance;
     }
 
+    // Same as calcLineDeviationPunishment(), but continues the sum the session cached for the
+    // points that stay the same while the gesture goes on, and caches it up to those points.
+    static AK_FORCE_INLINE float getCachedLineDeviationPunishment(
+            const latinime::DicTraverseSession *const traverseSession,
+            int codePoint0, int codePoint1,
+            int lowerLimit, int upperLimit,
+            float threshold
+    ) {
+        latinime::GestureMatchCache *const cache = traverseSession->getGestureMatchCache();
+        const latinime::GestureMatchCache::LineDeviation *const cachedDeviation =
+                cache->getLineDeviation(codePoint0, codePoint1, lowerLimit);
+
+        int startIndex = lowerLimit;
+        float totalDistance = 0.0f;
+        if(cachedDeviation != nullptr && cachedDeviation->mEndInputIndex <= upperLimit) {
+            startIndex = cachedDeviation->mEndInputIndex;
+            totalDistance = cachedDeviation->mDeviation;
+            if(totalDistance >= MAX_VALUE_FOR_WEIGHTING) {
+                return MAX_VALUE_FOR_WEIGHTING;
+            }
+        }
+
+        const int stableLimit = std::min(upperLimit, cache->getStableInputSize());
+        if(startIndex < stableLimit) {
+            totalDistance = calcLineDeviationPunishment(traverseSession, codePoint0, codePoint1,
+                    startIndex, stableLimit, threshold, totalDistance);
+            if(cachedDeviation == nullptr || cachedDeviation->mEndInputIndex < stableLimit) {
+                cache->putLineDeviation(codePoint0, codePoint1, lowerLimit,
+                        { stableLimit, totalDistance });
+            }
+            if(totalDistance >= MAX_VALUE_FOR_WEIGHTING) {
+                return MAX_VALUE_FOR_WEIGHTING;
+            }
+            startIndex = stableLimit;
+        }
+
+        return calcLineDeviationPunishment(traverseSession, codePoint0, codePoint1,
+                startIndex, upperLimit, threshold, totalDistance);
+    }
+
+    // Searches the gesture from inputIndex for the point where it passes closest to the key of
+    // codePoint. The search over the points that stay the same while the gesture goes on is
+    // cached, so that following updates resume it at the first point that may have changed.
+    static AK_FORCE_INLINE bool findKeyPassing(
+            const latinime::DicTraverseSession *const traverseSession,
+            int codePoint, int inputIndex, float keyThreshold,
+            int *const outMinEdgeIndex, float *const outMinEdgeDistance
+    ) {
+        latinime::GestureMatchCache *const cache = traverseSession->getGestureMatchCache();
+        const int swipeLength = traverseSession->getInputSize();
+        const int stableInputSize = cache->getStableInputSize();
+
+        latinime::GestureMatchCache::KeySearch search =
+                { inputIndex, -1, MAX_VALUE_FOR_WEIGHTING, false };
+        const latinime::GestureMatchCache::KeySearch *const cachedSearch =
+                cache->getKeySearch(codePoint, inputIndex);
+        if(cachedSearch != nullptr) {
+            search = *cachedSearch;
+        }
+
+        bool found = search.mNextInputIndex == NOT_AN_INDEX;
+        int i = search.mNextInputIndex;
+        for (; !found && i < swipeLength; i++) {
+            if (i == stableInputSize && i != search.mNextInputIndex) {
+                cache->putKeySearch(codePoint, inputIndex, { i, search.mMinEdgeIndex,
+                        search.mMinEdgeDistance, search.mIsHeadingTowardsKey });
+            }
+
+            if (i == 0) continue;
+
+            const float distance = getDistanceLine(traverseSession, codePoint, i - 1, i);
+
+#if(DEBUG_SWIPE)
+            AKLOGI("[%c:%d] distance %.2f, min %.2f. thresh %.2f", (char)codePoint, i, distance, search.mMinEdgeDistance, keyThreshold);
+#endif
+            if (distance < search.mMinEdgeDistance) {
+                if(search.mMinEdgeIndex != -1) search.mIsHeadingTowardsKey = true;
+                search.mMinEdgeDistance = distance;
+                search.mMinEdgeIndex = i;
+            }
+
+            if (((distance > search.mMinEdgeDistance) || (i >= (swipeLength - 1))) && (search.mMinEdgeDistance < keyThreshold) && search.mIsHeadingTowardsKey) {
+#if(DEBUG_SWIPE)
+                AKLOGI("found!");
+#endif
+                found = true;
+                if (i < stableInputSize) {
+                    cache->putKeySearch(codePoint, inputIndex, { NOT_AN_INDEX,
+                            search.mMinEdgeIndex, search.mMinEdgeDistance,
+                            search.mIsHeadingTowardsKey });
+                }
+            }
+        }
+
+        *outMinEdgeIndex = search.mMinEdgeIndex;
+        *outMinEdgeDistance = search.mMinEdgeDistance;
+        return found;
+    }
+
     static AK_FORCE_INLINE float getThresholdBase(const latinime::DicTraverseSession *const traverseSession) {
         return traverseSession->getProximityInfo()->getMostCommonKeyWidth() / 48.0f;
     }
@@ -187,7 +285,7 @@ public:
 
                 const float threshold = (distanceThreshold * 86.0f);
 
-                const float extraDistance = 8.0f * util::calcLineDeviationPunishment(
+                const float extraDistance = 8.0f * util::getCachedLineDeviationPunishment(
                         traverseSession, codePoint0, codePoint1, lowerLimit, upperLimit, threshold);
 
                 totalDistance += pow(extraDistance, 1.8f) * 0.1f;
@@ -270,41 +368,17 @@ public:
             return 0.0f;
         } else { // Add middle points
             const int inputIndex = dicNode->getInputIndex(0);
-            const int swipeLength = traverseSession->getInputSize();
 
             int minEdgeIndex = -1;
             float minEdgeDistance = MAX_VALUE_FOR_WEIGHTING;
-            bool found = false;
-            bool headedTowardsCharacterYet = false;
 
             const float keyThreshold = (80.0f * distanceThreshold);
 
 #if(DEBUG_SWIPE)
             AKLOGI("commence search for %c", (char)codePoint);
 #endif
-            for (int i = inputIndex; i < swipeLength; i++) {
-                if (i == 0) continue;
-
-                const float distance = util::getDistanceLine(traverseSession, codePoint, i - 1, i);
-
-#if(DEBUG_SWIPE)
-                AKLOGI("[%c:%d] distance %.2f, min %.2f. thresh %.2f", (char)codePoint, i, distance, minEdgeDistance, keyThreshold);
-#endif
-                if (distance < minEdgeDistance) {
-                    if(minEdgeIndex != -1) headedTowardsCharacterYet = true;
-                    minEdgeDistance = distance;
-                    minEdgeIndex = i;
-                }
-
-                if (((distance > minEdgeDistance) || (i >= (swipeLength - 1))) && (minEdgeDistance < keyThreshold) && headedTowardsCharacterYet) {
-#if(DEBUG_SWIPE)
-                    AKLOGI("found!");
-#endif
-
-                    found = true;
-                    break;
-                }
-            }
+            const bool found = util::findKeyPassing(traverseSession, codePoint, inputIndex,
+                    keyThreshold, &minEdgeIndex, &minEdgeDistance);
 
             if(found && parentDicNode != nullptr && minEdgeDistance < MAX_VALUE_FOR_WEIGHTING) {
                 float totalDistance = 24.0f * pow(minEdgeDistance, 1.6f);
@@ -324,7 +398,7 @@ public:
 
                     const float threshold = (distanceThreshold * 86.0f);
 
-                    const float punishment = util::calcLineDeviationPunishment(
+                    const float punishment = util::getCachedLineDeviationPunishment(
                             traverseSession, codePoint0, codePoint1, lowerLimit, upperLimit,
                             threshold);
 
@@ -391,7 +465,7 @@ public:
     AK_FORCE_INLINE float getNewWordBigramLanguageCost(const DicTraverseSession *const traverseSession,
                                        const DicNode *const dicNode, MultiBigramMap *const multiBigramMap) const override {
         return DicNodeUtils::getBigramNodeImprobability(
-                traverseSession->getDictionaryStructurePolicy(),
+                traverseSession->getDictionaryStructurePolicy(dicNode->getDictionaryIndex()),
                 dicNode, multiBigramMap) * ScoringParams::DISTANCE_WEIGHT_LANGUAGE;
     }
 
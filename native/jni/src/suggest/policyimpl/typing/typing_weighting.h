@@ -160,14 +160,14 @@ class TypingWeighting : public Weighting {
     float getSpaceOmissionCost(const DicTraverseSession *const traverseSession,
             const DicNode *const dicNode, DicNode_InputStateG *inputStateG) const {
         const float cost = ScoringParams::SPACE_OMISSION_COST;
-        return cost * traverseSession->getMultiWordCostMultiplier();
+        return cost * traverseSession->getMultiWordCostMultiplier(dicNode->getDictionaryIndex());
     }
 
     float getNewWordBigramLanguageCost(const DicTraverseSession *const traverseSession,
             const DicNode *const dicNode,
             MultiBigramMap *const multiBigramMap) const {
         return DicNodeUtils::getBigramNodeImprobability(
-                traverseSession->getDictionaryStructurePolicy(),
+                traverseSession->getDictionaryStructurePolicy(dicNode->getDictionaryIndex()),
                 dicNode, multiBigramMap) * ScoringParams::DISTANCE_WEIGHT_LANGUAGE;
     }
 
@@ -214,7 +214,7 @@ class TypingWeighting : public Weighting {
         const float distanceToSpaceKey = traverseSession->getProximityInfoState(0)
                 ->getPointToKeyLength(inputIndex, KEYCODE_SPACE);
         const float cost = ScoringParams::SPACE_SUBSTITUTION_COST * distanceToSpaceKey;
-        return cost * traverseSession->getMultiWordCostMultiplier();
+        return cost * traverseSession->getMultiWordCostMultiplier(dicNode->getDictionaryIndex());
     }
 
     ErrorTypeUtils::ErrorType getErrorType(const CorrectionType correctionType,
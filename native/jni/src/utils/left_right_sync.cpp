@@ -0,0 +1,30 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/left_right_sync.h"
+
+#include <thread>
+
+namespace latinime {
+
+void LeftRightSync::waitForReaders(const int versionIndex) const {
+    // Readers only hold a replica for the duration of a lookup, so yielding is enough.
+    while (mReaderCounts[versionIndex].load() != 0) {
+        std::this_thread::yield();
+    }
+}
+
+} // namespace latinime
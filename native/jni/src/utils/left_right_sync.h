@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_LEFT_RIGHT_SYNC_H
+#define LATINIME_LEFT_RIGHT_SYNC_H
+
+#include <atomic>
+
+#include "defines.h"
+
+namespace latinime {
+
+/**
+ * Synchronizes two replicas of a data structure with the left-right technique: readers never
+ * wait and always read a replica that isn't being written, while the writer applies each update
+ * to both replicas in turn. The replica that readers are sent to switches after every update.
+ *
+ * There must be a single writer at a time; serializing updates is up to the caller.
+ */
+class LeftRightSync {
+ public:
+    // Keeps the replica returned by getReadableIndex() safe to read during its lifetime.
+    class ReadScope {
+     public:
+        explicit ReadScope(const LeftRightSync *const sync)
+                : mSync(sync), mVersionIndex(sync->arriveReader()) {}
+
+        ~ReadScope() {
+            mSync->departReader(mVersionIndex);
+        }
+
+     private:
+        DISALLOW_IMPLICIT_CONSTRUCTORS(ReadScope);
+
+        const LeftRightSync *const mSync;
+        const int mVersionIndex;
+    };
+
+    LeftRightSync() : mReadableIndex(0), mVersionIndex(0), mReaderCounts() {}
+
+    // Returns the replica readers should use. Has to be called between arriveReader() and
+    // departReader(), or in a ReadScope.
+    int getReadableIndex() const {
+        return mReadableIndex.load();
+    }
+
+    // Returns the version index that has to be passed to departReader().
+    int arriveReader() const {
+        const int versionIndex = mVersionIndex.load();
+        mReaderCounts[versionIndex].fetch_add(1);
+        return versionIndex;
+    }
+
+    void departReader(const int versionIndex) const {
+        mReaderCounts[versionIndex].fetch_sub(1);
+    }
+
+    // Calls update(replicaIndex) for the replica readers don't use, sends readers to it, waits
+    // until no reader can still be on the other replica and updates that one too. Returns the
+    // result of the first call.
+    template <typename Update>
+    bool update(const Update &update) {
+        const int readableIndex = mReadableIndex.load();
+        const bool result = update(1 - readableIndex);
+        mReadableIndex.store(1 - readableIndex);
+        const int previousVersionIndex = mVersionIndex.load();
+        const int nextVersionIndex = 1 - previousVersionIndex;
+        waitForReaders(nextVersionIndex);
+        mVersionIndex.store(nextVersionIndex);
+        waitForReaders(previousVersionIndex);
+        update(readableIndex);
+        return result;
+    }
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(LeftRightSync);
+
+    std::atomic<int> mReadableIndex;
+    std::atomic<int> mVersionIndex;
+    mutable std::atomic<int> mReaderCounts[2];
+
+    void waitForReaders(const int versionIndex) const;
+};
+} // namespace latinime
+#endif // LATINIME_LEFT_RIGHT_SYNC_H
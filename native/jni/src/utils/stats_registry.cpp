@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/stats_registry.h"
+
+#include <cstdio>
+#include <ctime>
+
+namespace latinime {
+
+const char *const StatsRegistry::STAGE_NAMES[] = {
+    "tokenize",
+    "prompt_decode",
+    "embed_mix",
+    "xbc_decode",
+    "sample_step",
+    "kv_copy",
+    "dic_node_expansion",
+    "gc",
+    "lexicon_build",
+};
+
+// Zero-initialized as it has static storage duration
+StatsRegistry::StageStats StatsRegistry::sStages[static_cast<int>(StatsStage::STAGE_COUNT)];
+
+/* static */ int64_t StatsRegistry::getTimeInMicroSec() {
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return static_cast<int64_t>(time.tv_sec) * 1000000
+            + static_cast<int64_t>(time.tv_nsec) / 1000;
+}
+
+/* static */ int StatsRegistry::getBucketIndex(const int64_t durationUs) {
+    int index = 0;
+    for (int64_t value = durationUs >> 1; value > 0 && index < HISTOGRAM_BUCKET_COUNT - 1;
+            value >>= 1) {
+        index++;
+    }
+    return index;
+}
+
+/* static */ void StatsRegistry::record(const StatsStage stage, const int64_t durationUs,
+        const int itemCount) {
+    StageStats &stats = sStages[static_cast<int>(stage)];
+    const int64_t duration = durationUs < 0 ? 0 : durationUs;
+
+    stats.mEventCount.fetch_add(1, std::memory_order_relaxed);
+    stats.mItemCount.fetch_add(itemCount, std::memory_order_relaxed);
+    stats.mTotalTimeUs.fetch_add(duration, std::memory_order_relaxed);
+    stats.mHistogram[getBucketIndex(duration)].fetch_add(1, std::memory_order_relaxed);
+
+    int64_t maxTime = stats.mMaxTimeUs.load(std::memory_order_relaxed);
+    while (duration > maxTime && !stats.mMaxTimeUs.compare_exchange_weak(maxTime, duration,
+            std::memory_order_relaxed)) {}
+}
+
+/* static */ void StatsRegistry::getSnapshot(const StatsStage stage,
+        StageSnapshot *const outSnapshot) {
+    const StageStats &stats = sStages[static_cast<int>(stage)];
+    outSnapshot->mEventCount = stats.mEventCount.load(std::memory_order_relaxed);
+    outSnapshot->mItemCount = stats.mItemCount.load(std::memory_order_relaxed);
+    outSnapshot->mTotalTimeUs = stats.mTotalTimeUs.load(std::memory_order_relaxed);
+    outSnapshot->mMaxTimeUs = stats.mMaxTimeUs.load(std::memory_order_relaxed);
+    for (int i = 0; i < HISTOGRAM_BUCKET_COUNT; ++i) {
+        outSnapshot->mHistogram[i] = stats.mHistogram[i].load(std::memory_order_relaxed);
+    }
+}
+
+/* static */ int64_t StatsRegistry::getPercentileUs(const StageSnapshot &snapshot,
+        const float percentile) {
+    int64_t histogramCount = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKET_COUNT; ++i) {
+        histogramCount += snapshot.mHistogram[i];
+    }
+    if (histogramCount == 0) {
+        return 0;
+    }
+
+    // The snapshot is not atomic as a whole, so rank against the histogram itself
+    const int64_t rank = static_cast<int64_t>(static_cast<float>(histogramCount) * percentile);
+    int64_t seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKET_COUNT - 1; ++i) {
+        seen += snapshot.mHistogram[i];
+        if (seen > rank) {
+            return static_cast<int64_t>(1) << (i + 1);
+        }
+    }
+    return snapshot.mMaxTimeUs;
+}
+
+/* static */ const char *StatsRegistry::getStageName(const StatsStage stage) {
+    return STAGE_NAMES[static_cast<int>(stage)];
+}
+
+/* static */ std::string StatsRegistry::dump() {
+    std::string result;
+    char line[256];
+    for (int i = 0; i < static_cast<int>(StatsStage::STAGE_COUNT); ++i) {
+        const StatsStage stage = static_cast<StatsStage>(i);
+        StageSnapshot snapshot;
+        getSnapshot(stage, &snapshot);
+        snprintf(line, sizeof(line),
+                "%s events=%lld items=%lld total_us=%lld max_us=%lld p50_us=%lld p90_us=%lld"
+                " p99_us=%lld\n",
+                getStageName(stage), static_cast<long long>(snapshot.mEventCount),
+                static_cast<long long>(snapshot.mItemCount),
+                static_cast<long long>(snapshot.mTotalTimeUs),
+                static_cast<long long>(snapshot.mMaxTimeUs),
+                static_cast<long long>(getPercentileUs(snapshot, 0.5f)),
+                static_cast<long long>(getPercentileUs(snapshot, 0.9f)),
+                static_cast<long long>(getPercentileUs(snapshot, 0.99f)));
+        result += line;
+    }
+    return result;
+}
+
+/* static */ void StatsRegistry::reset() {
+    for (StageStats &stats : sStages) {
+        stats.mEventCount.store(0, std::memory_order_relaxed);
+        stats.mItemCount.store(0, std::memory_order_relaxed);
+        stats.mTotalTimeUs.store(0, std::memory_order_relaxed);
+        stats.mMaxTimeUs.store(0, std::memory_order_relaxed);
+        for (std::atomic<int64_t> &bucket : stats.mHistogram) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+} // namespace latinime
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_STATS_REGISTRY_H
+#define LATINIME_STATS_REGISTRY_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "defines.h"
+
+namespace latinime {
+
+// Stages of the language model and dictionary pipelines that are measured. Keep in sync with
+// STAGE_NAMES in stats_registry.cpp.
+enum class StatsStage : int {
+    TOKENIZE = 0,
+    PROMPT_DECODE,
+    EMBED_MIX,
+    XBC_DECODE,
+    SAMPLE_STEP,
+    KV_COPY,
+    DIC_NODE_EXPANSION,
+    GC,
+    LEXICON_BUILD,
+    STAGE_COUNT
+};
+
+/**
+ * Process-wide counters and latency histograms for each StatsStage. Unlike Profiler this is always
+ * compiled in: recording an event is a few relaxed atomic adds, so it is cheap enough to leave on
+ * in release builds and lets benchmarks and field diagnostics read the numbers through JNI.
+ */
+class StatsRegistry {
+ public:
+    // Latencies go into power of two buckets: bucket 0 holds [0, 2) us, bucket i holds
+    // [2^i, 2^(i+1)) us and the last bucket holds everything above.
+    static const int HISTOGRAM_BUCKET_COUNT = 24;
+
+    struct StageSnapshot {
+        int64_t mEventCount;
+        int64_t mItemCount;
+        int64_t mTotalTimeUs;
+        int64_t mMaxTimeUs;
+        int64_t mHistogram[HISTOGRAM_BUCKET_COUNT];
+    };
+
+    static int64_t getTimeInMicroSec();
+
+    // Records one event of the stage that took durationUs and processed itemCount items
+    static void record(const StatsStage stage, const int64_t durationUs, const int itemCount = 1);
+
+    static void getSnapshot(const StatsStage stage, StageSnapshot *const outSnapshot);
+
+    // Upper bound in microseconds of the bucket that contains the given percentile, or 0 when the
+    // stage has no events
+    static int64_t getPercentileUs(const StageSnapshot &snapshot, const float percentile);
+
+    static const char *getStageName(const StatsStage stage);
+
+    // One line per stage: "<name> events=.. items=.. total_us=.. max_us=.. p50_us=.. p90_us=.. p99_us=.."
+    static std::string dump();
+
+    static void reset();
+
+    static int getBucketIndex(const int64_t durationUs);
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(StatsRegistry);
+
+    struct StageStats {
+        std::atomic<int64_t> mEventCount;
+        std::atomic<int64_t> mItemCount;
+        std::atomic<int64_t> mTotalTimeUs;
+        std::atomic<int64_t> mMaxTimeUs;
+        std::atomic<int64_t> mHistogram[HISTOGRAM_BUCKET_COUNT];
+    };
+
+    static const char *const STAGE_NAMES[];
+    static StageStats sStages[static_cast<int>(StatsStage::STAGE_COUNT)];
+};
+
+// Records the time from construction to destruction as one event of the stage
+class StatsScopedTimer {
+ public:
+    explicit StatsScopedTimer(const StatsStage stage)
+            : mStage(stage), mStartTime(StatsRegistry::getTimeInMicroSec()), mItemCount(1) {}
+
+    ~StatsScopedTimer() {
+        StatsRegistry::record(mStage, StatsRegistry::getTimeInMicroSec() - mStartTime, mItemCount);
+    }
+
+    void setItemCount(const int itemCount) { mItemCount = itemCount; }
+    void addItems(const int itemCount) { mItemCount += itemCount; }
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(StatsScopedTimer);
+
+    const StatsStage mStage;
+    const int64_t mStartTime;
+    int mItemCount;
+};
+} // namespace latinime
+
+// For stages that do not match a scope; events are only recorded when STATS_TIMER_END is reached
+#define STATS_TIMER_START(name) \
+        const int64_t latinimeStatsStart_##name = ::latinime::StatsRegistry::getTimeInMicroSec()
+#define STATS_TIMER_END(name, stage, itemCount) \
+        ::latinime::StatsRegistry::record(::latinime::StatsStage::stage, \
+                ::latinime::StatsRegistry::getTimeInMicroSec() - latinimeStatsStart_##name, \
+                static_cast<int>(itemCount))
+
+#endif // LATINIME_STATS_REGISTRY_H
@@ -20,17 +20,17 @@
 
 namespace latinime {
 
-int TimeKeeper::sCurrentTime;
+std::atomic<int> TimeKeeper::sCurrentTime(0);
 bool TimeKeeper::sSetForTesting;
 
 /* static  */ void TimeKeeper::setCurrentTime() {
     if (!sSetForTesting) {
-        sCurrentTime = time(0);
+        sCurrentTime.store(time(0), std::memory_order_relaxed);
     }
 }
 
 /* static */ void TimeKeeper::startTestModeWithForceCurrentTime(const int currentTime) {
-    sCurrentTime = currentTime;
+    sCurrentTime.store(currentTime, std::memory_order_relaxed);
     sSetForTesting = true;
 }
 
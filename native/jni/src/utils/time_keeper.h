@@ -17,6 +17,8 @@
 #ifndef LATINIME_TIME_KEEPER_H
 #define LATINIME_TIME_KEEPER_H
 
+#include <atomic>
+
 #include "defines.h"
 
 namespace latinime {
@@ -29,12 +31,13 @@ class TimeKeeper {
 
     static void stopTestMode();
 
-    static int peekCurrentTime() { return sCurrentTime; };
+    static int peekCurrentTime() { return sCurrentTime.load(std::memory_order_relaxed); };
 
  private:
     DISALLOW_IMPLICIT_CONSTRUCTORS(TimeKeeper);
 
-    static int sCurrentTime;
+    // Atomic as searches over different dictionaries may run concurrently.
+    static std::atomic<int> sCurrentTime;
     static bool sSetForTesting;
 };
 } // namespace latinime
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/worker_pool.h"
+
+namespace latinime {
+
+WorkerPool::WorkerPool(const int threadCount)
+        : mWorkers(), mRunMutex(), mMutex(), mTaskAvailableCondition(), mBatchDoneCondition(),
+          mTask(nullptr), mTaskCount(0), mNextTaskIndex(0), mUnfinishedTaskCount(0),
+          mIsStopping(false) {
+    for (int i = 1; i < threadCount; ++i) {
+        mWorkers.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mIsStopping = true;
+    }
+    mTaskAvailableCondition.notify_all();
+    for (std::thread &worker : mWorkers) {
+        worker.join();
+    }
+}
+
+void WorkerPool::run(const int taskCount, const Task &task) {
+    if (taskCount <= 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> runLock(mRunMutex);
+    std::unique_lock<std::mutex> lock(mMutex);
+    mTask = &task;
+    mTaskCount = taskCount;
+    mNextTaskIndex = 0;
+    mUnfinishedTaskCount = taskCount;
+    if (taskCount > 1) {
+        mTaskAvailableCondition.notify_all();
+    }
+    runPendingTasks(&lock);
+    mBatchDoneCondition.wait(lock, [this] { return mUnfinishedTaskCount == 0; });
+    mTask = nullptr;
+    mTaskCount = 0;
+}
+
+void WorkerPool::workerLoop() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true) {
+        mTaskAvailableCondition.wait(lock,
+                [this] { return mIsStopping || mNextTaskIndex < mTaskCount; });
+        if (mIsStopping) {
+            return;
+        }
+        runPendingTasks(&lock);
+    }
+}
+
+void WorkerPool::runPendingTasks(std::unique_lock<std::mutex> *const lock) {
+    while (mNextTaskIndex < mTaskCount) {
+        const int taskIndex = mNextTaskIndex++;
+        const Task *const task = mTask;
+        lock->unlock();
+        (*task)(taskIndex);
+        lock->lock();
+        if (--mUnfinishedTaskCount == 0) {
+            mBatchDoneCondition.notify_all();
+        }
+    }
+}
+} // namespace latinime
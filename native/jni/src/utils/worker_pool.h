@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_WORKER_POOL_H
+#define LATINIME_WORKER_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "defines.h"
+
+namespace latinime {
+
+/**
+ * A small fixed pool of threads running batches of independent tasks. The thread calling run()
+ * takes tasks too, so a pool of threadCount threads starts threadCount - 1 workers and a pool of
+ * one thread runs everything inline.
+ *
+ * Batches are serialized: concurrent run() calls wait for each other.
+ */
+class WorkerPool {
+ public:
+    typedef std::function<void(const int taskIndex)> Task;
+
+    explicit WorkerPool(const int threadCount);
+    ~WorkerPool();
+
+    // Calls task(i) for every i in [0, taskCount) and returns once all of them have finished.
+    void run(const int taskCount, const Task &task);
+
+    int getThreadCount() const {
+        return static_cast<int>(mWorkers.size()) + 1;
+    }
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(WorkerPool);
+
+    void workerLoop();
+    // Takes and runs tasks of the current batch until none is left. mMutex must be held by lock.
+    void runPendingTasks(std::unique_lock<std::mutex> *const lock);
+
+    std::vector<std::thread> mWorkers;
+    std::mutex mRunMutex;
+    std::mutex mMutex;
+    std::condition_variable mTaskAvailableCondition;
+    std::condition_variable mBatchDoneCondition;
+    const Task *mTask;
+    int mTaskCount;
+    int mNextTaskIndex;
+    int mUnfinishedTaskCount;
+    bool mIsStopping;
+};
+} // namespace latinime
+#endif // LATINIME_WORKER_POOL_H
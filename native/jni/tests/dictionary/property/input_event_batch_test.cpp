@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/property/input_event_batch.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "defines.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+void packEvent(const int timestamp, const std::vector<int> &prevWord,
+        const bool isBeginningOfSentence, const std::vector<int> &word,
+        std::vector<int> *const outBuffer) {
+    outBuffer->push_back(timestamp);
+    outBuffer->push_back(1 /* isValidWord */);
+    outBuffer->push_back(1 /* prevWordCount */);
+    outBuffer->push_back(isBeginningOfSentence ? 1 : 0);
+    outBuffer->push_back(prevWord.size());
+    outBuffer->insert(outBuffer->end(), prevWord.begin(), prevWord.end());
+    outBuffer->push_back(word.size());
+    outBuffer->insert(outBuffer->end(), word.begin(), word.end());
+}
+
+TEST(InputEventBatchTest, TestMergesAndSortsByWord) {
+    std::vector<int> buffer;
+    packEvent(10, {'a'}, false /* isBeginningOfSentence */, {'c'}, &buffer);
+    packEvent(20, {'b'}, false /* isBeginningOfSentence */, {'a', 'b'}, &buffer);
+    packEvent(30, {'a'}, false /* isBeginningOfSentence */, {'c'}, &buffer);
+    packEvent(40, {}, true /* isBeginningOfSentence */, {'c'}, &buffer);
+    InputEventBatch batch;
+    ASSERT_TRUE(batch.readFrom(IntArrayView(buffer), 4 /* eventCount */));
+    ASSERT_EQ(3, batch.getEntryCount());
+
+    EXPECT_EQ(std::vector<int>({'a', 'b'}), batch.getWordCodePoints(0).toVector());
+    EXPECT_FALSE(batch.hasSameWordAsPreviousEntry(0));
+    EXPECT_TRUE(batch.hasFirstEventOfWord(0));
+    EXPECT_EQ(20, batch.getHistoricalInfo(0).getTimestamp());
+    EXPECT_EQ(1, batch.getHistoricalInfo(0).getCount());
+
+    // "c" at the beginning of a sentence sorts after "c" after "a".
+    EXPECT_EQ(std::vector<int>({'c'}), batch.getWordCodePoints(1).toVector());
+    EXPECT_FALSE(batch.hasSameWordAsPreviousEntry(1));
+    EXPECT_EQ(std::vector<int>({'a'}),
+            batch.getNgramContext(1).getNthPrevWordCodePoints(1 /* n */).toVector());
+    EXPECT_TRUE(batch.hasFirstEventOfWord(1));
+    EXPECT_EQ(30, batch.getHistoricalInfo(1).getTimestamp());
+    EXPECT_EQ(2, batch.getHistoricalInfo(1).getCount());
+
+    EXPECT_TRUE(batch.hasSameWordAsPreviousEntry(2));
+    EXPECT_TRUE(batch.getNgramContext(2).isNthPrevWordBeginningOfSentence(1 /* n */));
+    EXPECT_FALSE(batch.hasFirstEventOfWord(2));
+    EXPECT_EQ(40, batch.getHistoricalInfo(2).getTimestamp());
+    EXPECT_EQ(1, batch.getHistoricalInfo(2).getCount());
+}
+
+TEST(InputEventBatchTest, TestRejectsMalformedBuffer) {
+    std::vector<int> buffer;
+    packEvent(10, {'a'}, false /* isBeginningOfSentence */, {'b'}, &buffer);
+    InputEventBatch batch;
+    EXPECT_FALSE(batch.readFrom(IntArrayView(buffer), 2 /* eventCount */));
+    EXPECT_FALSE(batch.readFrom(IntArrayView(buffer).limit(buffer.size() - 1),
+            1 /* eventCount */));
+    buffer[2] = MAX_PREV_WORD_COUNT_FOR_N_GRAM + 1;
+    EXPECT_FALSE(batch.readFrom(IntArrayView(buffer), 1 /* eventCount */));
+
+    std::vector<int> emptyWordBuffer;
+    packEvent(10, {'a'}, false /* isBeginningOfSentence */, {}, &emptyWordBuffer);
+    EXPECT_FALSE(batch.readFrom(IntArrayView(emptyWordBuffer), 1 /* eventCount */));
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/structure/flat/flat_patricia_trie_policy.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "dictionary/interface/dictionary_header_structure_policy.h"
+#include "dictionary/property/ngram_context.h"
+#include "dictionary/property/ngram_property.h"
+#include "dictionary/property/unigram_property.h"
+#include "dictionary/structure/dictionary_structure_with_buffer_policy_factory.h"
+#include "dictionary/structure/flat/flat_dict_writer.h"
+#include "dictionary/utils/file_utils.h"
+#include "dictionary/utils/format_utils.h"
+#include "suggest/core/dicnode/dic_node.h"
+#include "suggest/core/dicnode/dic_node_utils.h"
+#include "suggest/core/dicnode/dic_node_vector.h"
+#include "test_utils.h"
+#include "utils/char_utils.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+void addUnigram(DictionaryStructureWithBufferPolicy *const policy, const char *const word,
+        const int probability, std::vector<UnigramProperty::ShortcutProperty> &&shortcuts) {
+    const UnigramProperty unigramProperty(false /* representsBeginningOfSentence */,
+            false /* isNotAWord */, false /* isPossiblyOffensive */, probability,
+            HistoricalInfo(), std::move(shortcuts));
+    const std::vector<int> codePoints = TestUtils::toCodePoints(word);
+    ASSERT_TRUE(policy->addUnigramEntry(CodePointArrayView(codePoints), &unigramProperty));
+}
+
+void addBigram(DictionaryStructureWithBufferPolicy *const policy, const char *const prevWord,
+        const char *const word, const int probability) {
+    const std::vector<int> prevWordCodePoints = TestUtils::toCodePoints(prevWord);
+    const NgramProperty ngramProperty(NgramContext(prevWordCodePoints.data(),
+            prevWordCodePoints.size(), false /* isBeginningOfSentence */),
+            TestUtils::toCodePoints(word), probability, HistoricalInfo());
+    ASSERT_TRUE(policy->addNgramEntry(&ngramProperty));
+}
+
+class FlatPatriciaTriePolicyTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        mFilePath = ::testing::TempDir() + "/flat_patricia_trie_policy_test.dict";
+        remove(mFilePath.c_str());
+        const DictionaryHeaderStructurePolicy::AttributeMap attributeMap;
+        DictionaryStructureWithBufferPolicy::StructurePolicyPtr sourcePolicy =
+                DictionaryStructureWithBufferPolicyFactory::newPolicyForOnMemoryDict(
+                        FormatUtils::VERSION_403, CharUtils::EMPTY_STRING, &attributeMap);
+        ASSERT_TRUE(sourcePolicy);
+        addUnigram(sourcePolicy.get(), "a", 100, {});
+        addUnigram(sourcePolicy.get(), "about", 120, {});
+        addUnigram(sourcePolicy.get(), "above", 80, {});
+        addUnigram(sourcePolicy.get(), "abroad", 60, {});
+        addUnigram(sourcePolicy.get(), "be", 110, {});
+        addUnigram(sourcePolicy.get(), "ok", 90,
+                {UnigramProperty::ShortcutProperty(TestUtils::toCodePoints("okay"), 14)});
+        addBigram(sourcePolicy.get(), "a", "be", 150);
+        addBigram(sourcePolicy.get(), "about", "a", 140);
+        ASSERT_TRUE(FlatDictWriter::writeFlatDictFile(sourcePolicy.get(), mFilePath.c_str()));
+
+        mPolicy = DictionaryStructureWithBufferPolicyFactory::newPolicyForExistingDictFile(
+                mFilePath.c_str(), 0 /* bufOffset */, FileUtils::getFileSize(mFilePath.c_str()),
+                false /* isUpdatable */);
+        ASSERT_TRUE(mPolicy);
+    }
+
+    void TearDown() override {
+        mPolicy.reset();
+        remove(mFilePath.c_str());
+    }
+
+    std::string mFilePath;
+    DictionaryStructureWithBufferPolicy::StructurePolicyPtr mPolicy;
+};
+
+TEST_F(FlatPatriciaTriePolicyTest, TestFormatVersion) {
+    EXPECT_EQ(FormatUtils::VERSION_FLAT,
+            mPolicy->getHeaderStructurePolicy()->getFormatVersionNumber());
+    EXPECT_FALSE(mPolicy->isCorrupted());
+}
+
+TEST_F(FlatPatriciaTriePolicyTest, TestWordIdAndCodePoints) {
+    for (const char *const word : {"a", "about", "above", "abroad", "be", "ok"}) {
+        const int wordId = TestUtils::getWordId(mPolicy.get(), word);
+        ASSERT_NE(NOT_A_WORD_ID, wordId) << word;
+        int codePoints[MAX_WORD_LENGTH];
+        const int codePointCount = mPolicy->getCodePointsAndReturnCodePointCount(wordId,
+                MAX_WORD_LENGTH, codePoints);
+        EXPECT_EQ(TestUtils::toCodePoints(word),
+                CodePointArrayView(codePoints, codePointCount).toVector()) << word;
+    }
+    EXPECT_EQ(NOT_A_WORD_ID, TestUtils::getWordId(mPolicy.get(), "ab"));
+    EXPECT_EQ(NOT_A_WORD_ID, TestUtils::getWordId(mPolicy.get(), "abo"));
+    EXPECT_EQ(NOT_A_WORD_ID, TestUtils::getWordId(mPolicy.get(), "abouts"));
+    EXPECT_EQ(NOT_A_WORD_ID, TestUtils::getWordId(mPolicy.get(), "c"));
+
+    const std::vector<int> upperCaseWord = TestUtils::toCodePoints("ABOVE");
+    EXPECT_EQ(TestUtils::getWordId(mPolicy.get(), "above"),
+            mPolicy->getWordId(CodePointArrayView(upperCaseWord), true /* forceLowerCaseSearch */));
+}
+
+TEST_F(FlatPatriciaTriePolicyTest, TestProbabilities) {
+    const int aWordId = TestUtils::getWordId(mPolicy.get(), "a");
+    const int aboutWordId = TestUtils::getWordId(mPolicy.get(), "about");
+    const int beWordId = TestUtils::getWordId(mPolicy.get(), "be");
+    EXPECT_EQ(120, mPolicy->getProbabilityOfWord(WordIdArrayView(), aboutWordId));
+    EXPECT_EQ(150, mPolicy->getProbabilityOfWord(WordIdArrayView::singleElementView(&aWordId),
+            beWordId));
+    EXPECT_EQ(140, mPolicy->getProbabilityOfWord(
+            WordIdArrayView::singleElementView(&aboutWordId), aWordId));
+    EXPECT_EQ(NOT_A_PROBABILITY, mPolicy->getProbabilityOfWord(
+            WordIdArrayView::singleElementView(&beWordId), aWordId));
+    EXPECT_EQ(150, mPolicy->getWordAttributesInContext(
+            WordIdArrayView::singleElementView(&aWordId), beWordId,
+            nullptr /* multiBigramMap */).getProbability());
+    EXPECT_EQ(110, mPolicy->getWordAttributesInContext(
+            WordIdArrayView::singleElementView(&aboutWordId), beWordId,
+            nullptr /* multiBigramMap */).getProbability());
+}
+
+TEST_F(FlatPatriciaTriePolicyTest, TestWordProperty) {
+    const WordProperty wordProperty = mPolicy->getWordProperty(
+            CodePointArrayView(TestUtils::toCodePoints("ok")));
+    EXPECT_EQ(90, wordProperty.getUnigramProperty().getProbability());
+    ASSERT_EQ(1u, wordProperty.getUnigramProperty().getShortcuts().size());
+    const UnigramProperty::ShortcutProperty &shortcut =
+            wordProperty.getUnigramProperty().getShortcuts()[0];
+    EXPECT_EQ(TestUtils::toCodePoints("okay"), *shortcut.getTargetCodePoints());
+    EXPECT_EQ(14, shortcut.getProbability());
+
+    const WordProperty aWordProperty = mPolicy->getWordProperty(
+            CodePointArrayView(TestUtils::toCodePoints("a")));
+    ASSERT_EQ(1u, aWordProperty.getNgramProperties().size());
+    EXPECT_EQ(TestUtils::toCodePoints("be"),
+            *aWordProperty.getNgramProperties()[0].getTargetCodePoints());
+}
+
+TEST_F(FlatPatriciaTriePolicyTest, TestIterateWords) {
+    int codePoints[MAX_WORD_LENGTH];
+    int codePointCount = 0;
+    int token = 0;
+    int wordCount = 0;
+    do {
+        token = mPolicy->getNextWordAndNextToken(token, codePoints, &codePointCount);
+        EXPECT_NE(NOT_A_WORD_ID, mPolicy->getWordId(
+                CodePointArrayView(codePoints, codePointCount), false /* forceLowerCaseSearch */));
+        ++wordCount;
+    } while (token != 0);
+    EXPECT_EQ(6, wordCount);
+}
+
+TEST_F(FlatPatriciaTriePolicyTest, TestChildDicNodes) {
+    DicNode rootDicNode;
+    DicNodeUtils::initAsRoot(mPolicy.get(), WordIdArrayView(), &rootDicNode);
+    DicNodeVector childDicNodes;
+    mPolicy->createAndGetAllChildDicNodes(&rootDicNode, &childDicNodes);
+    ASSERT_EQ(3, childDicNodes.getSizeAndLock());
+    EXPECT_EQ('a', childDicNodes[0]->getNodeCodePoint());
+    EXPECT_EQ(TestUtils::getWordId(mPolicy.get(), "a"), childDicNodes[0]->getWordId());
+    EXPECT_EQ('b', childDicNodes[1]->getNodeCodePoint());
+    EXPECT_EQ(TestUtils::getWordId(mPolicy.get(), "be"), childDicNodes[1]->getWordId());
+    EXPECT_EQ('o', childDicNodes[2]->getNodeCodePoint());
+    EXPECT_EQ(TestUtils::getWordId(mPolicy.get(), "ok"), childDicNodes[2]->getWordId());
+
+    // "a" has a single child PtNode "b" that is not a word.
+    DicNodeVector grandChildDicNodes;
+    mPolicy->createAndGetAllChildDicNodes(childDicNodes[0], &grandChildDicNodes);
+    ASSERT_EQ(1, grandChildDicNodes.getSizeAndLock());
+    EXPECT_EQ('b', grandChildDicNodes[0]->getNodeCodePoint());
+    EXPECT_EQ(NOT_A_WORD_ID, grandChildDicNodes[0]->getWordId());
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/structure/v2/ver2_reverse_index.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "utils/byte_array_view.h"
+
+namespace latinime {
+namespace {
+
+TEST(Ver2ReverseIndexTest, TestGetParentPtNodePos) {
+    // 10 bytes of trie followed by an index with 3 entries at position 10.
+    // Root array: [0, 20), children of 2: [20, 30), children of 25: [30, 40), children of 4: [40, )
+    const std::vector<uint8_t> buffer = {
+        0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u,
+        0x00u, 0x00u, 0x00u, 0x03u,
+        0x00u, 0x00u, 0x14u, 0x00u, 0x00u, 0x02u,
+        0x00u, 0x00u, 0x1Eu, 0x00u, 0x00u, 0x19u,
+        0x00u, 0x00u, 0x28u, 0x00u, 0x00u, 0x04u,
+    };
+    const Ver2ReverseIndex reverseIndex(ReadOnlyByteArrayView(buffer.data(), buffer.size()),
+            10 /* indexPos */);
+    ASSERT_TRUE(reverseIndex.isAvailable());
+    EXPECT_EQ(NOT_A_DICT_POS, reverseIndex.getParentPtNodePos(0));
+    EXPECT_EQ(NOT_A_DICT_POS, reverseIndex.getParentPtNodePos(19));
+    EXPECT_EQ(2, reverseIndex.getParentPtNodePos(20));
+    EXPECT_EQ(2, reverseIndex.getParentPtNodePos(25));
+    EXPECT_EQ(25, reverseIndex.getParentPtNodePos(30));
+    EXPECT_EQ(25, reverseIndex.getParentPtNodePos(39));
+    EXPECT_EQ(4, reverseIndex.getParentPtNodePos(40));
+    EXPECT_EQ(4, reverseIndex.getParentPtNodePos(1000));
+}
+
+TEST(Ver2ReverseIndexTest, TestInvalidIndex) {
+    const std::vector<uint8_t> buffer = { 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x02u };
+    const ReadOnlyByteArrayView bufferView(buffer.data(), buffer.size());
+    EXPECT_FALSE(Ver2ReverseIndex(bufferView, NOT_A_DICT_POS).isAvailable());
+    EXPECT_FALSE(Ver2ReverseIndex(bufferView, 6 /* indexPos */).isAvailable());
+    // The entry count exceeds the buffer.
+    EXPECT_FALSE(Ver2ReverseIndex(bufferView, 4 /* indexPos */).isAvailable());
+    EXPECT_TRUE(Ver2ReverseIndex(bufferView, 0 /* indexPos */).isAvailable());
+}
+
+}  // namespace
+}  // namespace latinime
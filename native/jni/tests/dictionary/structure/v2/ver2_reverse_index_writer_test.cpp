@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/structure/v2/ver2_reverse_index_writer.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "dictionary/header/header_policy.h"
+#include "dictionary/header/header_read_write_utils.h"
+#include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
+#include "dictionary/structure/dictionary_structure_with_buffer_policy_factory.h"
+#include "dictionary/structure/v2/ver2_reverse_index.h"
+#include "dictionary/utils/buffer_with_extendable_buffer.h"
+#include "dictionary/utils/dict_file_writing_utils.h"
+#include "dictionary/utils/file_utils.h"
+#include "dictionary/utils/format_utils.h"
+#include "dictionary/utils/mmapped_buffer.h"
+#include "test_utils.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+// A v2 body with the words "a" (100), "about" (120), "above" (80) and "be" (110). The PtNode "bo"
+// below "a" is not a word, so "about" and "above" are three PtNode arrays deep.
+const std::vector<uint8_t> BODY = {
+    // Root PtNode array with "a" and "be".
+    0x02u,
+    0x50u, 'a', 100, 0x06u, // Terminal, children at 4 + 6.
+    0x30u, 'b', 'e', 0x1Fu, 110,
+    // Children of "a".
+    0x01u,
+    0x60u, 'b', 'o', 0x1Fu, 0x01u, // Children at 15 + 1.
+    // Children of "abo".
+    0x02u,
+    0x30u, 'u', 't', 0x1Fu, 120,
+    0x30u, 'v', 'e', 0x1Fu, 80,
+};
+
+bool writeVer2DictFile(const char *const filePath) {
+    BufferWithExtendableBuffer buffer(BufferWithExtendableBuffer::DEFAULT_MAX_ADDITIONAL_BUFFER_SIZE);
+    const DictionaryHeaderStructurePolicy::AttributeMap attributeMap;
+    int writingPos = 0;
+    if (!HeaderReadWriteUtils::writeDictionaryVersion(&buffer, FormatUtils::VERSION_202,
+                    &writingPos)
+            || !HeaderReadWriteUtils::writeDictionaryFlags(&buffer, 0 /* flags */, &writingPos)) {
+        return false;
+    }
+    int headerSizeFieldPos = writingPos;
+    if (!HeaderReadWriteUtils::writeDictionaryHeaderSize(&buffer, 0 /* size */, &writingPos)
+            || !HeaderReadWriteUtils::writeHeaderAttributes(&buffer, &attributeMap, &writingPos)
+            || !HeaderReadWriteUtils::writeDictionaryHeaderSize(&buffer, writingPos,
+                    &headerSizeFieldPos)) {
+        return false;
+    }
+    for (const uint8_t byte : BODY) {
+        if (!buffer.writeUintAndAdvancePosition(byte, 1 /* size */, &writingPos)) {
+            return false;
+        }
+    }
+    return DictFileWritingUtils::flushBufferToFile(filePath, &buffer);
+}
+
+DictionaryStructureWithBufferPolicy::StructurePolicyPtr openDictFile(const std::string &path) {
+    return DictionaryStructureWithBufferPolicyFactory::newPolicyForExistingDictFile(path.c_str(),
+            0 /* bufOffset */, FileUtils::getFileSize(path.c_str()), false /* isUpdatable */);
+}
+
+TEST(Ver2ReverseIndexWriterTest, TestRoundTrip) {
+    const std::string sourcePath = ::testing::TempDir() + "/ver2_reverse_index_writer_test.dict";
+    const std::string path = sourcePath + ".indexed";
+    const std::string reindexedPath = path + ".reindexed";
+    remove(sourcePath.c_str());
+    remove(path.c_str());
+    remove(reindexedPath.c_str());
+    ASSERT_TRUE(writeVer2DictFile(sourcePath.c_str()));
+    ASSERT_TRUE(Ver2ReverseIndexWriter::writeDictFileWithReverseIndex(sourcePath.c_str(),
+            path.c_str()));
+
+    {
+        const MmappedBuffer::MmappedBufferPtr mmappedBuffer =
+                MmappedBuffer::openBuffer(path.c_str(), false /* isUpdatable */);
+        ASSERT_TRUE(mmappedBuffer);
+        const HeaderPolicy headerPolicy(mmappedBuffer->getReadOnlyByteArrayView().data(),
+                FormatUtils::VERSION_202);
+        EXPECT_EQ(static_cast<int>(BODY.size()), HeaderReadWriteUtils::readIntAttributeValue(
+                headerPolicy.getAttributeMap(), Ver2ReverseIndex::REVERSE_INDEX_POS_KEY,
+                NOT_A_DICT_POS));
+    }
+
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr sourcePolicy =
+            openDictFile(sourcePath);
+    const DictionaryStructureWithBufferPolicy::StructurePolicyPtr policy = openDictFile(path);
+    ASSERT_TRUE(sourcePolicy);
+    ASSERT_TRUE(policy);
+    for (const char *const word : {"a", "about", "above", "be"}) {
+        const int wordId = TestUtils::getWordId(policy.get(), word);
+        ASSERT_NE(NOT_A_WORD_ID, wordId) << word;
+        // The trie is copied unchanged.
+        EXPECT_EQ(TestUtils::getWordId(sourcePolicy.get(), word), wordId) << word;
+        int codePoints[MAX_WORD_LENGTH];
+        const int codePointCount = policy->getCodePointsAndReturnCodePointCount(wordId,
+                MAX_WORD_LENGTH, codePoints);
+        EXPECT_EQ(std::string(word), std::string(codePoints, codePoints + codePointCount));
+        EXPECT_EQ(sourcePolicy->getProbabilityOfWord(WordIdArrayView(), wordId),
+                policy->getProbabilityOfWord(WordIdArrayView(), wordId)) << word;
+    }
+    EXPECT_EQ(120, policy->getProbabilityOfWord(WordIdArrayView(),
+            TestUtils::getWordId(policy.get(), "about")));
+    EXPECT_EQ(NOT_A_WORD_ID, TestUtils::getWordId(policy.get(), "abo"));
+    EXPECT_FALSE(policy->isCorrupted());
+
+    // Rewriting an indexed dictionary replaces the index.
+    ASSERT_TRUE(Ver2ReverseIndexWriter::writeDictFileWithReverseIndex(path.c_str(),
+            reindexedPath.c_str()));
+    EXPECT_EQ(FileUtils::getFileSize(path.c_str()), FileUtils::getFileSize(reindexedPath.c_str()));
+
+    remove(sourcePath.c_str());
+    remove(path.c_str());
+    remove(reindexedPath.c_str());
+}
+
+}  // namespace
+}  // namespace latinime
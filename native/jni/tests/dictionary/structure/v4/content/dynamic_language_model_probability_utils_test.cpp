@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dictionary/structure/v4/content/dynamic_language_model_probability_utils.h"
+
+#include <gtest/gtest.h>
+
+#include "defines.h"
+#include "dictionary/property/historical_info.h"
+#include "utils/time_keeper.h"
+
+namespace latinime {
+namespace {
+
+const int CURRENT_TIME = 1000 * 24 * 60 * 60;
+const int ONE_DAY_IN_SECONDS = 24 * 60 * 60;
+const int PROBABILITY = 200;
+
+int getDecayedProbability(const int elapsedDays, const int count) {
+    const HistoricalInfo historicalInfo(CURRENT_TIME - elapsedDays * ONE_DAY_IN_SECONDS,
+            0 /* level */, count);
+    return DynamicLanguageModelProbabilityUtils::getDecayedProbability(PROBABILITY,
+            historicalInfo);
+}
+
+TEST(DynamicLanguageModelProbabilityUtilsTest, TestDecayOverTime) {
+    TimeKeeper::startTestModeWithForceCurrentTime(CURRENT_TIME);
+    EXPECT_EQ(PROBABILITY, getDecayedProbability(0 /* elapsedDays */, 1 /* count */));
+    int previousProbability = PROBABILITY;
+    for (int elapsedDays = 1; elapsedDays < 100; ++elapsedDays) {
+        const int probability = getDecayedProbability(elapsedDays, 1 /* count */);
+        EXPECT_LE(probability, previousProbability);
+        previousProbability = probability;
+    }
+    EXPECT_LT(previousProbability, PROBABILITY);
+    TimeKeeper::stopTestMode();
+}
+
+TEST(DynamicLanguageModelProbabilityUtilsTest, TestFrequentEntriesDecaySlower) {
+    TimeKeeper::startTestModeWithForceCurrentTime(CURRENT_TIME);
+    static const int ELAPSED_DAYS = 30;
+    EXPECT_LT(getDecayedProbability(ELAPSED_DAYS, 1 /* count */),
+            getDecayedProbability(ELAPSED_DAYS, 4 /* count */));
+    EXPECT_LT(getDecayedProbability(ELAPSED_DAYS, 4 /* count */),
+            getDecayedProbability(ELAPSED_DAYS, 100 /* count */));
+    TimeKeeper::stopTestMode();
+}
+
+TEST(DynamicLanguageModelProbabilityUtilsTest, TestDeadEntry) {
+    TimeKeeper::startTestModeWithForceCurrentTime(CURRENT_TIME);
+    const HistoricalInfo recentInfo(CURRENT_TIME - ONE_DAY_IN_SECONDS, 0 /* level */,
+            1 /* count */);
+    EXPECT_FALSE(DynamicLanguageModelProbabilityUtils::isDeadEntry(recentInfo));
+    const HistoricalInfo oldInfo(CURRENT_TIME - 299 * ONE_DAY_IN_SECONDS, 0 /* level */,
+            1 /* count */);
+    EXPECT_TRUE(DynamicLanguageModelProbabilityUtils::isDeadEntry(oldInfo));
+    EXPECT_EQ(NOT_A_PROBABILITY, DynamicLanguageModelProbabilityUtils::getDecayedProbability(
+            PROBABILITY, oldInfo));
+    // Frequent entries survive longer but not past the discard duration.
+    const HistoricalInfo oldFrequentInfo(CURRENT_TIME - 299 * ONE_DAY_IN_SECONDS,
+            0 /* level */, 100 /* count */);
+    EXPECT_FALSE(DynamicLanguageModelProbabilityUtils::isDeadEntry(oldFrequentInfo));
+    const HistoricalInfo expiredFrequentInfo(CURRENT_TIME - 300 * ONE_DAY_IN_SECONDS,
+            0 /* level */, 100 /* count */);
+    EXPECT_TRUE(DynamicLanguageModelProbabilityUtils::isDeadEntry(expiredFrequentInfo));
+    TimeKeeper::stopTestMode();
+}
+
+}  // namespace
+}  // namespace latinime
@@ -78,6 +78,12 @@ TEST(FormatUtilsTest, TestDetectFormatVersion) {
         EXPECT_EQ(FormatUtils::VERSION_403, FormatUtils::detectFormatVersion(
                 ReadOnlyByteArrayView(buffer.data(), buffer.size())));
     }
+    {
+        const std::vector<uint8_t> buffer =
+                getBuffer(FormatUtils::MAGIC_NUMBER, FormatUtils::VERSION_FLAT, 0, 0);
+        EXPECT_EQ(FormatUtils::VERSION_FLAT, FormatUtils::detectFormatVersion(
+                ReadOnlyByteArrayView(buffer.data(), buffer.size())));
+    }
 
     {
         const std::vector<uint8_t> buffer =
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ggml/TokenLexicon.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace {
+
+std::vector<int> getChildTokens(const TokenLexicon &lexicon, const int node) {
+    const int *const tokens = lexicon.ChildTokens(node);
+    return std::vector<int>(tokens, tokens + lexicon.ChildCount(node));
+}
+
+TEST(TokenLexiconTest, TestEmpty) {
+    TokenLexicon lexicon;
+    EXPECT_TRUE(lexicon.IsEmpty());
+    EXPECT_EQ(0, lexicon.ChildCount(TOKEN_LEXICON_ROOT));
+    EXPECT_EQ(TOKEN_LEXICON_NO_NODE, lexicon.Child(TOKEN_LEXICON_ROOT, 5));
+
+    lexicon.Build({ {} });
+    EXPECT_TRUE(lexicon.IsEmpty());
+}
+
+TEST(TokenLexiconTest, TestWalksWords) {
+    TokenLexicon lexicon;
+    lexicon.Build({ { 7, 3 }, { 7 }, { 7, 3, 9 }, { 2, 4 }, { 7, 3 } });
+    EXPECT_FALSE(lexicon.IsEmpty());
+    EXPECT_EQ(std::vector<int>({ 2, 7 }), getChildTokens(lexicon, TOKEN_LEXICON_ROOT));
+
+    const int node7 = lexicon.Child(TOKEN_LEXICON_ROOT, 7);
+    ASSERT_NE(TOKEN_LEXICON_NO_NODE, node7);
+    EXPECT_TRUE(lexicon.IsWordEnd(node7));
+    EXPECT_EQ(std::vector<int>({ 3 }), getChildTokens(lexicon, node7));
+
+    const int node73 = lexicon.Child(node7, 3);
+    ASSERT_NE(TOKEN_LEXICON_NO_NODE, node73);
+    EXPECT_TRUE(lexicon.IsWordEnd(node73));
+    const int node739 = lexicon.Child(node73, 9);
+    ASSERT_NE(TOKEN_LEXICON_NO_NODE, node739);
+    EXPECT_TRUE(lexicon.IsWordEnd(node739));
+    EXPECT_EQ(0, lexicon.ChildCount(node739));
+
+    const int node2 = lexicon.Child(TOKEN_LEXICON_ROOT, 2);
+    ASSERT_NE(TOKEN_LEXICON_NO_NODE, node2);
+    EXPECT_FALSE(lexicon.IsWordEnd(node2));
+    EXPECT_EQ(TOKEN_LEXICON_NO_NODE, lexicon.Child(node2, 3));
+    EXPECT_NE(TOKEN_LEXICON_NO_NODE, lexicon.Child(node2, 4));
+
+    EXPECT_EQ(TOKEN_LEXICON_NO_NODE, lexicon.Child(TOKEN_LEXICON_ROOT, 3));
+}
+
+TEST(TokenLexiconTest, TestRebuild) {
+    TokenLexicon lexicon;
+    lexicon.Build({ { 1, 2 } });
+    lexicon.Build({ { 3 } });
+    EXPECT_EQ(TOKEN_LEXICON_NO_NODE, lexicon.Child(TOKEN_LEXICON_ROOT, 1));
+    const int node3 = lexicon.Child(TOKEN_LEXICON_ROOT, 3);
+    ASSERT_NE(TOKEN_LEXICON_NO_NODE, node3);
+    EXPECT_TRUE(lexicon.IsWordEnd(node3));
+}
+
+}  // namespace
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/dicnode/dic_node.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+TEST(DicNodeTest, TestDictionaryIndexIsInherited) {
+    static const int DICTIONARY_INDEX = 2;
+    static const int ROOT_POS = 0;
+    static const int CHILDREN_POS = 10;
+    static const int WORD_ID = 5;
+    DicNode rootDicNode;
+    rootDicNode.initAsRoot(ROOT_POS, WordIdArrayView(), DICTIONARY_INDEX);
+    EXPECT_EQ(DICTIONARY_INDEX, rootDicNode.getDictionaryIndex());
+
+    const std::vector<int> codePoints = {'a', 'b'};
+    DicNode childDicNode;
+    childDicNode.initAsChild(&rootDicNode, CHILDREN_POS, WORD_ID,
+            CodePointArrayView(codePoints));
+    EXPECT_EQ(DICTIONARY_INDEX, childDicNode.getDictionaryIndex());
+
+    DicNode passingChildDicNode;
+    passingChildDicNode.initAsPassingChild(&childDicNode);
+    EXPECT_EQ(DICTIONARY_INDEX, passingChildDicNode.getDictionaryIndex());
+
+    DicNode copiedDicNode;
+    copiedDicNode.initByCopy(&childDicNode);
+    EXPECT_EQ(DICTIONARY_INDEX, copiedDicNode.getDictionaryIndex());
+
+    // The next word of a multi-word suggestion stays in the same dictionary.
+    DicNode nextWordRootDicNode;
+    nextWordRootDicNode.initAsRootWithPreviousWord(&childDicNode, ROOT_POS);
+    EXPECT_EQ(DICTIONARY_INDEX, nextWordRootDicNode.getDictionaryIndex());
+    EXPECT_EQ(WORD_ID, nextWordRootDicNode.getPrevWordIds()[0]);
+}
+
+TEST(DicNodeTest, TestRootsOfDifferentDictionaries) {
+    DicNode firstRootDicNode;
+    firstRootDicNode.initAsRoot(0 /* rootPtNodeArrayPos */, WordIdArrayView(),
+            0 /* dictionaryIndex */);
+    DicNode secondRootDicNode;
+    secondRootDicNode.initAsRoot(0 /* rootPtNodeArrayPos */, WordIdArrayView(),
+            1 /* dictionaryIndex */);
+    EXPECT_EQ(0, firstRootDicNode.getDictionaryIndex());
+    EXPECT_EQ(1, secondRootDicNode.getDictionaryIndex());
+
+    const DicNode copiedDicNode(secondRootDicNode);
+    EXPECT_EQ(1, copiedDicNode.getDictionaryIndex());
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/dictionary/dictionary.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "defines.h"
+#include "dictionary/interface/dictionary_header_structure_policy.h"
+#include "dictionary/property/historical_info.h"
+#include "dictionary/property/ngram_context.h"
+#include "dictionary/property/unigram_property.h"
+#include "dictionary/structure/dictionary_structure_with_buffer_policy_factory.h"
+#include "dictionary/utils/format_utils.h"
+#include "suggest/core/result/suggestion_results.h"
+#include "suggest/core/session/dic_traverse_session.h"
+#include "suggest/core/suggest_options.h"
+#include "test_utils.h"
+#include "utils/char_utils.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+namespace {
+
+class DictionaryGroupTest : public ::testing::Test {
+ protected:
+    static std::unique_ptr<Dictionary> createDictionary(
+            const std::vector<std::pair<const char *, int>> &words) {
+        const DictionaryHeaderStructurePolicy::AttributeMap attributeMap;
+        std::unique_ptr<Dictionary> dictionary(new Dictionary(nullptr /* env */,
+                DictionaryStructureWithBufferPolicyFactory::newPolicyForOnMemoryDict(
+                        FormatUtils::VERSION_403, CharUtils::EMPTY_STRING, &attributeMap)));
+        for (const auto &word : words) {
+            const UnigramProperty unigramProperty(false /* representsBeginningOfSentence */,
+                    false /* isNotAWord */, false /* isPossiblyOffensive */, word.second,
+                    HistoricalInfo(), std::vector<UnigramProperty::ShortcutProperty>());
+            const std::vector<int> codePoints = TestUtils::toCodePoints(word.first);
+            EXPECT_TRUE(dictionary->addUnigramEntry(CodePointArrayView(codePoints),
+                    &unigramProperty));
+        }
+        return dictionary;
+    }
+
+    // Types the word by tapping the centers of its keys. A single dictionary is searched with
+    // getSuggestions, several with getSuggestionsForGroup.
+    std::vector<SuggestedWord> getSuggestions(const Dictionary *const *dictionaries,
+            const int dictionaryCount, const char *const typedWord, const bool asGroup) const {
+        std::vector<int> inputCodePoints = TestUtils::toCodePoints(typedWord);
+        const int inputSize = static_cast<int>(inputCodePoints.size());
+        std::vector<int> xs;
+        std::vector<int> ys;
+        std::vector<int> times;
+        for (int i = 0; i < inputSize; ++i) {
+            xs.push_back(mKeyboard.getKeyCenterX(inputCodePoints[i]));
+            ys.push_back(mKeyboard.getKeyCenterY(inputCodePoints[i]));
+            times.push_back(i * 100);
+        }
+        std::vector<int> pointerIds(inputSize, 0);
+        // Not a gesture, no full edit distance, offensive words allowed, space aware gesture
+        // disabled and a weight for locale of 1.
+        const int options[] = { 0, 0, 0, 0, 1000 };
+        const SuggestOptions suggestOptions(options, NELEMS(options));
+        const NgramContext ngramContext;
+        DicTraverseSession session(nullptr /* env */, nullptr /* localeStr */,
+                false /* usesLargeCache */);
+        SuggestionResults suggestionResults(MAX_RESULTS);
+        if (asGroup) {
+            Dictionary::getSuggestionsForGroup(dictionaries, dictionaryCount,
+                    mKeyboard.getProximityInfo(), &session, xs.data(), ys.data(), times.data(),
+                    pointerIds.data(), inputCodePoints.data(), inputSize, &ngramContext,
+                    &suggestOptions, NOT_A_WEIGHT_OF_LANG_MODEL_VS_SPATIAL_MODEL,
+                    &suggestionResults);
+        } else {
+            dictionaries[0]->getSuggestions(mKeyboard.getProximityInfo(), &session, xs.data(),
+                    ys.data(), times.data(), pointerIds.data(), inputCodePoints.data(),
+                    inputSize, &ngramContext, &suggestOptions,
+                    NOT_A_WEIGHT_OF_LANG_MODEL_VS_SPATIAL_MODEL, &suggestionResults);
+        }
+        return suggestionResults.getSortedSuggestedWords();
+    }
+
+ private:
+    const TestKeyboard mKeyboard;
+};
+
+const SuggestedWord *findWord(const std::vector<SuggestedWord> &suggestedWords,
+        const char *const word) {
+    const std::vector<int> codePoints = TestUtils::toCodePoints(word);
+    for (const SuggestedWord &suggestedWord : suggestedWords) {
+        if (std::vector<int>(suggestedWord.getCodePoint(),
+                suggestedWord.getCodePoint() + suggestedWord.getCodePointCount()) == codePoints) {
+            return &suggestedWord;
+        }
+    }
+    return nullptr;
+}
+
+TEST_F(DictionaryGroupTest, TestSearchesAllDictionaries) {
+    const std::unique_ptr<Dictionary> english = createDictionary({ { "help", 150 },
+            { "hello", 140 } });
+    const std::unique_ptr<Dictionary> german = createDictionary({ { "help", 200 },
+            { "held", 180 } });
+    const Dictionary *const dictionaries[] = { english.get(), german.get() };
+    const std::vector<SuggestedWord> suggestedWords =
+            getSuggestions(dictionaries, NELEMS(dictionaries), "help", true /* asGroup */);
+
+    const SuggestedWord *const hello = findWord(suggestedWords, "hello");
+    ASSERT_NE(nullptr, hello);
+    EXPECT_EQ(0, hello->getDictionaryIndex());
+    const SuggestedWord *const held = findWord(suggestedWords, "held");
+    ASSERT_NE(nullptr, held);
+    EXPECT_EQ(1, held->getDictionaryIndex());
+    // Found in both dictionaries, output once from the one giving it the higher probability.
+    const SuggestedWord *const help = findWord(suggestedWords, "help");
+    ASSERT_NE(nullptr, help);
+    EXPECT_EQ(1, help->getDictionaryIndex());
+    EXPECT_EQ(help, &suggestedWords[0]);
+
+    std::set<std::vector<int>> distinctWords;
+    for (const SuggestedWord &suggestedWord : suggestedWords) {
+        distinctWords.emplace(suggestedWord.getCodePoint(),
+                suggestedWord.getCodePoint() + suggestedWord.getCodePointCount());
+    }
+    EXPECT_EQ(suggestedWords.size(), distinctWords.size());
+}
+
+TEST_F(DictionaryGroupTest, TestGroupOfOneMatchesSingleSearch) {
+    const std::unique_ptr<Dictionary> english = createDictionary({ { "help", 150 },
+            { "hello", 140 }, { "jelly", 100 } });
+    const Dictionary *const dictionaries[] = { english.get() };
+    const std::vector<SuggestedWord> groupWords =
+            getSuggestions(dictionaries, NELEMS(dictionaries), "hel", true /* asGroup */);
+    const std::vector<SuggestedWord> singleWords =
+            getSuggestions(dictionaries, NELEMS(dictionaries), "hel", false /* asGroup */);
+    EXPECT_NE(nullptr, findWord(groupWords, "help"));
+    EXPECT_NE(nullptr, findWord(groupWords, "hello"));
+    ASSERT_EQ(singleWords.size(), groupWords.size());
+    for (size_t i = 0; i < groupWords.size(); ++i) {
+        EXPECT_EQ(singleWords[i].getScore(), groupWords[i].getScore());
+        EXPECT_EQ(singleWords[i].getCodePointCount(), groupWords[i].getCodePointCount());
+        EXPECT_EQ(0, groupWords[i].getDictionaryIndex());
+    }
+}
+
+}  // namespace
+}  // namespace latinime
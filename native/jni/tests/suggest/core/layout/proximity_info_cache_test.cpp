@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/layout/proximity_info_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "defines.h"
+#include "suggest/core/layout/proximity_info.h"
+
+namespace latinime {
+namespace {
+
+const int KEY_COUNT = 3;
+const int KEY_X_COORDINATES[KEY_COUNT] = { 0, 100, 200 };
+const int KEY_Y_COORDINATES[KEY_COUNT] = { 0, 0, 100 };
+const int KEY_WIDTHS[KEY_COUNT] = { 100, 100, 100 };
+const int KEY_HEIGHTS[KEY_COUNT] = { 100, 100, 100 };
+const int KEY_CHAR_CODES[KEY_COUNT] = { 'A', 'b', 'c' };
+const float SWEET_SPOT_CENTER_XS[KEY_COUNT] = { 50.0f, 150.0f, 250.0f };
+const float SWEET_SPOT_CENTER_YS[KEY_COUNT] = { 55.0f, 55.0f, 155.0f };
+const float SWEET_SPOT_RADII[KEY_COUNT] = { 20.0f, 21.0f, 22.0f };
+
+std::unique_ptr<ProximityInfo> createProximityInfo() {
+    return std::unique_ptr<ProximityInfo>(new ProximityInfo(300 /* keyboardWidth */,
+            200 /* keyboardHeight */, 3 /* gridWidth */, 2 /* gridHeight */,
+            100 /* mostCommonKeyWidth */, 100 /* mostCommonKeyHeight */,
+            nullptr /* proximityChars */, KEY_COUNT, KEY_X_COORDINATES, KEY_Y_COORDINATES,
+            KEY_WIDTHS, KEY_HEIGHTS, KEY_CHAR_CODES, SWEET_SPOT_CENTER_XS, SWEET_SPOT_CENTER_YS,
+            SWEET_SPOT_RADII));
+}
+
+std::string createTempFilePath() {
+    const char *const tmpDir = getenv("TMPDIR");
+    std::string path = std::string(tmpDir ? tmpDir : "/tmp") + "/proximity_info_cache_XXXXXX";
+    const int fd = mkstemp(&path[0]);
+    if (fd >= 0) {
+        close(fd);
+    }
+    // The cache creates the file itself.
+    remove(path.c_str());
+    return path;
+}
+
+void expectSameProximityInfo(const ProximityInfo *const expected,
+        const ProximityInfo *const actual) {
+    ASSERT_NE(nullptr, actual);
+    EXPECT_EQ(expected->getKeyboardWidth(), actual->getKeyboardWidth());
+    EXPECT_EQ(expected->getKeyboardHeight(), actual->getKeyboardHeight());
+    EXPECT_EQ(expected->getMostCommonKeyWidth(), actual->getMostCommonKeyWidth());
+    EXPECT_TRUE(actual->hasTouchPositionCorrectionData());
+    ASSERT_EQ(expected->getKeyCount(), actual->getKeyCount());
+    for (int i = 0; i < expected->getKeyCount(); ++i) {
+        EXPECT_EQ(expected->getCodePointOf(i), actual->getCodePointOf(i));
+        EXPECT_FLOAT_EQ(expected->getSweetSpotCenterXAt(i), actual->getSweetSpotCenterXAt(i));
+        EXPECT_FLOAT_EQ(expected->getSweetSpotCenterYAt(i), actual->getSweetSpotCenterYAt(i));
+        EXPECT_FLOAT_EQ(expected->getSweetSpotRadiiAt(i), actual->getSweetSpotRadiiAt(i));
+        for (int j = 0; j < expected->getKeyCount(); ++j) {
+            EXPECT_EQ(expected->getKeyKeyDistanceG(i, j), actual->getKeyKeyDistanceG(i, j));
+        }
+    }
+    // The lower code point map is rebuilt.
+    EXPECT_EQ(0, actual->getKeyIndexOf('a'));
+    EXPECT_EQ(2, actual->getKeyIndexOf('c'));
+}
+
+TEST(ProximityInfoCacheTest, TestRestoresProximityInfo) {
+    const std::string path = createTempFilePath();
+    const std::unique_ptr<ProximityInfo> proximityInfo = createProximityInfo();
+    {
+        ProximityInfoCache cache(path.c_str());
+        EXPECT_EQ(nullptr, cache.createProximityInfo(1 /* layoutHash */));
+        cache.put(1 /* layoutHash */, proximityInfo.get());
+        // Restored from memory before it is written.
+        const std::unique_ptr<ProximityInfo> restored(
+                cache.createProximityInfo(1 /* layoutHash */));
+        expectSameProximityInfo(proximityInfo.get(), restored.get());
+        cache.writePendingEntries();
+    }
+    // Another process reads the file.
+    ProximityInfoCache cache(path.c_str());
+    const std::unique_ptr<ProximityInfo> restored(cache.createProximityInfo(1 /* layoutHash */));
+    expectSameProximityInfo(proximityInfo.get(), restored.get());
+    EXPECT_EQ(nullptr, cache.createProximityInfo(2 /* layoutHash */));
+    remove(path.c_str());
+}
+
+TEST(ProximityInfoCacheTest, TestStartsOverCorruptedFile) {
+    const std::string path = createTempFilePath();
+    const std::unique_ptr<ProximityInfo> proximityInfo = createProximityInfo();
+    {
+        ProximityInfoCache cache(path.c_str());
+        cache.put(1 /* layoutHash */, proximityInfo.get());
+        cache.writePendingEntries();
+    }
+    // Truncate the last entry as if the process was killed while writing it.
+    FILE *const file = fopen(path.c_str(), "r+b");
+    ASSERT_NE(nullptr, file);
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fclose(file);
+    ASSERT_EQ(0, truncate(path.c_str(), size - 1));
+
+    ProximityInfoCache cache(path.c_str());
+    EXPECT_EQ(nullptr, cache.createProximityInfo(1 /* layoutHash */));
+    cache.put(1 /* layoutHash */, proximityInfo.get());
+    cache.writePendingEntries();
+    ProximityInfoCache reopenedCache(path.c_str());
+    const std::unique_ptr<ProximityInfo> restored(
+            reopenedCache.createProximityInfo(1 /* layoutHash */));
+    expectSameProximityInfo(proximityInfo.get(), restored.get());
+    remove(path.c_str());
+}
+
+TEST(ProximityInfoCacheTest, TestKeepsUnwrittenEntriesOutOfFile) {
+    const std::string path = createTempFilePath();
+    const std::unique_ptr<ProximityInfo> proximityInfo = createProximityInfo();
+    {
+        ProximityInfoCache cache(path.c_str());
+        cache.put(1 /* layoutHash */, proximityInfo.get());
+    }
+    ProximityInfoCache cache(path.c_str());
+    EXPECT_EQ(nullptr, cache.createProximityInfo(1 /* layoutHash */));
+    remove(path.c_str());
+}
+
+TEST(ProximityInfoCacheTest, TestRejectsNonPositiveKeyboardSize) {
+    const std::unique_ptr<ProximityInfo> proximityInfo = createProximityInfo();
+    std::vector<uint8_t> data;
+    proximityInfo->writeTo(&data);
+    // The keyboard width and height follow the version.
+    for (const size_t offset : { sizeof(int), 2 * sizeof(int) }) {
+        std::vector<uint8_t> corrupted = data;
+        const int size = 0;
+        memcpy(corrupted.data() + offset, &size, sizeof(size));
+        EXPECT_EQ(nullptr, ProximityInfo::createFromSerializedData(
+                ReadOnlyByteArrayView(corrupted.data(), corrupted.size())));
+    }
+    EXPECT_NE(nullptr, std::unique_ptr<ProximityInfo>(ProximityInfo::createFromSerializedData(
+            ReadOnlyByteArrayView(data.data(), data.size()))));
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/result/suggestion_results.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "defines.h"
+#include "suggest/core/dictionary/dictionary.h"
+
+namespace latinime {
+namespace {
+
+void addSuggestion(SuggestionResults *const suggestionResults, const int codePoint,
+        const int score, const int dictionaryIndex = 0) {
+    suggestionResults->addSuggestion(&codePoint, 1 /* codePointCount */, score,
+            Dictionary::KIND_CORRECTION, NOT_AN_INDEX, NOT_A_FIRST_WORD_CONFIDENCE,
+            dictionaryIndex);
+}
+
+std::vector<int> getSortedScores(const SuggestionResults &suggestionResults) {
+    std::vector<int> scores(suggestionResults.getSuggestionCount());
+    suggestionResults.getSortedScores(scores.data());
+    return scores;
+}
+
+TEST(SuggestionResultsTest, TestMergeWeightsScoresBeforeTruncating) {
+    SuggestionResults resultsOfLowWeight(2 /* maxSuggestionCount */);
+    addSuggestion(&resultsOfLowWeight, 'a', 1000);
+    addSuggestion(&resultsOfLowWeight, 'b', 900);
+    SuggestionResults resultsOfHighWeight(2 /* maxSuggestionCount */);
+    addSuggestion(&resultsOfHighWeight, 'c', 800);
+    addSuggestion(&resultsOfHighWeight, 'd', 700);
+
+    SuggestionResults mergedResults(3 /* maxSuggestionCount */);
+    mergedResults.mergeSuggestionsFrom(resultsOfLowWeight, 0 /* dictionaryIndex */,
+            0.5f /* scoreWeight */);
+    mergedResults.mergeSuggestionsFrom(resultsOfHighWeight, 1 /* dictionaryIndex */,
+            1.0f /* scoreWeight */);
+    // Raw scores would keep 1000, 900 and 800.
+    EXPECT_EQ(std::vector<int>({ 800, 700, 500 }), getSortedScores(mergedResults));
+}
+
+TEST(SuggestionResultsTest, TestKeepsBestOfDuplicatesFromOtherDictionaries) {
+    SuggestionResults suggestionResults(2 /* maxSuggestionCount */);
+    addSuggestion(&suggestionResults, 'a', 500, 0 /* dictionaryIndex */);
+    addSuggestion(&suggestionResults, 'b', 400, 0 /* dictionaryIndex */);
+    // The duplicate replaces the worse copy instead of pushing 'b' out.
+    addSuggestion(&suggestionResults, 'a', 900, 1 /* dictionaryIndex */);
+    addSuggestion(&suggestionResults, 'b', 300, 1 /* dictionaryIndex */);
+    const std::vector<SuggestedWord> suggestedWords =
+            suggestionResults.getSortedSuggestedWords();
+    ASSERT_EQ(2u, suggestedWords.size());
+    EXPECT_EQ('a', suggestedWords[0].getCodePoint()[0]);
+    EXPECT_EQ(900, suggestedWords[0].getScore());
+    EXPECT_EQ(1, suggestedWords[0].getDictionaryIndex());
+    EXPECT_EQ('b', suggestedWords[1].getCodePoint()[0]);
+    EXPECT_EQ(400, suggestedWords[1].getScore());
+    EXPECT_EQ(0, suggestedWords[1].getDictionaryIndex());
+}
+
+TEST(SuggestionResultsTest, TestRemovesEveryWorseCopyFromOtherDictionary) {
+    SuggestionResults suggestionResults(4 /* maxSuggestionCount */);
+    // One dictionary may give a word twice, e.g. for different previous words.
+    addSuggestion(&suggestionResults, 'a', 500, 0 /* dictionaryIndex */);
+    addSuggestion(&suggestionResults, 'a', 450, 0 /* dictionaryIndex */);
+    addSuggestion(&suggestionResults, 'b', 400, 0 /* dictionaryIndex */);
+    addSuggestion(&suggestionResults, 'a', 900, 1 /* dictionaryIndex */);
+    const std::vector<SuggestedWord> suggestedWords =
+            suggestionResults.getSortedSuggestedWords();
+    ASSERT_EQ(2u, suggestedWords.size());
+    EXPECT_EQ('a', suggestedWords[0].getCodePoint()[0]);
+    EXPECT_EQ(1, suggestedWords[0].getDictionaryIndex());
+    EXPECT_EQ('b', suggestedWords[1].getCodePoint()[0]);
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/core/session/gesture_match_cache.h"
+
+#include <gtest/gtest.h>
+
+#include "defines.h"
+
+namespace latinime {
+namespace {
+
+const ProximityInfo *const PROXIMITY_INFO = reinterpret_cast<const ProximityInfo *>(0x1000);
+
+TEST(GestureMatchCacheTest, TestStableInputSize) {
+    GestureMatchCache cache;
+    cache.onInputUpdated(PROXIMITY_INFO, false /* isContinuation */, 2 /* sampledInputSize */);
+    EXPECT_EQ(0, cache.getStableInputSize());
+    cache.onInputUpdated(PROXIMITY_INFO, true /* isContinuation */, 10 /* sampledInputSize */);
+    EXPECT_EQ(7, cache.getStableInputSize());
+}
+
+TEST(GestureMatchCacheTest, TestKeepsResultsWhileGestureContinues) {
+    GestureMatchCache cache;
+    cache.onInputUpdated(PROXIMITY_INFO, false /* isContinuation */, 10 /* sampledInputSize */);
+    cache.putKeySearch('a', 3 /* startIndex */, { 7, 5, 1.5f, true });
+    cache.putLineDeviation('a', 'b', 3 /* startIndex */, { 7, 2.5f });
+    EXPECT_EQ(nullptr, cache.getKeySearch('b', 3 /* startIndex */));
+    EXPECT_EQ(nullptr, cache.getKeySearch('a', 4 /* startIndex */));
+    EXPECT_EQ(nullptr, cache.getLineDeviation('b', 'a', 3 /* startIndex */));
+
+    cache.onInputUpdated(PROXIMITY_INFO, true /* isContinuation */, 12 /* sampledInputSize */);
+    const GestureMatchCache::KeySearch *const keySearch =
+            cache.getKeySearch('a', 3 /* startIndex */);
+    ASSERT_NE(nullptr, keySearch);
+    EXPECT_EQ(7, keySearch->mNextInputIndex);
+    EXPECT_EQ(5, keySearch->mMinEdgeIndex);
+    EXPECT_FLOAT_EQ(1.5f, keySearch->mMinEdgeDistance);
+    EXPECT_TRUE(keySearch->mIsHeadingTowardsKey);
+    const GestureMatchCache::LineDeviation *const lineDeviation =
+            cache.getLineDeviation('a', 'b', 3 /* startIndex */);
+    ASSERT_NE(nullptr, lineDeviation);
+    EXPECT_EQ(7, lineDeviation->mEndInputIndex);
+    EXPECT_FLOAT_EQ(2.5f, lineDeviation->mDeviation);
+}
+
+TEST(GestureMatchCacheTest, TestNotACodePointKey) {
+    GestureMatchCache cache;
+    cache.onInputUpdated(PROXIMITY_INFO, false /* isContinuation */, 10 /* sampledInputSize */);
+    cache.putLineDeviation(NOT_A_CODE_POINT, 'b', 3 /* startIndex */, { 7, 2.5f });
+    EXPECT_NE(nullptr, cache.getLineDeviation(NOT_A_CODE_POINT, 'b', 3 /* startIndex */));
+    EXPECT_EQ(nullptr, cache.getLineDeviation(0x10FFFF, 'b', 3 /* startIndex */));
+    EXPECT_EQ(nullptr, cache.getKeySearch('b', 3 /* startIndex */));
+}
+
+TEST(GestureMatchCacheTest, TestDropsResults) {
+    GestureMatchCache cache;
+    cache.onInputUpdated(PROXIMITY_INFO, false /* isContinuation */, 10 /* sampledInputSize */);
+    cache.putKeySearch('a', 3 /* startIndex */, { 7, 5, 1.5f, true });
+    // A new gesture.
+    cache.onInputUpdated(PROXIMITY_INFO, false /* isContinuation */, 12 /* sampledInputSize */);
+    EXPECT_EQ(nullptr, cache.getKeySearch('a', 3 /* startIndex */));
+
+    cache.putKeySearch('a', 3 /* startIndex */, { 7, 5, 1.5f, true });
+    // Another keyboard.
+    cache.onInputUpdated(reinterpret_cast<const ProximityInfo *>(0x2000),
+            true /* isContinuation */, 14 /* sampledInputSize */);
+    EXPECT_EQ(nullptr, cache.getKeySearch('a', 3 /* startIndex */));
+
+    cache.putKeySearch('a', 3 /* startIndex */, { 11, 5, 1.5f, true });
+    // Resampling merged points, so the results may cover points the next update changes.
+    cache.onInputUpdated(reinterpret_cast<const ProximityInfo *>(0x2000),
+            true /* isContinuation */, 13 /* sampledInputSize */);
+    EXPECT_EQ(nullptr, cache.getKeySearch('a', 3 /* startIndex */));
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suggest/policyimpl/gesture/swipe_weighting.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "defines.h"
+#include "dictionary/interface/dictionary_header_structure_policy.h"
+#include "dictionary/property/ngram_context.h"
+#include "dictionary/structure/dictionary_structure_with_buffer_policy_factory.h"
+#include "dictionary/utils/format_utils.h"
+#include "suggest/core/dictionary/dictionary.h"
+#include "suggest/core/session/dic_traverse_session.h"
+#include "test_utils.h"
+
+namespace latinime {
+namespace {
+
+class SwipeWeightingTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        // The session reads the locale of its dictionary.
+        const DictionaryHeaderStructurePolicy::AttributeMap attributeMap;
+        mDictionary.reset(new Dictionary(nullptr /* env */,
+                DictionaryStructureWithBufferPolicyFactory::newPolicyForOnMemoryDict(
+                        FormatUtils::VERSION_403, CharUtils::EMPTY_STRING, &attributeMap)));
+    }
+
+    // Samples a swipe through the centers of the keys of the word, with a slight wobble.
+    void createGesture(const char *const word) {
+        int prevX = NOT_A_COORDINATE;
+        int prevY = NOT_A_COORDINATE;
+        int time = 0;
+        for (const char *c = word; *c != '\0'; ++c) {
+            const int x = mKeyboard.getKeyCenterX(*c);
+            const int y = mKeyboard.getKeyCenterY(*c);
+            if (prevX == NOT_A_COORDINATE) {
+                addPoint(x, y, time);
+            } else {
+                const int stepCount = std::max(1,
+                        static_cast<int>(hypotf(x - prevX, y - prevY) / 12.0f));
+                for (int step = 1; step <= stepCount; ++step) {
+                    time += 8;
+                    addPoint(prevX + (x - prevX) * step / stepCount + (step % 3) - 1,
+                            prevY + (y - prevY) * step / stepCount + (step % 2), time);
+                }
+            }
+            prevX = x;
+            prevY = y;
+        }
+    }
+
+    void setUpSession(DicTraverseSession *const session, const int inputSize) const {
+        session->init(mDictionary.get(), &mNgramContext, nullptr /* suggestOptions */);
+        session->setupForGetSuggestions(mKeyboard.getProximityInfo(), mInputCodePoints.data(),
+                inputSize, mInputXs.data(), mInputYs.data(), mTimes.data(), mPointerIds.data(),
+                1.0f /* maxSpatialDistance */, MAX_POINTER_COUNT_G);
+    }
+
+    int getGestureSize() const { return static_cast<int>(mInputXs.size()); }
+
+    const TestKeyboard mKeyboard;
+
+ private:
+    void addPoint(const int x, const int y, const int time) {
+        mInputXs.push_back(x);
+        mInputYs.push_back(y);
+        mTimes.push_back(time);
+        mPointerIds.push_back(0);
+        mInputCodePoints.push_back(NOT_A_CODE_POINT);
+    }
+
+    std::unique_ptr<Dictionary> mDictionary;
+    const NgramContext mNgramContext;
+    std::vector<int> mInputXs;
+    std::vector<int> mInputYs;
+    std::vector<int> mTimes;
+    std::vector<int> mPointerIds;
+    std::vector<int> mInputCodePoints;
+};
+
+TEST_F(SwipeWeightingTest, TestCachedScansMatchFreshScans) {
+    createGesture("international");
+    DicTraverseSession session(nullptr /* env */, nullptr /* localeStr */,
+            false /* usesLargeCache */);
+    int checkedKeySearchCount = 0;
+    for (int updateSize = 4; updateSize <= getGestureSize(); updateSize += 3) {
+        setUpSession(&session, updateSize);
+        ASSERT_GT(session.getInputSize(), 0);
+        // A new session has nothing cached, so it scans all the points.
+        DicTraverseSession freshSession(nullptr /* env */, nullptr /* localeStr */,
+                false /* usesLargeCache */);
+        setUpSession(&freshSession, updateSize);
+        ASSERT_EQ(freshSession.getInputSize(), session.getInputSize());
+
+        const int inputSize = session.getInputSize();
+        // The thresholds SwipeWeighting uses for the middle points of a word.
+        const float keyThreshold = 80.0f * util::getThresholdBase(&session);
+        const float lineThreshold = 86.0f * util::getThresholdBase(&session);
+        for (const int codePoint : mKeyboard.getKeyCodePoints()) {
+            for (int startIndex = 0; startIndex < inputSize; startIndex += 5) {
+                int minEdgeIndex = NOT_AN_INDEX;
+                float minEdgeDistance = 0.0f;
+                const bool found = util::findKeyPassing(&session, codePoint, startIndex,
+                        keyThreshold, &minEdgeIndex, &minEdgeDistance);
+                int freshMinEdgeIndex = NOT_AN_INDEX;
+                float freshMinEdgeDistance = 0.0f;
+                const bool freshFound = util::findKeyPassing(&freshSession, codePoint,
+                        startIndex, keyThreshold, &freshMinEdgeIndex, &freshMinEdgeDistance);
+                ASSERT_EQ(freshFound, found) << static_cast<char>(codePoint) << startIndex;
+                ASSERT_EQ(freshMinEdgeIndex, minEdgeIndex);
+                ASSERT_EQ(freshMinEdgeDistance, minEdgeDistance);
+                if (found) {
+                    ++checkedKeySearchCount;
+                }
+
+                const int upperLimit = std::min(inputSize, startIndex + 20);
+                for (const int prevCodePoint : { 'n', 'e' }) {
+                    ASSERT_EQ(util::calcLineDeviationPunishment(&freshSession, prevCodePoint,
+                                    codePoint, startIndex, upperLimit, lineThreshold),
+                            util::getCachedLineDeviationPunishment(&session, prevCodePoint,
+                                    codePoint, startIndex, upperLimit, lineThreshold));
+                }
+            }
+        }
+    }
+    EXPECT_GT(checkedKeySearchCount, 0);
+    // The updates continued the gesture, so the last one resumed the scans of the previous ones.
+    EXPECT_GT(session.getGestureMatchCache()->getStableInputSize(), 0);
+    EXPECT_NE(nullptr, session.getGestureMatchCache()->getKeySearch('i', 0 /* startIndex */));
+    EXPECT_NE(nullptr, session.getGestureMatchCache()->getLineDeviation('n', 'i',
+            0 /* startIndex */));
+}
+
+}  // namespace
+}  // namespace latinime
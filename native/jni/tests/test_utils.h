@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATINIME_TEST_UTILS_H
+#define LATINIME_TEST_UTILS_H
+
+#include <memory>
+#include <vector>
+
+#include "defines.h"
+#include "dictionary/interface/dictionary_structure_with_buffer_policy.h"
+#include "suggest/core/layout/proximity_info.h"
+#include "utils/int_array_view.h"
+
+namespace latinime {
+
+// Helpers shared by the native tests.
+class TestUtils {
+ public:
+    static std::vector<int> toCodePoints(const char *const word) {
+        std::vector<int> codePoints;
+        for (const char *c = word; *c != '\0'; ++c) {
+            codePoints.push_back(*c);
+        }
+        return codePoints;
+    }
+
+    static int getWordId(const DictionaryStructureWithBufferPolicy *const policy,
+            const char *const word) {
+        const std::vector<int> codePoints = toCodePoints(word);
+        return policy->getWordId(CodePointArrayView(codePoints), false /* forceLowerCaseSearch */);
+    }
+
+ private:
+    DISALLOW_IMPLICIT_CONSTRUCTORS(TestUtils);
+};
+
+// A QWERTY letter layout of same sized keys, each row shifted by half a key, without touch
+// position correction.
+class TestKeyboard {
+ public:
+    TestKeyboard() {
+        const int keyWidth = 100;
+        const int keyHeight = 150;
+        static const char *const KEYBOARD_ROWS[] = { "qwertyuiop", "asdfghjkl", "zxcvbnm" };
+        const int rowCount = static_cast<int>(NELEMS(KEYBOARD_ROWS));
+        for (int row = 0; row < rowCount; ++row) {
+            for (const char *c = KEYBOARD_ROWS[row]; *c != '\0'; ++c) {
+                mKeyXs.push_back(static_cast<int>(c - KEYBOARD_ROWS[row]) * keyWidth
+                        + row * keyWidth / 2);
+                mKeyYs.push_back(row * keyHeight);
+                mKeyWidths.push_back(keyWidth);
+                mKeyHeights.push_back(keyHeight);
+                mKeyCodePoints.push_back(*c);
+            }
+        }
+        mProximityInfo.reset(new ProximityInfo(10 * keyWidth /* keyboardWidth */,
+                rowCount * keyHeight /* keyboardHeight */, 32 /* gridWidth */,
+                16 /* gridHeight */, keyWidth /* mostCommonKeyWidth */,
+                keyHeight /* mostCommonKeyHeight */, nullptr /* proximityChars */,
+                static_cast<int>(mKeyCodePoints.size()), mKeyXs.data(), mKeyYs.data(),
+                mKeyWidths.data(), mKeyHeights.data(), mKeyCodePoints.data(),
+                nullptr /* sweetSpotCenterXs */, nullptr /* sweetSpotCenterYs */,
+                nullptr /* sweetSpotRadii */));
+    }
+
+    // Not const, as the suggestion entry points take a mutable proximity info.
+    ProximityInfo *getProximityInfo() const {
+        return mProximityInfo.get();
+    }
+
+    const std::vector<int> &getKeyCodePoints() const {
+        return mKeyCodePoints;
+    }
+
+    int getKeyCenterX(const int codePoint) const {
+        const int keyIndex = mProximityInfo->getKeyIndexOf(codePoint);
+        return mKeyXs[keyIndex] + mKeyWidths[keyIndex] / 2;
+    }
+
+    int getKeyCenterY(const int codePoint) const {
+        const int keyIndex = mProximityInfo->getKeyIndexOf(codePoint);
+        return mKeyYs[keyIndex] + mKeyHeights[keyIndex] / 2;
+    }
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(TestKeyboard);
+
+    std::vector<int> mKeyXs;
+    std::vector<int> mKeyYs;
+    std::vector<int> mKeyWidths;
+    std::vector<int> mKeyHeights;
+    std::vector<int> mKeyCodePoints;
+    std::unique_ptr<ProximityInfo> mProximityInfo;
+};
+} // namespace latinime
+#endif // LATINIME_TEST_UTILS_H
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/left_right_sync.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace latinime {
+namespace {
+
+TEST(LeftRightSyncTest, TestUpdateSwitchesReadableReplica) {
+    LeftRightSync sync;
+    EXPECT_EQ(0, sync.getReadableIndex());
+    std::vector<int> updatedIndices;
+    EXPECT_TRUE(sync.update([&updatedIndices](const int replicaIndex) {
+        updatedIndices.push_back(replicaIndex);
+        return true;
+    }));
+    EXPECT_EQ(std::vector<int>({1, 0}), updatedIndices);
+    EXPECT_EQ(1, sync.getReadableIndex());
+}
+
+TEST(LeftRightSyncTest, TestUpdateReturnsFirstResult) {
+    LeftRightSync sync;
+    int callCount = 0;
+    EXPECT_FALSE(sync.update([&callCount](const int replicaIndex) {
+        return callCount++ != 0;
+    }));
+    EXPECT_EQ(2, callCount);
+}
+
+TEST(LeftRightSyncTest, TestReadersSeeConsistentReplicas) {
+    static const int UPDATE_COUNT = 500;
+    static const int READER_COUNT = 2;
+    LeftRightSync sync;
+    // Both fields of a replica are written together; a reader sharing a replica with the writer
+    // would see them differ.
+    int replicas[2][2] = {{0, 0}, {0, 0}};
+    std::atomic<bool> isDone(false);
+    std::atomic<int> inconsistentReadCount(0);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < READER_COUNT; ++i) {
+        readers.emplace_back([&sync, &replicas, &isDone, &inconsistentReadCount] {
+            int lastValue = 0;
+            while (!isDone.load()) {
+                const LeftRightSync::ReadScope readScope(&sync);
+                const int *const replica = replicas[sync.getReadableIndex()];
+                if (replica[0] != replica[1] || replica[0] < lastValue) {
+                    inconsistentReadCount.fetch_add(1);
+                }
+                lastValue = replica[0];
+                std::this_thread::yield();
+            }
+        });
+    }
+    for (int value = 1; value <= UPDATE_COUNT; ++value) {
+        sync.update([&replicas, value](const int replicaIndex) {
+            replicas[replicaIndex][0] = value;
+            std::this_thread::yield();
+            replicas[replicaIndex][1] = value;
+            return true;
+        });
+    }
+    isDone.store(true);
+    for (std::thread &reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(0, inconsistentReadCount.load());
+    EXPECT_EQ(UPDATE_COUNT, replicas[0][0]);
+    EXPECT_EQ(UPDATE_COUNT, replicas[1][1]);
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/stats_registry.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace latinime {
+namespace {
+
+TEST(StatsRegistryTest, TestBucketIndex) {
+    EXPECT_EQ(0, StatsRegistry::getBucketIndex(0));
+    EXPECT_EQ(0, StatsRegistry::getBucketIndex(1));
+    EXPECT_EQ(1, StatsRegistry::getBucketIndex(2));
+    EXPECT_EQ(1, StatsRegistry::getBucketIndex(3));
+    EXPECT_EQ(2, StatsRegistry::getBucketIndex(4));
+    EXPECT_EQ(10, StatsRegistry::getBucketIndex(1024));
+    EXPECT_EQ(StatsRegistry::HISTOGRAM_BUCKET_COUNT - 1,
+            StatsRegistry::getBucketIndex(static_cast<int64_t>(1) << 40));
+}
+
+TEST(StatsRegistryTest, TestRecord) {
+    StatsRegistry::reset();
+    StatsRegistry::record(StatsStage::SAMPLE_STEP, 10, 3);
+    StatsRegistry::record(StatsStage::SAMPLE_STEP, 100, 2);
+    StatsRegistry::record(StatsStage::SAMPLE_STEP, 1000);
+
+    StatsRegistry::StageSnapshot snapshot;
+    StatsRegistry::getSnapshot(StatsStage::SAMPLE_STEP, &snapshot);
+    EXPECT_EQ(3, snapshot.mEventCount);
+    EXPECT_EQ(6, snapshot.mItemCount);
+    EXPECT_EQ(1110, snapshot.mTotalTimeUs);
+    EXPECT_EQ(1000, snapshot.mMaxTimeUs);
+    EXPECT_EQ(1, snapshot.mHistogram[StatsRegistry::getBucketIndex(10)]);
+    EXPECT_EQ(1, snapshot.mHistogram[StatsRegistry::getBucketIndex(100)]);
+    EXPECT_EQ(1, snapshot.mHistogram[StatsRegistry::getBucketIndex(1000)]);
+
+    StatsRegistry::getSnapshot(StatsStage::GC, &snapshot);
+    EXPECT_EQ(0, snapshot.mEventCount);
+    EXPECT_EQ(0, StatsRegistry::getPercentileUs(snapshot, 0.5f));
+
+    StatsRegistry::reset();
+    StatsRegistry::getSnapshot(StatsStage::SAMPLE_STEP, &snapshot);
+    EXPECT_EQ(0, snapshot.mEventCount);
+    EXPECT_EQ(0, snapshot.mMaxTimeUs);
+}
+
+TEST(StatsRegistryTest, TestPercentile) {
+    StatsRegistry::reset();
+    for (int i = 0; i < 99; ++i) {
+        StatsRegistry::record(StatsStage::KV_COPY, 5);
+    }
+    StatsRegistry::record(StatsStage::KV_COPY, 3000);
+
+    StatsRegistry::StageSnapshot snapshot;
+    StatsRegistry::getSnapshot(StatsStage::KV_COPY, &snapshot);
+    EXPECT_EQ(8, StatsRegistry::getPercentileUs(snapshot, 0.5f));
+    EXPECT_EQ(8, StatsRegistry::getPercentileUs(snapshot, 0.9f));
+    EXPECT_EQ(4096, StatsRegistry::getPercentileUs(snapshot, 0.995f));
+    StatsRegistry::reset();
+}
+
+TEST(StatsRegistryTest, TestScopedTimerAndDump) {
+    StatsRegistry::reset();
+    {
+        StatsScopedTimer timer(StatsStage::DIC_NODE_EXPANSION);
+        timer.setItemCount(0);
+        timer.addItems(7);
+    }
+
+    StatsRegistry::StageSnapshot snapshot;
+    StatsRegistry::getSnapshot(StatsStage::DIC_NODE_EXPANSION, &snapshot);
+    EXPECT_EQ(1, snapshot.mEventCount);
+    EXPECT_EQ(7, snapshot.mItemCount);
+
+    const std::string dump = StatsRegistry::dump();
+    EXPECT_NE(std::string::npos, dump.find("dic_node_expansion events=1 items=7 "));
+    EXPECT_NE(std::string::npos, dump.find("tokenize events=0 "));
+    StatsRegistry::reset();
+}
+
+}  // namespace
+}  // namespace latinime
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2026 FUTO Holdings, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/worker_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+namespace latinime {
+namespace {
+
+TEST(WorkerPoolTest, TestRunsEveryTaskOnce) {
+    static const int TASK_COUNT = 17;
+    WorkerPool workerPool(4 /* threadCount */);
+    EXPECT_EQ(4, workerPool.getThreadCount());
+    std::vector<std::atomic<int>> runCounts(TASK_COUNT);
+    workerPool.run(TASK_COUNT, [&runCounts](const int taskIndex) {
+        runCounts[taskIndex].fetch_add(1);
+    });
+    for (int i = 0; i < TASK_COUNT; ++i) {
+        EXPECT_EQ(1, runCounts[i].load());
+    }
+}
+
+TEST(WorkerPoolTest, TestSingleThreadRunsInline) {
+    WorkerPool workerPool(1 /* threadCount */);
+    EXPECT_EQ(1, workerPool.getThreadCount());
+    std::vector<int> taskIndices;
+    workerPool.run(3 /* taskCount */, [&taskIndices](const int taskIndex) {
+        taskIndices.push_back(taskIndex);
+    });
+    EXPECT_EQ(std::vector<int>({0, 1, 2}), taskIndices);
+}
+
+TEST(WorkerPoolTest, TestRepeatedBatches) {
+    WorkerPool workerPool(3 /* threadCount */);
+    std::atomic<int> sum(0);
+    for (int batch = 0; batch < 100; ++batch) {
+        workerPool.run(batch % 5, [&sum](const int taskIndex) {
+            sum.fetch_add(taskIndex + 1);
+        });
+    }
+    // Each batch of n tasks adds 1 + 2 + ... + n; n cycles through 0..4 twenty times.
+    EXPECT_EQ(20 * (0 + 1 + 3 + 6 + 10), sum.load());
+}
+
+}  // namespace
+}  // namespace latinime
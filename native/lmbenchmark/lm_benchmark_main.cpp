@@ -0,0 +1,367 @@
+// Replays a typed corpus through LanguageModelState on the host and reports per-keystroke latency
+// and top-1/top-3 accuracy. See README.md for the layout and corpus formats.
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ggml/LanguageModelState.h"
+#include "suggest/core/layout/proximity_info.h"
+#include "utils/stats_registry.h"
+
+// Grid used by the Java ProximityInfo, the LM only needs the key rectangles
+#define GRID_WIDTH 32
+#define GRID_HEIGHT 16
+
+// Same limit as LanguageModel.safeguardContext
+#define MAX_CONTEXT_LENGTH 128
+
+struct Options {
+    std::string modelPath;
+    std::string layoutPath;
+    std::string corpusPath;
+    float autocorrectThreshold = 4.0f;
+    float noise = 0.0f; // standard deviation of synthesized taps, in key widths
+    int maxWords = -1;
+    unsigned int seed = 1;
+};
+
+struct Key {
+    int codePoint;
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+struct Layout {
+    int width = 0;
+    int height = 0;
+    int mostCommonKeyWidth = 0;
+    int mostCommonKeyHeight = 0;
+    std::vector<Key> keys;
+};
+
+struct CorpusWord {
+    std::string target;
+    std::string typed;
+    std::vector<std::pair<int, int>> taps; // empty when the taps are synthesized
+    bool startsSentence;
+};
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "Usage: %s --model <model.gguf> --layout <layout.txt> --corpus <corpus.tsv>\n"
+            "        [--threshold <autocorrect threshold, default 4.0>] [--noise <key widths>]\n"
+            "        [--max-words <n>] [--seed <n>]\n", argv0);
+}
+
+static bool parseOptions(int argc, char **argv, Options *options) {
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Missing value for %s\n", arg);
+            return false;
+        }
+        const char *value = argv[++i];
+        if (strcmp(arg, "--model") == 0) {
+            options->modelPath = value;
+        } else if (strcmp(arg, "--layout") == 0) {
+            options->layoutPath = value;
+        } else if (strcmp(arg, "--corpus") == 0) {
+            options->corpusPath = value;
+        } else if (strcmp(arg, "--threshold") == 0) {
+            options->autocorrectThreshold = strtof(value, nullptr);
+        } else if (strcmp(arg, "--noise") == 0) {
+            options->noise = strtof(value, nullptr);
+        } else if (strcmp(arg, "--max-words") == 0) {
+            options->maxWords = atoi(value);
+        } else if (strcmp(arg, "--seed") == 0) {
+            options->seed = static_cast<unsigned int>(strtoul(value, nullptr, 10));
+        } else {
+            fprintf(stderr, "Unknown option %s\n", arg);
+            return false;
+        }
+    }
+    return !options->modelPath.empty() && !options->layoutPath.empty()
+            && !options->corpusPath.empty();
+}
+
+// A key label is either a single ASCII character or a code point written as U+XXXX
+static int parseCodePoint(const std::string &label) {
+    if (label.size() > 2 && label[0] == 'U' && label[1] == '+') {
+        return static_cast<int>(strtol(label.c_str() + 2, nullptr, 16));
+    }
+    return label.size() == 1 ? static_cast<unsigned char>(label[0]) : -1;
+}
+
+static bool readLayout(const std::string &path, Layout *layout) {
+    std::ifstream file(path);
+    if (!file) {
+        fprintf(stderr, "Cannot open layout %s\n", path.c_str());
+        return false;
+    }
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        std::istringstream stream(line);
+        std::string kind;
+        if (!(stream >> kind) || kind[0] == '#') continue;
+        if (kind == "keyboard") {
+            stream >> layout->width >> layout->height >> layout->mostCommonKeyWidth
+                    >> layout->mostCommonKeyHeight;
+        } else if (kind == "key") {
+            std::string label;
+            Key key {};
+            stream >> label >> key.x >> key.y >> key.width >> key.height;
+            key.codePoint = parseCodePoint(label);
+            if (key.codePoint < 0) {
+                fprintf(stderr, "%s:%d: bad key label [%s]\n", path.c_str(), lineNumber,
+                        label.c_str());
+                return false;
+            }
+            layout->keys.push_back(key);
+        }
+        if (stream.fail()) {
+            fprintf(stderr, "%s:%d: cannot parse [%s]\n", path.c_str(), lineNumber, line.c_str());
+            return false;
+        }
+    }
+    if (layout->width <= 0 || layout->height <= 0 || layout->mostCommonKeyWidth <= 0
+            || layout->keys.empty()) {
+        fprintf(stderr, "Layout %s needs a keyboard line and at least one key\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+static std::unique_ptr<latinime::ProximityInfo> createProximityInfo(const Layout &layout) {
+    std::vector<int> xs, ys, widths, heights, codePoints;
+    for (const Key &key : layout.keys) {
+        xs.push_back(key.x);
+        ys.push_back(key.y);
+        widths.push_back(key.width);
+        heights.push_back(key.height);
+        codePoints.push_back(key.codePoint);
+    }
+    return std::unique_ptr<latinime::ProximityInfo>(new latinime::ProximityInfo(
+            layout.width, layout.height, GRID_WIDTH, GRID_HEIGHT, layout.mostCommonKeyWidth,
+            layout.mostCommonKeyHeight, nullptr /* proximityChars */,
+            static_cast<int>(layout.keys.size()), xs.data(), ys.data(), widths.data(),
+            heights.data(), codePoints.data(), nullptr, nullptr, nullptr));
+}
+
+// One word per line: <target>[\t<typed letters>[\t<x>,<y> <x>,<y> ...]]. A blank line starts a
+// new sentence, which clears the context.
+static bool readCorpus(const std::string &path, std::vector<CorpusWord> *words) {
+    std::ifstream file(path);
+    if (!file) {
+        fprintf(stderr, "Cannot open corpus %s\n", path.c_str());
+        return false;
+    }
+    std::string line;
+    bool startsSentence = true;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) {
+            startsSentence = true;
+            continue;
+        }
+        std::vector<std::string> columns;
+        std::istringstream stream(line);
+        std::string column;
+        while (std::getline(stream, column, '\t')) columns.push_back(column);
+
+        CorpusWord word {};
+        word.target = columns[0];
+        word.typed = columns.size() > 1 && !columns[1].empty() ? columns[1] : columns[0];
+        if (columns.size() > 2) {
+            std::istringstream taps(columns[2]);
+            std::string tap;
+            while (taps >> tap) {
+                int x, y;
+                if (sscanf(tap.c_str(), "%d,%d", &x, &y) != 2) {
+                    fprintf(stderr, "Bad tap [%s] for [%s]\n", tap.c_str(), word.target.c_str());
+                    return false;
+                }
+                word.taps.emplace_back(x, y);
+            }
+            if (word.taps.size() != word.typed.size()) {
+                fprintf(stderr, "[%s] has %d taps for %d letters\n", word.target.c_str(),
+                        static_cast<int>(word.taps.size()), static_cast<int>(word.typed.size()));
+                return false;
+            }
+        }
+        word.startsSentence = startsSentence;
+        startsSentence = false;
+        words->push_back(word);
+    }
+    return true;
+}
+
+// Taps at the centers of the typed keys, moved by gaussian noise when requested
+static void synthesizeTaps(const Layout &layout, CorpusWord *word, float noise,
+        std::mt19937 *random) {
+    std::normal_distribution<float> distribution(0.0f, noise * layout.mostCommonKeyWidth);
+    for (char c : word->typed) {
+        const int codePoint = tolower(static_cast<unsigned char>(c));
+        auto key = std::find_if(layout.keys.begin(), layout.keys.end(), [&](const Key &k) {
+            return tolower(k.codePoint) == codePoint;
+        });
+        if (key == layout.keys.end()) {
+            word->taps.emplace_back(-1, -1);
+            continue;
+        }
+        float x = key->x + key->width / 2.0f;
+        float y = key->y + key->height / 2.0f;
+        if (noise > 0.0f) {
+            x += distribution(*random);
+            y += distribution(*random);
+        }
+        x = std::min(std::max(x, 0.0f), static_cast<float>(layout.width - 1));
+        y = std::min(std::max(y, 0.0f), static_cast<float>(layout.height - 1));
+        word->taps.emplace_back(static_cast<int>(x), static_cast<int>(y));
+    }
+}
+
+static std::string safeguardContext(std::string context) {
+    while (context.size() > MAX_CONTEXT_LENGTH) {
+        const size_t space = context.find(' ');
+        if (space == std::string::npos) break;
+        context = context.substr(space + 1);
+    }
+    return context;
+}
+
+static bool matchesTarget(const std::string &suggestion, const std::string &target) {
+    std::string a = suggestion;
+    a.erase(0, a.find_first_not_of(' '));
+    a.erase(a.find_last_not_of(' ') + 1);
+    if (a.size() != target.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (tolower(static_cast<unsigned char>(a[i]))
+                != tolower(static_cast<unsigned char>(target[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void printLatencies(const char *name, std::vector<int64_t> latencies) {
+    if (latencies.empty()) {
+        printf("%-12s n=0\n", name);
+        return;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    int64_t total = 0;
+    for (int64_t latency : latencies) total += latency;
+    auto percentile = [&](float p) {
+        size_t index = static_cast<size_t>(ceilf(p * latencies.size())) - 1;
+        return latencies[std::min(index, latencies.size() - 1)] / 1000.0;
+    };
+    printf("%-12s n=%zu mean=%.2fms p50=%.2fms p90=%.2fms p99=%.2fms max=%.2fms\n", name,
+            latencies.size(), total / 1000.0 / latencies.size(), percentile(0.5f),
+            percentile(0.9f), percentile(0.99f), latencies.back() / 1000.0);
+}
+
+static void quietLog(ggml_log_level level, const char *text, void *userData) {
+    if (level == GGML_LOG_LEVEL_ERROR) fputs(text, stderr);
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, &options)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    Layout layout;
+    std::vector<CorpusWord> words;
+    if (!readLayout(options.layoutPath, &layout) || !readCorpus(options.corpusPath, &words)) {
+        return 1;
+    }
+    if (options.maxWords >= 0 && static_cast<int>(words.size()) > options.maxWords) {
+        words.resize(options.maxWords);
+    }
+
+    std::mt19937 random(options.seed);
+    for (CorpusWord &word : words) {
+        if (word.taps.empty()) synthesizeTaps(layout, &word, options.noise, &random);
+    }
+
+    llama_backend_init(false);
+    llama_log_set(quietLog, nullptr);
+
+    const std::unique_ptr<latinime::ProximityInfo> proximityInfo = createProximityInfo(layout);
+    LanguageModelState state;
+    const int64_t loadStart = latinime::StatsRegistry::getTimeInMicroSec();
+    if (!state.Initialize(options.modelPath, "")) {
+        fprintf(stderr, "Cannot load model %s\n", options.modelPath.c_str());
+        return 1;
+    }
+    printf("Loaded %s in %.1f ms\n", options.modelPath.c_str(),
+            (latinime::StatsRegistry::getTimeInMicroSec() - loadStart) / 1000.0);
+    latinime::StatsRegistry::reset();
+
+    std::vector<int64_t> predictionLatencies;
+    std::vector<int64_t> correctionLatencies;
+    int top1 = 0;
+    int top3 = 0;
+    std::string context;
+    std::vector<std::pair<float, std::string>> results;
+
+    for (const CorpusWord &word : words) {
+        if (word.startsSentence) context.clear();
+        const std::string safeContext = safeguardContext(context);
+
+        // Next word prediction before the first letter, then one correction per keystroke
+        for (size_t typed = 0; typed <= word.typed.size(); ++typed) {
+            std::vector<int> xs, ys;
+            for (size_t i = 0; i < typed; ++i) {
+                xs.push_back(word.taps[i].first);
+                ys.push_back(word.taps[i].second);
+            }
+
+            const int64_t start = latinime::StatsRegistry::getTimeInMicroSec();
+            state.GetSuggestions(proximityInfo.get(), safeContext, word.typed.substr(0, typed),
+                    0 /* inputMode */, xs.data(), ys.data(), typed, options.autocorrectThreshold,
+                    results);
+            const int64_t latency = latinime::StatsRegistry::getTimeInMicroSec() - start;
+            (typed == 0 ? predictionLatencies : correctionLatencies).push_back(latency);
+        }
+
+        for (size_t i = 0; i < results.size() && i < 3; ++i) {
+            if (matchesTarget(results[i].second, word.target)) {
+                if (i == 0) top1++;
+                top3++;
+                break;
+            }
+        }
+
+        if (!context.empty()) context += " ";
+        context += word.target;
+    }
+
+    printf("Words: %zu, top-1 accuracy %.2f%%, top-3 accuracy %.2f%%\n", words.size(),
+            words.empty() ? 0.0 : 100.0 * top1 / words.size(),
+            words.empty() ? 0.0 : 100.0 * top3 / words.size());
+    printLatencies("prediction", predictionLatencies);
+    printLatencies("correction", correctionLatencies);
+    std::vector<int64_t> allLatencies = predictionLatencies;
+    allLatencies.insert(allLatencies.end(), correctionLatencies.begin(),
+            correctionLatencies.end());
+    printLatencies("keystroke", allLatencies);
+    printf("\n%s", latinime::StatsRegistry::dump().c_str());
+
+    llama_backend_free();
+    return 0;
+}
@@ -72,6 +72,14 @@ class WhisperGGML(
         }
     }
 
+    // Sizes and pages in the native buffers so the first dictation does not pay for it.
+    // Safe to call more than once, later calls return immediately
+    suspend fun warmup() = withContext(inferenceContext) {
+        if(handle != 0L) {
+            warmupNative(handle)
+        }
+    }
+
     fun cancel() {
         if(handle == 0L) return
         cancelNative(handle)
@@ -87,6 +95,7 @@ class WhisperGGML(
     private external fun openNative(path: String): Long
     private external fun openFromBufferNative(buffer: Buffer): Long
     private external fun inferNative(handle: Long, samples: FloatArray, prompt: String, languages: Array<String>, bailLanguages: Array<String>, decodingMode: Int, suppressNonSpeechTokens: Boolean): String
+    private external fun warmupNative(handle: Long): Boolean
     private external fun cancelNative(handle: Long)
     private external fun closeNative(handle: Long)
 }
\ No newline at end of file
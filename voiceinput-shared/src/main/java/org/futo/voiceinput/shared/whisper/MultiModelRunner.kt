@@ -33,7 +33,7 @@ class MultiModelRunner(
         val jobs = mutableListOf<Job>()
 
         jobs.add(launch(Dispatchers.Default) {
-            modelManager.obtainModel(runConfiguration.primaryModel)
+            modelManager.obtainModel(runConfiguration.primaryModel).warmup()
         })
 
         if (runConfiguration.languageSpecificModels.count() < 2) {